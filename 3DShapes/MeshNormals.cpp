@@ -0,0 +1,555 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshnormals.cpp
+// ============
+// generate the normals and tangents of indexed triangle meshes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshNormals.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MESH_NORMALS_AVX2
+#endif
+
+// declaration of global variables
+namespace
+{
+	// number of triangles processed together by the SIMD kernels
+	const size_t g_GroupSize = 8;
+	// largest float offset the 32 bit gathers can address
+	const size_t g_MaxGatherOffset = 0x7FFFFFFF;
+	// sums with a squared length below this are degenerate
+	const float g_MinLengthSquared = 1e-30f;
+	const float g_Pi = 3.14159265358979f;
+	// floats of the sums of each vertex of the tangents - the
+	// tangent and angle of the triangles that keep the texture
+	// as it is, and of the ones that mirror it
+	const size_t g_FloatsPerTangentSum = 8;
+	// floats of the sum of the normals of each vertex, padded so
+	// a sum is added with one vector
+	const size_t g_FloatsPerNormalSum = 4;
+
+	/***********************************************************
+	 *  ApproximateAcos()
+	 *
+	 *  This function is used for the arc cosine that weights
+	 *  the corners of the tangents, with the polynomial of
+	 *  Abramowitz and Stegun 4.4.45, which is within 0.00007
+	 *  radians - far closer than a weight needs to be.
+	 ***********************************************************/
+	float ApproximateAcos(float x)
+	{
+		x = std::min(std::max(x, -1.0f), 1.0f);
+		float a = fabsf(x);
+		float result = sqrtf(1.0f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f + a * -0.0187293f)));
+		return((x < 0.0f) ? (g_Pi - result) : result);
+	}
+
+	/***********************************************************
+	 *  NormalizeOrZero()
+	 *
+	 *  This function is used for normalizing a vector, and
+	 *  leaving the vectors too short to have a direction as 0.
+	 ***********************************************************/
+	glm::vec3 NormalizeOrZero(const glm::vec3& v)
+	{
+		float lengthSquared = glm::dot(v, v);
+		return((lengthSquared > g_MinLengthSquared) ? (v / sqrtf(lengthSquared)) : glm::vec3(0.0f));
+	}
+
+	/***********************************************************
+	 *  GetCornerTangents()
+	 *
+	 *  This function is used for computing the tangent of a
+	 *  triangle, as MikkTSpace does, projected onto the plane
+	 *  of the normal of each corner, and the angles of the
+	 *  corners in those planes.  The sign of the area of the
+	 *  texture coordinates is returned - negative when the
+	 *  triangle mirrors the texture.
+	 ***********************************************************/
+	float GetCornerTangents(
+		const glm::vec3 positions[3],
+		const glm::vec3 normals[3],
+		const glm::vec2 uvs[3],
+		glm::vec3 tangents[3],
+		float angles[3])
+	{
+		glm::vec3 d1 = positions[1] - positions[0];
+		glm::vec3 d2 = positions[2] - positions[0];
+		glm::vec2 t21 = uvs[1] - uvs[0];
+		glm::vec2 t31 = uvs[2] - uvs[0];
+		float signedArea = t21.x * t31.y - t21.y * t31.x;
+		float sign = (signedArea > 0.0f) ? 1.0f : -1.0f;
+
+		// the direction the u coordinate grows in, which points
+		// the other way in a mirrored triangle
+		glm::vec3 tangent(0.0f);
+		if (signedArea != 0.0f)
+		{
+			tangent = NormalizeOrZero(d1 * t31.y - d2 * t21.y) * sign;
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			const glm::vec3& n = normals[c];
+			glm::vec3 edge1 = positions[(c + 2) % 3] - positions[c];
+			glm::vec3 edge2 = positions[(c + 1) % 3] - positions[c];
+			edge1 = NormalizeOrZero(edge1 - n * glm::dot(n, edge1));
+			edge2 = NormalizeOrZero(edge2 - n * glm::dot(n, edge2));
+			tangents[c] = NormalizeOrZero(tangent - n * glm::dot(n, tangent));
+			angles[c] = ApproximateAcos(glm::dot(edge1, edge2));
+		}
+		return(sign);
+	}
+
+	/***********************************************************
+	 *  AddCornerTangent()
+	 *
+	 *  This function is used for adding the tangent of a
+	 *  corner, weighted by its angle, to the sums of its
+	 *  vertex on the side of its mirroring.
+	 ***********************************************************/
+	void AddCornerTangent(
+		float* pSums,
+		unsigned int vertex,
+		const glm::vec3& tangent,
+		float angle,
+		float sign)
+	{
+		float* pSum = pSums + (size_t)vertex * g_FloatsPerTangentSum + ((sign > 0.0f) ? 0 : 4);
+		pSum[0] += tangent.x * angle;
+		pSum[1] += tangent.y * angle;
+		pSum[2] += tangent.z * angle;
+		pSum[3] += angle;
+	}
+
+	/***********************************************************
+	 *  AddFaceNormal()
+	 *
+	 *  This function is used for adding the cross product of
+	 *  the edges of a triangle to the sums of its vertices.
+	 ***********************************************************/
+	void AddFaceNormal(
+		float* pSums,
+		const unsigned int* pTriangle,
+		float x,
+		float y,
+		float z)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			float* pSum = pSums + (size_t)pTriangle[c] * g_FloatsPerNormalSum;
+			pSum[0] += x;
+			pSum[1] += y;
+			pSum[2] += z;
+		}
+	}
+
+#if defined(MESH_NORMALS_AVX2)
+	// three components of eight vectors
+	struct VEC3_8
+	{
+		__m256 x;
+		__m256 y;
+		__m256 z;
+	};
+
+	/***********************************************************
+	 *  GatherCorner()
+	 *
+	 *  This function is used for reading the values at the
+	 *  passed in offset of the vertices of one corner of eight
+	 *  triangles, whose float offsets are passed in.
+	 ***********************************************************/
+	VEC3_8 GatherCorner(const float* pValues, __m256i offsets)
+	{
+		VEC3_8 v;
+		v.x = _mm256_i32gather_ps(pValues, offsets, 4);
+		v.y = _mm256_i32gather_ps(pValues + 1, offsets, 4);
+		v.z = _mm256_i32gather_ps(pValues + 2, offsets, 4);
+		return(v);
+	}
+
+	/***********************************************************
+	 *  GatherCornerOffsets()
+	 *
+	 *  This function is used for reading the vertex of one
+	 *  corner of eight triangles in a row, and turning it into
+	 *  the float offset of the vertex.
+	 ***********************************************************/
+	__m256i GatherCornerOffsets(const unsigned int* pTriangles, int corner, size_t stride)
+	{
+		const __m256i steps = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+		__m256i vertices = _mm256_i32gather_epi32((const int*)pTriangles + corner, steps, 4);
+		return(_mm256_mullo_epi32(vertices, _mm256_set1_epi32((int)stride)));
+	}
+
+	/***********************************************************
+	 *  Sub8(), Scale8() and Dot8()
+	 *
+	 *  These functions are used for the differences, scales
+	 *  and dot products of eight vectors at a time.
+	 ***********************************************************/
+	VEC3_8 Sub8(const VEC3_8& a, const VEC3_8& b)
+	{
+		VEC3_8 v;
+		v.x = _mm256_sub_ps(a.x, b.x);
+		v.y = _mm256_sub_ps(a.y, b.y);
+		v.z = _mm256_sub_ps(a.z, b.z);
+		return(v);
+	}
+
+	VEC3_8 Scale8(const VEC3_8& a, __m256 s)
+	{
+		VEC3_8 v;
+		v.x = _mm256_mul_ps(a.x, s);
+		v.y = _mm256_mul_ps(a.y, s);
+		v.z = _mm256_mul_ps(a.z, s);
+		return(v);
+	}
+
+	__m256 Dot8(const VEC3_8& a, const VEC3_8& b)
+	{
+		return(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a.x, b.x), _mm256_mul_ps(a.y, b.y)), _mm256_mul_ps(a.z, b.z)));
+	}
+
+	/***********************************************************
+	 *  NormalizeOrZero8()
+	 *
+	 *  This function is used for normalizing eight vectors,
+	 *  the same way as NormalizeOrZero().
+	 ***********************************************************/
+	VEC3_8 NormalizeOrZero8(const VEC3_8& a)
+	{
+		__m256 lengthSquared = Dot8(a, a);
+		__m256 valid = _mm256_cmp_ps(lengthSquared, _mm256_set1_ps(g_MinLengthSquared), _CMP_GT_OQ);
+		__m256 scale = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(lengthSquared)), valid);
+		return(Scale8(a, scale));
+	}
+
+	/***********************************************************
+	 *  RejectNormal8()
+	 *
+	 *  This function is used for projecting eight vectors onto
+	 *  the planes of eight normals and normalizing them.
+	 ***********************************************************/
+	VEC3_8 RejectNormal8(const VEC3_8& v, const VEC3_8& n)
+	{
+		return(NormalizeOrZero8(Sub8(v, Scale8(n, Dot8(n, v)))));
+	}
+
+	/***********************************************************
+	 *  LoadCornerPair()
+	 *
+	 *  This function is used for reading the positions of the
+	 *  same corner of two triangles into the two halves of one
+	 *  register.  The fourth float of each half is read with
+	 *  the position when the stride leaves room for it.
+	 ***********************************************************/
+	__m256 LoadCornerPair(const float* pFirst, const float* pSecond, bool bPadded)
+	{
+		if (bPadded == true)
+		{
+			return(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pFirst)), _mm_loadu_ps(pSecond), 1));
+		}
+		return(_mm256_setr_ps(pFirst[0], pFirst[1], pFirst[2], 0.0f, pSecond[0], pSecond[1], pSecond[2], 0.0f));
+	}
+
+	/***********************************************************
+	 *  CrossPair()
+	 *
+	 *  This function is used for the cross products of the two
+	 *  pairs of vectors in the halves of two registers, as
+	 *  (a * b.yzx - a.yzx * b).yzx.
+	 ***********************************************************/
+	__m256 CrossPair(__m256 a, __m256 b)
+	{
+		__m256 aYZX = _mm256_permute_ps(a, _MM_SHUFFLE(3, 0, 2, 1));
+		__m256 bYZX = _mm256_permute_ps(b, _MM_SHUFFLE(3, 0, 2, 1));
+		__m256 c = _mm256_sub_ps(_mm256_mul_ps(a, bYZX), _mm256_mul_ps(aYZX, b));
+		return(_mm256_permute_ps(c, _MM_SHUFFLE(3, 0, 2, 1)));
+	}
+
+	/***********************************************************
+	 *  AddFaceNormal4()
+	 *
+	 *  This function is used for adding the cross product of
+	 *  a triangle, as one vector, to the sums of its vertices.
+	 ***********************************************************/
+	void AddFaceNormal4(float* pSums, const unsigned int* pTriangle, __m128 face)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			float* pSum = pSums + (size_t)pTriangle[c] * g_FloatsPerNormalSum;
+			_mm_storeu_ps(pSum, _mm_add_ps(_mm_loadu_ps(pSum), face));
+		}
+	}
+
+	/***********************************************************
+	 *  ApproximateAcos8()
+	 *
+	 *  This function is used for eight arc cosines, with the
+	 *  polynomial of ApproximateAcos().
+	 ***********************************************************/
+	__m256 ApproximateAcos8(__m256 x)
+	{
+		const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+		x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+		__m256 a = _mm256_andnot_ps(signMask, x);
+		__m256 poly = _mm256_set1_ps(-0.0187293f);
+		poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(0.0742610f));
+		poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(-0.2121144f));
+		poly = _mm256_add_ps(_mm256_mul_ps(poly, a), _mm256_set1_ps(1.5707288f));
+		__m256 result = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), a)), poly);
+		__m256 negative = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ);
+		return(_mm256_blendv_ps(result, _mm256_sub_ps(_mm256_set1_ps(g_Pi), result), negative));
+	}
+#endif
+}
+
+/***********************************************************
+ *  GenerateNormals()
+ *
+ *  This function is used for adding the cross products of
+ *  the edges of every triangle to its vertices and then
+ *  normalizing the sums.  When AVX2 is available, eight
+ *  triangles are crossed per iteration, two in each
+ *  register, so each sum is added as one vector, and the
+ *  lengths of eight sums are found at a time.
+ ***********************************************************/
+void GenerateNormals(
+	const float* pPositions,
+	size_t positionStride,
+	size_t vertexCount,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	float* pNormals,
+	size_t normalStride)
+{
+	size_t triangleCount = indexCount / 3;
+	std::vector<float> sums(vertexCount * g_FloatsPerNormalSum, 0.0f);
+
+	size_t t = 0;
+#if defined(MESH_NORMALS_AVX2)
+	bool bPadded = (positionStride >= 4);
+	for (; t + g_GroupSize <= triangleCount; t += g_GroupSize)
+	{
+		for (size_t pair = 0; pair < g_GroupSize; pair += 2)
+		{
+			const unsigned int* pFirst = pIndices + (t + pair) * 3;
+			const unsigned int* pSecond = pFirst + 3;
+			__m256 p0 = LoadCornerPair(pPositions + pFirst[0] * positionStride, pPositions + pSecond[0] * positionStride, bPadded);
+			__m256 p1 = LoadCornerPair(pPositions + pFirst[1] * positionStride, pPositions + pSecond[1] * positionStride, bPadded);
+			__m256 p2 = LoadCornerPair(pPositions + pFirst[2] * positionStride, pPositions + pSecond[2] * positionStride, bPadded);
+			__m256 face = CrossPair(_mm256_sub_ps(p1, p0), _mm256_sub_ps(p2, p0));
+
+			// the two triangles can share vertices, so their sums
+			// are added one after the other
+			AddFaceNormal4(sums.data(), pFirst, _mm256_castps256_ps128(face));
+			AddFaceNormal4(sums.data(), pSecond, _mm256_extractf128_ps(face, 1));
+		}
+	}
+#endif
+
+	for (; t < triangleCount; t++)
+	{
+		const unsigned int* pTriangle = pIndices + t * 3;
+		glm::vec3 p0(pPositions[pTriangle[0] * positionStride], pPositions[pTriangle[0] * positionStride + 1], pPositions[pTriangle[0] * positionStride + 2]);
+		glm::vec3 p1(pPositions[pTriangle[1] * positionStride], pPositions[pTriangle[1] * positionStride + 1], pPositions[pTriangle[1] * positionStride + 2]);
+		glm::vec3 p2(pPositions[pTriangle[2] * positionStride], pPositions[pTriangle[2] * positionStride + 1], pPositions[pTriangle[2] * positionStride + 2]);
+		// twice the area in the direction of the normal
+		glm::vec3 face = glm::cross(p1 - p0, p2 - p0);
+		AddFaceNormal(sums.data(), pTriangle, face.x, face.y, face.z);
+	}
+
+	size_t v = 0;
+#if defined(MESH_NORMALS_AVX2)
+	const __m256i offsets = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+	float scales[g_GroupSize];
+	for (; v + g_GroupSize <= vertexCount; v += g_GroupSize)
+	{
+		VEC3_8 sum = GatherCorner(&sums[v * g_FloatsPerNormalSum], offsets);
+		__m256 lengthSquared = Dot8(sum, sum);
+		__m256 valid = _mm256_cmp_ps(lengthSquared, _mm256_set1_ps(g_MinLengthSquared), _CMP_GT_OQ);
+		// 0 marks the sums that get the default normal
+		_mm256_storeu_ps(scales, _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(lengthSquared)), valid));
+		for (size_t lane = 0; lane < g_GroupSize; lane++)
+		{
+			const float* pSum = &sums[(v + lane) * g_FloatsPerNormalSum];
+			float* pNormal = pNormals + (v + lane) * normalStride;
+			pNormal[0] = pSum[0] * scales[lane];
+			pNormal[1] = (scales[lane] > 0.0f) ? (pSum[1] * scales[lane]) : 1.0f;
+			pNormal[2] = pSum[2] * scales[lane];
+		}
+	}
+#endif
+
+	for (; v < vertexCount; v++)
+	{
+		const float* pSum = &sums[v * g_FloatsPerNormalSum];
+		float* pNormal = pNormals + v * normalStride;
+		glm::vec3 normal = NormalizeOrZero(glm::vec3(pSum[0], pSum[1], pSum[2]));
+		if (normal == glm::vec3(0.0f))
+		{
+			normal = glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+		pNormal[0] = normal.x;
+		pNormal[1] = normal.y;
+		pNormal[2] = normal.z;
+	}
+}
+
+/***********************************************************
+ *  GenerateTangents()
+ *
+ *  This function is used for adding the tangent of every
+ *  corner, weighted by its angle, to its vertex, apart for
+ *  the triangles that mirror the texture and the ones that
+ *  do not, and then keeping the side with the larger angle
+ *  around each vertex.  Eight triangles are processed at a
+ *  time when AVX2 is available.  A vertex without a usable
+ *  tangent gets one along the axis furthest from its normal.
+ ***********************************************************/
+void GenerateTangents(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	size_t vertexCount,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	size_t normalOffset,
+	size_t uvOffset,
+	std::vector<float>& tangents)
+{
+	size_t triangleCount = indexCount / 3;
+	std::vector<float> sums(vertexCount * g_FloatsPerTangentSum, 0.0f);
+
+	size_t t = 0;
+#if defined(MESH_NORMALS_AVX2)
+	if (vertexCount * floatsPerVertex <= g_MaxGatherOffset)
+	{
+		float cornerX[3][g_GroupSize];
+		float cornerY[3][g_GroupSize];
+		float cornerZ[3][g_GroupSize];
+		float cornerAngles[3][g_GroupSize];
+		float signs[g_GroupSize];
+		for (; t + g_GroupSize <= triangleCount; t += g_GroupSize)
+		{
+			const unsigned int* pTriangles = pIndices + t * 3;
+			VEC3_8 positions[3];
+			VEC3_8 normals[3];
+			__m256 u[3];
+			__m256 v[3];
+			for (int c = 0; c < 3; c++)
+			{
+				__m256i offsets = GatherCornerOffsets(pTriangles, c, floatsPerVertex);
+				positions[c] = GatherCorner(pVerts, offsets);
+				normals[c] = GatherCorner(pVerts + normalOffset, offsets);
+				u[c] = _mm256_i32gather_ps(pVerts + uvOffset, offsets, 4);
+				v[c] = _mm256_i32gather_ps(pVerts + uvOffset + 1, offsets, 4);
+			}
+
+			VEC3_8 d1 = Sub8(positions[1], positions[0]);
+			VEC3_8 d2 = Sub8(positions[2], positions[0]);
+			__m256 t21x = _mm256_sub_ps(u[1], u[0]);
+			__m256 t21y = _mm256_sub_ps(v[1], v[0]);
+			__m256 t31x = _mm256_sub_ps(u[2], u[0]);
+			__m256 t31y = _mm256_sub_ps(v[2], v[0]);
+			__m256 signedArea = _mm256_sub_ps(_mm256_mul_ps(t21x, t31y), _mm256_mul_ps(t21y, t31x));
+			__m256 preserving = _mm256_cmp_ps(signedArea, _mm256_setzero_ps(), _CMP_GT_OQ);
+			__m256 sign = _mm256_blendv_ps(_mm256_set1_ps(-1.0f), _mm256_set1_ps(1.0f), preserving);
+			__m256 hasArea = _mm256_cmp_ps(signedArea, _mm256_setzero_ps(), _CMP_NEQ_OQ);
+			VEC3_8 tangent = NormalizeOrZero8(Sub8(Scale8(d1, t31y), Scale8(d2, t21y)));
+			tangent = Scale8(tangent, _mm256_and_ps(sign, hasArea));
+			_mm256_storeu_ps(signs, sign);
+
+			for (int c = 0; c < 3; c++)
+			{
+				const VEC3_8& n = normals[c];
+				VEC3_8 edge1 = RejectNormal8(Sub8(positions[(c + 2) % 3], positions[c]), n);
+				VEC3_8 edge2 = RejectNormal8(Sub8(positions[(c + 1) % 3], positions[c]), n);
+				VEC3_8 cornerTangent = RejectNormal8(tangent, n);
+				_mm256_storeu_ps(cornerX[c], cornerTangent.x);
+				_mm256_storeu_ps(cornerY[c], cornerTangent.y);
+				_mm256_storeu_ps(cornerZ[c], cornerTangent.z);
+				_mm256_storeu_ps(cornerAngles[c], ApproximateAcos8(Dot8(edge1, edge2)));
+			}
+
+			for (size_t lane = 0; lane < g_GroupSize; lane++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					AddCornerTangent(sums.data(), pTriangles[lane * 3 + c],
+						glm::vec3(cornerX[c][lane], cornerY[c][lane], cornerZ[c][lane]),
+						cornerAngles[c][lane], signs[lane]);
+				}
+			}
+		}
+	}
+#endif
+
+	for (; t < triangleCount; t++)
+	{
+		const unsigned int* pTriangle = pIndices + t * 3;
+		glm::vec3 positions[3];
+		glm::vec3 normals[3];
+		glm::vec2 uvs[3];
+		for (int c = 0; c < 3; c++)
+		{
+			const float* pVertex = pVerts + pTriangle[c] * floatsPerVertex;
+			positions[c] = glm::vec3(pVertex[0], pVertex[1], pVertex[2]);
+			normals[c] = glm::vec3(pVertex[normalOffset], pVertex[normalOffset + 1], pVertex[normalOffset + 2]);
+			uvs[c] = glm::vec2(pVertex[uvOffset], pVertex[uvOffset + 1]);
+		}
+
+		glm::vec3 cornerTangents[3];
+		float angles[3];
+		float sign = GetCornerTangents(positions, normals, uvs, cornerTangents, angles);
+		for (int c = 0; c < 3; c++)
+		{
+			AddCornerTangent(sums.data(), pTriangle[c], cornerTangents[c], angles[c], sign);
+		}
+	}
+
+	tangents.resize(vertexCount * 4);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		const float* pSum = &sums[v * g_FloatsPerTangentSum];
+		const float* pNormal = pVerts + v * floatsPerVertex + normalOffset;
+		glm::vec3 normal(pNormal[0], pNormal[1], pNormal[2]);
+
+		bool bPreserving = (pSum[3] >= pSum[7]);
+		const float* pSide = bPreserving ? pSum : (pSum + 4);
+		glm::vec3 tangent = NormalizeOrZero(glm::vec3(pSide[0], pSide[1], pSide[2]));
+		if (tangent == glm::vec3(0.0f))
+		{
+			glm::vec3 axis = (fabsf(normal.x) < 0.9f) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			tangent = NormalizeOrZero(axis - normal * glm::dot(normal, axis));
+		}
+
+		float* pTangent = &tangents[v * 4];
+		pTangent[0] = tangent.x;
+		pTangent[1] = tangent.y;
+		pTangent[2] = tangent.z;
+		pTangent[3] = bPreserving ? 1.0f : -1.0f;
+	}
+}
+
+/***********************************************************
+ *  IsMeshNormalsSimd()
+ *
+ *  This function is used for checking whether the AVX2
+ *  kernels were compiled in.
+ ***********************************************************/
+bool IsMeshNormalsSimd()
+{
+#if defined(MESH_NORMALS_AVX2)
+	return(true);
+#else
+	return(false);
+#endif
+}
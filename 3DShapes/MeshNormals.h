@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshnormals.h
+// ============
+// generate the normals and tangents of indexed triangle meshes
+//
+//  The normal of a vertex is the sum of the cross products of the edges
+//  of the triangles around it, whose length is twice the area of each
+//  triangle, so large triangles count for more than slivers, and the sum
+//  is then normalized.  The tangent of a vertex follows the conventions
+//  of MikkTSpace: each triangle gives the direction in which its u
+//  texture coordinate grows, and the sign of the area of its texture
+//  coordinates says whether the texture is mirrored.  Every corner
+//  projects that direction onto the plane of its vertex normal and
+//  weights it by its angle, the sums are normalized, and the fourth
+//  value of the tangent is the sign of the bitangent, which is
+//  w * cross(normal, tangent).  MikkTSpace splits a vertex whose
+//  triangles disagree about the mirroring - here the vertices are kept
+//  as they are, and each takes the side with the larger angle around it.
+//  When the compiler targets AVX2 (/arch:AVX2, which the Visual Studio
+//  project sets, or -mavx2), eight triangles
+//  are processed per iteration: the normals cross two triangles in the
+//  halves of each register and add every padded sum as one vector, as
+//  adding to the vertices costs more than the cross products, and the
+//  tangents gather the corners of eight triangles into eight lanes.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// calculate the area weighted normals of the vertices of the
+// passed in triangles and write them, normalized, to the three
+// floats of every vertex at the normal address - the strides are
+// in floats, and a vertex with no triangle around it, or only
+// degenerate ones, gets the normal (0, 1, 0)
+void GenerateNormals(
+	const float* pPositions,
+	size_t positionStride,
+	size_t vertexCount,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	float* pNormals,
+	size_t normalStride);
+
+// calculate the tangents of interleaved vertices of a position,
+// a normal of length 1 and a texture coordinate at the passed in
+// offsets, as 4 floats per vertex - the tangent of length 1 and
+// the sign of its bitangent
+void GenerateTangents(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	size_t vertexCount,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	size_t normalOffset,
+	size_t uvOffset,
+	std::vector<float>& tangents);
+
+// check whether the normals and tangents are generated eight
+// triangles at a time with AVX2, rather than one at a time
+bool IsMeshNormalsSimd();
@@ -0,0 +1,486 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder indexed triangle meshes for the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	// how much worse than a whole run of triangles the cache use
+	// of one of the clusters it is split into may be
+	const float g_OverdrawThreshold = 1.05f;
+
+	// marks a vertex that has not been given a new position
+	const unsigned int g_NoVertex = 0xFFFFFFFF;
+
+	/***********************************************************
+	 *  SkipDeadEnd()
+	 *
+	 *  This function is used for finding the next vertex to
+	 *  walk around when the last one has no triangles left,
+	 *  first among the recently used vertices and then in
+	 *  order through the whole mesh.
+	 ***********************************************************/
+	int SkipDeadEnd(
+		const std::vector<int>& liveTriangles,
+		std::vector<unsigned int>& deadEnds,
+		size_t& cursor)
+	{
+		while (deadEnds.empty() == false)
+		{
+			unsigned int vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[vertex] > 0)
+			{
+				return((int)vertex);
+			}
+		}
+
+		while (cursor < liveTriangles.size())
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				return((int)cursor);
+			}
+			cursor++;
+		}
+
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  CountCacheMisses()
+	 *
+	 *  This function is used for adding the vertices of one
+	 *  triangle to a simulated first in, first out cache, where
+	 *  a vertex is still cached while fewer than cacheSize
+	 *  vertices were added after it.
+	 ***********************************************************/
+	int CountCacheMisses(
+		const unsigned int* pTriangle,
+		std::vector<unsigned int>& timestamps,
+		unsigned int& time,
+		int cacheSize)
+	{
+		int misses = 0;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			unsigned int vertex = pTriangle[corner];
+			if ((time - timestamps[vertex]) > (unsigned int)cacheSize)
+			{
+				timestamps[vertex] = time;
+				time++;
+				misses++;
+			}
+		}
+		return(misses);
+	}
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This function is used for measuring how often the
+ *  vertices of the passed in triangles miss the cache.
+ ***********************************************************/
+MESH_CACHE_STATS AnalyzeVertexCache(
+	const unsigned int* pIndices,
+	size_t indexCount,
+	size_t vertexCount,
+	int cacheSize)
+{
+	MESH_CACHE_STATS stats;
+	stats.acmr = 0.0f;
+	stats.atvr = 0.0f;
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return(stats);
+	}
+
+	// every vertex starts out older than the cache
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	std::vector<bool> bUsed(vertexCount, false);
+	unsigned int time = cacheSize + 1;
+	size_t misses = 0;
+	size_t usedCount = 0;
+	for (size_t i = 0; i < triangleCount * 3; i += 3)
+	{
+		misses += CountCacheMisses(pIndices + i, timestamps, time, cacheSize);
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (bUsed[pIndices[i + corner]] == false)
+			{
+				bUsed[pIndices[i + corner]] = true;
+				usedCount++;
+			}
+		}
+	}
+
+	stats.acmr = (float)misses / triangleCount;
+	stats.atvr = (float)misses / usedCount;
+	return(stats);
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This function is used for reordering the triangles with
+ *  Tipsify.  The walk adds all the remaining triangles
+ *  around a vertex, then moves on to the vertex of those
+ *  triangles that will stay in the cache the longest while
+ *  its own triangles are added, and only jumps back to older
+ *  vertices or on through the mesh when there is none.
+ ***********************************************************/
+void OptimizeVertexCache(
+	unsigned int* pIndices,
+	size_t indexCount,
+	size_t vertexCount,
+	int cacheSize,
+	std::vector<size_t>& clusters)
+{
+	size_t triangleCount = indexCount / 3;
+	clusters.clear();
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// the triangles around each vertex, as ranges of one array
+	std::vector<int> liveTriangles(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		liveTriangles[pIndices[i]]++;
+	}
+	std::vector<size_t> adjacencyStart(vertexCount + 1, 0);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		adjacencyStart[vertex + 1] = adjacencyStart[vertex] + liveTriangles[vertex];
+	}
+	std::vector<unsigned int> adjacency(adjacencyStart[vertexCount]);
+	std::vector<size_t> adjacencyFill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[adjacencyFill[pIndices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	std::vector<unsigned int> output;
+	output.reserve(triangleCount * 3);
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	std::vector<bool> bEmitted(triangleCount, false);
+	std::vector<unsigned int> deadEnds;
+	std::vector<unsigned int> candidates;
+	unsigned int time = cacheSize + 1;
+	size_t cursor = 0;
+
+	int vertex = SkipDeadEnd(liveTriangles, deadEnds, cursor);
+	clusters.push_back(0);
+	while (vertex >= 0)
+	{
+		candidates.clear();
+		for (size_t a = adjacencyStart[vertex]; a < adjacencyStart[vertex + 1]; a++)
+		{
+			unsigned int triangle = adjacency[a];
+			if (bEmitted[triangle] == true)
+			{
+				continue;
+			}
+			bEmitted[triangle] = true;
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				unsigned int cornerVertex = pIndices[triangle * 3 + corner];
+				output.push_back(cornerVertex);
+				deadEnds.push_back(cornerVertex);
+				candidates.push_back(cornerVertex);
+				liveTriangles[cornerVertex]--;
+				if ((time - timestamps[cornerVertex]) > (unsigned int)cacheSize)
+				{
+					timestamps[cornerVertex] = time;
+					time++;
+				}
+			}
+		}
+
+		// the candidate that is in the cache now and will still
+		// be there after its remaining triangles are added
+		int next = -1;
+		int bestPriority = -1;
+		for (size_t c = 0; c < candidates.size(); c++)
+		{
+			unsigned int candidate = candidates[c];
+			if (liveTriangles[candidate] <= 0)
+			{
+				continue;
+			}
+
+			int priority = 0;
+			int age = (int)(time - timestamps[candidate]);
+			if ((age + 2 * liveTriangles[candidate]) <= cacheSize)
+			{
+				priority = age;
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				next = (int)candidate;
+			}
+		}
+
+		if (next == -1)
+		{
+			next = SkipDeadEnd(liveTriangles, deadEnds, cursor);
+			if ((next >= 0) && (output.size() < triangleCount * 3))
+			{
+				clusters.push_back(output.size());
+			}
+		}
+		vertex = next;
+	}
+
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This function is used for splitting the runs of triangles
+ *  into clusters that are still cache friendly on their own,
+ *  and sorting the clusters by how far they face out from the
+ *  center of the mesh, so the outer surfaces are drawn first.
+ ***********************************************************/
+void OptimizeOverdraw(
+	unsigned int* pIndices,
+	size_t indexCount,
+	const float* pVerts,
+	size_t floatsPerVertex,
+	const std::vector<size_t>& clusters,
+	int cacheSize,
+	float threshold)
+{
+	size_t triangleCount = indexCount / 3;
+	if ((triangleCount == 0) || (clusters.empty() == true))
+	{
+		return;
+	}
+
+	size_t vertexCount = 0;
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		vertexCount = std::max(vertexCount, (size_t)pIndices[i] + 1);
+	}
+
+	// split each run where the cache use of the cluster so far is
+	// close enough to that of the whole run
+	std::vector<size_t> starts;
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	unsigned int time = cacheSize + 1;
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		size_t start = clusters[c];
+		size_t end = ((c + 1) < clusters.size()) ? clusters[c + 1] : triangleCount * 3;
+
+		time += cacheSize + 1;
+		int runMisses = 0;
+		for (size_t i = start; i < end; i += 3)
+		{
+			runMisses += CountCacheMisses(pIndices + i, timestamps, time, cacheSize);
+		}
+		float clusterThreshold = threshold * runMisses / ((end - start) / 3);
+
+		starts.push_back(start);
+		time += cacheSize + 1;
+		int misses = 0;
+		int triangles = 0;
+		for (size_t i = start; i < end; i += 3)
+		{
+			misses += CountCacheMisses(pIndices + i, timestamps, time, cacheSize);
+			triangles++;
+			if (((i + 3) < end) && ((float)misses / triangles <= clusterThreshold))
+			{
+				starts.push_back(i + 3);
+				time += cacheSize + 1;
+				misses = 0;
+				triangles = 0;
+			}
+		}
+	}
+
+	// the center of the mesh, and the center and the direction
+	// of each cluster weighted by the areas of its triangles
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+	std::vector<glm::vec3> clusterCenters(starts.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(starts.size(), glm::vec3(0.0f));
+	std::vector<float> clusterAreas(starts.size(), 0.0f);
+	for (size_t c = 0; c < starts.size(); c++)
+	{
+		size_t end = ((c + 1) < starts.size()) ? starts[c + 1] : triangleCount * 3;
+		for (size_t i = starts[c]; i < end; i += 3)
+		{
+			const float* p0 = pVerts + pIndices[i] * floatsPerVertex;
+			const float* p1 = pVerts + pIndices[i + 1] * floatsPerVertex;
+			const float* p2 = pVerts + pIndices[i + 2] * floatsPerVertex;
+			glm::vec3 v0(p0[0], p0[1], p0[2]);
+			glm::vec3 v1(p1[0], p1[1], p1[2]);
+			glm::vec3 v2(p2[0], p2[1], p2[2]);
+			glm::vec3 normal = glm::cross(v1 - v0, v2 - v0);
+			float area = glm::length(normal);
+
+			clusterCenters[c] += (v0 + v1 + v2) * (area / 3.0f);
+			clusterNormals[c] += normal;
+			clusterAreas[c] += area;
+		}
+		meshCenter += clusterCenters[c];
+		meshArea += clusterAreas[c];
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCenter /= meshArea;
+	}
+
+	std::vector<float> sortKeys(starts.size(), 0.0f);
+	for (size_t c = 0; c < starts.size(); c++)
+	{
+		float normalLength = glm::length(clusterNormals[c]);
+		if ((clusterAreas[c] > 0.0f) && (normalLength > 0.0f))
+		{
+			glm::vec3 center = clusterCenters[c] / clusterAreas[c];
+			sortKeys[c] = glm::dot(center - meshCenter, clusterNormals[c] / normalLength);
+		}
+	}
+
+	std::vector<size_t> order(starts.size());
+	for (size_t c = 0; c < order.size(); c++)
+	{
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(),
+		[&sortKeys](size_t a, size_t b) { return(sortKeys[a] > sortKeys[b]); });
+
+	std::vector<unsigned int> output;
+	output.reserve(triangleCount * 3);
+	for (size_t c = 0; c < order.size(); c++)
+	{
+		size_t start = starts[order[c]];
+		size_t end = ((order[c] + 1) < starts.size()) ? starts[order[c] + 1] : triangleCount * 3;
+		output.insert(output.end(), pIndices + start, pIndices + end);
+	}
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This function is used for moving the vertices into the
+ *  order the triangles first use them.  Vertices that no
+ *  triangle uses are kept at the end.
+ ***********************************************************/
+void OptimizeVertexFetch(
+	std::vector<float>& verts,
+	size_t floatsPerVertex,
+	std::vector<unsigned int>& indices)
+{
+	size_t vertexCount = verts.size() / floatsPerVertex;
+	std::vector<unsigned int> remap(vertexCount, g_NoVertex);
+	unsigned int nextVertex = 0;
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		if (remap[indices[i]] == g_NoVertex)
+		{
+			remap[indices[i]] = nextVertex++;
+		}
+		indices[i] = remap[indices[i]];
+	}
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		if (remap[vertex] == g_NoVertex)
+		{
+			remap[vertex] = nextVertex++;
+		}
+	}
+
+	std::vector<float> sorted(verts.size());
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		std::copy(
+			verts.begin() + vertex * floatsPerVertex,
+			verts.begin() + (vertex + 1) * floatsPerVertex,
+			sorted.begin() + remap[vertex] * floatsPerVertex);
+	}
+	verts.swap(sorted);
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This function is used for reordering the triangles of
+ *  each range of the indices for the vertex cache and for
+ *  overdraw, and then the vertices for fetching.  A range
+ *  that already uses the cache better than the Tipsify order,
+ *  such as a generated grid, keeps its order and is treated
+ *  as one run of triangles.
+ ***********************************************************/
+void OptimizeMesh(
+	std::vector<float>& verts,
+	size_t floatsPerVertex,
+	std::vector<unsigned int>& indices,
+	const std::vector<size_t>& rangeEnds,
+	MESH_CACHE_STATS* pBefore,
+	MESH_CACHE_STATS* pAfter)
+{
+	size_t vertexCount = verts.size() / floatsPerVertex;
+	if (NULL != pBefore)
+	{
+		*pBefore = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+	}
+
+	std::vector<size_t> clusters;
+	size_t rangeStart = 0;
+	for (size_t r = 0; r <= rangeEnds.size(); r++)
+	{
+		size_t rangeEnd = (r < rangeEnds.size()) ? rangeEnds[r] : indices.size();
+		if (rangeEnd > rangeStart)
+		{
+			unsigned int* pRange = indices.data() + rangeStart;
+			size_t rangeCount = rangeEnd - rangeStart;
+			std::vector<unsigned int> original(pRange, pRange + rangeCount);
+			float originalACMR = AnalyzeVertexCache(pRange, rangeCount, vertexCount).acmr;
+
+			OptimizeVertexCache(pRange, rangeCount, vertexCount, MESH_CACHE_SIZE, clusters);
+			float cacheACMR = AnalyzeVertexCache(pRange, rangeCount, vertexCount).acmr;
+			if (cacheACMR > originalACMR)
+			{
+				std::copy(original.begin(), original.end(), pRange);
+				clusters.assign(1, 0);
+				cacheACMR = originalACMR;
+			}
+
+			// the cluster order is only kept while it costs no more
+			// of the cache than the threshold allows, which is not
+			// the case for small meshes split into many clusters
+			original.assign(pRange, pRange + rangeCount);
+			OptimizeOverdraw(pRange, rangeCount, verts.data(), floatsPerVertex,
+				clusters, MESH_CACHE_SIZE, g_OverdrawThreshold);
+			if (AnalyzeVertexCache(pRange, rangeCount, vertexCount).acmr > cacheACMR * g_OverdrawThreshold)
+			{
+				std::copy(original.begin(), original.end(), pRange);
+			}
+		}
+		rangeStart = std::max(rangeStart, rangeEnd);
+	}
+
+	OptimizeVertexFetch(verts, floatsPerVertex, indices);
+
+	if (NULL != pAfter)
+	{
+		*pAfter = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+	}
+}
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder indexed triangle meshes for the GPU
+//
+//  A mesh is optimized in three steps.  The triangles are first put in
+//  an order that reuses the vertices still in the post-transform cache,
+//  with the Tipsify algorithm of Sander, Nehab and Barczak, which walks
+//  the mesh in a fan around each vertex and only jumps elsewhere when
+//  the walk runs out of triangles.  The runs of triangles between the
+//  jumps are then split into small clusters, and the clusters are sorted
+//  so the ones facing out from the center of the mesh are drawn first,
+//  which lets the early depth test throw away more of the pixels behind
+//  them.  Last, the vertices are stored in the order the triangles first
+//  use them, so the vertex fetches read memory in order.  Meshes that
+//  must keep ranges of their indices apart, such as the caps of a
+//  cylinder, are optimized one range at a time.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// entries of the post-transform vertex cache the meshes are
+// optimized for and measured with
+const int MESH_CACHE_SIZE = 16;
+
+// how well an index buffer uses the post-transform vertex cache
+struct MESH_CACHE_STATS
+{
+	// average cache misses per triangle - from 0.5 for a very
+	// large regular grid up to 3
+	float acmr;
+	// average cache misses per vertex used - 1 is the best
+	float atvr;
+};
+
+// simulate a first in, first out vertex cache of the passed in
+// size over the triangles of the passed in indices
+MESH_CACHE_STATS AnalyzeVertexCache(
+	const unsigned int* pIndices,
+	size_t indexCount,
+	size_t vertexCount,
+	int cacheSize = MESH_CACHE_SIZE);
+
+// reorder the triangles of the passed in indices for the vertex
+// cache, and return the index positions where the order had to
+// jump to an unconnected part of the mesh
+void OptimizeVertexCache(
+	unsigned int* pIndices,
+	size_t indexCount,
+	size_t vertexCount,
+	int cacheSize,
+	std::vector<size_t>& clusters);
+
+// reorder the clusters of triangles of the passed in indices,
+// starting at the passed in index positions, from the most
+// outward facing to the least - the threshold is how much worse
+// than the whole cluster the cache use of a smaller cluster may be
+void OptimizeOverdraw(
+	unsigned int* pIndices,
+	size_t indexCount,
+	const float* pVerts,
+	size_t floatsPerVertex,
+	const std::vector<size_t>& clusters,
+	int cacheSize,
+	float threshold);
+
+// store the interleaved vertices in the order of their first use
+// by the indices, and renumber the indices
+void OptimizeVertexFetch(
+	std::vector<float>& verts,
+	size_t floatsPerVertex,
+	std::vector<unsigned int>& indices);
+
+// run all three steps on a mesh whose indices are split into
+// ranges that end at the passed in index positions, which can be
+// empty for a single range - the cache use before and after is
+// returned when asked for
+void OptimizeMesh(
+	std::vector<float>& verts,
+	size_t floatsPerVertex,
+	std::vector<unsigned int>& indices,
+	const std::vector<size_t>& rangeEnds,
+	MESH_CACHE_STATS* pBefore = NULL,
+	MESH_CACHE_STATS* pAfter = NULL);
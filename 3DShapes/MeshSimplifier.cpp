@@ -0,0 +1,724 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshsimplifier.cpp
+// ============
+// simplify indexed triangle meshes with the quadric error metric
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshSimplifier.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// marks a slot of the weld table without a vertex
+	const unsigned int g_NoVertex = 0xFFFFFFFF;
+	// weight of the planes that hold the borders and seams in
+	// place, relative to the planes of the triangles
+	const float g_BorderWeight = 10.0f;
+	// states of the positions
+	const unsigned char POSITION_FREE = 0;
+	const unsigned char POSITION_BORDER = 1;
+	const unsigned char POSITION_LOCKED = 2;
+	// bits of an error that order the collapses - the exponent
+	// and the top three bits of the mantissa of the float, so
+	// the order is within an eighth of the error
+	const int g_SortKeyShift = 20;
+	const size_t g_SortKeyCount = 1 << 11;
+	// how much more than the error of the collapse that would
+	// reach the target, if no collapse were skipped, a pass may
+	// collapse - the cheaper edges next to a collapse are left
+	// for the next pass instead of taking expensive ones now
+	const float g_PassErrorFactor = 1.5f;
+
+	// the symmetric matrix, vector and constant of the sum of
+	// the squared distances from a set of planes, and the sum of
+	// the weights of the planes
+	struct QUADRIC
+	{
+		float a00, a11, a22, a01, a02, a12;
+		float b0, b1, b2;
+		float c;
+		float weight;
+	};
+
+	// a collapse of the edge from one position onto the other
+	struct EDGE_COLLAPSE
+	{
+		unsigned int from;
+		unsigned int to;
+		float error;
+	};
+
+	// the working state of a mesh that is simplified
+	struct SIMPLIFIER_MESH
+	{
+		// the positions scaled into a unit box, which keeps the
+		// quadrics accurate in floats
+		std::vector<glm::vec3> positions;
+		// the first vertex at the position of every vertex
+		std::vector<unsigned int> remap;
+		std::vector<unsigned char> states;
+		std::vector<QUADRIC> quadrics;
+		std::vector<unsigned int> indices;
+		// the triangles around every position, rebuilt before
+		// each pass
+		std::vector<unsigned int> adjacencyStart;
+		std::vector<unsigned int> adjacency;
+	};
+
+	/***********************************************************
+	 *  HashPosition()
+	 *
+	 *  This function is used for mixing the bits of a position
+	 *  into the slot of the weld table.
+	 ***********************************************************/
+	inline uint32_t HashPosition(const float* pPosition)
+	{
+		uint32_t bits[3];
+		memcpy(bits, pPosition, sizeof(bits));
+		uint64_t hash = (uint64_t)bits[0] * 0x9E3779B97F4A7C15ull;
+		hash ^= ((uint64_t)bits[1] + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+		hash ^= ((uint64_t)bits[2] + 0x165667B19E3779F9ull) * 0x85EBCA77C2B2AE63ull;
+		return((uint32_t)(hash >> 32) ^ (uint32_t)hash);
+	}
+
+	/***********************************************************
+	 *  AddPlane()
+	 *
+	 *  This function is used for adding a weighted plane of
+	 *  unit normal n through the point p to a quadric.
+	 ***********************************************************/
+	void AddPlane(QUADRIC& q, const glm::vec3& n, const glm::vec3& p, float weight)
+	{
+		float d = -glm::dot(n, p);
+		q.a00 += weight * n.x * n.x;
+		q.a11 += weight * n.y * n.y;
+		q.a22 += weight * n.z * n.z;
+		q.a01 += weight * n.x * n.y;
+		q.a02 += weight * n.x * n.z;
+		q.a12 += weight * n.y * n.z;
+		q.b0 += weight * n.x * d;
+		q.b1 += weight * n.y * d;
+		q.b2 += weight * n.z * d;
+		q.c += weight * d * d;
+		q.weight += weight;
+	}
+
+	/***********************************************************
+	 *  AddQuadric()
+	 *
+	 *  This function is used for adding one quadric to another.
+	 ***********************************************************/
+	void AddQuadric(QUADRIC& q, const QUADRIC& other)
+	{
+		q.a00 += other.a00;
+		q.a11 += other.a11;
+		q.a22 += other.a22;
+		q.a01 += other.a01;
+		q.a02 += other.a02;
+		q.a12 += other.a12;
+		q.b0 += other.b0;
+		q.b1 += other.b1;
+		q.b2 += other.b2;
+		q.c += other.c;
+		q.weight += other.weight;
+	}
+
+	/***********************************************************
+	 *  GetQuadricError()
+	 *
+	 *  This function is used for the mean squared distance of
+	 *  a point from the planes of the sum of two quadrics.
+	 ***********************************************************/
+	float GetQuadricError(const QUADRIC& q0, const QUADRIC& q1, const glm::vec3& p)
+	{
+		float weight = q0.weight + q1.weight;
+		float error =
+			(q0.a00 + q1.a00) * p.x * p.x +
+			(q0.a11 + q1.a11) * p.y * p.y +
+			(q0.a22 + q1.a22) * p.z * p.z +
+			2.0f * ((q0.a01 + q1.a01) * p.x * p.y + (q0.a02 + q1.a02) * p.x * p.z + (q0.a12 + q1.a12) * p.y * p.z) +
+			2.0f * ((q0.b0 + q1.b0) * p.x + (q0.b1 + q1.b1) * p.y + (q0.b2 + q1.b2) * p.z) +
+			(q0.c + q1.c);
+		return((weight > 0.0f) ? (fabsf(error) / weight) : 0.0f);
+	}
+
+	/***********************************************************
+	 *  BuildAdjacency()
+	 *
+	 *  This function is used for listing the triangles around
+	 *  every position, with a counting sort of the corners.
+	 ***********************************************************/
+	void BuildAdjacency(SIMPLIFIER_MESH& mesh)
+	{
+		size_t vertexCount = mesh.remap.size();
+		mesh.adjacencyStart.assign(vertexCount + 1, 0);
+		for (size_t i = 0; i < mesh.indices.size(); i++)
+		{
+			mesh.adjacencyStart[mesh.remap[mesh.indices[i]] + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			mesh.adjacencyStart[v + 1] += mesh.adjacencyStart[v];
+		}
+
+		mesh.adjacency.resize(mesh.indices.size());
+		std::vector<unsigned int> next(mesh.adjacencyStart.begin(), mesh.adjacencyStart.end() - 1);
+		for (size_t i = 0; i < mesh.indices.size(); i++)
+		{
+			mesh.adjacency[next[mesh.remap[mesh.indices[i]]]++] = (unsigned int)(i / 3);
+		}
+	}
+
+	/***********************************************************
+	 *  HasEdge()
+	 *
+	 *  This function is used for checking whether a triangle
+	 *  around a position has the edge from it to another one,
+	 *  either between any vertices at the two positions, or
+	 *  between the two passed in vertices only.
+	 ***********************************************************/
+	bool HasEdge(
+		const SIMPLIFIER_MESH& mesh,
+		unsigned int fromVertex,
+		unsigned int toVertex,
+		bool bSameVertices)
+	{
+		unsigned int from = mesh.remap[fromVertex];
+		unsigned int to = mesh.remap[toVertex];
+		for (unsigned int a = mesh.adjacencyStart[from]; a < mesh.adjacencyStart[from + 1]; a++)
+		{
+			const unsigned int* pTriangle = &mesh.indices[mesh.adjacency[a] * 3];
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int corner = pTriangle[c];
+				unsigned int next = pTriangle[(c + 1) % 3];
+				if (bSameVertices == true)
+				{
+					if ((corner == fromVertex) && (next == toVertex))
+					{
+						return(true);
+					}
+				}
+				else if ((mesh.remap[corner] == from) && (mesh.remap[next] == to))
+				{
+					return(true);
+				}
+			}
+		}
+		return(false);
+	}
+
+	/***********************************************************
+	 *  AddEdgePlane()
+	 *
+	 *  This function is used for adding the plane through an
+	 *  edge at right angles to its triangle to the quadrics of
+	 *  both ends of the edge, which keeps a border or a seam
+	 *  from moving sideways.
+	 ***********************************************************/
+	void AddEdgePlane(SIMPLIFIER_MESH& mesh, unsigned int a, unsigned int b, const glm::vec3& faceNormal)
+	{
+		glm::vec3 edge = mesh.positions[b] - mesh.positions[a];
+		glm::vec3 normal = glm::cross(edge, faceNormal);
+		float length = glm::length(normal);
+		if (length > 0.0f)
+		{
+			float weight = glm::dot(edge, edge) * g_BorderWeight;
+			AddPlane(mesh.quadrics[a], normal / length, mesh.positions[a], weight);
+			AddPlane(mesh.quadrics[b], normal / length, mesh.positions[a], weight);
+		}
+	}
+
+	/***********************************************************
+	 *  ClassifyPositions()
+	 *
+	 *  This function is used for adding up the quadrics of the
+	 *  triangles around every position, finding the open
+	 *  borders and the seams, and locking the positions where
+	 *  more than two border edges meet or that hold a locked
+	 *  vertex.
+	 ***********************************************************/
+	void ClassifyPositions(SIMPLIFIER_MESH& mesh, const unsigned char* pLocked)
+	{
+		size_t vertexCount = mesh.remap.size();
+		QUADRIC zero;
+		memset(&zero, 0, sizeof(zero));
+		mesh.quadrics.assign(vertexCount, zero);
+		std::vector<unsigned char> borderEdges(vertexCount, 0);
+
+		for (size_t t = 0; t < mesh.indices.size(); t += 3)
+		{
+			const unsigned int* pTriangle = &mesh.indices[t];
+			unsigned int p[3] = { mesh.remap[pTriangle[0]], mesh.remap[pTriangle[1]], mesh.remap[pTriangle[2]] };
+			glm::vec3 normal = glm::cross(mesh.positions[p[1]] - mesh.positions[p[0]], mesh.positions[p[2]] - mesh.positions[p[0]]);
+			float length = glm::length(normal);
+			if (length <= 0.0f)
+			{
+				continue;
+			}
+			normal /= length;
+			// the area of the triangle is half the length
+			for (int c = 0; c < 3; c++)
+			{
+				AddPlane(mesh.quadrics[p[c]], normal, mesh.positions[p[0]], length * 0.5f);
+			}
+
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int from = pTriangle[c];
+				unsigned int to = pTriangle[(c + 1) % 3];
+				if (HasEdge(mesh, to, from, false) == false)
+				{
+					borderEdges[p[c]] = (unsigned char)std::min(borderEdges[p[c]] + 1, 255);
+					borderEdges[p[(c + 1) % 3]] = (unsigned char)std::min(borderEdges[p[(c + 1) % 3]] + 1, 255);
+					AddEdgePlane(mesh, p[c], p[(c + 1) % 3], normal);
+				}
+				else if (HasEdge(mesh, to, from, true) == false)
+				{
+					// a seam, which is added from both of its sides
+					AddEdgePlane(mesh, p[c], p[(c + 1) % 3], normal);
+				}
+			}
+		}
+
+		mesh.states.assign(vertexCount, POSITION_FREE);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			unsigned int position = mesh.remap[v];
+			if (((NULL != pLocked) && (pLocked[v] != 0)) ||
+				((position == v) && (borderEdges[v] != 0) && (borderEdges[v] != 2)))
+			{
+				mesh.states[position] = POSITION_LOCKED;
+			}
+			else if ((position == v) && (borderEdges[v] == 2) && (mesh.states[v] != POSITION_LOCKED))
+			{
+				mesh.states[v] = POSITION_BORDER;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  SortCollapses()
+	 *
+	 *  This function is used for ordering the collapses from
+	 *  the cheapest to the most expensive, with a counting
+	 *  sort of the top bits of their errors, which are never
+	 *  negative.
+	 ***********************************************************/
+	void SortCollapses(
+		const std::vector<EDGE_COLLAPSE>& collapses,
+		std::vector<unsigned int>& order)
+	{
+		std::vector<unsigned int> counts(g_SortKeyCount + 1, 0);
+		for (size_t i = 0; i < collapses.size(); i++)
+		{
+			uint32_t bits;
+			memcpy(&bits, &collapses[i].error, sizeof(bits));
+			counts[(bits >> g_SortKeyShift) + 1]++;
+		}
+		for (size_t k = 0; k < g_SortKeyCount; k++)
+		{
+			counts[k + 1] += counts[k];
+		}
+
+		order.resize(collapses.size());
+		for (size_t i = 0; i < collapses.size(); i++)
+		{
+			uint32_t bits;
+			memcpy(&bits, &collapses[i].error, sizeof(bits));
+			order[counts[bits >> g_SortKeyShift]++] = (unsigned int)i;
+		}
+	}
+
+	/***********************************************************
+	 *  CanMove()
+	 *
+	 *  This function is used for checking whether a position
+	 *  may collapse along an edge - a locked one never moves,
+	 *  and a border one only along the border.
+	 ***********************************************************/
+	inline bool CanMove(const SIMPLIFIER_MESH& mesh, unsigned int position, bool bBorderEdge)
+	{
+		return((mesh.states[position] == POSITION_FREE) ||
+			((mesh.states[position] == POSITION_BORDER) && (bBorderEdge == true)));
+	}
+
+	/***********************************************************
+	 *  AddUnique()
+	 *
+	 *  This function is used for adding a value to a short
+	 *  list unless it is already in it.
+	 ***********************************************************/
+	inline void AddUnique(std::vector<unsigned int>& values, unsigned int value)
+	{
+		if (std::find(values.begin(), values.end(), value) == values.end())
+		{
+			values.push_back(value);
+		}
+	}
+
+	/***********************************************************
+	 *  GetCollapseWedges()
+	 *
+	 *  This function is used for checking a collapse of one
+	 *  position onto another against the current triangles,
+	 *  and finding the vertex at the new position that every
+	 *  vertex at the old one becomes.  Each vertex must share
+	 *  an edge of a collapsed triangle with exactly one vertex
+	 *  at the new position, which keeps seams on their seam.
+	 *  The positions next to both ends may only be the third
+	 *  corners of the collapsed triangles, and no triangle
+	 *  that is left may turn over.
+	 ***********************************************************/
+	bool GetCollapseWedges(
+		const SIMPLIFIER_MESH& mesh,
+		unsigned int from,
+		unsigned int to,
+		std::vector<unsigned int>& fromWedges,
+		std::vector<unsigned int>& toWedges,
+		std::vector<unsigned int>& usedWedges,
+		std::vector<unsigned int>& counted)
+	{
+		fromWedges.clear();
+		toWedges.clear();
+		usedWedges.clear();
+
+		int collapsedCount = 0;
+		const glm::vec3& newPosition = mesh.positions[to];
+		for (unsigned int a = mesh.adjacencyStart[from]; a < mesh.adjacencyStart[from + 1]; a++)
+		{
+			const unsigned int* pTriangle = &mesh.indices[mesh.adjacency[a] * 3];
+			int fromCorner = -1;
+			int toCorner = -1;
+			for (int c = 0; c < 3; c++)
+			{
+				if (mesh.remap[pTriangle[c]] == from)
+				{
+					fromCorner = c;
+				}
+				else if (mesh.remap[pTriangle[c]] == to)
+				{
+					toCorner = c;
+				}
+			}
+			AddUnique(usedWedges, pTriangle[fromCorner]);
+
+			if (toCorner >= 0)
+			{
+				collapsedCount++;
+				std::vector<unsigned int>::iterator wedge =
+					std::find(fromWedges.begin(), fromWedges.end(), pTriangle[fromCorner]);
+				if (wedge == fromWedges.end())
+				{
+					fromWedges.push_back(pTriangle[fromCorner]);
+					toWedges.push_back(pTriangle[toCorner]);
+				}
+				else if (toWedges[wedge - fromWedges.begin()] != pTriangle[toCorner])
+				{
+					return(false);
+				}
+				continue;
+			}
+
+			// the triangle stays, with the corner at the new position
+			const glm::vec3& p0 = mesh.positions[mesh.remap[pTriangle[(fromCorner + 1) % 3]]];
+			const glm::vec3& p1 = mesh.positions[mesh.remap[pTriangle[(fromCorner + 2) % 3]]];
+			glm::vec3 oldNormal = glm::cross(p0 - mesh.positions[from], p1 - mesh.positions[from]);
+			glm::vec3 newNormal = glm::cross(p0 - newPosition, p1 - newPosition);
+			if (glm::dot(oldNormal, newNormal) <= 0.0f)
+			{
+				return(false);
+			}
+		}
+		if ((collapsedCount == 0) || (usedWedges.size() != fromWedges.size()))
+		{
+			return(false);
+		}
+
+		// the link condition - the neighbours the two ends have
+		// in common are the third corners of the collapsed
+		// triangles, one for each
+		usedWedges.clear();
+		for (unsigned int a = mesh.adjacencyStart[from]; a < mesh.adjacencyStart[from + 1]; a++)
+		{
+			const unsigned int* pTriangle = &mesh.indices[mesh.adjacency[a] * 3];
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int position = mesh.remap[pTriangle[c]];
+				if ((position != from) && (position != to))
+				{
+					AddUnique(usedWedges, position);
+				}
+			}
+		}
+		int commonCount = 0;
+		counted.clear();
+		for (unsigned int a = mesh.adjacencyStart[to]; a < mesh.adjacencyStart[to + 1]; a++)
+		{
+			const unsigned int* pTriangle = &mesh.indices[mesh.adjacency[a] * 3];
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int position = mesh.remap[pTriangle[c]];
+				if ((std::find(usedWedges.begin(), usedWedges.end(), position) != usedWedges.end()) &&
+					(std::find(counted.begin(), counted.end(), position) == counted.end()))
+				{
+					counted.push_back(position);
+					commonCount++;
+				}
+			}
+		}
+		return(commonCount <= collapsedCount);
+	}
+}
+
+/***********************************************************
+ *  WeldPositions()
+ *
+ *  This function is used for finding the first vertex at
+ *  the position of every vertex, with an open addressing
+ *  hash table of the positions that is kept at most half
+ *  full.
+ ***********************************************************/
+void WeldPositions(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	size_t vertexCount,
+	std::vector<unsigned int>& remap)
+{
+	size_t capacity = 1024;
+	while (capacity < vertexCount * 2)
+	{
+		capacity *= 2;
+	}
+	size_t mask = capacity - 1;
+	std::vector<unsigned int> table(capacity, g_NoVertex);
+
+	remap.resize(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		const float* pPosition = pVerts + v * floatsPerVertex;
+		size_t slot = HashPosition(pPosition) & mask;
+		while ((table[slot] != g_NoVertex) &&
+			(memcmp(pVerts + (size_t)table[slot] * floatsPerVertex, pPosition, sizeof(float) * 3) != 0))
+		{
+			slot = (slot + 1) & mask;
+		}
+		if (table[slot] == g_NoVertex)
+		{
+			table[slot] = (unsigned int)v;
+		}
+		remap[v] = table[slot];
+	}
+}
+
+/***********************************************************
+ *  SimplifyMesh()
+ *
+ *  This function is used for collapsing the edges of a mesh
+ *  in passes.  Each pass lists the edges of the triangles
+ *  that are left with the cheaper of their two directions,
+ *  sorts them by cost, and collapses them in order, skipping
+ *  the ones next to a collapse of the same pass, until the
+ *  target is reached.  The triangles that collapsed are then
+ *  removed and the next pass starts, until no edge can be
+ *  collapsed.
+ ***********************************************************/
+float SimplifyMesh(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	size_t vertexCount,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	const unsigned char* pLocked,
+	size_t targetIndexCount,
+	float targetError,
+	std::vector<unsigned int>& result)
+{
+	SIMPLIFIER_MESH mesh;
+	mesh.indices.assign(pIndices, pIndices + indexCount - (indexCount % 3));
+	if (mesh.indices.size() <= targetIndexCount)
+	{
+		result = mesh.indices;
+		return(0.0f);
+	}
+
+	// scale the positions into a unit box
+	glm::vec3 boundsMin(pVerts[0], pVerts[1], pVerts[2]);
+	glm::vec3 boundsMax = boundsMin;
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		glm::vec3 position(pVerts[v * floatsPerVertex], pVerts[v * floatsPerVertex + 1], pVerts[v * floatsPerVertex + 2]);
+		boundsMin = glm::min(boundsMin, position);
+		boundsMax = glm::max(boundsMax, position);
+	}
+	glm::vec3 extents = boundsMax - boundsMin;
+	float extent = std::max(std::max(extents.x, extents.y), std::max(extents.z, 1e-20f));
+	mesh.positions.resize(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		glm::vec3 position(pVerts[v * floatsPerVertex], pVerts[v * floatsPerVertex + 1], pVerts[v * floatsPerVertex + 2]);
+		mesh.positions[v] = (position - boundsMin) / extent;
+	}
+
+	WeldPositions(pVerts, floatsPerVertex, vertexCount, mesh.remap);
+	BuildAdjacency(mesh);
+	ClassifyPositions(mesh, pLocked);
+
+	// the errors are squared distances in the unit box
+	float errorLimit = (targetError / extent) * (targetError / extent);
+	float largestError = 0.0f;
+	std::vector<EDGE_COLLAPSE> collapses;
+	std::vector<unsigned int> order;
+	std::vector<unsigned char> touched(vertexCount);
+	std::vector<unsigned int> vertexTargets(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexTargets[v] = (unsigned int)v;
+	}
+	std::vector<unsigned int> fromWedges;
+	std::vector<unsigned int> toWedges;
+	std::vector<unsigned int> usedWedges;
+	std::vector<unsigned int> counted;
+
+	size_t triangleCount = mesh.indices.size() / 3;
+	size_t targetTriangles = targetIndexCount / 3;
+	float smallestPassLimit = 0.0f;
+	size_t rejectedCount = 0;
+	while (triangleCount > targetTriangles)
+	{
+		collapses.clear();
+		for (size_t i = 0; i < mesh.indices.size(); i++)
+		{
+			unsigned int fromVertex = mesh.indices[i];
+			unsigned int toVertex = mesh.indices[(i % 3 == 2) ? (i - 2) : (i + 1)];
+			unsigned int a = mesh.remap[fromVertex];
+			unsigned int b = mesh.remap[toVertex];
+			// an inner edge is listed from one of its sides only,
+			// and only positions on a border can share a border edge
+			bool bBorderEdge = (mesh.states[a] != POSITION_FREE) && (mesh.states[b] != POSITION_FREE) &&
+				(HasEdge(mesh, toVertex, fromVertex, false) == false);
+			if ((bBorderEdge == false) && (a > b))
+			{
+				continue;
+			}
+
+			EDGE_COLLAPSE collapse;
+			collapse.error = -1.0f;
+			if (CanMove(mesh, a, bBorderEdge) == true)
+			{
+				collapse.from = a;
+				collapse.to = b;
+				collapse.error = GetQuadricError(mesh.quadrics[a], mesh.quadrics[b], mesh.positions[b]);
+			}
+			if (CanMove(mesh, b, bBorderEdge) == true)
+			{
+				float error = GetQuadricError(mesh.quadrics[a], mesh.quadrics[b], mesh.positions[a]);
+				if ((collapse.error < 0.0f) || (error < collapse.error))
+				{
+					collapse.from = b;
+					collapse.to = a;
+					collapse.error = error;
+				}
+			}
+			if ((collapse.error >= 0.0f) && (collapse.error <= errorLimit))
+			{
+				collapses.push_back(collapse);
+			}
+		}
+		SortCollapses(collapses, order);
+
+		// each collapse removes about two triangles, and the
+		// cheap edges that could not collapse in the last pass
+		// most likely still cannot
+		size_t goal = (triangleCount - targetTriangles) / 2 + rejectedCount;
+		float passErrorLimit = std::max(
+			(goal < order.size()) ? (collapses[order[goal]].error * g_PassErrorFactor) : errorLimit,
+			smallestPassLimit);
+		passErrorLimit = std::min(passErrorLimit, errorLimit);
+		float nextError = -1.0f;
+
+		std::fill(touched.begin(), touched.end(), 0);
+		size_t appliedCount = 0;
+		rejectedCount = 0;
+		for (size_t i = 0; (i < collapses.size()) && (triangleCount > targetTriangles); i++)
+		{
+			const EDGE_COLLAPSE& collapse = collapses[order[i]];
+			if (collapse.error > passErrorLimit)
+			{
+				nextError = collapse.error;
+				break;
+			}
+			if ((touched[collapse.from] != 0) || (touched[collapse.to] != 0))
+			{
+				continue;
+			}
+			if (GetCollapseWedges(mesh, collapse.from, collapse.to, fromWedges, toWedges, usedWedges, counted) == false)
+			{
+				rejectedCount++;
+				continue;
+			}
+
+			for (size_t w = 0; w < fromWedges.size(); w++)
+			{
+				vertexTargets[fromWedges[w]] = toWedges[w];
+			}
+			AddQuadric(mesh.quadrics[collapse.to], mesh.quadrics[collapse.from]);
+
+			// the triangles around the old position are out of date
+			// in the adjacency until the next pass
+			for (unsigned int a = mesh.adjacencyStart[collapse.from]; a < mesh.adjacencyStart[collapse.from + 1]; a++)
+			{
+				const unsigned int* pTriangle = &mesh.indices[mesh.adjacency[a] * 3];
+				bool bCollapsed = false;
+				for (int c = 0; c < 3; c++)
+				{
+					touched[mesh.remap[pTriangle[c]]] = 1;
+					bCollapsed = bCollapsed || (mesh.remap[pTriangle[c]] == collapse.to);
+				}
+				triangleCount -= bCollapsed ? 1 : 0;
+			}
+			largestError = std::max(largestError, collapse.error);
+			appliedCount++;
+		}
+		// a pass that could not collapse anything within its
+		// limit is tried again up to the next error past it
+		if (appliedCount == 0)
+		{
+			if (nextError < 0.0f)
+			{
+				break;
+			}
+			smallestPassLimit = nextError * g_PassErrorFactor;
+			continue;
+		}
+		smallestPassLimit = 0.0f;
+
+		// move the corners and drop the triangles that collapsed
+		size_t next = 0;
+		for (size_t t = 0; t < mesh.indices.size(); t += 3)
+		{
+			unsigned int v0 = vertexTargets[mesh.indices[t]];
+			unsigned int v1 = vertexTargets[mesh.indices[t + 1]];
+			unsigned int v2 = vertexTargets[mesh.indices[t + 2]];
+			if ((mesh.remap[v0] != mesh.remap[v1]) && (mesh.remap[v1] != mesh.remap[v2]) && (mesh.remap[v0] != mesh.remap[v2]))
+			{
+				mesh.indices[next++] = v0;
+				mesh.indices[next++] = v1;
+				mesh.indices[next++] = v2;
+			}
+		}
+		mesh.indices.resize(next);
+		triangleCount = next / 3;
+		BuildAdjacency(mesh);
+	}
+
+	result.swap(mesh.indices);
+	return(sqrtf(largestError) * extent);
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshsimplifier.h
+// ============
+// simplify indexed triangle meshes with the quadric error metric
+//
+//  The simplifier follows Garland and Heckbert: every position gets the
+//  sum of the quadrics of the planes of the triangles around it, weighted
+//  by their area, and the cost of collapsing an edge is the mean squared
+//  distance of the position it collapses onto from those planes.  An edge
+//  is only collapsed onto one of its ends, so no new vertex is made and
+//  the normals and texture coordinates of the mesh stay the ones it had -
+//  the result is a new index buffer over the same vertices.  Vertices at
+//  the same position with other attributes, along the seams of texture
+//  coordinates or creases of the normals, are moved together and only
+//  along their seam, and open borders only along the border, with extra
+//  planes at right angles to the triangles that keep both in place.
+//  Collapses that would flip a triangle or join two separate parts of the
+//  surface are skipped.  The edges are sorted by cost once per pass, and a
+//  pass collapses the cheapest edges whose neighbourhoods it has not
+//  changed yet, until the mesh reaches the target triangle count or the
+//  next edge would pass the target error.  Vertices can be locked, so a
+//  large mesh can be cut into cells that are simplified on their own and
+//  still meet at the same positions.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// give every vertex the first vertex at the same position, with
+// the position at the start of each vertex
+void WeldPositions(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	size_t vertexCount,
+	std::vector<unsigned int>& remap);
+
+// simplify the triangles of the passed in indices until at most
+// the target number of indices is left, or no edge can be
+// collapsed within the target error, which is a distance in the
+// units of the positions - the vertices with a nonzero lock, or
+// NULL for none, never move, and the error reached is returned
+float SimplifyMesh(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	size_t vertexCount,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	const unsigned char* pLocked,
+	size_t targetIndexCount,
+	float targetError,
+	std::vector<unsigned int>& result);
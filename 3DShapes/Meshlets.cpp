@@ -0,0 +1,386 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlets.cpp
+// ============
+// split meshes into clusters of triangles and cull the clusters on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Meshlets.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define MESHLETS_SSE2
+#endif
+
+// declaration of global variables
+namespace
+{
+	// marks a vertex that is not used by the current meshlet
+	const unsigned int g_NoMeshlet = 0xFFFFFFFF;
+
+	// smallest cosine between the cone axis and the normals of
+	// a meshlet for which the cone is tight enough to be tested,
+	// and the cutoff of the meshlets that are never tested
+	const float g_MinConeDot = 0.1f;
+	const float g_NoConeCutoff = 2.0f;
+
+	/***********************************************************
+	 *  AddMeshlet()
+	 *
+	 *  This function is used for computing the bounding sphere
+	 *  and normal cone of the triangles from the passed in
+	 *  index position and adding them to the meshlets.
+	 ***********************************************************/
+	void AddMeshlet(
+		const float* pVerts,
+		size_t floatsPerVertex,
+		const unsigned int* pIndices,
+		size_t firstIndex,
+		size_t indexCount,
+		const std::vector<unsigned int>& vertices,
+		MESHLETS& meshlets)
+	{
+		// the sphere around the center of the box of the vertices
+		glm::vec3 boxMin(pVerts[vertices[0] * floatsPerVertex], pVerts[vertices[0] * floatsPerVertex + 1], pVerts[vertices[0] * floatsPerVertex + 2]);
+		glm::vec3 boxMax = boxMin;
+		for (size_t v = 1; v < vertices.size(); v++)
+		{
+			const float* pPosition = &pVerts[vertices[v] * floatsPerVertex];
+			glm::vec3 position(pPosition[0], pPosition[1], pPosition[2]);
+			boxMin = glm::min(boxMin, position);
+			boxMax = glm::max(boxMax, position);
+		}
+		glm::vec3 center = (boxMin + boxMax) * 0.5f;
+		float radiusSquared = 0.0f;
+		for (size_t v = 0; v < vertices.size(); v++)
+		{
+			const float* pPosition = &pVerts[vertices[v] * floatsPerVertex];
+			glm::vec3 offset = glm::vec3(pPosition[0], pPosition[1], pPosition[2]) - center;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+		}
+
+		// the cone around the average direction of the triangles,
+		// with each triangle counted once whatever its size
+		std::vector<glm::vec3> normals;
+		normals.reserve(indexCount / 3);
+		glm::vec3 axis(0.0f);
+		for (size_t i = firstIndex; i < firstIndex + indexCount; i += 3)
+		{
+			const float* p0 = &pVerts[pIndices[i] * floatsPerVertex];
+			const float* p1 = &pVerts[pIndices[i + 1] * floatsPerVertex];
+			const float* p2 = &pVerts[pIndices[i + 2] * floatsPerVertex];
+			glm::vec3 normal = glm::cross(
+				glm::vec3(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]),
+				glm::vec3(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]));
+			float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		float cutoff = g_NoConeCutoff;
+		float axisLength = glm::length(axis);
+		if (axisLength > 0.0f)
+		{
+			axis /= axisLength;
+			float minDot = 1.0f;
+			for (size_t n = 0; n < normals.size(); n++)
+			{
+				minDot = std::min(minDot, glm::dot(normals[n], axis));
+			}
+			// the camera is behind every triangle when it is more
+			// than 90 degrees plus the spread away from the axis,
+			// and the cosine of that angle is minus the sine of the
+			// spread
+			if (minDot >= g_MinConeDot)
+			{
+				cutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+		}
+
+		meshlets.centerX.push_back(center.x);
+		meshlets.centerY.push_back(center.y);
+		meshlets.centerZ.push_back(center.z);
+		meshlets.radius.push_back(std::sqrt(radiusSquared));
+		meshlets.coneAxisX.push_back(axis.x);
+		meshlets.coneAxisY.push_back(axis.y);
+		meshlets.coneAxisZ.push_back(axis.z);
+		meshlets.coneCutoff.push_back(cutoff);
+		meshlets.firstIndex.push_back((unsigned int)firstIndex);
+		meshlets.indexCount.push_back((unsigned int)indexCount);
+	}
+
+	/***********************************************************
+	 *  AddRange()
+	 *
+	 *  This function is used for adding the index range of a
+	 *  visible meshlet, merged with the range before it when
+	 *  they touch.  Once all the ranges are used the last one
+	 *  is stretched over the meshlet, hidden ones included.
+	 ***********************************************************/
+	void AddRange(
+		unsigned int firstIndex,
+		unsigned int indexCount,
+		MESHLET_RANGE* pRanges,
+		int maxRanges,
+		int& rangeCount)
+	{
+		if (rangeCount > 0)
+		{
+			MESHLET_RANGE& last = pRanges[rangeCount - 1];
+			if ((last.firstIndex + last.indexCount == firstIndex) || (rangeCount == maxRanges))
+			{
+				last.indexCount = firstIndex + indexCount - last.firstIndex;
+				return;
+			}
+		}
+
+		pRanges[rangeCount].firstIndex = firstIndex;
+		pRanges[rangeCount].indexCount = indexCount;
+		rangeCount++;
+	}
+
+	/***********************************************************
+	 *  IsMeshletVisible()
+	 *
+	 *  This function is used for testing one meshlet against
+	 *  the frustum planes and the camera.
+	 ***********************************************************/
+	bool IsMeshletVisible(
+		const MESHLETS& meshlets,
+		size_t i,
+		const float planes[6][4],
+		bool bConeTest,
+		const float camera[4])
+	{
+		float x = meshlets.centerX[i];
+		float y = meshlets.centerY[i];
+		float z = meshlets.centerZ[i];
+		float radius = meshlets.radius[i];
+
+		for (int p = 0; p < 6; p++)
+		{
+			if (planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < -radius)
+			{
+				return(false);
+			}
+		}
+
+		if (bConeTest == true)
+		{
+			float vx = x * camera[3] - camera[0];
+			float vy = y * camera[3] - camera[1];
+			float vz = z * camera[3] - camera[2];
+			float length = std::sqrt(vx * vx + vy * vy + vz * vz);
+			float dot = vx * meshlets.coneAxisX[i] + vy * meshlets.coneAxisY[i] + vz * meshlets.coneAxisZ[i];
+			if (dot >= meshlets.coneCutoff[i] * length + radius * camera[3])
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  BuildMeshlets()
+ *
+ *  This function is used for walking the triangles in the
+ *  order of the indices and starting a new meshlet whenever
+ *  the next triangle would take the current one past its
+ *  vertex or triangle limit.
+ ***********************************************************/
+void BuildMeshlets(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	size_t vertexCount,
+	MESHLETS& meshlets,
+	int maxVertices,
+	int maxTriangles)
+{
+	meshlets = MESHLETS();
+	if ((indexCount < 3) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	// the meshlet that last used each vertex
+	std::vector<unsigned int> vertexMeshlet(vertexCount, g_NoMeshlet);
+	std::vector<unsigned int> vertices;
+	vertices.reserve(maxVertices);
+	unsigned int meshlet = 0;
+	size_t firstIndex = 0;
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		int newVertices = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			unsigned int vertex = pIndices[i + c];
+			if ((vertexMeshlet[vertex] != meshlet) &&
+				((c == 0) || (pIndices[i] != vertex)) &&
+				((c < 2) || (pIndices[i + 1] != vertex)))
+			{
+				newVertices++;
+			}
+		}
+
+		if ((vertices.size() + newVertices > (size_t)maxVertices) ||
+			((i - firstIndex) / 3 + 1 > (size_t)maxTriangles))
+		{
+			AddMeshlet(pVerts, floatsPerVertex, pIndices, firstIndex, i - firstIndex, vertices, meshlets);
+			vertices.clear();
+			meshlet++;
+			firstIndex = i;
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			unsigned int vertex = pIndices[i + c];
+			if (vertexMeshlet[vertex] != meshlet)
+			{
+				vertexMeshlet[vertex] = meshlet;
+				vertices.push_back(vertex);
+			}
+		}
+	}
+
+	AddMeshlet(pVerts, floatsPerVertex, pIndices, firstIndex, indexCount / 3 * 3 - firstIndex, vertices, meshlets);
+}
+
+/***********************************************************
+ *  CullMeshlets()
+ *
+ *  This function is used for finding the meshlets that
+ *  are inside the view frustum and face the camera, and
+ *  writing their index ranges in order.  The planes of the
+ *  frustum are taken from the rows of the matrix, so they
+ *  are in object space and the bounds are used as stored.
+ *  Four meshlets are tested at a time when SSE2 is
+ *  available.
+ ***********************************************************/
+int CullMeshlets(
+	const MESHLETS& meshlets,
+	const float* pModelViewProjection,
+	const float* pCamera,
+	MESHLET_RANGE* pRanges,
+	int maxRanges,
+	size_t* pVisibleMeshlets)
+{
+	const float* m = pModelViewProjection;
+	size_t count = meshlets.firstIndex.size();
+	size_t visibleMeshlets = 0;
+	int rangeCount = 0;
+
+	if (maxRanges <= 0)
+	{
+		return(0);
+	}
+
+	// left, right, bottom, top, near and far planes, scaled so
+	// the distance of a point from each is in object units
+	float planes[6][4];
+	for (int p = 0; p < 6; p++)
+	{
+		int row = p / 2;
+		float sign = ((p % 2) == 0) ? 1.0f : -1.0f;
+		for (int c = 0; c < 4; c++)
+		{
+			planes[p][c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+		}
+		float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+		if (length > 0.0f)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				planes[p][c] /= length;
+			}
+		}
+	}
+
+	// the vector from the camera to a meshlet is its center
+	// minus the camera position, or the view direction for a
+	// parallel projection
+	bool bConeTest = (NULL != pCamera);
+	float camera[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	if (bConeTest == true)
+	{
+		float sign = (pCamera[3] != 0.0f) ? 1.0f : -1.0f;
+		camera[0] = pCamera[0] * sign;
+		camera[1] = pCamera[1] * sign;
+		camera[2] = pCamera[2] * sign;
+		camera[3] = (pCamera[3] != 0.0f) ? 1.0f : 0.0f;
+	}
+
+	size_t i = 0;
+#if defined(MESHLETS_SSE2)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 cameraX = _mm_set1_ps(camera[0]);
+	const __m128 cameraY = _mm_set1_ps(camera[1]);
+	const __m128 cameraZ = _mm_set1_ps(camera[2]);
+	const __m128 cameraW = _mm_set1_ps(camera[3]);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&meshlets.centerX[i]);
+		__m128 y = _mm_loadu_ps(&meshlets.centerY[i]);
+		__m128 z = _mm_loadu_ps(&meshlets.centerZ[i]);
+		__m128 radius = _mm_loadu_ps(&meshlets.radius[i]);
+		__m128 negativeRadius = _mm_sub_ps(zero, radius);
+
+		__m128 visible = _mm_cmpeq_ps(zero, zero);
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p][0]), x), _mm_mul_ps(_mm_set1_ps(planes[p][1]), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p][2]), z), _mm_set1_ps(planes[p][3])));
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		if (bConeTest == true)
+		{
+			__m128 vx = _mm_sub_ps(_mm_mul_ps(x, cameraW), cameraX);
+			__m128 vy = _mm_sub_ps(_mm_mul_ps(y, cameraW), cameraY);
+			__m128 vz = _mm_sub_ps(_mm_mul_ps(z, cameraW), cameraZ);
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+			__m128 dot = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&meshlets.coneAxisX[i])), _mm_mul_ps(vy, _mm_loadu_ps(&meshlets.coneAxisY[i]))),
+				_mm_mul_ps(vz, _mm_loadu_ps(&meshlets.coneAxisZ[i])));
+			__m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&meshlets.coneCutoff[i]), length), _mm_mul_ps(radius, cameraW));
+			visible = _mm_andnot_ps(_mm_cmpge_ps(dot, limit), visible);
+		}
+
+		int mask = _mm_movemask_ps(visible);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if ((mask & (1 << lane)) != 0)
+			{
+				AddRange(meshlets.firstIndex[i + lane], meshlets.indexCount[i + lane], pRanges, maxRanges, rangeCount);
+				visibleMeshlets++;
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		if (IsMeshletVisible(meshlets, i, planes, bConeTest, camera) == true)
+		{
+			AddRange(meshlets.firstIndex[i], meshlets.indexCount[i], pRanges, maxRanges, rangeCount);
+			visibleMeshlets++;
+		}
+	}
+
+	if (NULL != pVisibleMeshlets)
+	{
+		*pVisibleMeshlets = visibleMeshlets;
+	}
+	return(rangeCount);
+}
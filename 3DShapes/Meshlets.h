@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlets.h
+// ============
+// split meshes into clusters of triangles and cull the clusters on the CPU
+//
+//  A meshlet is a run of consecutive triangles of the index buffer that
+//  uses at most 64 vertices and 124 triangles.  The runs are cut from the
+//  order the optimizer left the triangles in, which already keeps nearby
+//  triangles together, so the index buffer does not change and any part
+//  of the meshlets can be drawn as ranges of it.  Every meshlet has a
+//  bounding sphere and a cone that holds the normals of its triangles.
+//  Each frame the meshlets of a mesh are tested four at a time against
+//  the planes of the view frustum and the position of the camera, both
+//  in the object space of the mesh: a meshlet is skipped when its sphere
+//  is outside the frustum or when the camera is behind all its triangles.
+//  The meshlets that are left are merged into as few index ranges as
+//  possible for one multi-draw.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// most vertices and triangles of one meshlet
+const int MESHLET_MAX_VERTICES = 64;
+const int MESHLET_MAX_TRIANGLES = 124;
+
+// the meshlets of a mesh, with one array per bound value so
+// that several meshlets are tested at once
+struct MESHLETS
+{
+	// bounding sphere in object space
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+	// axis of the normal cone, and the sine of the spread of
+	// the normals around it - above 1 when the triangles face
+	// too many ways for the meshlet to ever face away
+	std::vector<float> coneAxisX;
+	std::vector<float> coneAxisY;
+	std::vector<float> coneAxisZ;
+	std::vector<float> coneCutoff;
+	// the triangles of each meshlet in the index buffer
+	std::vector<unsigned int> firstIndex;
+	std::vector<unsigned int> indexCount;
+};
+
+// a range of the index buffer to draw
+struct MESHLET_RANGE
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+// split the triangles of the passed in indices into meshlets of
+// consecutive triangles, with the positions at the start of the
+// interleaved vertices
+void BuildMeshlets(
+	const float* pVerts,
+	size_t floatsPerVertex,
+	const unsigned int* pIndices,
+	size_t indexCount,
+	size_t vertexCount,
+	MESHLETS& meshlets,
+	int maxVertices = MESHLET_MAX_VERTICES,
+	int maxTriangles = MESHLET_MAX_TRIANGLES);
+
+// test the meshlets against the frustum of a column-major model,
+// view and projection matrix and against the camera in object
+// space - a position with w of 1, or the view direction with w of
+// 0 for a parallel projection, or NULL to keep the meshlets that
+// face away - and write the index ranges of the ones that are
+// left, which are extended past hidden meshlets once the passed
+// in number of ranges is used up
+int CullMeshlets(
+	const MESHLETS& meshlets,
+	const float* pModelViewProjection,
+	const float* pCamera,
+	MESHLET_RANGE* pRanges,
+	int maxRanges,
+	size_t* pVisibleMeshlets = NULL);
@@ -9,12 +9,18 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "shapemeshes.h"
+#include "MeshOptimizer.h"
+#include "VertexPacking.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <vector>
 
 namespace
@@ -24,25 +30,239 @@ namespace
 	const GLuint g_FloatsPerVertex = 3;	// Number of coordinates per vertex
 	const GLuint g_FloatsPerNormal = 3;	// Number of values per vertex color
 	const GLuint g_FloatsPerUV = 2;		// Number of texture coordinate values
+
+	// tessellation of the generated detail levels, where
+	// level 0 is the full detail mesh
+	const int g_SphereLODStacks[ShapeMeshes::LOD_COUNT] = { 24, 12, 8, 4 };
+	const int g_SphereLODSlices[ShapeMeshes::LOD_COUNT] = { 32, 16, 10, 6 };
+	const int g_TorusLODMainSegments[ShapeMeshes::LOD_COUNT] = { 30, 20, 12, 8 };
+	const int g_TorusLODTubeSegments[ShapeMeshes::LOD_COUNT] = { 30, 12, 8, 5 };
+	const int g_RoundLODSegments[ShapeMeshes::LOD_COUNT] = { 36, 18, 10, 6 };
+	// segments from top to bottom of the generated cylinders,
+	// which only need more for lighting computed per vertex
+	const int g_RoundHeightSegments = 1;
+
+	// columns of quads added together by AppendGridIndices(),
+	// so the two rows of vertices of a block fit in a 16 entry
+	// post-transform vertex cache
+	const int g_CacheBlockColumns = 6;
+
+	// fewest triangles of an imported mesh that is split into
+	// meshlets - the smaller meshes are always drawn whole
+	const size_t g_MeshletMinTriangles = 4096;
+
+	// thickness and segments of the torus the scenes draw,
+	// the defaults of LoadTorusMesh()
+	const float g_TorusThickness = 0.2f;
+	const int g_TorusSegments = 30;
+
+	// alignment of the vertices and indices of each shape in
+	// the buffer the shapes are stored in together - a whole
+	// number of vertices of either layout, so every shape can
+	// also be drawn from the start of the buffer with a base
+	// vertex
+	const size_t g_ShapeDataAlignment = 32;
+
+	// components, type and normalization of an attribute
+	struct VERTEX_ATTRIBUTE_FORMAT
+	{
+		GLint size;
+		GLenum type;
+		GLboolean bNormalized;
+	};
+
+	// the position, normal and texture coordinate formats of
+	// the float layout, and of the packed 16 byte layout:
+	// position fractions of the packing box, the octahedral
+	// normal as plain integers the shader scales, and half
+	// float texture coordinates
+	const GLuint g_AttributeCount = 3;
+	const VERTEX_ATTRIBUTE_FORMAT g_FloatAttributeFormats[g_AttributeCount] = {
+		{ (GLint)g_FloatsPerVertex, GL_FLOAT, GL_FALSE },
+		{ (GLint)g_FloatsPerNormal, GL_FLOAT, GL_FALSE },
+		{ (GLint)g_FloatsPerUV, GL_FLOAT, GL_FALSE } };
+	const VERTEX_ATTRIBUTE_FORMAT g_PackedAttributeFormats[g_AttributeCount] = {
+		{ 3, GL_UNSIGNED_SHORT, GL_TRUE },
+		{ 4, GL_INT_2_10_10_10_REV, GL_FALSE },
+		{ 2, GL_HALF_FLOAT, GL_FALSE } };
+
+	/***********************************************************
+	 *  AlignShapeOffset()
+	 *
+	 *  This function is used for rounding an offset in the
+	 *  buffer of the shapes up to the next aligned block.
+	 ***********************************************************/
+	size_t AlignShapeOffset(size_t offset)
+	{
+		return((offset + g_ShapeDataAlignment - 1) & ~(g_ShapeDataAlignment - 1));
+	}
+
+	/***********************************************************
+	 *  GetIndexSize()
+	 *
+	 *  This function is used for getting the size in bytes of
+	 *  an index of the passed in type.
+	 ***********************************************************/
+	size_t GetIndexSize(GLenum indexType)
+	{
+		return((indexType == GL_UNSIGNED_INT) ? sizeof(GLuint) :
+			((indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLubyte)));
+	}
+
+	/***********************************************************
+	 *  AppendCapVertices()
+	 *
+	 *  This function is used for writing the center point and
+	 *  the closed ring of a flat cap facing straight up or down.
+	 ***********************************************************/
+	void AppendCapVertices(
+		GLfloat* pVertex,
+		int radialSegments,
+		const float* sinAround,
+		const float* cosAround,
+		float radius,
+		float y,
+		float normalY)
+	{
+		const int floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+		const GLfloat center[] = { 0.0f, y, 0.0f,	0.0f, normalY, 0.0f,	0.5f, 0.5f };
+		memcpy(pVertex, center, sizeof(center));
+		pVertex += floatsPerVertex;
+
+		for (int column = 0; column <= radialSegments; column++)
+		{
+			pVertex[0] = radius * cosAround[column];
+			pVertex[1] = y;
+			pVertex[2] = -radius * sinAround[column];
+			pVertex[3] = 0.0f;
+			pVertex[4] = normalY;
+			pVertex[5] = 0.0f;
+			pVertex[6] = 0.5f + 0.5f * normalY * cosAround[column];
+			pVertex[7] = 0.5f + 0.5f * sinAround[column];
+			pVertex += floatsPerVertex;
+		}
+	}
+
+	/***********************************************************
+	 *  AppendFanIndices()
+	 *
+	 *  This function is used for adding the triangles of a cap
+	 *  written by AppendCapVertices(), wound to face up or down.
+	 ***********************************************************/
+	void AppendFanIndices(
+		std::vector<GLuint>& indices,
+		GLuint firstVertex,
+		int radialSegments,
+		bool bFacingUp)
+	{
+		for (int column = 0; column < radialSegments; column++)
+		{
+			GLuint ring = firstVertex + 1 + column;
+			indices.push_back(firstVertex);
+			indices.push_back(bFacingUp ? ring : ring + 1);
+			indices.push_back(bFacingUp ? ring + 1 : ring);
+		}
+	}
+
+	/***********************************************************
+	 *  AppendGridIndices()
+	 *
+	 *  This function is used for adding two triangles for every
+	 *  quad of a grid of rows of (columns + 1) vertices, from
+	 *  the first row up to the last one.  The quads are added in
+	 *  blocks of a few columns from the top down, so the
+	 *  vertices shared with the row above are still in the
+	 *  post-transform cache, and the triangles that collapse
+	 *  into a point at the top or bottom edge are left out.
+	 ***********************************************************/
+	void AppendGridIndices(
+		std::vector<GLuint>& indices,
+		GLuint firstVertex,
+		int columns,
+		int firstRow,
+		int lastRow,
+		bool bCollapsedTop,
+		bool bCollapsedBottom)
+	{
+		for (int blockStart = 0; blockStart < columns; blockStart += g_CacheBlockColumns)
+		{
+			int blockEnd = std::min(blockStart + g_CacheBlockColumns, columns);
+			for (int row = firstRow; row < lastRow; row++)
+			{
+				bool bTopTriangle = (bCollapsedTop == false) || (row != firstRow);
+				bool bBottomTriangle = (bCollapsedBottom == false) || (row != (lastRow - 1));
+				for (int column = blockStart; column < blockEnd; column++)
+				{
+					GLuint topLeft = firstVertex + row * (columns + 1) + column;
+					GLuint bottomLeft = topLeft + columns + 1;
+
+					if (bBottomTriangle == true)
+					{
+						indices.push_back(topLeft);
+						indices.push_back(bottomLeft);
+						indices.push_back(bottomLeft + 1);
+					}
+					if (bTopTriangle == true)
+					{
+						indices.push_back(topLeft);
+						indices.push_back(bottomLeft + 1);
+						indices.push_back(topLeft + 1);
+					}
+				}
+			}
+		}
+	}
 }
 
 ShapeMeshes::ShapeMeshes()
 {
-	m_bMemoryLayoutDone = false;
+	m_bPackedVertices = false;
+	m_levelOfDetail = 0;
+	m_drawnVertexCount = 0;
+	m_vertexArrayBindCount = 0;
+
+	// separate attribute formats let every mesh of a layout
+	// share one vertex array
+	m_bSharedVertexArrays = (GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding);
+	m_sharedVAOs[0] = 0;
+	m_sharedVAOs[1] = 0;
+	m_zeroBuffer = 0;
+	m_indirectVAOs[0] = 0;
+	m_indirectVAOs[1] = 0;
+	m_boundVAO = 0;
+	m_boundIndexBuffer = 0;
+
+	// the generated shapes keep the records of their types,
+	// which are only drawn once the shapes are loaded
+	m_meshes.reserve(SHAPE_COUNT * LOD_COUNT);
+	for (int i = 0; i < SHAPE_COUNT; i++)
+	{
+		AddMesh();
+	}
 }
 
 ///////////////////////////////////////////////////
 //	LoadBoxMesh()
 //
-//	Create a box mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Create a box mesh and store it in a VAO/VBO.
 //
 //	Correct triangle drawing command:
 //
 //	glDrawElements(GL_TRIANGLES, meshes.gBoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadBoxMesh()
+{
+	LoadShape(SHAPE_BOX);
+}
+
+///////////////////////////////////////////////////
+//	BuildBoxData()
+//
+//	Create a box mesh by specifying the vertices and
+//  indices.  The normals and texture coordinates are
+//  also set.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildBoxData(MESH_DATA& data)
 {
 	// Position and Color data
 	GLfloat verts[] = {
@@ -102,486 +322,65 @@ void ShapeMeshes::LoadBoxMesh()
 		20,23,22
 	};
 
-	m_BoxMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_BoxMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
-
-	glGenVertexArrays(1, &m_BoxMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_BoxMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(2, m_BoxMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_BoxMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the vertices and indices are stored with the other shapes
+	data.verts.assign(verts, verts + sizeof(verts) / sizeof(verts[0]));
+	data.indices.assign(indices, indices + sizeof(indices) / sizeof(indices[0]));
 }
 
 ///////////////////////////////////////////////////
 //	LoadConeMesh()
 //
-//	Create a cole mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Generate a cone mesh with a bottom cap at every
+//  detail level and store each in a VAO/VBO.  The
+//  normals and texture coordinates are also set.
 //
-//  Correct triangle drawing commands:
+//  Correct triangle drawing command:
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
+//	DrawConeMesh();
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadConeMesh()
 {
-	GLfloat verts[] = {
-		// cone bottom			// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cone sides		// normals									// texture coords
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		1.0f,0.5f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.0f, -0.116841137f, 		0.983f,0.6f,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f, 		0.983f,0.6f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f, 		0.96f,0.68f,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f, 		0.96f,0.68f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f, 		0.92f,0.77f,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f, 		0.92f,0.77f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f, 		0.87f, 0.83f,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f, 		0.87f, 0.83f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f, 		0.83f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f, 		0.83f, 0.87f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f, 		0.77f, 0.92f,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f, 		0.77f, 0.92f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f, 		0.68f, 0.96f,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f, 		0.68f, 0.96f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f, 		0.6f, 0.983f,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f, 		0.6f, 0.983f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f, 		0.41f, 0.983f,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f, 		0.41f, 0.983f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f, 		0.33f, 0.96f,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f, 		0.33f, 0.96f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f, 		0.25f, 0.92f,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f, 		0.25f, 0.92f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f, 		0.17f, 0.87f,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f, 		0.17f, 0.87f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f, 		0.13f, 0.83f,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f, 		0.13f, 0.83f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f, 		0.08f, 0.77f,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f, 		0.08f, 0.77f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f, 		0.04f, 0.68f,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f, 		0.04f, 0.68f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f, 		0.017f, 0.6f,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f, 		0.017f, 0.6f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f, 		0.5f, 0.5f,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f, 		0.017f, 0.41f,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f, 		0.017f, 0.41f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, 0.229039446f, 		0.5f, 0.5f,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f, 		0.04f, 0.33f,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f, 		0.04f, 0.33f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, 0.400818795f, 		0.5f, 0.5f,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f, 		0.08f, 0.25f,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f, 		0.08f, 0.25f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, 0.581238329f, 		0.5f, 0.5f,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f, 		0.13f, 0.17f,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f, 		0.13f, 0.17f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, 0.707106769f, 		0.5f, 0.5f,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f, 		0.17f, 0.13f,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f, 		0.17f, 0.13f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, 0.813733339f, 		0.5f, 0.5f,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f, 		0.25f, 0.08f,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f, 		0.25f, 0.08f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, 0.916157305f, 		0.5f, 0.5f,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f, 		0.33f, 0.04f,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f, 		0.33f, 0.04f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, 0.973417103f, 		0.5f, 0.5f,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f, 		0.41f, 0.017f,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f, 		0.41f, 0.017f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.0f,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.0f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f, 	0.6f, 0.017f,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f, 	0.6f, 0.017f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, 0.973417103f, 	0.5f, 0.5f,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f, 	0.68f, 0.04f,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f, 	0.68f, 0.04f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, 0.916157305f, 	0.5f, 0.5f,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f, 	0.77f, 0.08f,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f, 	0.77f, 0.08f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, 0.813733339f, 	0.5f, 0.5f,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f, 	0.83f, 0.13f,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f, 	0.83f, 0.13f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, 0.707106769f, 	0.5f, 0.5f,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f, 	0.87f, 0.17f,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f, 	0.87f, 0.17f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, 0.581238329f, 	0.5f, 0.5f,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f, 	0.92f, 0.25f,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f, 	0.92f, 0.25f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, 0.400818795f, 	0.5f, 0.5f,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f, 	0.96f, 0.33f,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f, 	0.96f, 0.33f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, 0.229039446f, 	0.5f, 0.5f,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f, 	0.983f, 0.41f,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f, 	0.983f, 0.41f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	0.5f, 0.5f,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	1.0f, 0.5f
-	};
-
-	// store vertex and index count
-	m_ConeMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_ConeMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_ConeMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_ConeMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_ConeMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_ConeMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadShape(SHAPE_CONE);
 }
 
 ///////////////////////////////////////////////////
 //	LoadCylinderMesh()
 //
-//	Create a cylinder mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Generate a cylinder mesh with both caps at every
+//  detail level and store each in a VAO/VBO.  The
+//  normals and texture coordinates are also set.
 //
-//  Correct triangle drawing commands:
+//  Correct triangle drawing command:
 //
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 36);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//	DrawCylinderMesh();
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadCylinderMesh()
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 1.0f, -0.34f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 1.0f, -0.64f,		0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 1.0f, -0.77f,		0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 1.0f, -0.94f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 1.0f, -0.98f,		0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -1.0f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 1.0f, -0.98f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 1.0f, -0.94f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 1.0f, -0.77f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 1.0f, -0.64f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 1.0f, -0.34f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.5f, -0.116841137f,	0.0277,0.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,1.0,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f,	0.0554,0.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f,	0.0277,1.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f,	0.0831,0.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f,	0.1108,0.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f,	0.1385,0.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,1.0,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f,	0.1662,0.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385, 1.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f,	0.1939, 0.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f,	0.2216, 0.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		0.0f, 1.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f,	0.3047, 0.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f,	0.3324, 0.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f,	0.3601, 0.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f,	0.3878, 0.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f,	0.4155, 0.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f,	0.4432, 0.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f,	0.4709, 0.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f,	0.5263, 0.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f,	0.4986, 1.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f,	0.554, 0.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f,	0.5817, 0.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f,	0.6094, 0.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f,	0.6371, 0.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f,	0.6648, 0.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f,	0.6925, 0.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f,	0.7202, 0.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f,	0.8033, 0.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f,	0.831, 0.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f,	0.8587, 0.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f,	0.8864, 0.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f,	0.9141, 0.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f,	0.9418, 0.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 0.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f,	0.9695, 0.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0
-	};
-
-	glm::vec3 normal;
-
-	normal = CalculateTriangleNormal(glm::vec3(.98f, 1.0f, 0.17f), glm::vec3(.98f, 0.0f, 0.17f), glm::vec3(1.0f, 0.0f, 0.0f));
-
-	// store vertex and index count
-	m_CylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_CylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_CylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_CylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_CylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_CylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	LoadShape(SHAPE_CYLINDER);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPlaneMesh()
 //
-//	Create a plane mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-// 
-//  Correct triangle drawing command:
+//	Create a plane mesh and store it in a VAO/VBO.
+//
+//	Correct triangle drawing command:
 //
 //	glDrawElements(GL_TRIANGLES, meshes.gPlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPlaneMesh()
+{
+	LoadShape(SHAPE_PLANE);
+}
+
+///////////////////////////////////////////////////
+//	BuildPlaneData()
+//
+//	Create a plane mesh by specifying the vertices
+//  and indices.  The normals and texture coordinates
+//  are also set.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildPlaneData(MESH_DATA& data)
 {
 	// Vertex data
 	GLfloat verts[] = {
@@ -598,40 +397,33 @@ void ShapeMeshes::LoadPlaneMesh()
 		0,3,2
 	};
 
-	// store vertex and index count
-	m_PlaneMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_PlaneMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
-
-	// Generate the VAO for the mesh
-	glGenVertexArrays(1, &m_PlaneMesh.vao);
-	glBindVertexArray(m_PlaneMesh.vao);	// activate the VAO
-
-	// Create VBOs for the mesh
-	glGenBuffers(2, m_PlaneMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PlaneMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_PlaneMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the vertices and indices are stored with the other shapes
+	data.verts.assign(verts, verts + sizeof(verts) / sizeof(verts[0]));
+	data.indices.assign(indices, indices + sizeof(indices) / sizeof(indices[0]));
 }
 
 ///////////////////////////////////////////////////
 //	LoadPrismMesh()
 //
-//	Create a prism mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Create a prism mesh and store it in a VAO/VBO.
 //
 //	Correct triangle drawing command:
 //
 //	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPrismMesh.nVertices);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPrismMesh()
+{
+	LoadShape(SHAPE_PRISM);
+}
+
+///////////////////////////////////////////////////
+//	BuildPrismData()
+//
+//	Create a prism mesh by specifying the vertices.
+//  The normals and texture coordinates are also
+//  set.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildPrismData(MESH_DATA& data)
 {
 	// Vertex data
 	GLfloat verts[] = {
@@ -682,34 +474,33 @@ void ShapeMeshes::LoadPrismMesh()
 
 	};
 
-	m_PrismMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_PrismMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_PrismMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(1, m_PrismMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PrismMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the vertices are stored with the other shapes
+	data.verts.assign(verts, verts + sizeof(verts) / sizeof(verts[0]));
 }
 
 ///////////////////////////////////////////////////
 //	LoadPyramid3Mesh()
 //
-//	Create a 3-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
+//	Create a 3-sided pyramid mesh and store it in a
+//  VAO/VBO.
 //
-//  Correct triangle drawing command:
+//	Correct triangle drawing command:
 //
 //	glDrawArrays(GL_TRIANGLE_STRIP, 0, gPyramid3Mesh.nVertices);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid3Mesh()
+{
+	LoadShape(SHAPE_PYRAMID3);
+}
+
+///////////////////////////////////////////////////
+//	BuildPyramid3Data()
+//
+//	Create a 3-sided pyramid mesh by specifying the
+//  vertices.  The normals and texture coordinates
+//  are also set.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildPyramid3Data(MESH_DATA& data)
 {
 	// Vertex data
 	GLfloat verts[] = {
@@ -736,34 +527,33 @@ void ShapeMeshes::LoadPyramid3Mesh()
 		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
 	};
 
-	// Calculate total defined vertices
-	m_Pyramid3Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid3Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid3Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid3Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid3Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the vertices are stored with the other shapes
+	data.verts.assign(verts, verts + sizeof(verts) / sizeof(verts[0]));
 }
 
 ///////////////////////////////////////////////////
 //	LoadPyramid4Mesh()
 //
-//	Create a 4-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
+//	Create a 4-sided pyramid mesh and store it in a
+//  VAO/VBO.
 //
-//  Correct triangle drawing command:
+//	Correct triangle drawing command:
 //
 //	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPyramid4Mesh.nVertices);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid4Mesh()
+{
+	LoadShape(SHAPE_PYRAMID4);
+}
+
+///////////////////////////////////////////////////
+//	BuildPyramid4Data()
+//
+//	Create a 4-sided pyramid mesh by specifying the
+//  vertices.  The normals and texture coordinates
+//  are also set.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildPyramid4Data(MESH_DATA& data)
 {
 	// Vertex data
 	GLfloat verts[] = {
@@ -799,27 +589,15 @@ void ShapeMeshes::LoadPyramid4Mesh()
 		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,	0.5f, 1.0f,		//top point
 	};
 
-	// Calculate total defined vertices
-	m_Pyramid4Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid4Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid4Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid4Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid4Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the vertices are stored with the other shapes
+	data.verts.assign(verts, verts + sizeof(verts) / sizeof(verts[0]));
 }
 
 ///////////////////////////////////////////////////
 //	LoadSphereMesh()
 //
-//	Create a sphere mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//	Generate a sphere mesh at every detail level and
+//  store each in a VAO/VBO.  The normals and texture
 //  coordinates are also set.
 //
 //  Correct triangle drawing command:
@@ -828,1426 +606,473 @@ void ShapeMeshes::LoadPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadSphereMesh()
 {
-	GLfloat verts[] = {
-		// vertex data					// texture coords			// index
-		// top center point
-		0.0f, 1.0f, 0.0f,				0.5f, 1.0f,					//0
-		// ring 1
-		0.0f, 0.9808f, 0.1951f,			0.5f, 0.9375f,				//1
-		0.0747f, 0.9808f, 0.1802f,		0.51219375f, 0.9375f,		//2
-		0.1379f, 0.9808f, 0.1379f,		0.5243875f, 0.9375f,		//3
-		0.1802f, 0.9808f, 0.0747f,		0.53658125f, 0.9375f,		//4
-		0.1951f, 0.9808, 0.0f,			0.548775f, 0.9375f,			//5
-		0.1802f, 0.9808f, -0.0747f,		0.56096875f, 0.9375f,		//6
-		0.1379f, 0.9808f, -0.1379f,		0.5731625f, 0.9375f,		//7
-		0.0747f, 0.9808f, -0.1802f,		0.58535625f, 0.9375f,		//8
-		0.0f, 0.9808f, -0.1951f,		0.59755f, 0.9375f,			//9 - seam
-		0.0f, 0.9808f, -0.1951f,		0.40245f, 0.9375f,			//10 - seam
-		-0.0747f, 0.9808f, -0.1802f,	0.41464375f, 0.9375f,		//11
-		-0.1379f, 0.9808f, -0.1379f,	0.4268375f, 0.9375f,		//12
-		-0.1802f, 0.9808f, -0.0747f,	0.43903125f, 0.9375f,		//13
-		-0.1951f, 0.9808, 0.0f,			0.451225f, 0.9375f,			//14
-		-0.1802f, 0.9808f, 0.0747f,		0.46341875f, 0.9375f,		//15
-		-0.1379f, 0.9808f, 0.1379f,		0.4756125f, 0.9375f,		//16
-		-0.0747f, 0.9808f, 0.1802f,		0.48780625f, 0.9375f,		//17
-		// ring 2
-		0.0f, 0.9239f, 0.3827f,			0.5f, 0.875f,				//18
-		0.1464f, 0.9239f, 0.3536f,		0.52391875f, 0.875f,		//19
-		0.2706f, 0.9239f, 0.2706f,		0.5478375f, 0.875f,			//20
-		0.3536f, 0.9239f, 0.1464f,		0.57175625f, 0.875f,		//21
-		0.3827f, 0.9239f, 0.0f,			0.5956755f, 0.875f,			//22
-		0.3536f, 0.9239f, -0.1464f,		0.61959425f, 0.875f,		//23
-		0.2706f, 0.9239f, -0.2706f,		0.643513f, 0.875f,			//24
-		0.1464f, 0.9239f, -0.3536f,		0.66743175f, 0.875f,		//25
-		0.0f, 0.9239f, -0.3827f,		0.6913505f, 0.875f,			//26 - seam
-		0.0f, 0.9239f, -0.3827f,		0.3086495f, 0.875f,			//27 - seam
-		-0.1464f, 0.9239f, -0.3536f,	0.33256825f, 0.875f,		//28
-		-0.2706f, 0.9239f, -0.2706f,	0.356487f, 0.875f,			//29
-		-0.3536f, 0.9239f, -0.1464f,	0.38040575f, 0.875f,		//30
-		-0.3827f, 0.9239f, 0.0f,		0.4043245f, 0.875f,			//31
-		-0.3536f, 0.9239f, 0.1464f,		0.42824325f, 0.875f,		//32
-		-0.2706f, 0.9239f, 0.2706f,		0.452162f, 0.875f,			//33
-		-0.1464f, 0.9239f, 0.3536f,		0.47608075f, 0.875f,		//34
-		// ring 3
-		0.0f, 0.8315f, 0.5556f,			0.5f, 0.8125f,				//35
-		0.2126f, 0.8315f, 0.5133f,		0.534725f, 0.8125f,			//36
-		0.3928f, 0.8315f, 0.3928f,		0.56945f, 0.8125f,			//37
-		0.5133f, 0.8315f, 0.2126f,		0.604175f, 0.8125f,			//38
-		0.5556f, 0.8315f, 0.0f,			0.6389f, 0.8125f,			//39
-		0.5133f, 0.8315f, -0.2126f,		0.673625f, 0.8125f,			//40
-		0.3928f, 0.8315f, -0.3928f,		0.70835f, 0.8125f,			//41
-		0.2126f, 0.8315f, -0.5133f,		0.743075f, 0.8125f,			//42
-		0.0f, 0.8315f, -0.5556f,		0.7778f, 0.8125f,			//43 - seam
-		0.0f, 0.8315f, -0.5556f,		0.2222f, 0.8125f,			//44 - seam
-		-0.2126f, 0.8315f, -0.5133f,	0.256925f, 0.8125f,			//45
-		-0.3928f, 0.8315f, -0.3928f,	0.29165f, 0.8125f,			//46
-		-0.5133f, 0.8315f, -0.2126f,	0.326375f, 0.8125f,			//47
-		-0.5556f, 0.8315f, 0.0f,		0.3611f, 0.8125f,			//48
-		-0.5133f, 0.8315f, 0.2126f,		0.395825f, 0.8125f,			//49
-		-0.3928f, 0.8315f, 0.3928f,		0.43055f, 0.8125f,			//50
-		-0.2126f, 0.8315f, 0.5133f,		0.465275f, 0.8125f,			//51
-		// ring 4
-		0.0f, 0.7071f, 0.7071f,			0.5f, 0.75f,				//52
-		0.2706f, 0.7071f, 0.6533f,		0.54419375f, 0.75f,			//53
-		0.5f, 0.7071f, 0.5f,			0.5883875f, 0.75f,			//54
-		0.6533f, 0.7071f, 0.2706f,		0.63258125f, 0.75f,			//55
-		0.7071f, 0.7071f, 0.0f,			0.676775f, 0.75f,			//56
-		0.6533f, 0.7071f, -0.2706f,		0.72096875f, 0.75f,			//57
-		0.5f, 0.7071f, -0.5f,			0.7651625f, 0.75f,			//58
-		0.2706f, 0.7071f, -0.6533f,		0.80935625f, 0.75f,			//59
-		0.0f, 0.7071f, -0.7071f,		0.85355f, 0.75f,			//60 - seam
-		0.0f, 0.7071f, -0.7071f,		0.14645f, 0.75f,			//61 - seam
-		-0.2706f, 0.7071f, -0.6533f,	0.19064375f, 0.75f,			//62
-		-0.5f, 0.7071f, -0.5f,			0.2348375f, 0.75f,			//63
-		-0.6533f, 0.7071f, -0.2706f,	0.27903135f, 0.75f,			//64
-		-0.7071f, 0.7071f, 0.0f,		0.323225f, 0.75f,			//65
-		-0.6533f, 0.7071f, 0.2706f,		0.36741875f, 0.75f,			//66
-		-0.5f, 0.7071f, 0.5f,			0.4116125f, 0.75f,			//67
-		-0.2706f, 0.7071f, 0.6533f,		0.45580625f, 0.75f,			//68
-		// ring 5
-		0.0f, 0.5556f, 0.8315f,			0.5f, 0.6875f,				//69
-		0.3182f, 0.5556f, 0.7682f,		0.55196875f, 0.6875f,		//70
-		0.5879f, 0.5556f, 0.5879f,		0.6039375f, 0.6875f,		//71
-		0.7682f, 0.5556f, 0.3182f,		0.65590625f, 0.6875f,		//72
-		0.8315f, 0.5556f, 0.0f,			0.707875f, 0.6875f,			//73
-		0.7682f, 0.5556f, -0.3182f,		0.75984375f, 0.6875f,		//74
-		0.5879f, 0.5556f, -0.5879f,		0.8118125f, 0.6875f,		//75
-		0.3182f, 0.5556f, -0.7682f,		0.86378125f, 0.6875f,		//76
-		0.0f, 0.5556f, -0.8315f,		0.91575f, 0.6875f,			//77 - seam
-		0.0f, 0.5556f, -0.8315f,		0.08425f, 0.6875f,			//78 - seam
-		-0.3182f, 0.5556f, -0.7682f,	0.13621875f, 0.6875f,		//79
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.6875f,		//80
-		-0.7682f, 0.5556f, -0.3182f,	0.24015625f, 0.6875f,		//81
-		-0.8315f, 0.5556f, 0.0f,		0.292125f, 0.6875f,			//82
-		-0.7682f, 0.5556f, 0.3182f,		0.34409375f, 0.6875f,		//83
-		-0.5879f, 0.5556f, 0.5879f,		0.3960625f, 0.6875f,		//84
-		-0.3182f, 0.5556f, 0.7682f,		0.44803125f, 0.6875f,		//85
-		//ring 6
-		0.0f, 0.3827f, 0.9239f,			0.5f, 0.625f,				//86
-		0.3536f, 0.3827f, 0.8536f,		0.55774375f, 0.625f,		//87
-		0.6533f, 0.3827f, 0.6533f,		0.6154875f, 0.625f,			//88
-		0.8536f, 0.3827f, 0.3536f,		0.67323125f, 0.625f,		//89
-		0.9239f, 0.3827f, 0.0f,			0.730975f, 0.625f,			//90
-		0.8536f, 0.3827f, -0.3536f,		0.78871875f, 0.625f,		//91
-		0.6533f, 0.3827f, -0.6533f,		0.8464625f, 0.625f,			//92
-		0.3536f, 0.3827f, -0.8536f,		0.90420625f, 0.625f,		//93
-		0.0f, 0.3827f, -0.9239f,		0.96195f, 0.625f,			//94 - seam
-		0.0f, 0.3827f, -0.9239f,		0.03805f, 0.625f,			//95 - seam
-		-0.3536f, 0.3827f, -0.8536f,	0.09579375f, 0.625f,		//96
-		-0.6533f, 0.3827f, -0.6533f,	0.1535375f, 0.625f,			//97
-		-0.8536f, 0.3827f, -0.3536f,	0.21128125f, 0.625f,		//98
-		-0.9239f, 0.3827f, 0.0f,		0.269025f, 0.625f,			//99
-		-0.8536f, 0.3827f, 0.3536f,		0.32676875f, 0.625f,		//100
-		-0.6533f, 0.3827f, 0.6533f,		0.3845125f, 0.625f,			//101
-		-0.3536f, 0.3827f, 0.8536f,		0.44225625f, 0.625f,		//102
-		// ring 7
-		0.0f, 0.1951f, 0.9808f,			0.5f, 0.5625f,				//103
-		0.3753f, 0.1915f, 0.9061f,		0.5613f, 0.5625f,			//104
-		0.6935f, 0.1915f, 0.6935f,		0.6226f, 0.5625f,			//105
-		0.9061f, 0.1915f, 0.3753f,		0.6839f, 0.5625f,			//106
-		0.9808f, 0.1915f, 0.0f,			0.7452f, 0.5625f,			//107
-		0.9061f, 0.1915f, -0.3753f,		0.8065f, 0.5625f,			//108
-		0.6935f, 0.1915f, -0.6935f,		0.8678f, 0.5625f,			//109
-		0.3753f, 0.1915f, -0.9061f,		0.9291f, 0.5625f,			//110
-		0.0f, 0.1915f, -0.9808f,		0.9904f, 0.5625f,			//111 - seam
-		0.0f, 0.1915f, -0.9808f,		0.0096f, 0.5625f,			//112 - seam
-		-0.3753f, 0.1915f, -0.9061f,	0.0709f, 0.5625f,			//113
-		-0.6935f, 0.1915f, -0.6935f,	0.1322f, 0.5625f,			//114
-		-0.9061f, 0.1915f, -0.3753f,	0.1935f, 0.5625f,			//115
-		-0.9808f, 0.1915f, 0.0f,		0.2548f, 0.5625f,			//116
-		-0.9061f, 0.1915f, 0.3753f,		0.3161f, 0.5625f,			//117
-		-0.6935f, 0.1915f, 0.6935f,		0.3774f, 0.5625f,			//118
-		-0.3753f, 0.1915f, 0.9061f,		0.4387f, 0.5625f,			//119
-		// ring 8
-		0.0f, 0.0f, 1.0f,				0.5f, 0.5f,					//120
-		0.3827f, 0.0f, 0.9239f,			0.5625f, 0.5f,				//121
-		0.7071f, 0.0f, 0.7071f,			0.625f, 0.5f,				//122
-		0.9239f, 0.0f, 0.3827f,			0.6875f, 0.5f,				//123
-		1.0f, 0.0f, 0.0f,				0.75f, 0.5f,				//124
-		0.9239f, 0.0f, -0.3827f,		0.8125f, 0.5f,				//125
-		0.7071f, 0.0f, -0.7071f,		0.875f, 0.5f,				//126
-		0.3827f, 0.0f, -0.9239f,		0.9375f, 0.5f,				//127
-		0.0f, 0.0f, -1.0f,				1.0f, 0.5f,					//128 - seam
-		0.0f, 0.0f, -1.0f, 				0.0f, 0.5f,					//129 - seam
-		-0.3827f, 0.0f, -0.9239f,		0.0625f, 0.5f,				//130
-		-0.7071f, 0.0f, -0.7071f,		0.125f, 0.5f,				//131
-		-0.9239f, 0.0f, -0.3827f,		0.1875f, 0.5f,				//132
-		-1.0f, 0.0f, 0.0f,				0.25f, 0.5f,				//133
-		-0.9239f, 0.0f, 0.3827f,		0.3125f, 0.5f,				//134
-		-0.7071, 0.0, 0.7071f,			0.375f, 0.5f,				//135
-		-0.3827f, 0.0f, 0.9239f,		0.4375f, 0.5f,				//136
-		// ring 9
-		0.0f, -0.1915f, 0.9808f,		0.5f, 0.4375f,				//137
-		0.3753f, -0.1915f, 0.9061f,		0.5613f, 0.4375f,			//138
-		0.6935f, -0.1915f, 0.6935f,		0.6226f, 0.4375f,			//139
-		0.9061f, -0.1915f, 0.3753f,		0.6839f, 0.4375f,			//140
-		0.9808f, -0.1915f, 0.0f,		0.7452f, 0.4375f,			//141
-		0.9061f, -0.1915f, -0.3753f,	0.8065f, 0.4375f,			//142
-		0.6935f, -0.1915f, -0.6935f,	0.8678f, 0.4375f,			//143
-		0.3753f, -0.1915f, -0.9061f,	0.9261f, 0.4375f,			//144
-		0.0f, -0.1915f, -0.9808f,		0.9904f, 0.4375f,			//145 - seam
-		0.0f, -0.1915f, -0.9808f,		0.0096f, 0.4375f,			//146 - seam
-		-0.3753f, -0.1915f, -0.9061f,	0.0709f, 0.4375f,			//147
-		-0.6935f, -0.1915f, -0.6935f,	0.1322f, 0.4375f,			//148
-		-0.9061f, -0.1915f, -0.3753f,	0.1935f, 0.4375f,			//149
-		-0.9808f, -0.1915f, 0.0f,		0.2548f, 0.4375f,			//150
-		-0.9061f, -0.1915f, 0.3753f,	0.3161f, 0.4375f,			//151
-		-0.6935f, -0.1915f, 0.6935f,	0.3774f, 0.4375f,			//152
-		-0.3753f, -0.1915f, 0.9061f,	0.4387f, 0.4375f,			//153
-		// ring 10
-		0.0f, -0.3827f, 0.9239f,		0.5f, 0.375f,				//154
-		0.3536f, -0.3827f, 0.8536f,		0.55774375f, 0.375f,		//155
-		0.6533f, -0.3827f, 0.6533f,		0.6154875f, 0.375f,			//156
-		0.8536f, -0.3827f, 0.3536f,		0.67323125f, 0.375f,		//157
-		0.9239f, -0.3827f, 0.0f,		0.730975f, 0.375f,			//158
-		0.8536f, -0.3827f, -0.3536f,	0.78871875f, 0.375f,		//159
-		0.6533f, -0.3827f, -0.6533f,	0.8464625f, 0.375f,			//160
-		0.3536f, -0.3827f, -0.8536f,	0.90420625f, 0.375f,		//161
-		0.0f, -0.3827f, -0.9239f,		0.96195f, 0.375f,			//162 - seam
-		0.0f, -0.3827f, -0.9239f,		0.03805f, 0.375f,			//163 - seam
-		-0.3536f, -0.3827f, -0.8536f,	0.09579375f, 0.375f,		//164
-		-0.6533f, -0.3827f, -0.6533f,	0.1535375f, 0.375f,			//165
-		-0.8536f, -0.3827f, -0.3536f,	0.21128125f, 0.375f,		//166
-		-0.9239f, -0.3827f, 0.0f,		0.269025f, 0.375f,			//167
-		-0.8536f, -0.3827f, 0.3536f,	0.32676875f, 0.375f,		//168
-		-0.6533f, -0.3827f, 0.6533f,	0.3845125f, 0.375f,			//169
-		-0.3536f, -0.3827f, 0.8536f,	0.44225625f, 0.375f,		//170
-		// ring 11
-		0.0f, -0.5556f, 0.8315f,		0.5f, 0.3125f,				//171
-		0.3182f, -0.5556f, 0.7682f,		0.55196875f, 0.3125f,		//172
-		0.5879f, -0.5556f, 0.5879f,		0.6039375f, 0.3125f,		//173
-		0.7682f, -0.5556f, 0.3182f,		0.65590625f, 0.3125f,		//174
-		0.8315f, -0.5556f, 0.0f,		0.707875f, 0.3125f,			//175
-		0.7682f, -0.5556f, -0.3182f,	0.75984375f, 0.3125f,		//176
-		0.5879f, -0.5556f, -0.5879f,	0.8118125f, 0.3125f,		//177
-		0.3182f, -0.5556f, -0.7682f,	0.86378125f, 0.3125f,		//178
-		0.0f, -0.5556f, -0.8315f,		0.91575f, 0.3125f,			//179 - seam
-		0.0f, -0.5556f, -0.8315f,		0.08425f, 0.3125f,			//180 - seam
-		-0.3182f, -0.5556f, -0.7682f,	0.13621875f, 0.3125f,		//181
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.3125f,		//182
-		-0.7682f, -0.5556f, -0.3182f,	0.24015625f, 0.3125f,		//183
-		-0.8315f, -0.5556f, 0.0f,		0.292125f, 0.3125f,			//184
-		-0.7682f, -0.5556f, 0.3182f,	0.34409375f, 0.3125f,		//185
-		-0.5879f, -0.5556f, 0.5879f,	0.3960625f, 0.3125f,		//186
-		-0.3182f, -0.5556f, 0.7682f,	0.44803125f, 0.3125f,		//187
-		// ring 12
-		0.0f, -0.7071f, 0.7071f,		0.5f, 0.25f,				//188
-		0.2706f, -0.7071f, 0.6533f,		0.54419375f, 0.25f,			//189
-		0.5f, -0.7071f, 0.5f,			0.5883875f, 0.25f,			//190
-		0.6533f, -0.7071f, 0.2706f,		0.63258125f, 0.25f,			//191
-		0.7071f, -0.7071f, 0.0f,		0.676775f, 0.25f,			//192
-		0.6533f, -0.7071f, -0.2706f,	0.72096875f, 0.25f,			//193
-		0.5f, -0.7071f, -0.5f,			0.7651625f, 0.25f,			//194
-		0.2706f, -0.7071f, -0.6533f,	0.80935625f, 0.25f,			//195
-		0.0f, -0.7071f, -0.7071f,		0.85355f, 0.25f,			//196 - seam
-		0.0f, -0.7071f, -0.7071f,		0.14645f, 0.25f,			//197 - seam
-		-0.2706f, -0.7071f, -0.6533f,	0.19064375f, 0.25f,			//198
-		-0.5f, -0.7071f, -0.5f,			0.2348375f, 0.25f,			//199
-		-0.6533f, -0.7071f, -0.2706f,	0.27903135f, 0.25f,			//200
-		-0.7071f, -0.7071f, 0.0f,		0.323225f, 0.25f,			//201
-		-0.6533f, -0.7071f, 0.2706f,	0.36741875f, 0.25f,			//202
-		-0.5f, -0.7071f, 0.5f,			0.4116125f, 0.25f,			//203
-		-0.2706f, -0.7071f, 0.6533f,	0.45580625f, 0.25f,			//204
-		// ring 13
-		0.0f, -0.8315f, 0.5556f,		0.5f, 0.1875f,				//205
-		0.2126f, -0.8315f, 0.5133f,		0.534725f, 0.1875f,			//206
-		0.3928f, -0.8315f, 0.3928f,		0.56945f, 0.1875f,			//207
-		0.5133f, -0.8315f, 0.2126f,		0.604175f, 0.1875f,			//208
-		0.5556f, -0.8315f, 0.0f,		0.6389f, 0.1875f,			//209
-		0.5133f, -0.8315f, -0.2126f,	0.673625f, 0.1875f,			//210
-		0.3928f, -0.8315f, -0.3928f,	0.70835f, 0.1875f,			//211
-		0.2126f, -0.8315f, -0.5133f,	0.743075f, 0.1875f,			//212
-		0.0f, -0.8315f, -0.5556f,		0.7778f, 0.1875f,			//213 - seam
-		0.0f, -0.8315f, -0.5556f,		0.2222f, 0.1875f,			//214 - seam
-		-0.2126f, -0.8315f, -0.5133f,	0.256925f, 0.1875f,			//215
-		-0.3928f, -0.8315f, -0.3928f,	0.29165f, 0.1875f,			//216
-		-0.5133f, -0.8315f, -0.2126f,	0.326375f, 0.1875f,			//217
-		-0.5556f, -0.8315f, 0.0f,		0.3611f, 0.1875f,			//218
-		-0.5133f, -0.8315f, 0.2126f,	0.395825f, 0.1875f,			//219
-		-0.3928f, -0.8315f, 0.3928f,	0.43055f, 0.1875f,			//220
-		-0.2126f, -0.8315f, 0.5133f,	0.465275f, 0.1875f,			//221
-		// ring 14
-		0.0f, -0.9239f, 0.3827f,		0.5f, 0.125f,				//222
-		0.1464f, -0.9239f, 0.3536f,		0.52391875f, 0.125f,		//223
-		0.2706f, -0.9239f, 0.2706f,		0.5478375f, 0.125f,			//224
-		0.3536f, -0.9239f, 0.1464f,		0.57175625f, 0.125f,		//225
-		0.3827f, -0.9239f, 0.0f,		0.5956755f, 0.125f,			//226
-		0.3536f, -0.9239f, -0.1464f,	0.61959425f, 0.125f,		//227
-		0.2706f, -0.9239f, -0.2706f,	0.643513f, 0.125f,			//228
-		0.1464f, -0.9239f, -0.3536f,	0.66743175f, 0.125f,		//229
-		0.0f, -0.9239f, -0.3827f,		0.6913505f, 0.125f,			//230 - seam
-		0.0f, -0.9239f, -0.3827f,		0.3086495f, 0.125f,			//231 - seam
-		-0.1464f, -0.9239f, -0.3536f,	0.33256825f, 0.125f,		//232
-		-0.2706f, -0.9239f, -0.2706f,	0.356487f, 0.125f,			//233
-		-0.3536f, -0.9239f, -0.1464f,	0.38040575f, 0.125f,		//234
-		-0.3827f, -0.9239f, 0.0f,		0.4043245f, 0.125f,			//235
-		-0.3536f, -0.9239f, 0.1464f,	0.42824325f, 0.125f,		//236
-		-0.2706f, -0.9239f, 0.2706f,	0.452162f, 0.125f,			//237
-		-0.1464f, -0.9239f, 0.3536f,	0.47608075f, 0.125f,		//238
-		// ring 15
-		0.0f, -0.9808f, 0.1951f,		0.5f, 0.0625f,				//239
-		0.0747f, -0.9808f, 0.1802f,		0.51219375f, 0.0625f,		//240
-		0.1379f, -0.9808f, 0.1379f,		0.5243875f, 0.0625f,		//241
-		0.1802f, -0.9808f, 0.0747f,		0.53658125f, 0.0625f,		//242
-		0.1951f, -0.9808, 0.0f,			0.548775f, 0.0625f,			//243
-		0.1802f, -0.9808f, -0.0747f,	0.56096875f, 0.0625f,		//244
-		0.1379f, -0.9808f, -0.1379f,	0.5731625f, 0.0625f,		//245
-		0.0747f, -0.9808f, -0.1802f,	0.58535625f, 0.0625f,		//246
-		0.0f, -0.9808f, -0.1951f,		0.59755f, 0.0625f,			//247 - seam
-		0.0f, -0.9808f, -0.1951f,		0.40245f, 0.0625f,			//248 - seam
-		-0.0747f, -0.9808f, -0.1802f,	0.41464375f, 0.0625f,		//249
-		-0.1379f, -0.9808f, -0.1379f,	0.4268375f, 0.0625f,		//250
-		-0.1802f, -0.9808f, -0.0747f,	0.43903125f, 0.0625f,		//251
-		-0.1951f, -0.9808, 0.0f,		0.451225f, 0.0625f,			//252
-		-0.1802f, -0.9808f, 0.0747f,	0.46341875f, 0.0625f,		//253
-		-0.1379f, -0.9808f, 0.1379f,	0.4756125f, 0.0625f,		//254
-		-0.0747f, -0.9808f, 0.1802f,	0.48780625f, 0.0625f,		//255
-		// bottom center point
-		0.0f, -1.0f, 0.0f,				0.5f, 0.0f					//256
-	};
-
-	// index data
-	GLuint indices[] = {
-		//ring 1 - top
-		0,10,11,
-		0,11,12,
-		0,12,13,
-		0,13,14,
-		0,14,15,
-		0,15,16,
-		0,16,17,
-		0,17,1,
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,9,
-		0,9,10,
-
-		// ring 1 to ring 2
-		10,27,28,
-		10,11,28,
-		11,28,29,
-		11,12,29,
-		12,29,30,
-		12,13,30,
-		13,30,31,
-		13,14,31,
-		14,31,32,
-		14,15,32,
-		15,32,33,
-		15,16,33,
-		16,33,34,
-		16,17,34,
-		17,34,18,
-		17,1,18,
-		1,18,19,
-		1,2,19,
-		2,19,20,
-		2,3,20,
-		3,20,21,
-		3,4,21,
-		4,21,22,
-		4,5,22,
-		5,22,23,
-		5,6,23,
-		6,23,24,
-		6,7,24,
-		7,24,25,
-		7,8,25,
-		8,25,26,
-		8,9,26,
-		9,26,27,
-		9,10,27,
-
-		// ring 2 to ring 3
-		27,44,45,
-		27,28,45,
-		28,45,46,
-		28,29,46,
-		29,46,47,
-		29,30,47,
-		30,47,48,
-		30,31,48,
-		31,48,49,
-		31,32,49,
-		32,49,50,
-		32,33,50,
-		33,50,51,
-		33,34,51,
-		34,51,35,
-		34,18,35,
-		18,35,36,
-		18,19,36,
-		19,36,37,
-		19,20,37,
-		20,37,38,
-		20,21,38,
-		21,38,39,
-		21,22,39,
-		22,39,40,
-		22,23,40,
-		23,40,41,
-		23,24,41,
-		24,41,42,
-		24,25,42,
-		25,42,43,
-		25,26,43,
-		26,43,44,
-		26,27,44,
-
-		// ring 3 to ring 4
-		44,61,62,
-		44,45,62,
-		45,62,63,
-		45,46,63,
-		46,63,64,
-		46,47,64,
-		47,64,65,
-		47,48,65,
-		48,65,66,
-		48,49,66,
-		49,66,67,
-		49,50,67,
-		50,67,68,
-		50,51,68,
-		51,68,52,
-		51,35,52,
-		35,52,53,
-		35,36,53,
-		36,53,54,
-		36,37,54,
-		37,54,55,
-		37,38,55,
-		38,55,56,
-		38,39,56,
-		39,56,57,
-		39,40,57,
-		40,57,58,
-		40,41,58,
-		41,58,59,
-		41,42,59,
-		42,59,60,
-		42,43,60,
-		43,60,61,
-		43,44,61,
-
-		// ring 4 to ring 5
-		61,78,79,
-		61,62,79,
-		62,79,80,
-		62,63,80,
-		63,80,81,
-		63,64,81,
-		64,81,82,
-		64,65,82,
-		65,82,83,
-		65,66,83,
-		66,83,84,
-		66,67,84,
-		67,84,85,
-		67,68,85,
-		68,85,69,
-		68,52,69,
-		52,69,70,
-		52,53,70,
-		53,70,71,
-		53,54,71,
-		54,71,72,
-		54,55,72,
-		55,72,73,
-		55,56,73,
-		56,73,74,
-		56,57,74,
-		57,74,75,
-		57,58,75,
-		58,75,76,
-		58,59,76,
-		59,76,77,
-		59,60,77,
-		60,77,78,
-		60,61,78,
-
-		// ring 5 to ring 6
-		78,95,96,
-		78,79,96,
-		79,96,97,
-		79,80,97,
-		80,97,98,
-		80,81,98,
-		81,98,99,
-		81,82,99,
-		82,99,100,
-		82,83,100,
-		83,100,101,
-		83,84,101,
-		84,101,102,
-		84,85,102,
-		85,102,86,
-		85,69,86,
-		69,86,87,
-		69,70,87,
-		70,87,88,
-		70,71,88,
-		71,88,89,
-		71,72,89,
-		72,89,90,
-		72,73,90,
-		73,90,91,
-		73,74,91,
-		74,91,92,
-		74,75,92,
-		75,92,93,
-		75,76,93,
-		76,93,94,
-		76,77,94,
-		77,94,95,
-		77,78,95,
-
-		// ring 6 to ring 7
-		95,112,113,
-		95,96,113,
-		96,113,114,
-		96,97,114,
-		97,114,115,
-		97,98,115,
-		98,115,116,
-		98,99,116,
-		99,116,117,
-		99,100,117,
-		100,117,118,
-		100,101,118,
-		101,118,119,
-		101,102,119,
-		102,119,103,
-		102,86,103,
-		86,103,104,
-		86,87,104,
-		87,104,105,
-		87,88,105,
-		88,105,106,
-		88,89,106,
-		89,106,107,
-		89,90,107,
-		90,107,108,
-		90,91,108,
-		91,108,109,
-		91,92,109,
-		92,109,110,
-		92,93,110,
-		93,110,111,
-		93,94,111,
-		94,111,112,
-		94,95,112,
-
-		// ring 7 to ring 8
-		112,129,130,
-		112,113,130,
-		113,130,131,
-		113,114,131,
-		114,131,132,
-		114,115,132,
-		115,132,133,
-		115,116,133,
-		116,133,134,
-		116,117,134,
-		117,134,135,
-		117,118,135,
-		118,135,136,
-		118,119,136,
-		119,136,120,
-		119,103,120,
-		103,120,121,
-		103,104,121,
-		104,121,122,
-		104,105,122,
-		105,122,123,
-		105,106,123,
-		106,123,124,
-		106,107,124,
-		107,124,125,
-		107,108,125,
-		108,125,126,
-		108,109,126,
-		109,126,127,
-		109,110,127,
-		110,127,128,
-		110,111,128,
-		111,128,129,
-		111,112,129,
-
-		// ring 8 to ring 9
-		129,146,147,
-		129,130,147,
-		130,147,148,
-		130,131,148,
-		131,148,149,
-		131,132,149,
-		132,149,150,
-		132,133,150,
-		133,150,151,
-		133,134,151,
-		134,151,152,
-		134,135,152,
-		135,152,153,
-		135,136,153,
-		136,153,137,
-		136,120,137,
-		120,137,138,
-		120,121,138,
-		121,138,139,
-		121,122,139,
-		122,139,140,
-		122,123,140,
-		123,140,141,
-		123,124,141,
-		124,141,142,
-		124,125,142,
-		125,142,143,
-		125,126,143,
-		126,143,144,
-		126,127,144,
-		127,144,145,
-		127,128,145,
-		128,145,146,
-		128,129,146,
-
-		// ring 9 to ring 10
-		146,163,164,
-		146,147,164,
-		147,164,165,
-		147,148,165,
-		148,165,166,
-		148,149,166,
-		149,166,167,
-		149,150,167,
-		150,167,168,
-		150,151,168,
-		151,168,169,
-		151,152,169,
-		152,169,170,
-		152,153,170,
-		153,170,154,
-		153,137,154,
-		137,154,155,
-		137,138,155,
-		138,155,156,
-		138,139,156,
-		139,156,157,
-		139,140,157,
-		140,157,158,
-		140,141,158,
-		141,158,159,
-		141,142,159,
-		142,159,160,
-		142,143,160,
-		143,160,161,
-		143,144,161,
-		144,161,162,
-		144,145,162,
-		145,162,163,
-		145,146,163,
-
-		// ring 10 to ring 11
-		163,180,181,
-		163,164,181,
-		164,181,182,
-		164,165,182,
-		165,182,183,
-		165,166,183,
-		166,183,184,
-		166,167,184,
-		167,184,185,
-		167,168,185,
-		168,185,186,
-		168,169,186,
-		169,186,187,
-		169,170,187,
-		170,187,171,
-		170,154,171,
-		154,171,172,
-		154,155,172,
-		155,172,173,
-		155,156,173,
-		156,173,174,
-		156,157,174,
-		157,174,175,
-		157,158,175,
-		158,175,176,
-		158,159,176,
-		159,176,177,
-		159,160,177,
-		160,177,178,
-		160,161,178,
-		161,178,179,
-		161,162,179,
-		162,179,180,
-		162,163,180,
-
-		// ring 11 to ring 12
-		180,197,198,
-		180,181,198,
-		181,198,199,
-		181,182,199,
-		182,199,200,
-		182,183,200,
-		183,200,201,
-		183,184,201,
-		184,201,202,
-		184,185,202,
-		185,202,203,
-		185,186,203,
-		186,203,204,
-		186,187,204,
-		187,204,188,
-		187,171,188,
-		171,188,189,
-		171,172,189,
-		172,189,190,
-		172,173,190,
-		173,190,191,
-		173,174,191,
-		174,191,192,
-		174,175,192,
-		175,192,193,
-		175,176,193,
-		176,193,194,
-		176,177,194,
-		177,194,195,
-		177,178,195,
-		178,195,196,
-		178,179,196,
-		179,196,197,
-		179,180,197,
-
-		// ring 12 to ring 13
-		197,214,215,
-		197,198,215,
-		198,215,216,
-		198,199,216,
-		199,216,217,
-		199,200,217,
-		200,217,218,
-		200,201,218,
-		201,218,219,
-		201,202,219,
-		202,219,220,
-		202,203,220,
-		203,220,221,
-		203,204,221,
-		204,221,205,
-		204,188,205,
-		188,205,206,
-		188,189,206,
-		189,206,207,
-		189,190,207,
-		190,207,208,
-		190,191,208,
-		191,208,209,
-		191,192,209,
-		192,209,210,
-		192,193,210,
-		193,210,211,
-		193,194,211,
-		194,211,212,
-		194,195,212,
-		195,212,213,
-		195,196,213,
-		196,213,214,
-		196,197,214,
-
-		// ring 13 to ring 14
-		214,231,232,
-		214,215,232,
-		215,232,233,
-		215,216,233,
-		216,233,234,
-		216,217,234,
-		217,234,235,
-		217,218,235,
-		218,235,236,
-		218,219,236,
-		219,236,237,
-		219,220,237,
-		220,237,238,
-		220,221,238,
-		221,238,222,
-		221,205,222,
-		205,222,223,
-		205,206,223,
-		206,223,224,
-		206,207,224,
-		207,224,225,
-		207,208,225,
-		208,225,226,
-		208,209,226,
-		209,226,227,
-		209,210,227,
-		210,227,228,
-		210,211,228,
-		211,228,229,
-		211,212,229,
-		212,229,230,
-		212,213,230,
-		213,230,231,
-		213,214,231,
-
-		// ring 14 to ring 15
-		231,248,249,
-		231,232,249,
-		232,249,250,
-		232,233,250,
-		233,250,251,
-		233,234,251,
-		234,251,252,
-		234,235,252,
-		235,252,253,
-		235,236,253,
-		236,253,254,
-		236,237,254,
-		237,254,255,
-		237,238,255,
-		238,255,239,
-		238,222,239,
-		222,239,240,
-		222,223,240,
-		223,240,241,
-		223,224,241,
-		224,241,242,
-		224,225,242,
-		225,242,243,
-		225,226,243,
-		226,243,244,
-		226,227,244,
-		227,244,245,
-		227,228,245,
-		228,245,246,
-		228,229,246,
-		229,246,247,
-		229,230,247,
-		230,247,248,
-		230,231,248,
-
-		// ring 15 - bottom
-		248,256,249,
-		249,256,250,
-		250,256,251,
-		251,256,252,
-		252,256,253,
-		253,256,254,
-		254,256,255,
-		255,256,239,
-		239,256,240,
-		240,256,241,
-		241,256,242,
-		242,256,243,
-		243,256,244,
-		244,256,245,
-		245,256,246,
-		246,256,247,
-		247,256,248
-	};
-
-	// total float values per each type
-	const GLuint floatsPerVertex = 3;
-	const GLuint floatsPerNormal = 3;
-	const GLuint floatsPerUV = 2;
+	LoadShape(SHAPE_SPHERE);
+}
 
-	// store vertex and index count
-	m_SphereMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (floatsPerVertex));
-	m_SphereMesh.nIndices = sizeof(indices) / (sizeof(indices[0]));
+///////////////////////////////////////////////////
+//	LoadTaperedCylinderMesh()
+//
+//	Generate a tapered cylinder mesh with both caps at
+//  every detail level and store each in a VAO/VBO.
+//  The normals and texture coordinates are also set.
+//
+//  Correct triangle drawing command:
+//
+//	DrawTaperedCylinderMesh();
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadTaperedCylinderMesh()
+{
+	LoadShape(SHAPE_TAPERED_CYLINDER);
+}
 
-	glm::vec3 normal;
-	glm::vec3 vert;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	float u, v;
-	std::vector<GLfloat> combined_values;
+///////////////////////////////////////////////////
+//	LoadTorusMesh()
+//
+//	Generate a torus mesh with a main radius of 1, the
+//  passed in tube radius and the passed in segments
+//  around the main ring and around the tube, at every
+//  detail level, and store each in a VAO/VBO.  The
+//  normals and texture coordinates are also set.
+//
+//	Correct triangle drawing command:
+//
+//	glDrawElements(GL_TRIANGLES, meshes.gTorusMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadTorusMesh(
+	float thickness,
+	int mainSegments,
+	int tubeSegments)
+{
+	SHAPE_DATA data;
+	BuildTorusLevels(thickness, mainSegments, tubeSegments, data);
+	FinishShapeData(m_bPackedVertices, data);
+	StoreShapeData(&data, 1);
+}
 
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < sizeof(verts) / (sizeof(verts[0])); i += 5)
+///////////////////////////////////////////////////
+//	BuildTorusLevels()
+//
+//	Generate the detail levels of a torus with the
+//  passed in thickness and segments, where the
+//  reduced levels keep the same share of the
+//  segments as the default tessellation.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildTorusLevels(
+	float thickness,
+	int mainSegments,
+	int tubeSegments,
+	SHAPE_DATA& data)
+{
+	float tubeRadius = .1f;
+	if (thickness <= 1.0)
 	{
-		vert = glm::vec3(verts[i], verts[i + 1], verts[i + 2]);
-		normal = normalize(vert - center);
-		//u = atan2(normal.x, normal.z) / (2 * M_PI) + 0.5;
-		//v = normal.y * 0.5 + 0.5;
-		combined_values.push_back(vert.x);
-		combined_values.push_back(vert.y);
-		combined_values.push_back(vert.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(verts[i + 3]);
-		combined_values.push_back(verts[i + 4]);
+		tubeRadius = thickness;
 	}
 
-	// Create VAO
-	glGenVertexArrays(1, &m_SphereMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_SphereMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(2, m_SphereMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_SphereMesh.vbos[0]); // Activates the vertex buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_SphereMesh.vbos[1]); // Activates the index buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
+	data.shape = SHAPE_TORUS;
+	data.levelCount = LOD_COUNT;
+	for (int lod = 0; lod < LOD_COUNT; lod++)
 	{
-		SetShaderMemoryLayout();
+		BuildTorusData(
+			std::max(mainSegments * g_TorusLODMainSegments[lod] / g_TorusLODMainSegments[0], 3),
+			std::max(tubeSegments * g_TorusLODTubeSegments[lod] / g_TorusLODTubeSegments[0], 3),
+			tubeRadius,
+			data.levels[lod]);
 	}
 }
 
 ///////////////////////////////////////////////////
-//	LoadTaperedCylinderMesh()
+//	LoadShape()
 //
-//	Create a tapered cylinder mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
-//
-//  Correct triangle drawing commands:
-//
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 72);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//	Generate a shape and store it in a buffer of
+//  its own.  The scene builds all its shapes at
+//  once with BuildShapeData() and stores them
+//  together instead.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTaperedCylinderMesh()
+void ShapeMeshes::LoadShape(ShapeType shape)
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.47f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.17f, 1.0f, -0.47f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.17f, 1.0f, -0.47f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.47f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.49f, 1.0f, 0.085f,	0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.435f, 1.0f, 0.25f,	0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.385f, 1.0f, 0.32f,	0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.32f, 1.0f, 0.385f,	0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.25f, 1.0f, 0.435f,	0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.085f, 1.0f, 0.49f,	0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.085f, 1.0f, 0.49f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.25f, 1.0f, 0.435f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.32f, 1.0f, 0.385f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.385f, 1.0f, 0.32f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.435f, 1.0f, 0.25f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.49f, 1.0f, 0.085f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.25,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f, 	0.25,1.0,
-		.49f, 1.0f, -0.085f,	0.993150651, 0.5f, -0.116841137f, 	0.2635,1.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.49f, 1.0f, -0.085f,	0.993417103f, 0.5f, -0.229039446f,	0.2635,1.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.993417103f, 0.5f, -0.229039446f,	0.0831,0.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.5f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.385f, 1.0f, -0.32f,	0.813733339f, 0.5f, -0.581238329f,	0.304,1.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.385f, 1.0f, -0.32f,	0.707106769f, 0.5f, -0.707106769f,	0.304,1.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175,1.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.707106769f, 0.5f, -0.707106769f,	0.1662,0.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175, 1.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.5f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.17f, 1.0f, -0.47f,		0.400818795f, 0.5f, -0.916157305f,	0.3445, 1.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		.17f, 1.0f, -0.47f,		0.229039446f, 0.5f, -0.973417103f,	0.3445, 1.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.229039446f, 0.5f, -0.973417103f,	0.2493, 0.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.5f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		-.085f, 1.0f, -0.49f,	-0.116841137f, 0.5f, -0.993150651f,	0.385, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.085f, 1.0f, -0.49f,	-0.229039446f, 0.5f, -0.973417103f,	0.385, 1.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.229039446f, 0.5f, -0.973417103f,	0.3324, 0.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.5f, -0.581238329f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.32f, 1.0f, -0.385f,	-0.581238329f, 0.5f, -0.581238329f,	0.4255, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.32f, 1.0f, -0.385f,	-0.707106769f, 0.5f, -0.707106769f,	0.4255, 1.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.707106769f, 0.5f, -0.707106769f,	0.4155, 0.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.5f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.47f, 1.0f, -0.17f,	-0.916157305f, 0.5f, -0.400818795f,	0.466, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-.47f, 1.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.466, 1.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.973417103f, 0.5f, -0.229039446f,	0.4986, 0.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.493, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, 0.116841137f,	0.493, 1.0,
-		-.49f, 1.0f, 0.085f,	-0.993150651f, 0.5f, 0.116841137f,	0.5065, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.49f, 1.0f, 0.085f,	-0.973417103f, 0.5f, 0.229039446f,	0.5065, 1.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.973417103f, 0.5f, 0.229039446f,	0.5817, 0.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.5f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.385f, 1.0f, 0.32f,	-0.813733339f, 0.5f, 0.581238329f,	0.547, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.385f, 1.0f, 0.32f,	-0.707106769f, 0.5f, 0.707106769f,	0.547, 1.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.707106769f, 0.5f, 0.707106769f,	0.6648, 0.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.5f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.17f, 1.0f, 0.47f,		-0.400818795f, 0.5f, 0.916157305f,	0.5875, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		-.17f, 1.0f, 0.47f,		-0.229039446f, 0.5f, 0.973417103f,	0.5875, 1.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		-0.229039446f, 0.5f, 0.973417103f,	0.7479, 0.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		0.0f, 1.0f, 0.5f,		-0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.5f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 0.5f,		0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		.085f, 1.0f, 0.49f,		0.116841137f, 0.5f, 0.993150651f,	0.628, 1.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.085f, 1.0f, 0.49f,		0.229039446f, 0.5f, 0.973417103f,	0.628, 1.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.229039446f, 0.5f, 0.973417103f,	0.831, 0.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.5f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.32f, 1.0f, 0.385f,		0.581238329f, 0.5f, 0.813733339f,	0.6685, 1.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.32f, 1.0f, 0.385f,		0.707106769f, 0.5f, 0.707106769f,	0.6685, 1.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.707106769f, 0.5f, 0.707106769f,	0.9141, 0.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.5f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 0.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.47f, 1.0f, 0.17f,		0.916157305f, 0.5f, 0.400818795f,	0.709, 1.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		.47f, 1.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.709, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.973417103f, 0.5f, 0.229039446f,	1.0, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		0.5f, 1.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	0.75, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	1.0, 0.0
-	};
-
-	// store vertex and index count
-	m_TaperedCylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_TaperedCylinderMesh.nIndices = 0;
+	SHAPE_DATA data;
+	BuildShapeData(shape, m_bPackedVertices, data);
+	StoreShapeData(&data, 1);
+}
 
-	// Create VAO
-	glGenVertexArrays(1, &m_TaperedCylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
+///////////////////////////////////////////////////
+//	BuildShapeData()
+//
+//	Generate the vertices and indices of a shape at
+//  all its detail levels, optimize them and pack
+//  them when requested.  Nothing here touches GL
+//  or the members, so shapes can be built on any
+//  thread while others are built or stored.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildShapeData(
+	ShapeType shape,
+	bool bPackedLayout,
+	SHAPE_DATA& data)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 
-	// Create VBO
-	glGenBuffers(1, m_TaperedCylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TaperedCylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	data.shape = shape;
+	data.levelCount = 1;
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		data.levels[lod] = MESH_DATA();
+	}
 
-	if (m_bMemoryLayoutDone == false)
+	switch (shape)
 	{
-		SetShaderMemoryLayout();
+	case SHAPE_BOX:			BuildBoxData(data.levels[0]); break;
+	case SHAPE_PLANE:		BuildPlaneData(data.levels[0]); break;
+	case SHAPE_PRISM:		BuildPrismData(data.levels[0]); break;
+	case SHAPE_PYRAMID3:	BuildPyramid3Data(data.levels[0]); break;
+	case SHAPE_PYRAMID4:	BuildPyramid4Data(data.levels[0]); break;
+	case SHAPE_CONE:
+	case SHAPE_CYLINDER:
+	case SHAPE_TAPERED_CYLINDER:
+	{
+		// a cone has a bottom cap only, and the cylinders
+		// have both
+		float topRadius = (shape == SHAPE_CONE) ? 0.0f : ((shape == SHAPE_CYLINDER) ? 1.0f : 0.5f);
+		int caps = (shape == SHAPE_CONE) ? CAPS_BOTTOM : CAPS_BOTH;
+		data.levelCount = LOD_COUNT;
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			BuildRoundData(g_RoundLODSegments[lod], g_RoundHeightSegments, 1.0f, topRadius, caps, data.levels[lod]);
+		}
+		break;
+	}
+	case SHAPE_SPHERE:
+		data.levelCount = LOD_COUNT;
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			BuildSphereData(g_SphereLODSlices[lod], g_SphereLODStacks[lod], data.levels[lod]);
+		}
+		break;
+	case SHAPE_TORUS:
+		BuildTorusLevels(g_TorusThickness, g_TorusSegments, g_TorusSegments, data);
+		break;
+	default:
+		// imported meshes are not generated
+		data.levelCount = 0;
+		break;
 	}
+
+	FinishShapeData(bPackedLayout, data);
+	data.buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
 }
 
 ///////////////////////////////////////////////////
-//	LoadTorusMesh()
-//
-//	Create a torus mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	FinishShapeData()
 //
-//	Correct triangle drawing command:
-//
-//	glDrawArrays(GL_TRIANGLES, 0, meshes.gTorusMesh.nVertices);
+//	Optimize the generated detail levels of a shape
+//  for the vertex cache, store the bounds of every
+//  level and pack the vertices into the box around
+//  all the levels when requested, so the levels
+//  share one position decode matrix.  The shapes
+//  without detail levels are kept in the order
+//  they are listed, which their strips rely on.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTorusMesh(float thickness)
+void ShapeMeshes::FinishShapeData(bool bPackedLayout, SHAPE_DATA& data)
 {
-	int _mainSegments = 30;
-	int _tubeSegments = 30;
-	float _mainRadius = 1.0f;
-	float _tubeRadius = .1f;
+	const size_t floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	glm::vec3 boxMin(0.0f);
+	glm::vec3 boxMax(0.0f);
 
-	if (thickness <= 1.0)
+	for (int lod = 0; lod < data.levelCount; lod++)
 	{
-		_tubeRadius = thickness;
-	}
-
-	auto mainSegmentAngleStep = glm::radians(360.0f / float(_mainSegments));
-	auto tubeSegmentAngleStep = glm::radians(360.0f / float(_tubeSegments));
+		MESH_DATA& level = data.levels[lod];
+		if (data.levelCount > 1)
+		{
+			OptimizeMesh(level.verts, floatsPerVertex, level.indices, level.rangeEnds);
+		}
 
-	std::vector<glm::vec3> vertex_list;
-	std::vector<std::vector<glm::vec3>> segments_list;
-	std::vector<glm::vec2> texture_coords;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	glm::vec3 normal;
-	glm::vec3 vertex;
-	glm::vec2 text_coord;
+		GLMesh levelBounds;
+		CalculateMeshBounds(levelBounds, level.verts.data(), level.verts.size());
+		data.boundsMin[lod] = levelBounds.boundsMin;
+		data.boundsMax[lod] = levelBounds.boundsMax;
+		boxMin = (lod == 0) ? levelBounds.boundsMin : glm::min(boxMin, levelBounds.boundsMin);
+		boxMax = (lod == 0) ? levelBounds.boundsMax : glm::max(boxMax, levelBounds.boundsMax);
+	}
 
-	// generate the torus vertices
-	auto currentMainSegmentAngle = 0.0f;
-	for (auto i = 0; i < _mainSegments; i++)
+	data.bPackedLayout = bPackedLayout;
+	data.positionDecode = glm::mat4(1.0f);
+	if (bPackedLayout == true)
 	{
-		// Calculate sine and cosine of main segment angle
-		auto sinMainSegment = sin(currentMainSegmentAngle);
-		auto cosMainSegment = cos(currentMainSegmentAngle);
-		auto currentTubeSegmentAngle = 0.0f;
-		std::vector<glm::vec3> segment_points;
-		for (auto j = 0; j < _tubeSegments; j++)
+		for (int lod = 0; lod < data.levelCount; lod++)
 		{
-			// Calculate sine and cosine of tube segment angle
-			auto sinTubeSegment = sin(currentTubeSegmentAngle);
-			auto cosTubeSegment = cos(currentTubeSegmentAngle);
+			const MESH_DATA& level = data.levels[lod];
+			PackVertices(level.verts.data(), level.verts.size() / floatsPerVertex, floatsPerVertex, boxMin, boxMax, data.packedVerts[lod]);
+		}
+		data.positionDecode = glm::translate(boxMin) * glm::scale(boxMax - boxMin);
+	}
+}
 
-			// Calculate vertex position on the surface of torus
-			auto surfacePosition = glm::vec3(
-				(_mainRadius + _tubeRadius * cosTubeSegment) * cosMainSegment,
-				(_mainRadius + _tubeRadius * cosTubeSegment) * sinMainSegment,
-				_tubeRadius * sinTubeSegment);
+///////////////////////////////////////////////////
+//	StoreShapeData()
+//
+//	Store built shapes in one new buffer.  Every
+//  level of every shape is copied into a single
+//  staging block, its vertices and then its
+//  indices, which is uploaded with one call, and
+//  each mesh then reads its part of the buffer by
+//  its offsets.  The full detail level goes in
+//  the record of the shape type and the reduced
+//  levels in records added after the others.
+///////////////////////////////////////////////////
+void ShapeMeshes::StoreShapeData(SHAPE_DATA* pShapes, int shapeCount)
+{
+	const size_t floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
 
-			//vertex_list.push_back(surfacePosition);
-			segment_points.push_back(surfacePosition);
+	// lay the levels out in the staging block first, and
+	// give the reduced levels their records, which a shape
+	// stored again reuses
+	size_t size = 0;
+	for (int i = 0; i < shapeCount; i++)
+	{
+		size_t vertexSize = (pShapes[i].bPackedLayout == true) ? sizeof(PACKED_VERTEX) : sizeof(GLfloat) * floatsPerVertex;
+		for (int lod = 0; lod < pShapes[i].levelCount; lod++)
+		{
+			const MESH_DATA& level = pShapes[i].levels[lod];
+			size = AlignShapeOffset(size) + vertexSize * (level.verts.size() / floatsPerVertex);
+			size = AlignShapeOffset(size) + sizeof(GLuint) * level.indices.size();
 
-			// Update current tube angle
-			currentTubeSegmentAngle += tubeSegmentAngleStep;
+			if ((lod > 0) && (m_meshes[pShapes[i].shape].levels[lod] == INVALID_MESH))
+			{
+				MeshHandle levelHandle = AddMesh();
+				m_meshes[pShapes[i].shape].levels[lod] = levelHandle;
+			}
 		}
-		segments_list.push_back(segment_points);
-		segment_points.clear();
-
-		// Update main segment angle
-		currentMainSegmentAngle += mainSegmentAngleStep;
+	}
+	if (size == 0)
+	{
+		return;
 	}
 
-	float horizontalStep = 1.0 / _mainSegments;
-	float verticalStep = 1.0 / _tubeSegments;
-	float u = 0.0;
-	float v = 0.0;
+	std::vector<unsigned char> staging(size);
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
 
-	// connect the various segments together, forming triangles
-	for (int i = 0; i < _mainSegments; i++)
+	size_t offset = 0;
+	for (int i = 0; i < shapeCount; i++)
 	{
-		for (int j = 0; j < _tubeSegments; j++)
+		const SHAPE_DATA& data = pShapes[i];
+		m_meshes[data.shape].levelCount = data.levelCount;
+		for (int lod = 0; lod < data.levelCount; lod++)
 		{
-			if (((i + 1) < _mainSegments) && ((j + 1) < _tubeSegments))
+			GLMesh* pMesh = &m_meshes[m_meshes[data.shape].levels[lod]];
+			const MESH_DATA& level = data.levels[lod];
+			size_t nVertices = level.verts.size() / floatsPerVertex;
+
+			pMesh->vbos[0] = buffer;
+			pMesh->vbos[1] = (level.indices.empty() == false) ? buffer : 0;
+			pMesh->nVertices = (GLuint)nVertices;
+			pMesh->nIndices = (GLuint)level.indices.size();
+			pMesh->boundsMin = data.boundsMin[lod];
+			pMesh->boundsMax = data.boundsMax[lod];
+			// the generated shapes without indices are strips
+			pMesh->primitive = (level.indices.empty() == false) ? GL_TRIANGLES : GL_TRIANGLE_STRIP;
+			SetSubmeshes(*pMesh, level.rangeEnds);
+			pMesh->positionDecode = data.positionDecode;
+			pMesh->indexType = GL_UNSIGNED_INT;
+			pMesh->bPackedLayout = data.bPackedLayout;
+
+			offset = AlignShapeOffset(offset);
+			SetInterleavedAttributes(*pMesh, offset);
+			if (data.bPackedLayout == true)
 			{
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i][j + 1]);
-				texture_coords.push_back(glm::vec2(u, v + verticalStep));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v + verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i + 1][j]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v - verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
+				memcpy(&staging[offset], data.packedVerts[lod].data(), sizeof(PACKED_VERTEX) * nVertices);
+				offset += sizeof(PACKED_VERTEX) * nVertices;
 			}
 			else
 			{
-				if (((i + 1) == _mainSegments) && ((j + 1) == _tubeSegments))
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((i + 1) == _mainSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][j + 1]);
-					texture_coords.push_back(glm::vec2(u, v + verticalStep));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((j + 1) == _tubeSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i + 1][j]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
+				memcpy(&staging[offset], level.verts.data(), sizeof(GLfloat) * level.verts.size());
+				offset += sizeof(GLfloat) * level.verts.size();
+			}
 
+			offset = AlignShapeOffset(offset);
+			pMesh->indexOffset = offset;
+			if (level.indices.empty() == false)
+			{
+				memcpy(&staging[offset], level.indices.data(), sizeof(GLuint) * level.indices.size());
+				offset += sizeof(GLuint) * level.indices.size();
 			}
-			v += verticalStep;
 		}
-		v = 0.0;
-		u += horizontalStep;
 	}
 
-	std::vector<GLfloat> combined_values;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, staging.size(), staging.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < vertex_list.size(); i++)
+	for (int i = 0; i < shapeCount; i++)
 	{
-		vertex = vertex_list[i];
-		normal = normalize(vertex);
-		if (vertex.x < 0)
-		{
-			if (normal.x > 0)
-				normal.x *= -1;
-		}
-		else if (vertex.x > 0)
-		{
-			if (normal.x < 0)
-				normal.x *= -1;
-		}
-		if (vertex.y < 0)
-		{
-			if (normal.y > 0)
-				normal.y *= -1;
-		}
-		else if (vertex.y > 0)
-		{
-			if (normal.y < 0)
-				normal.y *= -1;
-		}
-		if (vertex.z < 0)
-		{
-			if (normal.z > 0)
-				normal.z *= -1;
-		}
-		else if (vertex.z > 0)
+		for (int lod = 0; lod < pShapes[i].levelCount; lod++)
 		{
-			if (normal.z < 0)
-				normal.z *= -1;
+			CreateVertexArray(m_meshes[m_meshes[pShapes[i].shape].levels[lod]]);
 		}
-		text_coord = texture_coords[i];
-		combined_values.push_back(vertex.x);
-		combined_values.push_back(vertex.y);
-		combined_values.push_back(vertex.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(text_coord.x);
-		combined_values.push_back(text_coord.y);
-	}
-
-	// store vertex and index count
-	m_TorusMesh.nVertices = vertex_list.size();
-	m_TorusMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TorusMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TorusMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(1, m_TorusMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TorusMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
 	}
 }
 
-
-
 ///////////////////////////////////////////////////
-//	DrawBoxMesh()
+//	LoadImportedMesh()
 //
-//	Transform and draw the plane mesh to the window.
-// 
+//	Store the interleaved vertices and triangle
+//  indices of an imported mesh in a new VAO/VBO.
+//  The mesh is expected to be optimized already,
+//  and the handle of the mesh is returned.  A
+//  dense mesh is also split into meshlets.
 ///////////////////////////////////////////////////
-void ShapeMeshes::DrawBoxMesh()
+ShapeMeshes::MeshHandle ShapeMeshes::LoadImportedMesh(const MESH_DATA& data)
 {
-	glBindVertexArray(m_BoxMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	return(LoadImportedMesh(&data, 1));
 }
 
 ///////////////////////////////////////////////////
-//	DrawConeMesh()
+//	LoadImportedMesh()
 //
-//	Transform and draw the plane mesh to the window.
-// 
+//	Store the detail levels of an imported mesh,
+//  each in its own VAO/VBO, with the full detail
+//  level in the record of the returned handle and
+//  the reduced levels in records added after it.
+//  The levels share the bounds of the full detail
+//  level, so one position decode fits them all,
+//  and each dense level is split into meshlets.
 ///////////////////////////////////////////////////
-void ShapeMeshes::DrawConeMesh(
-	bool bDrawBottom)
+ShapeMeshes::MeshHandle ShapeMeshes::LoadImportedMesh(
+	const MESH_DATA* pLevels,
+	int levelCount)
 {
-	glBindVertexArray(m_ConeMesh.vao);
+	const size_t floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	GLMesh bounds;
+	CalculateMeshBounds(bounds, pLevels[0].verts.data(), pLevels[0].verts.size());
 
-	if (bDrawBottom == true)
+	levelCount = std::max(1, std::min(levelCount, LOD_COUNT));
+	MeshHandle handle = AddMesh();
+	for (int lod = 1; lod < levelCount; lod++)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
+		MeshHandle levelHandle = AddMesh();
+		m_meshes[handle].levels[lod] = levelHandle;
 	}
-	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
+	m_meshes[handle].levelCount = levelCount;
 
-	glBindVertexArray(0);
+	for (int lod = 0; lod < levelCount; lod++)
+	{
+		const MESH_DATA& data = pLevels[lod];
+		GLMesh& mesh = m_meshes[m_meshes[handle].levels[lod]];
+		CreateGeneratedMesh(mesh, data.verts, data.indices, bounds.boundsMin, bounds.boundsMax);
+		SetSubmeshes(mesh, data.rangeEnds);
+
+		if (data.indices.size() / 3 >= g_MeshletMinTriangles)
+		{
+			BuildMeshlets(data.verts.data(), floatsPerVertex, data.indices.data(), data.indices.size(),
+				data.verts.size() / floatsPerVertex, mesh.meshlets);
+		}
+	}
+	return(handle);
 }
 
 ///////////////////////////////////////////////////
-//	DrawCylinderMesh()
+//	CreateMeshBuffer()
 //
-//	Transform and draw the plane mesh to the window.
-// 
+//	Store a block of vertex and index data in a new
+//  buffer as it is, so several imported meshes can
+//  read their attributes from it without a copy.
 ///////////////////////////////////////////////////
-void ShapeMeshes::DrawCylinderMesh(
-	bool bDrawTop,
-	bool bDrawBottom,
-	bool bDrawSides)
+GLuint ShapeMeshes::CreateMeshBuffer(const void* pData, size_t size)
 {
-	glBindVertexArray(m_CylinderMesh.vao);
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, size, pData, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return(buffer);
+}
 
-	if (bDrawBottom == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
-	}
-	if (bDrawTop == true)
-	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
-	}
-	if (bDrawSides == true)
+///////////////////////////////////////////////////
+//	LoadBufferMesh()
+//
+//	Store an imported mesh that reads its positions,
+//  normals and texture coordinates, with their own
+//  offsets and strides, and its indices from a
+//  buffer made by CreateMeshBuffer().  The
+//  attributes are floats, which the vertex shader
+//  only reads when packing is disabled.  A dense
+//  mesh whose positions and indices are passed in
+//  is also split into meshlets.
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::LoadBufferMesh(const BUFFER_MESH_DATA& data)
+{
+	MeshHandle handle = AddMesh();
+	GLMesh& mesh = m_meshes[handle];
+	mesh.vbos[0] = data.buffer;
+	mesh.vbos[1] = data.buffer;
+	mesh.nVertices = data.nVertices;
+	mesh.nIndices = data.nIndices;
+	mesh.boundsMin = data.boundsMin;
+	mesh.boundsMax = data.boundsMax;
+	SetSubmeshes(mesh, std::vector<size_t>());
+	mesh.positionDecode = glm::mat4(1.0f);
+	mesh.indexType = data.indexType;
+	mesh.indexOffset = data.indexOffset;
+
+	// a bound vertex buffer has no tight packing, so a stride
+	// of 0 becomes the size of the attribute
+	mesh.bPackedLayout = false;
+	mesh.attributeBuffers[0] = data.buffer;
+	mesh.attributeOffsets[0] = data.positionOffset;
+	mesh.attributeStrides[0] = (data.positionStride > 0) ? data.positionStride : sizeof(GLfloat) * g_FloatsPerVertex;
+	mesh.attributeBuffers[1] = data.buffer;
+	mesh.attributeOffsets[1] = data.normalOffset;
+	mesh.attributeStrides[1] = (data.normalStride > 0) ? data.normalStride : sizeof(GLfloat) * g_FloatsPerNormal;
+	mesh.attributeBuffers[2] = (data.bHasUVs == true) ? data.buffer : 0;
+	mesh.attributeOffsets[2] = data.uvOffset;
+	mesh.attributeStrides[2] = (data.uvStride > 0) ? data.uvStride : sizeof(GLfloat) * g_FloatsPerUV;
+	CreateVertexArray(mesh);
+
+	if ((NULL != data.pPositions) && (NULL != data.pIndices) && (data.nIndices / 3 >= g_MeshletMinTriangles))
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		size_t floatsPerVertex = (data.positionStride > 0) ? data.positionStride / sizeof(GLfloat) : g_FloatsPerVertex;
+		BuildMeshlets(data.pPositions, floatsPerVertex, data.pIndices, data.nIndices, data.nVertices, mesh.meshlets);
 	}
+	return(handle);
+}
 
-	glBindVertexArray(0);
+
+
+///////////////////////////////////////////////////
+//	DrawBoxMesh()
+//
+//	Transform and draw the plane mesh to the window.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawBoxMesh()
+{
+	Draw(SHAPE_BOX);
+}
+
+///////////////////////////////////////////////////
+//	DrawConeMesh()
+//
+//	Transform and draw the plane mesh to the window.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawConeMesh(
+	bool bDrawBottom)
+{
+	Draw(SHAPE_CONE, GetRoundSubmeshMask(false, bDrawBottom, true));
+}
+
+///////////////////////////////////////////////////
+//	DrawCylinderMesh()
+//
+//	Transform and draw the plane mesh to the window.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawCylinderMesh(
+	bool bDrawTop,
+	bool bDrawBottom,
+	bool bDrawSides)
+{
+	Draw(SHAPE_CYLINDER, GetRoundSubmeshMask(bDrawTop, bDrawBottom, bDrawSides));
 }
 
 ///////////////////////////////////////////////////
@@ -2258,11 +1083,7 @@ void ShapeMeshes::DrawCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMesh()
 {
-	glBindVertexArray(m_PlaneMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-	
-	glBindVertexArray(0);
+	Draw(SHAPE_PLANE);
 }
 
 ///////////////////////////////////////////////////
@@ -2273,11 +1094,7 @@ void ShapeMeshes::DrawPlaneMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMesh()
 {
-	glBindVertexArray(m_PrismMesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
-
-	glBindVertexArray(0);
+	Draw(SHAPE_PRISM);
 }
 
 ///////////////////////////////////////////////////
@@ -2288,22 +1105,21 @@ void ShapeMeshes::DrawPrismMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3Mesh()
 {
-	glBindVertexArray(m_Pyramid3Mesh.vao);
-
-	// Draw as filled (using GL_TRIANGLE_STRIP)
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
-
-	glBindVertexArray(0);
+	Draw(SHAPE_PYRAMID3);
 }
 
 void ShapeMeshes::DrawPyramid4MeshLines()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);  // Bind the correct mesh object
+	const GLMesh& mesh = m_meshes[SHAPE_PYRAMID4];
+	if (mesh.vao == 0)
+	{
+		return;
+	}
+	BindMesh(mesh);
 
 	// Draw as wireframe using GL_LINES (make sure your vertex data is suitable for this)
-	glDrawArrays(GL_LINES, 0, m_Pyramid4Mesh.nVertices);
-
-	glBindVertexArray(0);
+	glDrawArrays(GL_LINES, 0, mesh.nVertices);
+	m_drawnVertexCount += mesh.nVertices;
 }
 
 ///////////////////////////////////////////////////
@@ -2314,11 +1130,7 @@ void ShapeMeshes::DrawPyramid4MeshLines()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4Mesh()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
-
-	glBindVertexArray(0);
+	Draw(SHAPE_PYRAMID4);
 }
 
 ///////////////////////////////////////////////////
@@ -2329,11 +1141,7 @@ void ShapeMeshes::DrawPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	Draw(SHAPE_SPHERE);
 }
 
 ///////////////////////////////////////////////////
@@ -2344,11 +1152,7 @@ void ShapeMeshes::DrawSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices/2, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	Draw(SHAPE_SPHERE, SUBMESH_FIRST_HALF);
 }
 
 ///////////////////////////////////////////////////
@@ -2362,52 +1166,275 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
+	Draw(SHAPE_TAPERED_CYLINDER, GetRoundSubmeshMask(bDrawTop, bDrawBottom, bDrawSides));
+}
+
+///////////////////////////////////////////////////
+//	DrawTorusMesh()
+//
+//	Transform and draw the plane mesh to the window.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawTorusMesh()
+{
+	Draw(SHAPE_TORUS);
+}
+
+///////////////////////////////////////////////////
+//	DrawHalfTorusMesh()
+//
+//	Transform and draw the plane mesh to the window.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawHalfTorusMesh()
+{
+	Draw(SHAPE_TORUS, SUBMESH_FIRST_HALF);
+}
 
-	if (bDrawBottom == true)
+///////////////////////////////////////////////////
+//	Draw()
+//
+//	Draw the parts of a stored mesh picked by the
+//  passed in submesh mask, at the current detail
+//  level, to the window.  The parts lie in the
+//  order of their bits, so neighbouring parts are
+//  drawn together with one call, and a mesh that
+//  is not stored draws nothing.
+///////////////////////////////////////////////////
+void ShapeMeshes::Draw(
+	MeshHandle handle,
+	unsigned int submeshMask)
+{
+	if (IsMeshLoaded(handle) == false)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
+		return;
 	}
-	if (bDrawTop == true)
+
+	const GLMesh& mesh = GetLODMesh(m_meshes[handle], m_levelOfDetail);
+	size_t indexSize = GetIndexSize(mesh.indexType);
+	BindMesh(mesh);
+
+	int part = 0;
+	while (part < mesh.submeshCount)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 72);	//top
+		if ((submeshMask & (1u << part)) == 0)
+		{
+			part++;
+			continue;
+		}
+
+		GLuint start = (part > 0) ? mesh.submeshEnds[part - 1] : 0;
+		GLuint end = start;
+		while ((part < mesh.submeshCount) && ((submeshMask & (1u << part)) != 0))
+		{
+			end = mesh.submeshEnds[part];
+			part++;
+		}
+		if (end <= start)
+		{
+			continue;
+		}
+
+		if (mesh.nIndices > 0)
+		{
+			glDrawElements(mesh.primitive, end - start, mesh.indexType, (void*)(mesh.indexOffset + indexSize * start));
+		}
+		else
+		{
+			glDrawArrays(mesh.primitive, start, end - start);
+		}
+		m_drawnVertexCount += end - start;
 	}
-	if (bDrawSides == true)
+}
+
+///////////////////////////////////////////////////
+//	DrawRanges()
+//
+//	Draw the passed in ranges of the indices of an
+//  imported mesh at the current detail level, such
+//  as the visible meshlets of that level, to the
+//  window with one call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawRanges(
+	MeshHandle handle,
+	const MESHLET_RANGE* pRanges,
+	int rangeCount)
+{
+	if (IsMeshLoaded(handle) == false)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		return;
 	}
 
-	glBindVertexArray(0);
+	const GLMesh& mesh = GetLODMesh(m_meshes[handle], m_levelOfDetail);
+	size_t indexSize = GetIndexSize(mesh.indexType);
+
+	m_rangeCounts.resize(rangeCount);
+	m_rangeOffsets.resize(rangeCount);
+	for (int i = 0; i < rangeCount; i++)
+	{
+		m_rangeCounts[i] = (GLsizei)pRanges[i].indexCount;
+		m_rangeOffsets[i] = (const void*)(mesh.indexOffset + pRanges[i].firstIndex * indexSize);
+		m_drawnVertexCount += pRanges[i].indexCount;
+	}
+
+	BindMesh(mesh);
+	glMultiDrawElements(mesh.primitive, m_rangeCounts.data(), mesh.indexType, m_rangeOffsets.data(), rangeCount);
 }
 
 ///////////////////////////////////////////////////
-//	DrawTorusMesh()
+//	GetMeshBounds()
 //
-//	Transform and draw the plane mesh to the window.
-// 
+//	Get the object-space bounding box of the passed
+//  in mesh, as calculated when the mesh was loaded.
 ///////////////////////////////////////////////////
-void ShapeMeshes::DrawTorusMesh()
+void ShapeMeshes::GetMeshBounds(
+	MeshHandle handle,
+	glm::vec3& boundsMin,
+	glm::vec3& boundsMax) const
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	const GLMesh& mesh = m_meshes[handle];
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices);
+	boundsMin = mesh.boundsMin;
+	boundsMax = mesh.boundsMax;
+}
 
-	glBindVertexArray(0);
+///////////////////////////////////////////////////
+//	GetOccluderBounds()
+//
+//	Get an object-space box that fits inside the
+//  passed in mesh, so anything hidden behind the
+//  box is also hidden behind the mesh itself.  Only
+//  the solid generated shapes have one.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetOccluderBounds(
+	MeshHandle handle,
+	glm::vec3& boxMin,
+	glm::vec3& boxMax) const
+{
+	switch (handle)
+	{
+	case SHAPE_BOX:
+	case SHAPE_PLANE:
+		// the mesh fills its own bounding box
+		GetMeshBounds(handle, boxMin, boxMax);
+		return(true);
+	case SHAPE_SPHERE:
+		// cube inside the unit sphere, with its corners kept
+		// clear of the flat facets of the mesh
+		boxMin = glm::vec3(-0.5f, -0.5f, -0.5f);
+		boxMax = glm::vec3(0.5f, 0.5f, 0.5f);
+		return(true);
+	case SHAPE_CYLINDER:
+		// square prism inside the unit circle
+		boxMin = glm::vec3(-0.68f, 0.0f, -0.68f);
+		boxMax = glm::vec3(0.68f, 1.0f, 0.68f);
+		return(true);
+	case SHAPE_TAPERED_CYLINDER:
+		// square prism inside the top circle of radius 0.5
+		boxMin = glm::vec3(-0.34f, 0.0f, -0.34f);
+		boxMax = glm::vec3(0.34f, 1.0f, 0.34f);
+		return(true);
+	case SHAPE_CONE:
+		// square prism inside the cone up to half its height
+		boxMin = glm::vec3(-0.34f, 0.0f, -0.34f);
+		boxMax = glm::vec3(0.34f, 0.5f, 0.34f);
+		return(true);
+	default:
+		return(false);
+	}
 }
 
 ///////////////////////////////////////////////////
-//	DrawHalfTorusMesh()
+//	GetMeshlets()
 //
-//	Transform and draw the plane mesh to the window.
-// 
+//	Get the meshlets of the passed in mesh at a
+//  detail level, which only the dense levels of
+//  the imported meshes have.  A mesh without that
+//  level gives the meshlets of the level it draws
+//  instead.
 ///////////////////////////////////////////////////
-void ShapeMeshes::DrawHalfTorusMesh()
+const MESHLETS* ShapeMeshes::GetMeshlets(
+	MeshHandle handle,
+	int lod) const
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	const GLMesh& mesh = GetLODMesh(m_meshes[handle], lod);
+	return((mesh.meshlets.firstIndex.empty() == false) ? &mesh.meshlets : NULL);
+}
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
+///////////////////////////////////////////////////
+//	IsMeshLoaded()
+//
+//	Check whether the passed in handle names a mesh
+//  record that has been stored.
+///////////////////////////////////////////////////
+bool ShapeMeshes::IsMeshLoaded(MeshHandle handle) const
+{
+	return((handle < m_meshes.size()) && (m_meshes[handle].vao != 0));
+}
 
-	glBindVertexArray(0);
+///////////////////////////////////////////////////
+//	AddMesh()
+//
+//	Add an empty mesh record at the end of the array
+//  and get its handle.  The record has one detail
+//  level, itself, and is not drawn until its vertex
+//  array is created.
+///////////////////////////////////////////////////
+ShapeMeshes::MeshHandle ShapeMeshes::AddMesh()
+{
+	MeshHandle handle = (MeshHandle)m_meshes.size();
+	m_meshes.push_back(GLMesh());
+
+	GLMesh& mesh = m_meshes.back();
+	mesh.vao = 0;
+	mesh.vbos[0] = 0;
+	mesh.vbos[1] = 0;
+	mesh.nVertices = 0;
+	mesh.nIndices = 0;
+	mesh.boundsMin = glm::vec3(0.0f);
+	mesh.boundsMax = glm::vec3(0.0f);
+	mesh.primitive = GL_TRIANGLES;
+	mesh.submeshCount = 0;
+	mesh.levelCount = 1;
+	mesh.levels[0] = handle;
+	for (int lod = 1; lod < LOD_COUNT; lod++)
+	{
+		mesh.levels[lod] = INVALID_MESH;
+	}
+	mesh.positionDecode = glm::mat4(1.0f);
+	mesh.indexType = GL_UNSIGNED_INT;
+	mesh.indexOffset = 0;
+	mesh.bPackedLayout = false;
+	for (GLuint i = 0; i < g_AttributeCount; i++)
+	{
+		mesh.attributeBuffers[i] = 0;
+		mesh.attributeOffsets[i] = 0;
+		mesh.attributeStrides[i] = 0;
+	}
+	return(handle);
+}
+
+///////////////////////////////////////////////////
+//	SetSubmeshes()
+//
+//	Give a mesh record the parts that end at the
+//  passed in index positions, followed by the last
+//  part up to the end of its indices, or of its
+//  vertices when it has none.  The parts past the
+//  most a record holds are drawn with its last one.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetSubmeshes(
+	GLMesh& mesh,
+	const std::vector<size_t>& rangeEnds)
+{
+	GLuint count = (mesh.nIndices > 0) ? mesh.nIndices : mesh.nVertices;
+
+	mesh.submeshCount = 0;
+	for (size_t i = 0; (i < rangeEnds.size()) && (mesh.submeshCount < MAX_SUBMESHES - 1); i++)
+	{
+		mesh.submeshEnds[mesh.submeshCount++] = (GLuint)std::min(rangeEnds[i], (size_t)count);
+	}
+	mesh.submeshEnds[mesh.submeshCount++] = count;
 }
 
 glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
@@ -2421,7 +1448,7 @@ glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::
 	float v2z = p2.z - p1.z;
 	Normal.x = v1y * v2z - v1z * v2y;
 	Normal.y = v1z * v2x - v1x * v2z;
-	Normal.y = v1x * v2y - v1y * v2x;
+	Normal.z = v1x * v2y - v1y * v2x;
 	float len = (float)sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
 	if (len == 0)
 	{
@@ -2438,21 +1465,675 @@ glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::
 
 
 
-void ShapeMeshes::SetShaderMemoryLayout()
+void ShapeMeshes::SetShaderMemoryLayout(bool bPackedLayout)
+{
+	// The following code defines the layout of the mesh data in memory - every mesh of
+	// a layout is drawn through the same vertex array, so the format of each attribute
+	// is set once here and the meshes only bind their buffers to it.  Each attribute
+	// has its own binding point, so it may lie in a separate array of an imported buffer
+	const VERTEX_ATTRIBUTE_FORMAT* pFormats = (bPackedLayout == true) ? g_PackedAttributeFormats : g_FloatAttributeFormats;
+
+	for (GLuint i = 0; i < g_AttributeCount; i++)
+	{
+		glVertexAttribFormat(i, pFormats[i].size, pFormats[i].type, pFormats[i].bNormalized, 0);
+		glVertexAttribBinding(i, i);
+		glEnableVertexAttribArray(i);
+	}
+}
+
+///////////////////////////////////////////////////
+//	SetInterleavedAttributes()
+//
+//	Record that the positions, normals and texture
+//  coordinates of a mesh are interleaved in its
+//  vertex buffer from the passed in offset, in the
+//  float or the packed layout.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetInterleavedAttributes(GLMesh& mesh, size_t vertexOffset)
+{
+	if (mesh.bPackedLayout == true)
+	{
+		mesh.attributeOffsets[0] = vertexOffset + offsetof(PACKED_VERTEX, position);
+		mesh.attributeOffsets[1] = vertexOffset + offsetof(PACKED_VERTEX, normal);
+		mesh.attributeOffsets[2] = vertexOffset + offsetof(PACKED_VERTEX, uv);
+	}
+	else
+	{
+		mesh.attributeOffsets[0] = vertexOffset;
+		mesh.attributeOffsets[1] = vertexOffset + sizeof(GLfloat) * g_FloatsPerVertex;
+		mesh.attributeOffsets[2] = vertexOffset + sizeof(GLfloat) * (g_FloatsPerVertex + g_FloatsPerNormal);
+	}
+
+	GLsizei stride = (mesh.bPackedLayout == true) ? sizeof(PACKED_VERTEX) :
+		sizeof(GLfloat) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);
+	for (GLuint i = 0; i < g_AttributeCount; i++)
+	{
+		mesh.attributeBuffers[i] = mesh.vbos[0];
+		mesh.attributeStrides[i] = stride;
+	}
+}
+
+///////////////////////////////////////////////////
+//	CreateVertexArray()
+//
+//	Give a mesh the vertex array it is drawn with.
+//  When separate attribute formats are supported,
+//  this is the shared vertex array of its layout,
+//  which is created with the format on first use.
+//  Otherwise the mesh gets a vertex array of its
+//  own with its buffers and attribute pointers.
+///////////////////////////////////////////////////
+void ShapeMeshes::CreateVertexArray(GLMesh& mesh)
+{
+	if (m_bSharedVertexArrays == true)
+	{
+		GLuint& sharedVAO = m_sharedVAOs[(mesh.bPackedLayout == true) ? 1 : 0];
+		if (sharedVAO == 0)
+		{
+			glGenVertexArrays(1, &sharedVAO);
+			glBindVertexArray(sharedVAO);
+			SetShaderMemoryLayout(mesh.bPackedLayout);
+			glBindVertexArray(0);
+			m_boundVAO = 0;
+		}
+		// read by the meshes without texture coordinates
+		if (m_zeroBuffer == 0)
+		{
+			const GLfloat zeros[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			m_zeroBuffer = CreateMeshBuffer(zeros, sizeof(zeros));
+		}
+		mesh.vao = sharedVAO;
+		return;
+	}
+
+	const VERTEX_ATTRIBUTE_FORMAT* pFormats = (mesh.bPackedLayout == true) ? g_PackedAttributeFormats : g_FloatAttributeFormats;
+
+	glGenVertexArrays(1, &mesh.vao);
+	glBindVertexArray(mesh.vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);
+	for (GLuint i = 0; i < g_AttributeCount; i++)
+	{
+		// a missing attribute reads (0, 0) while it is disabled
+		if (mesh.attributeBuffers[i] != 0)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, mesh.attributeBuffers[i]);
+			glVertexAttribPointer(i, pFormats[i].size, pFormats[i].type, pFormats[i].bNormalized,
+				mesh.attributeStrides[i], (void*)mesh.attributeOffsets[i]);
+			glEnableVertexAttribArray(i);
+		}
+	}
+	glBindVertexArray(0);
+	m_boundVAO = 0;
+}
+
+///////////////////////////////////////////////////
+//	BindMesh()
+//
+//	Bind the vertex array of a mesh, and with the
+//  shared vertex arrays bind its vertex and index
+//  buffers to it.  Only what differs from the last
+//  drawn mesh is bound, so the shared vertex array
+//  is bound once for all the meshes of its layout.
+///////////////////////////////////////////////////
+void ShapeMeshes::BindMesh(const GLMesh& mesh)
+{
+	if (mesh.vao != m_boundVAO)
+	{
+		glBindVertexArray(mesh.vao);
+		m_boundVAO = mesh.vao;
+		m_vertexArrayBindCount++;
+
+		// the buffers are bound again after a switch of vertex
+		// arrays, as the bindings belong to the vertex array
+		for (GLuint i = 0; i < g_AttributeCount; i++)
+		{
+			m_boundBuffers[i] = 0;
+		}
+		m_boundIndexBuffer = 0;
+	}
+
+	if (m_bSharedVertexArrays == false)
+	{
+		return;
+	}
+
+	for (GLuint i = 0; i < g_AttributeCount; i++)
+	{
+		GLuint buffer = mesh.attributeBuffers[i];
+		size_t offset = mesh.attributeOffsets[i];
+		GLsizei stride = mesh.attributeStrides[i];
+		if (buffer == 0)
+		{
+			// a stride of 0 reads the same zeros for every vertex
+			buffer = m_zeroBuffer;
+			offset = 0;
+			stride = 0;
+		}
+		if ((buffer != m_boundBuffers[i]) || (offset != m_boundOffsets[i]) || (stride != m_boundStrides[i]))
+		{
+			glBindVertexBuffer(i, buffer, (GLintptr)offset, stride);
+			m_boundBuffers[i] = buffer;
+			m_boundOffsets[i] = offset;
+			m_boundStrides[i] = stride;
+		}
+	}
+
+	// the meshes drawn without indices leave the last one bound
+	if ((mesh.vbos[1] != 0) && (mesh.vbos[1] != m_boundIndexBuffer))
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);
+		m_boundIndexBuffer = mesh.vbos[1];
+	}
+}
+
+///////////////////////////////////////////////////
+//	UnbindMeshes()
+//
+//	Unbind the vertex array of the last drawn mesh,
+//  so the vertex arrays bound by other code do not
+//  get its bindings, and so the next draw of a mesh
+//  binds it again.
+///////////////////////////////////////////////////
+void ShapeMeshes::UnbindMeshes()
+{
+	glBindVertexArray(0);
+	m_boundVAO = 0;
+}
+
+///////////////////////////////////////////////////
+//	GetIndirectMesh()
+//
+//	Get the index count, first index and base vertex
+//  of every detail level of a generated shape, for
+//  the indirect draw commands written by the GPU.
+//  Every level must have indices and lie in the
+//  buffer of the full detail level, whose offsets
+//  are whole vertices and indices.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetIndirectMesh(
+	MeshHandle handle,
+	INDIRECT_MESH& indirectMesh) const
+{
+	if ((handle >= SHAPE_COUNT) || (IsMeshLoaded(handle) == false) || (m_bSharedVertexArrays == false))
+	{
+		return(false);
+	}
+
+	indirectMesh.buffer = m_meshes[handle].vbos[0];
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		const GLMesh& mesh = GetLODMesh(m_meshes[handle], lod);
+		GLsizei stride = mesh.attributeStrides[0];
+		if ((mesh.nIndices == 0) || (mesh.primitive != GL_TRIANGLES) || (mesh.indexType != GL_UNSIGNED_INT) ||
+			(mesh.vbos[0] != indirectMesh.buffer) || (mesh.vbos[1] != indirectMesh.buffer) ||
+			((mesh.attributeOffsets[0] % stride) != 0) || ((mesh.indexOffset % sizeof(GLuint)) != 0))
+		{
+			return(false);
+		}
+
+		indirectMesh.indexCounts[lod] = mesh.nIndices;
+		indirectMesh.firstIndices[lod] = (GLuint)(mesh.indexOffset / sizeof(GLuint));
+		indirectMesh.baseVertices[lod] = (GLint)(mesh.attributeOffsets[0] / stride);
+	}
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	BindIndirectMeshes()
+//
+//	Bind the vertex array of the indirect draws of
+//  the layout of the passed in shape, with the
+//  attributes read from the start of the buffer it
+//  is stored in, and the object index of each draw
+//  read once per instance, so a draw command with
+//  an object as its base instance reads the index
+//  of that object.  The vertex array is created
+//  with its formats on first use.
+///////////////////////////////////////////////////
+void ShapeMeshes::BindIndirectMeshes(
+	MeshHandle handle,
+	GLuint objectIndexBuffer)
+{
+	if ((IsMeshLoaded(handle) == false) || (m_bSharedVertexArrays == false))
+	{
+		return;
+	}
+
+	const GLMesh& mesh = m_meshes[handle];
+	GLuint& indirectVAO = m_indirectVAOs[(mesh.bPackedLayout == true) ? 1 : 0];
+	if (indirectVAO == 0)
+	{
+		glGenVertexArrays(1, &indirectVAO);
+		glBindVertexArray(indirectVAO);
+		SetShaderMemoryLayout(mesh.bPackedLayout);
+		glVertexAttribIFormat(OBJECT_INDEX_ATTRIBUTE, 1, GL_UNSIGNED_INT, 0);
+		glVertexAttribBinding(OBJECT_INDEX_ATTRIBUTE, OBJECT_INDEX_ATTRIBUTE);
+		glVertexBindingDivisor(OBJECT_INDEX_ATTRIBUTE, 1);
+		glEnableVertexAttribArray(OBJECT_INDEX_ATTRIBUTE);
+	}
+	else
+	{
+		glBindVertexArray(indirectVAO);
+	}
+	m_vertexArrayBindCount++;
+
+	// the base vertex of each command picks the shape, so the
+	// attributes start at the first vertex of the buffer
+	for (GLuint i = 0; i < g_AttributeCount; i++)
+	{
+		glBindVertexBuffer(i, mesh.vbos[0], (GLintptr)(mesh.attributeOffsets[i] - mesh.attributeOffsets[0]),
+			mesh.attributeStrides[i]);
+	}
+	glBindVertexBuffer(OBJECT_INDEX_ATTRIBUTE, objectIndexBuffer, 0, sizeof(GLuint));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);
+
+	// the next mesh drawn on its own binds its vertex array again
+	m_boundVAO = indirectVAO;
+}
+
+///////////////////////////////////////////////////
+//	CalculateMeshBounds()
+//
+//	Calculate the object-space bounding box of the 
+//  passed in interleaved vertex data and store it
+//  with the mesh.
+///////////////////////////////////////////////////
+void ShapeMeshes::CalculateMeshBounds(GLMesh& mesh, const GLfloat* verts, size_t nFloats)
+{
+	const size_t floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	mesh.boundsMin = glm::vec3(verts[0], verts[1], verts[2]);
+	mesh.boundsMax = mesh.boundsMin;
+	for (size_t i = floatsPerVertex; (i + 2) < nFloats; i += floatsPerVertex)
+	{
+		glm::vec3 position(verts[i], verts[i + 1], verts[i + 2]);
+		mesh.boundsMin = glm::min(mesh.boundsMin, position);
+		mesh.boundsMax = glm::max(mesh.boundsMax, position);
+	}
+}
+
+///////////////////////////////////////////////////
+//	StoreVertexData()
+//
+//	Send interleaved float vertex data to the bound
+//  vertex buffer, packed with its positions relative
+//  to the passed in box when packing is enabled, and
+//  store the matrix that turns the packed positions
+//  back into object space and where the attributes
+//  lie in the buffer.
+///////////////////////////////////////////////////
+void ShapeMeshes::StoreVertexData(
+	GLMesh& mesh,
+	const GLfloat* verts,
+	size_t nFloats,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax)
 {
-	// The following code defines the layout of the mesh data in memory - each mesh needs
-	// to have the same memory layout so that the data is retrieved properly by the shaders
+	const size_t floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	mesh.bPackedLayout = m_bPackedVertices;
+	SetInterleavedAttributes(mesh, 0);
 
-	// Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
-	GLint stride = sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);// The number of floats before each
+	if (m_bPackedVertices == false)
+	{
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * nFloats, verts, GL_STATIC_DRAW);
+		mesh.positionDecode = glm::mat4(1.0f);
+		return;
+	}
 
-	// Create Vertex Attribute Pointers
-	glVertexAttribPointer(0, g_FloatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-	glEnableVertexAttribArray(0);
+	std::vector<PACKED_VERTEX> packed;
+	PackVertices(verts, nFloats / floatsPerVertex, floatsPerVertex, boxMin, boxMax, packed);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(PACKED_VERTEX) * packed.size(), packed.data(), GL_STATIC_DRAW);
+	mesh.positionDecode = glm::translate(boxMin) * glm::scale(boxMax - boxMin);
+}
 
-	glVertexAttribPointer(1, g_FloatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * g_FloatsPerVertex));
-	glEnableVertexAttribArray(1);
+///////////////////////////////////////////////////
+//	SetPackedVertices()
+//
+//	Set whether the meshes loaded after this call are
+//  stored in the packed 16 byte vertex layout.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetPackedVertices(bool bPacked)
+{
+	m_bPackedVertices = bPacked;
+}
 
-	glVertexAttribPointer(2, g_FloatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal)));
-	glEnableVertexAttribArray(2);
-}
\ No newline at end of file
+///////////////////////////////////////////////////
+//	GetPositionDecode()
+//
+//	Get the matrix that turns the stored positions of
+//  a mesh into object space, which is put in front
+//  of its model matrix - the identity for the float
+//  layout.  The detail levels of a mesh share it.
+///////////////////////////////////////////////////
+glm::mat4 ShapeMeshes::GetPositionDecode(MeshHandle handle) const
+{
+	return(m_meshes[handle].positionDecode);
+}
+
+///////////////////////////////////////////////////
+//	SetLevelOfDetail()
+//
+//	Set the detail level used by the following draws
+//  of the meshes with detail levels.  Level 0 is the full detail
+//  mesh and every following level has fewer vertices.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetLevelOfDetail(int lod)
+{
+	if (lod < 0)
+	{
+		lod = 0;
+	}
+	if (lod >= LOD_COUNT)
+	{
+		lod = LOD_COUNT - 1;
+	}
+	m_levelOfDetail = lod;
+}
+
+///////////////////////////////////////////////////
+//	GetLODMesh()
+//
+//	Get the record for the passed in detail level of
+//  a mesh.  A mesh with fewer levels falls back to
+//  its coarsest one, and a level that is not stored
+//  to the full detail record.
+///////////////////////////////////////////////////
+const ShapeMeshes::GLMesh& ShapeMeshes::GetLODMesh(
+	const GLMesh& fullMesh,
+	int lod) const
+{
+	lod = std::min(lod, fullMesh.levelCount - 1);
+	if ((lod > 0) && (m_meshes[fullMesh.levels[lod]].vao != 0))
+	{
+		return(m_meshes[fullMesh.levels[lod]]);
+	}
+	return(fullMesh);
+}
+
+///////////////////////////////////////////////////
+//	GetRoundSubmeshMask()
+//
+//	Get the submesh mask of the parts of a generated
+//  cylinder, tapered cylinder or cone mesh, whose
+//  indices hold the bottom cap, the sides and the
+//  top cap in that order.
+///////////////////////////////////////////////////
+unsigned int ShapeMeshes::GetRoundSubmeshMask(
+	bool bDrawTop,
+	bool bDrawBottom,
+	bool bDrawSides)
+{
+	return(((bDrawBottom == true) ? SUBMESH_BOTTOM : 0) |
+		((bDrawSides == true) ? SUBMESH_SIDES : 0) |
+		((bDrawTop == true) ? SUBMESH_TOP : 0));
+}
+
+///////////////////////////////////////////////////
+//	BuildSphereData()
+//
+//	Build a unit sphere with the passed in number of
+//  segments around and from top to bottom, as
+//  indexed triangles.  The texture seam is at the
+//  back, and the rows of the top half come before
+//  the rows of the bottom half so the first half of
+//  the indices draws a dome.  The height segments
+//  are rounded up to an even number for that.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildSphereData(
+	int radialSegments,
+	int heightSegments,
+	MESH_DATA& data)
+{
+	radialSegments = std::max(radialSegments, 3);
+	heightSegments = std::max((heightSegments + 1) & ~1, 2);
+
+	const int floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	data.verts.resize((size_t)(radialSegments + 1) * (heightSegments + 1) * floatsPerVertex);
+	data.indices.clear();
+	data.indices.reserve((size_t)6 * radialSegments * (heightSegments - 1));
+
+	// the angles around are the same for every row
+	std::vector<float> sinAround(radialSegments + 1);
+	std::vector<float> cosAround(radialSegments + 1);
+	for (int column = 0; column <= radialSegments; column++)
+	{
+		float angle = 2.0f * (float)M_PI * column / radialSegments;
+		sinAround[column] = -sin(angle);
+		cosAround[column] = -cos(angle);
+	}
+
+	// the position of each vertex is also its normal
+	GLfloat* pVertex = data.verts.data();
+	for (int row = 0; row <= heightSegments; row++)
+	{
+		float phi = (float)M_PI * row / heightSegments;
+		float radius = sin(phi);
+		float y = cos(phi);
+		for (int column = 0; column <= radialSegments; column++)
+		{
+			float x = radius * sinAround[column];
+			float z = radius * cosAround[column];
+			pVertex[0] = x;
+			pVertex[1] = y;
+			pVertex[2] = z;
+			pVertex[3] = x;
+			pVertex[4] = y;
+			pVertex[5] = z;
+			pVertex[6] = (float)column / radialSegments;
+			pVertex[7] = 1.0f - (float)row / heightSegments;
+			pVertex += floatsPerVertex;
+		}
+	}
+
+	// the rows next to the poles leave out the triangles
+	// that collapse into them
+	AppendGridIndices(data.indices, 0, radialSegments, 0, heightSegments / 2, true, false);
+	data.rangeEnds.assign(1, data.indices.size());
+	AppendGridIndices(data.indices, 0, radialSegments, heightSegments / 2, heightSegments, false, true);
+}
+
+///////////////////////////////////////////////////
+//	BuildRoundData()
+//
+//	Build a cylinder of height 1 with the passed in
+//  bottom and top radius as indexed triangles.  The
+//  sides have the passed in number of segments around
+//  and from top to bottom, with normals tilted by the
+//  taper, and the requested caps are fans around a
+//  center point with their own flat normals.  The
+//  vertices and indices hold the bottom cap, the sides
+//  and the top cap in that order.  A top radius of 0
+//  makes a cone, which has no top cap.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildRoundData(
+	int radialSegments,
+	int heightSegments,
+	float bottomRadius,
+	float topRadius,
+	int caps,
+	MESH_DATA& data)
+{
+	radialSegments = std::max(radialSegments, 3);
+	heightSegments = std::max(heightSegments, 1);
+	if (topRadius <= 0.0f)
+	{
+		topRadius = 0.0f;
+		caps &= ~CAPS_TOP;
+	}
+
+	const int floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	const int capVertices = radialSegments + 2;
+	const int sideVertices = (radialSegments + 1) * (heightSegments + 1);
+	int vertexCount = sideVertices;
+	vertexCount += ((caps & CAPS_BOTTOM) != 0) ? capVertices : 0;
+	vertexCount += ((caps & CAPS_TOP) != 0) ? capVertices : 0;
+	data.verts.resize((size_t)vertexCount * floatsPerVertex);
+	data.indices.clear();
+	data.indices.reserve((size_t)6 * radialSegments * (heightSegments + 1));
+
+	std::vector<float> sinAround(radialSegments + 1);
+	std::vector<float> cosAround(radialSegments + 1);
+	for (int column = 0; column <= radialSegments; column++)
+	{
+		float angle = 2.0f * (float)M_PI * column / radialSegments;
+		sinAround[column] = sin(angle);
+		cosAround[column] = cos(angle);
+	}
+
+	GLfloat* pVertex = data.verts.data();
+	GLuint firstVertex = 0;
+
+	// the bottom cap, mirrored in u so its texture reads the
+	// right way round from below
+	if ((caps & CAPS_BOTTOM) != 0)
+	{
+		AppendCapVertices(pVertex, radialSegments, sinAround.data(), cosAround.data(),
+			bottomRadius, 0.0f, -1.0f);
+		pVertex += capVertices * floatsPerVertex;
+		AppendFanIndices(data.indices, firstVertex, radialSegments, false);
+		firstVertex += capVertices;
+	}
+	data.rangeEnds.assign(1, data.indices.size());
+
+	// the sides from the top row down, where the normal of
+	// each column is the same all the way down
+	float slope = bottomRadius - topRadius;
+	for (int row = 0; row <= heightSegments; row++)
+	{
+		float t = (float)row / heightSegments;
+		float y = 1.0f - t;
+		float radius = topRadius + slope * t;
+		for (int column = 0; column <= radialSegments; column++)
+		{
+			glm::vec3 normal = glm::normalize(glm::vec3(cosAround[column], slope, -sinAround[column]));
+			pVertex[0] = radius * cosAround[column];
+			pVertex[1] = y;
+			pVertex[2] = -radius * sinAround[column];
+			pVertex[3] = normal.x;
+			pVertex[4] = normal.y;
+			pVertex[5] = normal.z;
+			pVertex[6] = (float)column / radialSegments;
+			pVertex[7] = y;
+			pVertex += floatsPerVertex;
+		}
+	}
+	AppendGridIndices(data.indices, firstVertex, radialSegments, 0, heightSegments,
+		(topRadius == 0.0f), (bottomRadius <= 0.0f));
+	firstVertex += sideVertices;
+
+	data.rangeEnds.push_back(data.indices.size());
+	if ((caps & CAPS_TOP) != 0)
+	{
+		AppendCapVertices(pVertex, radialSegments, sinAround.data(), cosAround.data(),
+			topRadius, 1.0f, 1.0f);
+		AppendFanIndices(data.indices, firstVertex, radialSegments, true);
+	}
+}
+
+///////////////////////////////////////////////////
+//	BuildTorusData()
+//
+//	Build a torus around the z axis with a main radius
+//  of 1 and the passed in tube radius, as indexed
+//  triangles that share the vertices of neighbouring
+//  quads.  The normals point away from the center of
+//  the tube.  The rows of the first half of the main
+//  ring come before the rest, so the first half of
+//  the indices draws half of the torus, and the main
+//  segments are rounded up to an even number for that.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildTorusData(
+	int mainSegments,
+	int tubeSegments,
+	float tubeRadius,
+	MESH_DATA& data)
+{
+	mainSegments = std::max((mainSegments + 1) & ~1, 4);
+	tubeSegments = std::max(tubeSegments, 3);
+
+	const int floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	data.verts.resize((size_t)(mainSegments + 1) * (tubeSegments + 1) * floatsPerVertex);
+	data.indices.clear();
+	data.indices.reserve((size_t)6 * mainSegments * tubeSegments);
+
+	std::vector<float> sinTube(tubeSegments + 1);
+	std::vector<float> cosTube(tubeSegments + 1);
+	for (int column = 0; column <= tubeSegments; column++)
+	{
+		float angle = 2.0f * (float)M_PI * column / tubeSegments;
+		sinTube[column] = sin(angle);
+		cosTube[column] = cos(angle);
+	}
+
+	// one row of vertices around the tube for each main
+	// segment, with the first row repeated at the end for
+	// the texture seam
+	GLfloat* pVertex = data.verts.data();
+	for (int row = 0; row <= mainSegments; row++)
+	{
+		float angle = 2.0f * (float)M_PI * row / mainSegments;
+		float sinMain = sin(angle);
+		float cosMain = cos(angle);
+		for (int column = 0; column <= tubeSegments; column++)
+		{
+			glm::vec3 normal(cosTube[column] * cosMain, cosTube[column] * sinMain, sinTube[column]);
+			pVertex[0] = cosMain + tubeRadius * normal.x;
+			pVertex[1] = sinMain + tubeRadius * normal.y;
+			pVertex[2] = tubeRadius * normal.z;
+			pVertex[3] = normal.x;
+			pVertex[4] = normal.y;
+			pVertex[5] = normal.z;
+			pVertex[6] = (float)row / mainSegments;
+			pVertex[7] = (float)column / tubeSegments;
+			pVertex += floatsPerVertex;
+		}
+	}
+
+	AppendGridIndices(data.indices, 0, tubeSegments, 0, mainSegments / 2, false, false);
+	data.rangeEnds.assign(1, data.indices.size());
+	AppendGridIndices(data.indices, 0, tubeSegments, mainSegments / 2, mainSegments, false, false);
+}
+
+///////////////////////////////////////////////////
+//	CreateGeneratedMesh()
+//
+//	Store generated interleaved vertex data, and the
+//  index data if there is any, in a new VAO/VBO.
+//  The vertices are packed into the passed in box
+//  when packing is enabled.
+///////////////////////////////////////////////////
+void ShapeMeshes::CreateGeneratedMesh(
+	GLMesh& mesh,
+	const std::vector<GLfloat>& verts,
+	const std::vector<GLuint>& indices,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	// store vertex and index count
+	mesh.nVertices = verts.size() / floatsPerVertex;
+	mesh.nIndices = indices.size();
+	mesh.indexType = GL_UNSIGNED_INT;
+	mesh.indexOffset = 0;
+
+	// Create VBOs
+	glGenBuffers(2, mesh.vbos);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.vbos[0]); // Activates the vertex buffer
+
+	// store the object-space bounds of the mesh
+	CalculateMeshBounds(mesh, verts.data(), verts.size());
+	StoreVertexData(mesh, verts.data(), verts.size(), boxMin, boxMax);
+
+	if (indices.empty() == false)
+	{
+		// sent through the array buffer binding, as the element
+		// buffer binding belongs to a vertex array
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.vbos[1]); // Activates the index buffer
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	}
+
+	// Create VAO, or share the one of the layout
+	CreateVertexArray(mesh);
+}
@@ -10,10 +10,16 @@
 
 #pragma once
 
+#include "Meshlets.h"
+#include "VertexPacking.h"
+
 #include <GL/glew.h>
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
+#include <vector>
+
 /***********************************************************
  *  ShapeMeshes
  *
@@ -26,30 +32,229 @@ public:
 	// constructor
 	ShapeMeshes();
 
+	// identifiers for the available 3D shapes
+	enum ShapeType
+	{
+		SHAPE_BOX,
+		SHAPE_CONE,
+		SHAPE_CYLINDER,
+		SHAPE_PLANE,
+		SHAPE_PRISM,
+		SHAPE_PYRAMID3,
+		SHAPE_PYRAMID4,
+		SHAPE_SPHERE,
+		SHAPE_TAPERED_CYLINDER,
+		SHAPE_TORUS,
+		// number of generated shapes, which is the handle of the
+		// first mesh stored after them
+		SHAPE_COUNT
+	};
+
+	// identifies a stored mesh record - the generated shapes
+	// have the handles of their shape types, and the imported
+	// meshes and the detail levels get the handles after them
+	typedef uint32_t MeshHandle;
+	static const MeshHandle INVALID_MESH = 0xFFFFFFFF;
+
+	// parts of a mesh selected for drawing, one bit per part in
+	// the order of the indices
+	enum SubmeshMask
+	{
+		// caps and sides of a generated round mesh
+		SUBMESH_BOTTOM = 1,
+		SUBMESH_SIDES = 2,
+		SUBMESH_TOP = 4,
+		// halves of a generated sphere or torus
+		SUBMESH_FIRST_HALF = 1,
+		SUBMESH_SECOND_HALF = 2,
+		SUBMESH_ALL = 0xFF
+	};
+	// most parts of one mesh
+	static const int MAX_SUBMESHES = 8;
+
+	// number of detail levels of the curved shapes, where
+	// level 0 is the full detail mesh
+	static const int LOD_COUNT = 4;
+
+	// caps of a generated round mesh
+	enum MeshCaps
+	{
+		CAPS_NONE = 0,
+		CAPS_BOTTOM = 1,
+		CAPS_TOP = 2,
+		CAPS_BOTH = CAPS_BOTTOM | CAPS_TOP
+	};
+
+	// interleaved vertex data and triangle indices of a
+	// generated mesh, before it is stored in a VAO/VBO
+	struct MESH_DATA
+	{
+		std::vector<GLfloat> verts;
+		std::vector<GLuint> indices;
+		// index positions where the parts that are drawn on
+		// their own end, such as the caps or the half of a
+		// sphere, which the optimizer keeps apart - the last
+		// part ends with the indices
+		std::vector<size_t> rangeEnds;
+	};
+
+	// where the float attributes and the indices of an
+	// imported mesh lie in a buffer that is already stored,
+	// with a stride of 0 for tightly packed values
+	struct BUFFER_MESH_DATA
+	{
+		GLuint buffer;
+		size_t positionOffset;
+		GLsizei positionStride;
+		size_t normalOffset;
+		GLsizei normalStride;
+		// a mesh without texture coordinates reads (0, 0)
+		bool bHasUVs;
+		size_t uvOffset;
+		GLsizei uvStride;
+		GLuint nVertices;
+		// GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		GLenum indexType;
+		size_t indexOffset;
+		GLuint nIndices;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// the positions, with the stride above, and the indices
+		// in memory, for splitting a dense mesh into meshlets,
+		// or NULL
+		const GLfloat* pPositions;
+		const GLuint* pIndices;
+	};
+
+	// where every detail level of a generated shape lies in
+	// the buffer the shapes are stored in, as the index count,
+	// first index and base vertex of an indirect draw command
+	// that reads the vertices from the start of the buffer -
+	// the levels past the stored ones repeat the coarsest one
+	struct INDIRECT_MESH
+	{
+		GLuint buffer;
+		GLuint indexCounts[LOD_COUNT];
+		GLuint firstIndices[LOD_COUNT];
+		GLint baseVertices[LOD_COUNT];
+	};
+
+	// attribute location of the object index that the indirect
+	// draws read per instance, from their base instance
+	static const GLuint OBJECT_INDEX_ATTRIBUTE = 3;
+
+	// the vertices and indices of a shape at every detail
+	// level, generated and optimized, with the bounds of
+	// each level, the vertices in the layout they are
+	// stored in, and the time taken to build them
+	struct SHAPE_DATA
+	{
+		ShapeType shape;
+		int levelCount;
+		MESH_DATA levels[LOD_COUNT];
+		glm::vec3 boundsMin[LOD_COUNT];
+		glm::vec3 boundsMax[LOD_COUNT];
+		bool bPackedLayout;
+		std::vector<PACKED_VERTEX> packedVerts[LOD_COUNT];
+		glm::mat4 positionDecode;
+		double buildTime;
+	};
+
+	// build the data of a generated shape, in the packed
+	// vertex layout if requested - this does not need a GL
+	// context, so several shapes can be built at once on
+	// other threads
+	static void BuildShapeData(
+		ShapeType shape,
+		bool bPackedLayout,
+		SHAPE_DATA& data);
+
+	// build the data of a unit sphere, of a cylinder of
+	// height 1 that is a cone when its top radius is 0, or
+	// of a torus with a main radius of 1, with the passed in
+	// tessellation - these do not need a GL context
+	static void BuildSphereData(
+		int radialSegments,
+		int heightSegments,
+		MESH_DATA& data);
+	static void BuildRoundData(
+		int radialSegments,
+		int heightSegments,
+		float bottomRadius,
+		float topRadius,
+		int caps,
+		MESH_DATA& data);
+	static void BuildTorusData(
+		int mainSegments,
+		int tubeSegments,
+		float tubeRadius,
+		MESH_DATA& data);
+
 private:
 
 	// stores the GL data relative to a given mesh
 	struct GLMesh
 	{
-		GLuint vao;         // Handle for the vertex array object
+		GLuint vao;         // Handle for the vertex array object, or 0 until the mesh is stored
 		GLuint vbos[2];     // Handles for the vertex buffer objects
 		GLuint nVertices;	// Number of vertices for the mesh
 		GLuint nIndices;    // Number of indices for the mesh
+		glm::vec3 boundsMin;	// Object-space bounding box minimum
+		glm::vec3 boundsMax;	// Object-space bounding box maximum
+		GLenum primitive;		// Type of the primitives, read from the indices if there are any
+		int submeshCount;		// Number of parts that can be drawn on their own
+		GLuint submeshEnds[MAX_SUBMESHES];	// Index, or vertex without indices, where each part ends
+		int levelCount;			// Number of detail levels, including the full detail one
+		MeshHandle levels[LOD_COUNT];	// Records of the detail levels, starting with this one
+		glm::mat4 positionDecode;	// Turns the stored positions into object space
+		GLenum indexType;		// Type of the indices of an imported mesh
+		size_t indexOffset;		// Byte offset of the indices in their buffer
+		MESHLETS meshlets;		// Clusters of a dense imported mesh, or none
+		bool bPackedLayout;		// Whether the vertices are in the packed 16 byte layout
+		GLuint attributeBuffers[3];	// Buffers of the positions, normals and texture coordinates, or 0
+		size_t attributeOffsets[3];	// Byte offsets of the first position, normal and texture coordinate
+		GLsizei attributeStrides[3];	// Bytes between the positions, normals and texture coordinates
 	};
 
-	// the available 3D shapes
-	GLMesh m_BoxMesh;
-	GLMesh m_ConeMesh;
-	GLMesh m_CylinderMesh;
-	GLMesh m_PlaneMesh;
-	GLMesh m_PrismMesh;
-	GLMesh m_Pyramid3Mesh;
-	GLMesh m_Pyramid4Mesh;
-	GLMesh m_SphereMesh;
-	GLMesh m_TaperedCylinderMesh;
-	GLMesh m_TorusMesh;
+	// the records of all the stored meshes, indexed by their
+	// handles - the generated shapes first, in the order of
+	// their types, and then the detail levels and the imported
+	// meshes in the order they were stored
+	std::vector<GLMesh> m_meshes;
 
-	bool m_bMemoryLayoutDone;
+	// use one vertex array per vertex layout for all the
+	// meshes, with the buffers of each mesh bound to it
+	// before its draw, instead of one vertex array per mesh
+	bool m_bSharedVertexArrays;
+	// the shared vertex arrays of the float and the packed
+	// layouts, created with their formats on first use, and
+	// the buffer of zeros read by meshes without texture
+	// coordinates
+	GLuint m_sharedVAOs[2];
+	GLuint m_zeroBuffer;
+	// the vertex arrays of the indirect draws of the float and
+	// the packed layouts, with the object index attribute
+	GLuint m_indirectVAOs[2];
+	// the vertex array and the buffers bound for the last
+	// draw, so a draw of the same mesh binds nothing
+	GLuint m_boundVAO;
+	GLuint m_boundBuffers[3];
+	size_t m_boundOffsets[3];
+	GLsizei m_boundStrides[3];
+	GLuint m_boundIndexBuffer;
+	// vertex arrays bound by the draw methods
+	unsigned int m_vertexArrayBindCount;
+	// store the vertices of the next loaded meshes in the
+	// packed 16 byte layout instead of 32 bytes of floats
+	bool m_bPackedVertices;
+	// detail level used by the next draws of curved shapes
+	int m_levelOfDetail;
+	// vertices submitted by the draw methods
+	unsigned int m_drawnVertexCount;
+	// index counts and offsets of the last multi-draw of
+	// index ranges, kept to reuse their memory
+	std::vector<GLsizei> m_rangeCounts;
+	std::vector<const void*> m_rangeOffsets;
 
 public:
 	// methods for loading the shape mesh data 
@@ -63,7 +268,27 @@ public:
 	void LoadPyramid4Mesh();
 	void LoadSphereMesh();
 	void LoadTaperedCylinderMesh();
-	void LoadTorusMesh(float thickness = 0.2);
+	void LoadTorusMesh(
+		float thickness = 0.2,
+		int mainSegments = 30,
+		int tubeSegments = 30);
+	// store the built shapes together in one buffer, with
+	// a single upload
+	void StoreShapeData(SHAPE_DATA* pShapes, int shapeCount);
+	// store an imported mesh and get the handle that draws it
+	MeshHandle LoadImportedMesh(const MESH_DATA& data);
+	// store the detail levels of an imported mesh, full detail
+	// first, and get the handle that draws them
+	MeshHandle LoadImportedMesh(
+		const MESH_DATA* pLevels,
+		int levelCount);
+	// store a buffer of vertex and index data as it is, for
+	// the meshes that are drawn straight from it
+	GLuint CreateMeshBuffer(const void* pData, size_t size);
+	// store an imported mesh whose float attributes and
+	// indices are read from a stored buffer, and get the
+	// handle that draws it
+	MeshHandle LoadBufferMesh(const BUFFER_MESH_DATA& data);
 
 	// methods for drawing the shape mesh in the
 	// display window
@@ -87,6 +312,85 @@ public:
 		bool bDrawSides = true);
 	void DrawTorusMesh();
 	void DrawHalfTorusMesh();
+	// draw the parts of a stored mesh picked by a submesh
+	// mask, at the current detail level
+	void Draw(
+		MeshHandle handle,
+		unsigned int submeshMask = SUBMESH_ALL);
+	// draw the passed in ranges of the indices of an imported
+	// mesh, at the current detail level, with one multi-draw
+	void DrawRanges(
+		MeshHandle handle,
+		const MESHLET_RANGE* pRanges,
+		int rangeCount);
+	// unbind the vertex array of the last drawn mesh, before
+	// other code draws with its own vertex arrays
+	void UnbindMeshes();
+
+	// get where the detail levels of a generated shape lie in
+	// the buffer the shapes are stored in - false for the
+	// meshes that can not be drawn by indirect commands from
+	// that buffer, such as the imported meshes and the shapes
+	// without indices
+	bool GetIndirectMesh(
+		MeshHandle handle,
+		INDIRECT_MESH& indirectMesh) const;
+	// bind the buffer the passed in generated shape is stored
+	// in for indirect draws of any shape stored with it, with
+	// the object index of each draw read per instance from the
+	// passed in buffer of object indices
+	void BindIndirectMeshes(
+		MeshHandle handle,
+		GLuint objectIndexBuffer);
+
+	// store the meshes loaded after this call in the packed
+	// vertex layout, which the vertex shader must be told of
+	void SetPackedVertices(bool bPacked);
+	bool IsPackedVertices() const { return(m_bPackedVertices); }
+	// number of mesh records, stored or not, which is one
+	// past the highest handle
+	MeshHandle GetMeshCount() const { return((MeshHandle)m_meshes.size()); }
+	// check whether a handle names a mesh that is stored
+	bool IsMeshLoaded(MeshHandle handle) const;
+
+	// get the matrix that turns the stored positions of a
+	// mesh into object space, to put in front of its model
+	// matrix
+	glm::mat4 GetPositionDecode(MeshHandle handle) const;
+
+	// get the meshlets of a mesh at a detail level, or NULL
+	// for a level that is too small to be split
+	const MESHLETS* GetMeshlets(
+		MeshHandle handle,
+		int lod = 0) const;
+
+	// get the object-space bounding box of a stored mesh
+	void GetMeshBounds(
+		MeshHandle handle,
+		glm::vec3& boundsMin,
+		glm::vec3& boundsMax) const;
+
+	// set the detail level used when drawing the meshes that
+	// have detail levels, from 0 for full detail to
+	// LOD_COUNT - 1
+	void SetLevelOfDetail(int lod);
+	int GetLevelOfDetail() const { return(m_levelOfDetail); }
+
+	// number of vertices submitted by the draw methods
+	// since the count was last reset
+	unsigned int GetDrawnVertexCount() const { return(m_drawnVertexCount); }
+	// number of times the draw methods changed the bound
+	// vertex array since the counts were last reset
+	unsigned int GetVertexArrayBindCount() const { return(m_vertexArrayBindCount); }
+	void ResetDrawCounts() { m_drawnVertexCount = 0; m_vertexArrayBindCount = 0; }
+
+	// get a box that fits inside the surface of a mesh, for
+	// drawing the mesh as an occluder - returns false for the
+	// meshes that are too thin or hollow to hide anything
+	bool GetOccluderBounds(
+		MeshHandle handle,
+		glm::vec3& boxMin,
+		glm::vec3& boxMax) const;
 
 
 private:
@@ -97,6 +401,89 @@ private:
 		glm::vec3 px, glm::vec3 py, glm::vec3 pz);
 
 	// called to set the memory layout 
-	// template for shader data
-	void SetShaderMemoryLayout();
+	// template for shader data, in the bound
+	// shared vertex array
+	void SetShaderMemoryLayout(bool bPackedLayout);
+
+	// called to record where the attributes of the
+	// interleaved vertices of a mesh lie in its
+	// vertex buffer, from the passed in offset
+	void SetInterleavedAttributes(GLMesh& mesh, size_t vertexOffset);
+
+	// called to give a mesh the shared vertex array of
+	// its layout, or a vertex array of its own when
+	// separate attribute formats are not supported
+	void CreateVertexArray(GLMesh& mesh);
+
+	// bind the vertex array and the buffers of a mesh
+	// for drawing it, skipping what is already bound
+	void BindMesh(const GLMesh& mesh);
+
+	// called to calculate the bounding box of
+	// the passed in interleaved vertex data
+	static void CalculateMeshBounds(
+		GLMesh& mesh, const GLfloat* verts, size_t nFloats);
+
+	// called to send interleaved vertex data to the
+	// bound vertex buffer, packed into the passed in
+	// box when packing is enabled
+	void StoreVertexData(
+		GLMesh& mesh,
+		const GLfloat* verts,
+		size_t nFloats,
+		const glm::vec3& boxMin,
+		const glm::vec3& boxMax);
+
+	// add an empty mesh record and get its handle - this
+	// moves the other records
+	MeshHandle AddMesh();
+	// give a mesh record the parts of the passed in index
+	// ends, or one part of all its indices or vertices
+	static void SetSubmeshes(
+		GLMesh& mesh,
+		const std::vector<size_t>& rangeEnds);
+
+	// generate and store a single shape
+	void LoadShape(ShapeType shape);
+
+	// called to fill in the vertices, and the indices if
+	// there are any, of the shapes without detail levels
+	static void BuildBoxData(MESH_DATA& data);
+	static void BuildPlaneData(MESH_DATA& data);
+	static void BuildPrismData(MESH_DATA& data);
+	static void BuildPyramid3Data(MESH_DATA& data);
+	static void BuildPyramid4Data(MESH_DATA& data);
+
+	// called to generate the detail levels of a torus with
+	// the passed in thickness and segments
+	static void BuildTorusLevels(
+		float thickness,
+		int mainSegments,
+		int tubeSegments,
+		SHAPE_DATA& data);
+
+	// called to optimize the generated levels of a shape,
+	// calculate their bounds and pack their vertices
+	static void FinishShapeData(bool bPackedLayout, SHAPE_DATA& data);
+
+	// get the record to draw for a detail level of a mesh
+	const GLMesh& GetLODMesh(
+		const GLMesh& fullMesh,
+		int lod) const;
+
+	// get the submesh mask of the caps and sides of a
+	// generated round mesh
+	static unsigned int GetRoundSubmeshMask(
+		bool bDrawTop,
+		bool bDrawBottom,
+		bool bDrawSides);
+
+	// called to store generated vertex and index
+	// data in a new VAO/VBO
+	void CreateGeneratedMesh(
+		GLMesh& mesh,
+		const std::vector<GLfloat>& verts,
+		const std::vector<GLuint>& indices,
+		const glm::vec3& boxMin,
+		const glm::vec3& boxMax);
 };
\ No newline at end of file
@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexpacking.cpp
+// ============
+// store the interleaved mesh vertices in half the memory
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VertexPacking.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// largest value of the 16 bit position fractions
+	const float g_PositionScale = 65535.0f;
+
+	/***********************************************************
+	 *  SignNotZero()
+	 *
+	 *  This function is used for getting the sign of a value,
+	 *  where 0 counts as positive, so the folded normals that
+	 *  lie on an axis keep a side of the octahedron.
+	 ***********************************************************/
+	float SignNotZero(float value)
+	{
+		return((value >= 0.0f) ? 1.0f : -1.0f);
+	}
+
+	/***********************************************************
+	 *  PackOctahedralComponents()
+	 *
+	 *  This function is used for storing two signed 10 bit
+	 *  values in the x and y fields of a GL_INT_2_10_10_10_REV
+	 *  value, with z and w left at 0.
+	 ***********************************************************/
+	uint32_t PackOctahedralComponents(int x, int y)
+	{
+		return(((uint32_t)x & 0x3FF) | (((uint32_t)y & 0x3FF) << 10));
+	}
+
+	/***********************************************************
+	 *  DecodeOctahedral()
+	 *
+	 *  This function is used for unfolding a point of the
+	 *  flattened octahedron, from -1 to 1 on both axes, into
+	 *  the direction of length 1 that it stands for.
+	 ***********************************************************/
+	glm::vec3 DecodeOctahedral(float x, float y)
+	{
+		glm::vec3 normal(x, y, 1.0f - std::fabs(x) - std::fabs(y));
+		float fold = std::max(-normal.z, 0.0f);
+		normal.x += (normal.x >= 0.0f) ? -fold : fold;
+		normal.y += (normal.y >= 0.0f) ? -fold : fold;
+		return(glm::normalize(normal));
+	}
+}
+
+/***********************************************************
+ *  EncodeOctahedralNormal()
+ *
+ *  This function is used for projecting a normal onto the
+ *  octahedron, folding its lower half over the upper one,
+ *  and rounding the result to 10 bits.  Of the four nearest
+ *  10 bit values, the one that decodes closest to the
+ *  normal is kept, which halves the worst error of plain
+ *  rounding.
+ ***********************************************************/
+uint32_t EncodeOctahedralNormal(const glm::vec3& normal)
+{
+	float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (length <= 0.0f)
+	{
+		return(PackOctahedralComponents(0, 0));
+	}
+
+	float x = normal.x / length;
+	float y = normal.y / length;
+	if (normal.z < 0.0f)
+	{
+		float foldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+		float foldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	glm::vec3 direction = glm::normalize(normal);
+	int baseX = (int)std::floor(x * PACKED_NORMAL_SCALE);
+	int baseY = (int)std::floor(y * PACKED_NORMAL_SCALE);
+	int bestX = 0;
+	int bestY = 0;
+	float bestDot = -2.0f;
+	for (int corner = 0; corner < 4; corner++)
+	{
+		int candidateX = std::min(std::max(baseX + (corner & 1), -PACKED_NORMAL_SCALE), PACKED_NORMAL_SCALE);
+		int candidateY = std::min(std::max(baseY + (corner >> 1), -PACKED_NORMAL_SCALE), PACKED_NORMAL_SCALE);
+		glm::vec3 decoded = DecodeOctahedral(
+			(float)candidateX / PACKED_NORMAL_SCALE,
+			(float)candidateY / PACKED_NORMAL_SCALE);
+		float dot = glm::dot(decoded, direction);
+		if (dot > bestDot)
+		{
+			bestDot = dot;
+			bestX = candidateX;
+			bestY = candidateY;
+		}
+	}
+
+	return(PackOctahedralComponents(bestX, bestY));
+}
+
+/***********************************************************
+ *  DecodeOctahedralNormal()
+ *
+ *  This function is used for reading the two signed 10 bit
+ *  values back out of a packed normal and unfolding them,
+ *  the same way as the vertex shader.
+ ***********************************************************/
+glm::vec3 DecodeOctahedralNormal(uint32_t packed)
+{
+	// move each field to the top bits, so shifting it back
+	// down extends its sign
+	int x = ((int32_t)(packed << 22)) >> 22;
+	int y = ((int32_t)(packed << 12)) >> 22;
+	return(DecodeOctahedral(
+		std::max((float)x / PACKED_NORMAL_SCALE, -1.0f),
+		std::max((float)y / PACKED_NORMAL_SCALE, -1.0f)));
+}
+
+/***********************************************************
+ *  PackVertices()
+ *
+ *  This function is used for converting interleaved float
+ *  vertices into the packed layout.  An axis along which the
+ *  box is flat stores 0, which the box minimum decodes.
+ ***********************************************************/
+void PackVertices(
+	const float* pVerts,
+	size_t vertexCount,
+	size_t floatsPerVertex,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	std::vector<PACKED_VERTEX>& packed)
+{
+	glm::vec3 extent = boxMax - boxMin;
+	glm::vec3 inverseExtent(0.0f);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (extent[axis] > 0.0f)
+		{
+			inverseExtent[axis] = 1.0f / extent[axis];
+		}
+	}
+
+	packed.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float* pVertex = pVerts + i * floatsPerVertex;
+		PACKED_VERTEX& vertex = packed[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float fraction = (pVertex[axis] - boxMin[axis]) * inverseExtent[axis];
+			fraction = std::min(std::max(fraction, 0.0f), 1.0f);
+			vertex.position[axis] = (uint16_t)(fraction * g_PositionScale + 0.5f);
+		}
+		vertex.position[3] = 0;
+
+		vertex.normal = EncodeOctahedralNormal(glm::vec3(pVertex[3], pVertex[4], pVertex[5]));
+		vertex.uv[0] = glm::packHalf1x16(pVertex[6]);
+		vertex.uv[1] = glm::packHalf1x16(pVertex[7]);
+	}
+}
+
+/***********************************************************
+ *  UnpackVertex()
+ *
+ *  This function is used for converting a packed vertex
+ *  back into floats, for checking how far it is from the
+ *  vertex it was packed from.
+ ***********************************************************/
+void UnpackVertex(
+	const PACKED_VERTEX& vertex,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	float* pVertex)
+{
+	glm::vec3 extent = boxMax - boxMin;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		pVertex[axis] = boxMin[axis] + ((float)vertex.position[axis] / g_PositionScale) * extent[axis];
+	}
+
+	glm::vec3 normal = DecodeOctahedralNormal(vertex.normal);
+	pVertex[3] = normal.x;
+	pVertex[4] = normal.y;
+	pVertex[5] = normal.z;
+	pVertex[6] = glm::unpackHalf1x16(vertex.uv[0]);
+	pVertex[7] = glm::unpackHalf1x16(vertex.uv[1]);
+}
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexpacking.h
+// ============
+// store the interleaved mesh vertices in half the memory
+//
+//  A float vertex is 32 bytes - a position, a normal and a texture
+//  coordinate of full floats.  A packed vertex is 16 bytes.  The position
+//  is stored as three 16 bit fractions of a box around the mesh, which
+//  the model matrix turns back into object space, so the step between
+//  two positions is the size of the box divided by 65535.  The normal is
+//  folded from the sphere onto an octahedron and flattened into two
+//  signed 10 bit values, which keeps the error of its direction below a
+//  fifth of a degree.  The texture coordinate is two half floats, exact
+//  for the 0 to 1 range of the shapes to better than a thousandth.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// the largest value of the signed 10 bit normal components,
+// which the vertex shader divides by
+const int PACKED_NORMAL_SCALE = 511;
+
+// one vertex in the packed memory layout
+struct PACKED_VERTEX
+{
+	// fraction of the box from its minimum corner, and an
+	// unused fourth value that keeps the normal aligned
+	uint16_t position[4];
+	// octahedral normal in the lowest 20 bits of a
+	// GL_INT_2_10_10_10_REV value
+	uint32_t normal;
+	// half float texture coordinate
+	uint16_t uv[2];
+};
+
+// encode a normal of length 1 as the octahedral value closest
+// to its direction
+uint32_t EncodeOctahedralNormal(const glm::vec3& normal);
+
+// decode an octahedral normal the same way as the vertex shader
+glm::vec3 DecodeOctahedralNormal(uint32_t packed);
+
+// pack the passed in interleaved float vertices, of a position,
+// normal and texture coordinate each, with their positions
+// relative to the passed in box
+void PackVertices(
+	const float* pVerts,
+	size_t vertexCount,
+	size_t floatsPerVertex,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	std::vector<PACKED_VERTEX>& packed);
+
+// unpack a vertex into the 8 floats of the float layout, the
+// same way as the vertex shader and the model matrix
+void UnpackVertex(
+	const PACKED_VERTEX& vertex,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax,
+	float* pVertex);
@@ -0,0 +1,1327 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarks.cpp
+// ============
+// console microbenchmarks for the CPU side of the renderer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmarks.h"
+#include "Transform.h"
+#include "TransformBatch.h"
+#include "JobSystem.h"
+#include "DepthRasterizer.h"
+#include "SceneBuilder.h"
+#include "CommandBuffer.h"
+#include "ShapeMeshes.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include "MeshNormals.h"
+#include "VertexPacking.h"
+#include "MappedFile.h"
+#include "ObjImporter.h"
+#include "GltfImporter.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// number of transforms composed by each timed pass
+	const int g_TransformCount = 1000000;
+	// number of objects in the scene of the scaling benchmark,
+	// on a square grid, and the frames timed for each thread count
+	const int g_ScalingGridSize = 256;
+	const int g_ScalingFrameCount = 60;
+	// number of nodes in the scene file of the loading benchmark
+	const int g_SceneLoadNodeCount = 1000000;
+	// number of translucent objects in the sorting benchmark, the
+	// textures, materials and meshes they are spread over, and
+	// the frames timed for each way of ordering them
+	const int g_TranslucentCount = 20000;
+	const int g_TranslucentStateCount = 8;
+	const int g_TranslucentFrameCount = 60;
+	// segments around and from top to bottom of the generated
+	// meshes, and the meshes generated of each size
+	const int g_MeshGenerationSizes[] = { 8, 16, 32, 64, 128 };
+	const int g_MeshGenerationSizeCount = sizeof(g_MeshGenerationSizes) / sizeof(g_MeshGenerationSizes[0]);
+	const int g_MeshGenerationRepeats = 200;
+	// largest errors of the packed vertex layout that still
+	// pass - positions in steps of the packing box, normals in
+	// degrees and texture coordinates in texels of a 2048
+	// texel texture - and the random normals tested
+	const float g_PackedPositionTolerance = 0.5f;
+	const float g_PackedNormalTolerance = 0.25f;
+	const float g_PackedUVTolerance = 1.0f;
+	const int g_PackedRandomNormalCount = 1000000;
+	// segments around and from top to bottom of the sphere of
+	// quads in the OBJ file of the import benchmark, which
+	// makes the file about 100 MB
+	const int g_ObjImportSegments = 768;
+	// numbers of nodes in the .glb files of the glTF benchmark
+	const int g_GltfImportNodeCounts[] = { 1000, 10000, 100000 };
+	// segments around the dense torus of the meshlet benchmark,
+	// and the times its meshlets are culled from each camera
+	const int g_MeshletTorusSegments = 512;
+	const int g_MeshletCullRepeats = 200;
+	// segments around the torus of about a million triangles
+	// of the normal benchmark, and the times it is timed
+	const int g_NormalTorusSegments = 1024;
+	const int g_NormalRepeats = 10;
+
+	// segments around both circles of the torus whose detail
+	// levels are built, of about two million triangles
+	const int g_SimplifyTorusSegments = 1024;
+
+	/***********************************************************
+	 *  GetTimeInSeconds()
+	 *
+	 *  This function is used for reading a steady clock.
+	 ***********************************************************/
+	double GetTimeInSeconds()
+	{
+		return(std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	/***********************************************************
+	 *  ComposeWithMatrixProducts()
+	 *
+	 *  This function is used for building a model matrix the
+	 *  way SceneManager::SetTransformations() used to, from
+	 *  five separate matrices.
+	 ***********************************************************/
+	glm::mat4 ComposeWithMatrixProducts(
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegreesXYZ,
+		const glm::vec3& positionXYZ)
+	{
+		glm::mat4 scale = glm::scale(scaleXYZ);
+		glm::mat4 rotationX = glm::rotate(glm::radians(rotationDegreesXYZ.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 rotationY = glm::rotate(glm::radians(rotationDegreesXYZ.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rotationZ = glm::rotate(glm::radians(rotationDegreesXYZ.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 translation = glm::translate(positionXYZ);
+
+		return(translation * rotationX * rotationY * rotationZ * scale);
+	}
+
+	/***********************************************************
+	 *  BenchmarkTransforms()
+	 *
+	 *  This function is used for comparing the time taken to
+	 *  build one model matrix with the five matrix products
+	 *  and with the closed form.
+	 ***********************************************************/
+	void BenchmarkTransforms()
+	{
+		// a small set of varied transforms, reused round robin,
+		// so the inputs cannot be folded away by the compiler
+		const int inputCount = 1024;
+		std::vector<glm::vec3> scales(inputCount);
+		std::vector<glm::vec3> rotations(inputCount);
+		std::vector<glm::vec3> positions(inputCount);
+		for (int i = 0; i < inputCount; i++)
+		{
+			scales[i] = glm::vec3(0.5f + (i % 7) * 0.25f, 1.0f + (i % 3) * 0.5f, 0.5f + (i % 5) * 0.2f);
+			rotations[i] = glm::vec3((i * 37) % 360, (i * 53) % 360, (i * 71) % 360);
+			positions[i] = glm::vec3(i * 0.01f, -i * 0.02f, i * 0.03f);
+		}
+
+		float checksum = 0.0f;
+		double startTime = GetTimeInSeconds();
+		for (int i = 0; i < g_TransformCount; i++)
+		{
+			int input = i % inputCount;
+			checksum += ComposeWithMatrixProducts(scales[input], rotations[input], positions[input])[3][0];
+		}
+		double productTime = GetTimeInSeconds() - startTime;
+
+		startTime = GetTimeInSeconds();
+		for (int i = 0; i < g_TransformCount; i++)
+		{
+			int input = i % inputCount;
+			checksum += Transform::ComposeMatrix(scales[input], rotations[input], positions[input])[3][0];
+		}
+		double closedFormTime = GetTimeInSeconds() - startTime;
+
+		double nsPerTransform = 1.0e9 / g_TransformCount;
+		std::cout << std::fixed << std::setprecision(2)
+			<< "INFO: transforms, ns per transform over " << g_TransformCount << " transforms\n"
+			<< "  five matrix products: " << productTime * nsPerTransform << "\n"
+			<< "  closed form:          " << closedFormTime * nsPerTransform << "\n"
+			<< "  (checksum " << checksum << ")"
+			<< std::defaultfloat << std::endl;
+	}
+
+	/***********************************************************
+	 *  BenchmarkTransformBatch()
+	 *
+	 *  This function is used for comparing the rate at which
+	 *  a batch of model matrices is composed one at a time in
+	 *  closed form and by the structure-of-arrays batch, on a
+	 *  single core.
+	 ***********************************************************/
+	void BenchmarkTransformBatch()
+	{
+		const int batchSize = 4096;
+		const int passCount = g_TransformCount / batchSize;
+		TransformBatch batch;
+		std::vector<glm::vec3> scales(batchSize);
+		std::vector<glm::vec3> rotations(batchSize);
+		std::vector<glm::vec3> positions(batchSize);
+		std::vector<glm::mat4> matrices(batchSize);
+
+		batch.Resize(batchSize);
+		for (int i = 0; i < batchSize; i++)
+		{
+			scales[i] = glm::vec3(0.5f + (i % 7) * 0.25f, 1.0f + (i % 3) * 0.5f, 0.5f + (i % 5) * 0.2f);
+			rotations[i] = glm::vec3((i * 37) % 360, (i * 53) % 360, (i * 71) % 360);
+			positions[i] = glm::vec3(i * 0.01f, -i * 0.02f, i * 0.03f);
+			batch.Set(i, scales[i], rotations[i], positions[i]);
+		}
+
+		float checksum = 0.0f;
+		double startTime = GetTimeInSeconds();
+		for (int pass = 0; pass < passCount; pass++)
+		{
+			for (int i = 0; i < batchSize; i++)
+			{
+				matrices[i] = Transform::ComposeMatrix(scales[i], rotations[i], positions[i]);
+			}
+			checksum += matrices[pass % batchSize][3][0];
+		}
+		double scalarTime = GetTimeInSeconds() - startTime;
+
+		startTime = GetTimeInSeconds();
+		for (int pass = 0; pass < passCount; pass++)
+		{
+			batch.ComposeAll();
+			checksum += batch.GetMatrixData()[(pass % batchSize) * 16 + 12];
+		}
+		double batchTime = GetTimeInSeconds() - startTime;
+
+		// the largest difference from the closed form, as a check
+		float maxError = 0.0f;
+		for (int i = 0; i < batchSize; i++)
+		{
+			glm::mat4 expected = Transform::ComposeMatrix(scales[i], rotations[i], positions[i]);
+			glm::mat4 actual = batch.GetMatrix(i);
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					float error = fabsf(expected[column][row] - actual[column][row]);
+					maxError = (error > maxError) ? error : maxError;
+				}
+			}
+		}
+
+		double matrixCount = (double)passCount * batchSize;
+		std::cout << std::fixed << std::setprecision(1)
+			<< "INFO: transform-batch, matrices per ms on one core, batches of " << batchSize << "\n"
+			<< "  closed form, one at a time: " << matrixCount / (scalarTime * 1000.0) << "\n"
+			<< "  structure-of-arrays batch:  " << matrixCount / (batchTime * 1000.0) << "\n"
+			<< std::scientific << std::setprecision(2)
+			<< "  (largest difference " << maxError << ", checksum " << checksum << ")"
+			<< std::defaultfloat << std::endl;
+	}
+
+	/***********************************************************
+	 *  BenchmarkJobScaling()
+	 *
+	 *  This function is used for timing the CPU work of a
+	 *  frame with a growing number of job system threads.  A
+	 *  grid of objects is composed into model matrices, a row
+	 *  of large occluders is rasterized, and every object is
+	 *  tested against the depth buffer, as in a frame of the
+	 *  scene with the CPU occlusion culling.
+	 ***********************************************************/
+	void BenchmarkJobScaling()
+	{
+		const int objectCount = g_ScalingGridSize * g_ScalingGridSize;
+		const int groupCount = (objectCount + 7) / 8;
+		const glm::vec3 boundsMin(-0.5f, -0.5f, -0.5f);
+		const glm::vec3 boundsMax(0.5f, 0.5f, 0.5f);
+		TransformBatch batch;
+		std::vector<unsigned char> visible(objectCount);
+
+		batch.Resize(objectCount);
+		for (int i = 0; i < objectCount; i++)
+		{
+			float x = (float)(i % g_ScalingGridSize) - g_ScalingGridSize * 0.5f;
+			float z = -(float)(i / g_ScalingGridSize) - 2.0f;
+			batch.Set(i,
+				glm::vec3(0.8f, 0.8f, 0.8f),
+				glm::vec3((i * 37) % 360, (i * 53) % 360, 0.0f),
+				glm::vec3(x, 0.0f, z));
+		}
+
+		// looking down the grid, with a wall of occluders that
+		// hides the far part of it
+		glm::mat4 view = glm::lookAt(
+			glm::vec3(0.0f, 6.0f, 4.0f),
+			glm::vec3(0.0f, 0.0f, -30.0f),
+			glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.25f, 0.1f, 400.0f);
+		glm::mat4 viewProjection = projection * view;
+
+		int maxThreads = (int)std::thread::hardware_concurrency();
+		maxThreads = (maxThreads > 0) ? maxThreads : 1;
+
+		std::cout << "INFO: job-scaling, CPU time per frame for " << objectCount
+			<< " objects over " << g_ScalingFrameCount << " frames\n"
+			<< "  threads   ms per frame   speedup" << std::endl;
+
+		double singleThreadTime = 0.0;
+		for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+		{
+			JobSystem jobSystem(threadCount);
+			DepthRasterizer rasterizer(320, 256, &jobSystem);
+			for (int i = 0; i < 8; i++)
+			{
+				rasterizer.AddOccluder(
+					glm::translate(glm::vec3(-40.0f + i * 10.0f, 0.0f, -40.0f)),
+					glm::vec3(-5.0f, -10.0f, -1.0f),
+					glm::vec3(5.0f, 10.0f, 1.0f));
+			}
+
+			int visibleCount = 0;
+			double startTime = GetTimeInSeconds();
+			for (int frame = 0; frame < g_ScalingFrameCount; frame++)
+			{
+				// the transform updates, 8 objects at a time
+				jobSystem.ParallelFor(groupCount, 64, [&batch](int first, int last) {
+					batch.ComposeRange(first * 8, last * 8);
+				});
+
+				rasterizer.Rasterize(viewProjection);
+
+				// the culling of every object
+				jobSystem.ParallelFor(objectCount, 256, [&](int first, int last) {
+					for (int i = first; i < last; i++)
+					{
+						visible[i] = rasterizer.IsVisible(batch.GetMatrix(i), boundsMin, boundsMax) ? 1 : 0;
+					}
+				});
+			}
+			double frameTime = (GetTimeInSeconds() - startTime) / g_ScalingFrameCount;
+
+			for (int i = 0; i < objectCount; i++)
+			{
+				visibleCount += visible[i];
+			}
+			if (threadCount == 1)
+			{
+				singleThreadTime = frameTime;
+			}
+
+			std::cout << std::fixed << std::setprecision(3)
+				<< "  " << std::setw(7) << threadCount
+				<< "   " << std::setw(12) << frameTime * 1000.0
+				<< "   " << std::setprecision(2) << std::setw(7) << singleThreadTime / frameTime
+				<< "   (" << visibleCount << " visible)"
+				<< std::defaultfloat << std::endl;
+
+			// also time the hardware thread count when it is not
+			// a power of two
+			if ((threadCount < maxThreads) && (threadCount * 2 > maxThreads))
+			{
+				threadCount = maxThreads / 2;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  BenchmarkSceneLoad()
+	 *
+	 *  This function is used for timing the cooking of a scene
+	 *  with a million nodes, the mapping of the cooked file
+	 *  and a first pass over all of its nodes.
+	 ***********************************************************/
+	void BenchmarkSceneLoad()
+	{
+		const char* filename = "benchmark.scene";
+		int gridSize = (int)std::sqrt((double)g_SceneLoadNodeCount);
+
+		double startTime = GetTimeInSeconds();
+		SceneBuilder builder;
+		int material = builder.AddMaterial("benchmark",
+			glm::vec3(0.2f), 0.2f, glm::vec3(0.6f), glm::vec3(0.5f), 32.0f);
+		int meshes[3] = { builder.AddMesh("box"), builder.AddMesh("sphere"), builder.AddMesh("cylinder") };
+		for (int i = 0; i < g_SceneLoadNodeCount; i++)
+		{
+			builder.AddNode(meshes[i % 3],
+				glm::vec3(0.8f),
+				glm::vec3(0.0f, (float)((i * 53) % 360), 0.0f),
+				glm::vec3((float)(i % gridSize), 0.0f, (float)(i / gridSize)),
+				-1, material, glm::vec4(1.0f), glm::vec2(1.0f), 0);
+		}
+		bool bWritten = builder.Write(filename);
+		double cookTime = GetTimeInSeconds() - startTime;
+		if (bWritten == false)
+		{
+			return;
+		}
+
+		startTime = GetTimeInSeconds();
+		SceneFile sceneFile;
+		bool bOpened = sceneFile.Open(filename);
+		double openTime = GetTimeInSeconds() - startTime;
+
+		// the first pass reads every page of the file from the
+		// disk cache
+		startTime = GetTimeInSeconds();
+		double checksum = 0.0;
+		const SCENE_FILE_NODE* pNodes = sceneFile.GetNodes();
+		const SCENE_FILE_TRANSFORM* pTransforms = sceneFile.GetTransforms();
+		for (int i = 0; i < sceneFile.GetCount(SCENE_SECTION_NODES); i++)
+		{
+			checksum += pTransforms[pNodes[i].transform].matrix[12];
+		}
+		double readTime = GetTimeInSeconds() - startTime;
+
+		sceneFile.Close();
+		remove(filename);
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< "INFO: scene-load, " << g_SceneLoadNodeCount << " nodes"
+			<< (bOpened ? "" : " (the cooked file could not be mapped)") << "\n"
+			<< "  cook and write:   " << cookTime * 1000.0 << " ms\n"
+			<< "  map and check:    " << openTime * 1000.0 << " ms\n"
+			<< "  read every node:  " << readTime * 1000.0 << " ms\n"
+			<< "  (checksum " << checksum << ")"
+			<< std::defaultfloat << std::endl;
+	}
+
+	/***********************************************************
+	 *  BenchmarkTransparencySort()
+	 *
+	 *  This function is used for comparing the CPU cost of the
+	 *  two ways of ordering translucent draws, while the camera
+	 *  circles the objects.  Sorting from back to front needs
+	 *  the distance of every object each frame and changes the
+	 *  order whenever the camera moves, which also scatters the
+	 *  draws of each texture, material and mesh.  The weighted
+	 *  blended transparency keeps the order of the opaque draws,
+	 *  so the state changes during the replay are counted too.
+	 ***********************************************************/
+	void BenchmarkTransparencySort()
+	{
+		struct TRANSLUCENT_OBJECT
+		{
+			glm::mat4 modelMatrix;
+			int texture;
+			int material;
+			int shape;
+		};
+
+		std::vector<TRANSLUCENT_OBJECT> objects(g_TranslucentCount);
+		int gridSize = (int)std::sqrt((double)g_TranslucentCount);
+		for (int i = 0; i < g_TranslucentCount; i++)
+		{
+			objects[i].modelMatrix = glm::translate(glm::vec3(
+				(float)(i % gridSize) - gridSize * 0.5f,
+				(float)((i * 7) % 5),
+				(float)(i / gridSize) - gridSize * 0.5f));
+			objects[i].texture = (i * 13) % g_TranslucentStateCount;
+			objects[i].material = (i * 29) % g_TranslucentStateCount;
+			objects[i].shape = (i * 31) % g_TranslucentStateCount;
+		}
+
+		std::cout << "INFO: transparency-sort, " << g_TranslucentCount << " translucent objects, "
+			<< g_TranslucentFrameCount << " frames\n"
+			<< "  order                 record and sort ms   texture/material/mesh changes"
+			<< std::endl;
+
+		CommandQueue queue(NULL);
+		for (int mode = 0; mode < 2; mode++)
+		{
+			bool bBackToFront = (mode == 0);
+			double totalTime = 0.0;
+			double stateChanges = 0.0;
+
+			for (int frame = 0; frame < g_TranslucentFrameCount; frame++)
+			{
+				float angle = glm::radians(360.0f * frame / g_TranslucentFrameCount);
+				glm::mat4 view = glm::lookAt(
+					glm::vec3(std::cos(angle), 0.5f, std::sin(angle)) * (float)gridSize,
+					glm::vec3(0.0f),
+					glm::vec3(0.0f, 1.0f, 0.0f));
+
+				double startTime = GetTimeInSeconds();
+				queue.Reset();
+				CommandBuffer& buffer = queue.GetBuffer();
+				for (int i = 0; i < g_TranslucentCount; i++)
+				{
+					uint64_t sortKey = 0;
+					if (bBackToFront == true)
+					{
+						float distance = -(view * objects[i].modelMatrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)).z;
+						sortKey = GetBackToFrontSortKey(distance, i);
+					}
+					else
+					{
+						sortKey = SORT_KEY_TRANSLUCENT | GetStateSortKey(1,
+							objects[i].texture, objects[i].material, objects[i].shape, 0, i);
+					}
+
+					DRAW_SHAPE_DATA drawShape = DRAW_SHAPE_DATA();
+					drawShape.objectIndex = i;
+					buffer.BeginPacket(sortKey);
+					buffer.Write(COMMAND_DRAW_SHAPE, drawShape);
+				}
+				queue.Sort();
+				totalTime += GetTimeInSeconds() - startTime;
+
+				// count the changes the replay would make
+				const TRANSLUCENT_OBJECT* pPrevious = NULL;
+				for (int i = 0; i < queue.GetPacketCount(); i++)
+				{
+					uint32_t size = 0;
+					uint32_t position = 0;
+					RenderCommandType type;
+					const unsigned char* pPayload = NULL;
+					const unsigned char* pCommands = queue.GetPacketCommands(i, size);
+					if (CommandQueue::ReadCommand(pCommands, size, position, type, pPayload) == false)
+					{
+						continue;
+					}
+
+					DRAW_SHAPE_DATA drawShape;
+					memcpy(&drawShape, pPayload, sizeof(drawShape));
+					const TRANSLUCENT_OBJECT* pObject = &objects[drawShape.objectIndex];
+					if (NULL != pPrevious)
+					{
+						stateChanges += (pObject->texture != pPrevious->texture) ? 1 : 0;
+						stateChanges += (pObject->material != pPrevious->material) ? 1 : 0;
+						stateChanges += (pObject->shape != pPrevious->shape) ? 1 : 0;
+					}
+					pPrevious = pObject;
+				}
+			}
+
+			std::cout << std::fixed << std::setprecision(3)
+				<< "  " << (bBackToFront ? "back to front" : "weighted blended")
+				<< std::setw(bBackToFront ? 21 : 18) << totalTime * 1000.0 / g_TranslucentFrameCount
+				<< std::setprecision(0) << std::setw(19) << stateChanges / g_TranslucentFrameCount
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	/***********************************************************
+	 *  BenchmarkMeshGeneration()
+	 *
+	 *  This function is used for timing the generators of the
+	 *  curved shapes at several tessellations, without the
+	 *  upload to the GPU, to check that every detail level can
+	 *  be generated at startup.
+	 ***********************************************************/
+	void BenchmarkMeshGeneration()
+	{
+		std::cout << "INFO: mesh-generation, " << g_MeshGenerationRepeats << " meshes of each size\n"
+			<< "  segments   sphere ms   cylinder ms   torus ms   sphere vertices   sphere triangles"
+			<< std::endl;
+
+		ShapeMeshes::MESH_DATA data;
+		for (int i = 0; i < g_MeshGenerationSizeCount; i++)
+		{
+			int segments = g_MeshGenerationSizes[i];
+
+			double startTime = GetTimeInSeconds();
+			for (int repeat = 0; repeat < g_MeshGenerationRepeats; repeat++)
+			{
+				ShapeMeshes::BuildSphereData(segments, segments, data);
+			}
+			double sphereTime = (GetTimeInSeconds() - startTime) / g_MeshGenerationRepeats;
+			// position, normal and texture coordinates of each vertex
+			size_t sphereVertices = data.verts.size() / 8;
+			size_t sphereTriangles = data.indices.size() / 3;
+
+			startTime = GetTimeInSeconds();
+			for (int repeat = 0; repeat < g_MeshGenerationRepeats; repeat++)
+			{
+				ShapeMeshes::BuildRoundData(segments, segments, 1.0f, 1.0f, ShapeMeshes::CAPS_BOTH, data);
+			}
+			double cylinderTime = (GetTimeInSeconds() - startTime) / g_MeshGenerationRepeats;
+
+			startTime = GetTimeInSeconds();
+			for (int repeat = 0; repeat < g_MeshGenerationRepeats; repeat++)
+			{
+				ShapeMeshes::BuildTorusData(segments, segments, 0.2f, data);
+			}
+			double torusTime = (GetTimeInSeconds() - startTime) / g_MeshGenerationRepeats;
+
+			std::cout << std::fixed << std::setprecision(4)
+				<< std::setw(10) << segments
+				<< std::setw(12) << sphereTime * 1000.0
+				<< std::setw(14) << cylinderTime * 1000.0
+				<< std::setw(11) << torusTime * 1000.0
+				<< std::setw(18) << sphereVertices
+				<< std::setw(19) << sphereTriangles
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	/***********************************************************
+	 *  BenchmarkMeshOptimization()
+	 *
+	 *  This function is used for measuring the vertex cache use
+	 *  of the generated meshes before and after the optimizer,
+	 *  and of a sphere with its triangles shuffled the way an
+	 *  imported mesh might arrive.
+	 ***********************************************************/
+	void BenchmarkMeshOptimization()
+	{
+		std::cout << "INFO: mesh-optimization, " << MESH_CACHE_SIZE << " entry FIFO vertex cache\n"
+			<< "  mesh                triangles   ACMR before   ACMR after   ATVR before   ATVR after   ms"
+			<< std::endl;
+
+		const char* names[] = { "sphere", "cylinder", "tapered cylinder", "cone", "torus", "shuffled sphere" };
+		for (int mesh = 0; mesh < 6; mesh++)
+		{
+			ShapeMeshes::MESH_DATA data;
+			switch (mesh)
+			{
+			case 0: ShapeMeshes::BuildSphereData(32, 24, data); break;
+			case 1: ShapeMeshes::BuildRoundData(36, 1, 1.0f, 1.0f, ShapeMeshes::CAPS_BOTH, data); break;
+			case 2: ShapeMeshes::BuildRoundData(36, 1, 1.0f, 0.5f, ShapeMeshes::CAPS_BOTH, data); break;
+			case 3: ShapeMeshes::BuildRoundData(36, 1, 1.0f, 0.0f, ShapeMeshes::CAPS_BOTTOM, data); break;
+			case 4: ShapeMeshes::BuildTorusData(30, 30, 0.2f, data); break;
+			default:
+				ShapeMeshes::BuildSphereData(64, 64, data);
+				data.rangeEnds.clear();
+				for (size_t i = data.indices.size() / 3 - 1; i > 0; i--)
+				{
+					size_t j = ((i * 2654435761u) >> 7) % (i + 1);
+					std::swap_ranges(&data.indices[i * 3], &data.indices[i * 3] + 3, &data.indices[j * 3]);
+				}
+				break;
+			}
+
+			MESH_CACHE_STATS before;
+			MESH_CACHE_STATS after;
+			double startTime = GetTimeInSeconds();
+			OptimizeMesh(data.verts, 8, data.indices, data.rangeEnds, &before, &after);
+			double optimizeTime = GetTimeInSeconds() - startTime;
+
+			std::cout << std::fixed << std::setprecision(3)
+				<< "  " << std::left << std::setw(18) << names[mesh] << std::right
+				<< std::setw(11) << data.indices.size() / 3
+				<< std::setw(14) << before.acmr
+				<< std::setw(13) << after.acmr
+				<< std::setw(14) << before.atvr
+				<< std::setw(13) << after.atvr
+				<< std::setw(7) << optimizeTime * 1000.0
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	/***********************************************************
+	 *  BenchmarkVertexPacking()
+	 *
+	 *  This function is used for packing the generated meshes
+	 *  into the 16 byte vertex layout, unpacking them the same
+	 *  way as the vertex shader, and checking the largest
+	 *  errors against the float vertices and the tolerances.
+	 *  Random directions check the normals the meshes miss.
+	 ***********************************************************/
+	void BenchmarkVertexPacking()
+	{
+		std::cout << "INFO: vertex-packing, tolerances " << g_PackedPositionTolerance << " box steps, "
+			<< g_PackedNormalTolerance << " degrees, " << g_PackedUVTolerance << " texels of 2048\n"
+			<< "  mesh                vertices   float bytes   packed bytes   position   normal   uv       ms   result"
+			<< std::endl;
+
+		bool bAllPassed = true;
+		const char* names[] = { "sphere", "cylinder", "tapered cylinder", "cone", "torus", "random normals" };
+		for (int mesh = 0; mesh < 6; mesh++)
+		{
+			ShapeMeshes::MESH_DATA data;
+			switch (mesh)
+			{
+			case 0: ShapeMeshes::BuildSphereData(32, 24, data); break;
+			case 1: ShapeMeshes::BuildRoundData(36, 1, 1.0f, 1.0f, ShapeMeshes::CAPS_BOTH, data); break;
+			case 2: ShapeMeshes::BuildRoundData(36, 1, 1.0f, 0.5f, ShapeMeshes::CAPS_BOTH, data); break;
+			case 3: ShapeMeshes::BuildRoundData(36, 1, 1.0f, 0.0f, ShapeMeshes::CAPS_BOTTOM, data); break;
+			case 4: ShapeMeshes::BuildTorusData(30, 30, 0.2f, data); break;
+			default:
+				// random directions on a sphere of radius 1, with
+				// random texture coordinates
+				data.verts.resize((size_t)g_PackedRandomNormalCount * 8);
+				for (int i = 0; i < g_PackedRandomNormalCount; i++)
+				{
+					float* pVertex = &data.verts[(size_t)i * 8];
+					unsigned int hash = (unsigned int)i * 2654435761u;
+					float z = ((hash & 0xFFFF) / 32767.5f) - 1.0f;
+					float angle = (float)(hash >> 16) * (6.2831853f / 65536.0f) + (float)i * 0.001f;
+					float ring = sqrt(std::max(1.0f - z * z, 0.0f));
+					glm::vec3 normal(ring * cos(angle), ring * sin(angle), z);
+					pVertex[0] = normal.x;
+					pVertex[1] = normal.y;
+					pVertex[2] = normal.z;
+					pVertex[3] = normal.x;
+					pVertex[4] = normal.y;
+					pVertex[5] = normal.z;
+					pVertex[6] = (float)(hash & 0x7FF) / 2047.0f;
+					pVertex[7] = (float)((hash >> 11) & 0x7FF) / 2047.0f;
+				}
+				break;
+			}
+
+			size_t vertexCount = data.verts.size() / 8;
+			glm::vec3 boxMin(data.verts[0], data.verts[1], data.verts[2]);
+			glm::vec3 boxMax = boxMin;
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				glm::vec3 position(data.verts[i * 8], data.verts[i * 8 + 1], data.verts[i * 8 + 2]);
+				boxMin = glm::min(boxMin, position);
+				boxMax = glm::max(boxMax, position);
+			}
+
+			std::vector<PACKED_VERTEX> packed;
+			double startTime = GetTimeInSeconds();
+			PackVertices(data.verts.data(), vertexCount, 8, boxMin, boxMax, packed);
+			double packTime = GetTimeInSeconds() - startTime;
+
+			// the errors in box steps, degrees and texels
+			glm::vec3 step = (boxMax - boxMin) / 65535.0f;
+			float positionError = 0.0f;
+			float normalError = 0.0f;
+			float uvError = 0.0f;
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				const float* pVertex = &data.verts[i * 8];
+				float unpacked[8];
+				UnpackVertex(packed[i], boxMin, boxMax, unpacked);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					if (step[axis] > 0.0f)
+					{
+						positionError = std::max(positionError, std::fabs(unpacked[axis] - pVertex[axis]) / step[axis]);
+					}
+				}
+				float cosine = glm::dot(glm::vec3(unpacked[3], unpacked[4], unpacked[5]),
+					glm::normalize(glm::vec3(pVertex[3], pVertex[4], pVertex[5])));
+				normalError = std::max(normalError, glm::degrees(std::acos(std::min(cosine, 1.0f))));
+				uvError = std::max(uvError, std::fabs(unpacked[6] - pVertex[6]) * 2048.0f);
+				uvError = std::max(uvError, std::fabs(unpacked[7] - pVertex[7]) * 2048.0f);
+			}
+
+			// the float rounding of the box size adds a little to
+			// the half step of the position rounding
+			bool bPassed = (positionError <= g_PackedPositionTolerance + 0.01f) &&
+				(normalError <= g_PackedNormalTolerance) &&
+				(uvError <= g_PackedUVTolerance);
+			bAllPassed = bAllPassed && bPassed;
+
+			std::cout << std::fixed << std::setprecision(3)
+				<< "  " << std::left << std::setw(18) << names[mesh] << std::right
+				<< std::setw(10) << vertexCount
+				<< std::setw(14) << vertexCount * 8 * sizeof(float)
+				<< std::setw(15) << vertexCount * sizeof(PACKED_VERTEX)
+				<< std::setw(11) << positionError
+				<< std::setw(9) << normalError
+				<< std::setw(7) << uvError
+				<< std::setw(9) << packTime * 1000.0
+				<< (bPassed ? "   pass" : "   FAIL")
+				<< std::defaultfloat << std::endl;
+		}
+
+		if (bAllPassed == false)
+		{
+			std::cerr << "The packed vertices are outside the tolerances of the float vertices" << std::endl;
+		}
+	}
+
+	/***********************************************************
+	 *  WriteBenchmarkObj()
+	 *
+	 *  This function is used for writing a sphere of quads,
+	 *  with positions, texture coordinates and normals, as an
+	 *  OBJ file - false if it could not be written.
+	 ***********************************************************/
+	bool WriteBenchmarkObj(const char* filename, int segments)
+	{
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			return(false);
+		}
+
+		// the lines are formatted into a buffer that is written
+		// whenever it is nearly full
+		std::vector<char> buffer(1 << 20);
+		size_t used = 0;
+		int rowLength = segments + 1;
+		for (int pass = 0; pass < 3; pass++)
+		{
+			for (int stack = 0; stack <= segments; stack++)
+			{
+				float phi = 3.14159265f * stack / segments;
+				for (int slice = 0; slice <= segments; slice++)
+				{
+					float theta = 6.28318531f * slice / segments;
+					float x = std::sin(phi) * std::cos(theta);
+					float y = std::cos(phi);
+					float z = std::sin(phi) * std::sin(theta);
+					if (pass == 0)
+					{
+						used += snprintf(&buffer[used], 64, "v %.6f %.6f %.6f\n", x, y, z);
+					}
+					else if (pass == 1)
+					{
+						used += snprintf(&buffer[used], 64, "vt %.6f %.6f\n", (float)slice / segments, (float)stack / segments);
+					}
+					else
+					{
+						used += snprintf(&buffer[used], 64, "vn %.6f %.6f %.6f\n", x, y, z);
+					}
+					if ((used + 256) > buffer.size())
+					{
+						file.write(buffer.data(), used);
+						used = 0;
+					}
+				}
+			}
+		}
+		for (int stack = 0; stack < segments; stack++)
+		{
+			for (int slice = 0; slice < segments; slice++)
+			{
+				int corners[4] = {
+					stack * rowLength + slice + 1,
+					(stack + 1) * rowLength + slice + 1,
+					(stack + 1) * rowLength + slice + 2,
+					stack * rowLength + slice + 2 };
+				used += snprintf(&buffer[used], 128, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+					corners[0], corners[0], corners[0], corners[1], corners[1], corners[1],
+					corners[2], corners[2], corners[2], corners[3], corners[3], corners[3]);
+				if ((used + 256) > buffer.size())
+				{
+					file.write(buffer.data(), used);
+					used = 0;
+				}
+			}
+		}
+		file.write(buffer.data(), used);
+		return(file.good());
+	}
+
+	/***********************************************************
+	 *  BenchmarkObjImport()
+	 *
+	 *  This function is used for timing the import of a large
+	 *  generated OBJ file - parsing it on one thread and on all
+	 *  of them, the first import that writes the cache file,
+	 *  and the second import that reads it.
+	 ***********************************************************/
+	void BenchmarkObjImport()
+	{
+		const char* filename = "benchmark.obj";
+		std::string cacheFilename = GetMeshCacheFilename(filename);
+		remove(cacheFilename.c_str());
+
+		double startTime = GetTimeInSeconds();
+		bool bWritten = WriteBenchmarkObj(filename, g_ObjImportSegments);
+		double writeTime = GetTimeInSeconds() - startTime;
+		if (bWritten == false)
+		{
+			std::cerr << "Could not write the OBJ file of the benchmark: " << filename << std::endl;
+			return;
+		}
+
+		JobSystem singleThread(1);
+		JobSystem allThreads(0);
+		OBJ_IMPORT_STATS singleStats;
+		OBJ_IMPORT_STATS parallelStats;
+		OBJ_IMPORT_STATS firstStats;
+		OBJ_IMPORT_STATS cachedStats;
+		memset(&singleStats, 0, sizeof(singleStats));
+		memset(&parallelStats, 0, sizeof(parallelStats));
+		memset(&firstStats, 0, sizeof(firstStats));
+		memset(&cachedStats, 0, sizeof(cachedStats));
+
+		bool bImported = false;
+		{
+			MappedFile source;
+			if (source.Open(filename) == true)
+			{
+				ShapeMeshes::MESH_DATA data;
+				bImported = ParseObjMesh((const char*)source.GetData(), source.GetSize(), &singleThread, data, &singleStats) &&
+					ParseObjMesh((const char*)source.GetData(), source.GetSize(), &allThreads, data, &parallelStats);
+			}
+		}
+
+		OBJ_MESH_LEVELS first;
+		OBJ_MESH_LEVELS cached;
+		bImported = bImported &&
+			ImportObjMesh(filename, &allThreads, first, &firstStats) &&
+			ImportObjMesh(filename, &allThreads, cached, &cachedStats);
+		bool bSame = bImported && (first.levelCount == cached.levelCount);
+		for (int lod = 0; (bSame == true) && (lod < first.levelCount); lod++)
+		{
+			bSame = (first.levels[lod].verts == cached.levels[lod].verts) &&
+				(first.levels[lod].indices == cached.levels[lod].indices);
+		}
+		remove(filename);
+		remove(cacheFilename.c_str());
+		if (bImported == false)
+		{
+			return;
+		}
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< "INFO: obj-import, " << firstStats.fileSize / (1024.0 * 1024.0) << " MB, "
+			<< firstStats.positionCount << " positions, " << firstStats.triangleCount << " triangles, "
+			<< firstStats.vertexCount << " vertices after welding\n"
+			<< "  write the OBJ file:          " << writeTime * 1000.0 << " ms\n"
+			<< "  parse, 1 thread:             " << singleStats.parseTime << " ms, weld " << singleStats.weldTime << " ms\n"
+			<< "  parse, " << std::setw(2) << allThreads.GetThreadCount() << " threads:           "
+			<< parallelStats.parseTime << " ms, weld " << parallelStats.weldTime << " ms\n"
+			<< "  first import:                " << firstStats.hashTime + firstStats.parseTime + firstStats.weldTime
+			+ firstStats.simplifyTime + firstStats.optimizeTime + firstStats.cacheTime << " ms (hash " << firstStats.hashTime
+			<< ", " << firstStats.levelCount << " detail levels " << firstStats.simplifyTime
+			<< ", optimize " << firstStats.optimizeTime << ", write cache " << firstStats.cacheTime << ")\n"
+			<< "  cached import:               " << cachedStats.hashTime + cachedStats.cacheTime
+			<< " ms (hash " << cachedStats.hashTime << ", read cache " << cachedStats.cacheTime << ")"
+			<< (cachedStats.bFromCache ? "" : " - the cache file was not used")
+			<< (bSame ? "" : " - the cached mesh differs")
+			<< std::defaultfloat << std::endl;
+	}
+
+	/***********************************************************
+	 *  WriteBenchmarkGlb()
+	 *
+	 *  This function is used for writing a .glb file of one
+	 *  sphere mesh drawn by the passed in number of nodes, on
+	 *  a square grid - false if it could not be written.
+	 ***********************************************************/
+	bool WriteBenchmarkGlb(const char* filename, int nodeCount)
+	{
+		ShapeMeshes::MESH_DATA data;
+		ShapeMeshes::BuildSphereData(32, 24, data);
+		size_t vertexCount = data.verts.size() / 8;
+
+		// the positions, normals and texture coordinates one after
+		// the other, then the indices
+		std::vector<float> attributes(vertexCount * 8);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			memcpy(&attributes[v * 3], &data.verts[v * 8], sizeof(float) * 3);
+			memcpy(&attributes[vertexCount * 3 + v * 3], &data.verts[v * 8 + 3], sizeof(float) * 3);
+			memcpy(&attributes[vertexCount * 6 + v * 2], &data.verts[v * 8 + 6], sizeof(float) * 2);
+		}
+		size_t attributeBytes = attributes.size() * sizeof(float);
+		size_t indexBytes = data.indices.size() * sizeof(GLuint);
+
+		char text[1024];
+		snprintf(text, sizeof(text),
+			"{\"asset\":{\"version\":\"2.0\"},\"scene\":0,"
+			"\"buffers\":[{\"byteLength\":%u}],"
+			"\"bufferViews\":[{\"buffer\":0,\"byteLength\":%u},{\"buffer\":0,\"byteOffset\":%u,\"byteLength\":%u}],"
+			"\"accessors\":["
+			"{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\",\"min\":[-1,-1,-1],\"max\":[1,1,1]},"
+			"{\"bufferView\":0,\"byteOffset\":%u,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},"
+			"{\"bufferView\":0,\"byteOffset\":%u,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"},"
+			"{\"bufferView\":1,\"componentType\":5125,\"count\":%u,\"type\":\"SCALAR\"}],"
+			"\"materials\":[{\"pbrMetallicRoughness\":{\"baseColorFactor\":[0.8,0.6,0.2,1],\"roughnessFactor\":0.4}}],"
+			"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3,\"material\":0}]}],"
+			"\"nodes\":[",
+			(unsigned int)(attributeBytes + indexBytes),
+			(unsigned int)attributeBytes, (unsigned int)attributeBytes, (unsigned int)indexBytes,
+			(unsigned int)vertexCount,
+			(unsigned int)(vertexCount * 12), (unsigned int)vertexCount,
+			(unsigned int)(vertexCount * 24), (unsigned int)vertexCount,
+			(unsigned int)data.indices.size());
+		std::string json = text;
+		std::string sceneNodes = "],\"scenes\":[{\"nodes\":[";
+		int gridSize = (int)std::sqrt((double)nodeCount) + 1;
+		for (int i = 0; i < nodeCount; i++)
+		{
+			snprintf(text, sizeof(text), "%s{\"mesh\":0,\"translation\":[%d,0,%d],\"scale\":[0.4,0.4,0.4]}",
+				(i > 0) ? "," : "", (i % gridSize) * 2, (i / gridSize) * 2);
+			json += text;
+			snprintf(text, sizeof(text), "%s%d", (i > 0) ? "," : "", i);
+			sceneNodes += text;
+		}
+		json += sceneNodes + "]}]}";
+		while ((json.size() % 4) != 0)
+		{
+			json += ' ';
+		}
+
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+		uint32_t header[3] = { GLB_MAGIC, GLB_VERSION,
+			(uint32_t)(12 + 8 + json.size() + 8 + attributeBytes + indexBytes) };
+		uint32_t jsonChunk[2] = { (uint32_t)json.size(), GLB_CHUNK_JSON };
+		uint32_t binaryChunk[2] = { (uint32_t)(attributeBytes + indexBytes), GLB_CHUNK_BIN };
+		file.write((const char*)header, sizeof(header));
+		file.write((const char*)jsonChunk, sizeof(jsonChunk));
+		file.write(json.data(), (std::streamsize)json.size());
+		file.write((const char*)binaryChunk, sizeof(binaryChunk));
+		file.write((const char*)attributes.data(), (std::streamsize)attributeBytes);
+		file.write((const char*)data.indices.data(), (std::streamsize)indexBytes);
+		return(file.good());
+	}
+
+	/***********************************************************
+	 *  BenchmarkGltfImport()
+	 *
+	 *  This function is used for timing the cooking of .glb
+	 *  files whose nodes all draw one mesh, for a growing
+	 *  number of nodes, to show that the time follows the
+	 *  size of the file and that the mesh is stored once.
+	 ***********************************************************/
+	void BenchmarkGltfImport()
+	{
+		const char* filename = "benchmark.glb";
+		const char* sceneFilename = "benchmark.scene";
+		std::cout << "INFO: gltf-import, one sphere mesh drawn by every node\n"
+			<< "      nodes   file KB   cook ms   ms per MB   meshes" << std::endl;
+
+		for (size_t i = 0; i < sizeof(g_GltfImportNodeCounts) / sizeof(g_GltfImportNodeCounts[0]); i++)
+		{
+			int nodeCount = g_GltfImportNodeCounts[i];
+			if (WriteBenchmarkGlb(filename, nodeCount) == false)
+			{
+				std::cerr << "Could not write the glTF file of the benchmark: " << filename << std::endl;
+				return;
+			}
+			MappedFile source;
+			source.Open(filename);
+			double fileSize = (double)source.GetSize();
+			source.Close();
+
+			double startTime = GetTimeInSeconds();
+			bool bCooked = CookGltfScene(filename, sceneFilename);
+			double cookTime = GetTimeInSeconds() - startTime;
+
+			SceneFile sceneFile;
+			int meshCount = ((bCooked == true) && (sceneFile.Open(sceneFilename) == true)) ?
+				sceneFile.GetCount(SCENE_SECTION_MESHES) : 0;
+			sceneFile.Close();
+			remove(filename);
+			remove(sceneFilename);
+
+			std::cout << std::fixed << std::setprecision(3)
+				<< std::setw(11) << nodeCount
+				<< std::setw(10) << fileSize / 1024.0
+				<< std::setw(10) << cookTime * 1000.0
+				<< std::setw(12) << cookTime * 1000.0 / (fileSize / (1024.0 * 1024.0))
+				<< std::setw(9) << meshCount
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	/***********************************************************
+	 *  BenchmarkMeshletCulling()
+	 *
+	 *  This function is used for splitting a dense torus into
+	 *  meshlets and timing the culling of its meshlets from a
+	 *  few cameras, with the share of the meshlets and indices
+	 *  that are still drawn from each.
+	 ***********************************************************/
+	void BenchmarkMeshletCulling()
+	{
+		ShapeMeshes::MESH_DATA data;
+		ShapeMeshes::BuildTorusData(g_MeshletTorusSegments, g_MeshletTorusSegments / 2, 0.3f, data);
+		OptimizeMesh(data.verts, 8, data.indices, data.rangeEnds);
+
+		MESHLETS meshlets;
+		double startTime = GetTimeInSeconds();
+		BuildMeshlets(data.verts.data(), 8, data.indices.data(), data.indices.size(), data.verts.size() / 8, meshlets);
+		double buildTime = GetTimeInSeconds() - startTime;
+		size_t meshletCount = meshlets.firstIndex.size();
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< "INFO: meshlet-culling, torus of " << data.indices.size() / 3 << " triangles in "
+			<< meshletCount << " meshlets of " << (double)data.indices.size() / 3.0 / (double)meshletCount
+			<< " triangles on average, built in " << buildTime * 1000.0 << " ms\n"
+			<< "  camera             meshlets %   indices %   ranges   us per cull"
+			<< std::defaultfloat << std::endl;
+
+		const char* names[] = { "whole torus", "close up", "edge on", "looking away", "orthographic" };
+		const glm::vec3 eyes[] = {
+			glm::vec3(0.0f, 2.5f, 3.0f),
+			glm::vec3(0.0f, 0.4f, 1.9f),
+			glm::vec3(3.5f, 0.0f, 0.0f),
+			glm::vec3(0.0f, 2.5f, 3.0f),
+			glm::vec3(0.0f, 4.0f, 0.5f) };
+		const glm::vec3 targets[] = {
+			glm::vec3(0.0f),
+			glm::vec3(0.0f, 0.0f, 1.0f),
+			glm::vec3(0.0f),
+			glm::vec3(0.0f, 5.0f, 6.0f),
+			glm::vec3(0.0f) };
+
+		std::vector<MESHLET_RANGE> ranges(meshletCount);
+		for (int view = 0; view < 5; view++)
+		{
+			glm::mat4 viewMatrix = glm::lookAt(eyes[view], targets[view], glm::vec3(0.0f, 1.0f, 0.0f));
+			glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 100.0f);
+			glm::vec4 camera = glm::inverse(viewMatrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			if (view == 4)
+			{
+				projection = glm::ortho(-2.0f, 2.0f, -1.6f, 1.6f, 0.1f, 100.0f);
+				camera = glm::inverse(viewMatrix) * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+			}
+			glm::mat4 viewProjection = projection * viewMatrix;
+
+			size_t visibleMeshlets = 0;
+			int rangeCount = 0;
+			startTime = GetTimeInSeconds();
+			for (int i = 0; i < g_MeshletCullRepeats; i++)
+			{
+				rangeCount = CullMeshlets(meshlets, &viewProjection[0][0], &camera[0],
+					ranges.data(), (int)ranges.size(), &visibleMeshlets);
+			}
+			double cullTime = (GetTimeInSeconds() - startTime) / g_MeshletCullRepeats;
+
+			size_t visibleIndices = 0;
+			for (int r = 0; r < rangeCount; r++)
+			{
+				visibleIndices += ranges[r].indexCount;
+			}
+
+			std::cout << std::fixed << std::setprecision(1)
+				<< "  " << std::left << std::setw(17) << names[view] << std::right
+				<< std::setw(12) << 100.0 * visibleMeshlets / meshletCount
+				<< std::setw(12) << 100.0 * visibleIndices / data.indices.size()
+				<< std::setw(9) << rangeCount
+				<< std::setw(14) << cullTime * 1000000.0
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	/***********************************************************
+	 *  BenchmarkNormalGeneration()
+	 *
+	 *  This function is used for timing the normals of a torus
+	 *  of about a million triangles, added up one triangle at
+	 *  a time with glm as the importers used to and generated
+	 *  by GenerateNormals(), and its tangents, with the largest
+	 *  angles between the generated and the exact normals and
+	 *  between the tangents and their normal planes.
+	 ***********************************************************/
+	void BenchmarkNormalGeneration()
+	{
+		ShapeMeshes::MESH_DATA data;
+		ShapeMeshes::BuildTorusData(g_NormalTorusSegments, g_NormalTorusSegments / 2, 0.3f, data);
+		size_t vertexCount = data.verts.size() / 8;
+		size_t triangleCount = data.indices.size() / 3;
+
+		std::vector<glm::vec3> referenceNormals;
+		double startTime = GetTimeInSeconds();
+		for (int r = 0; r < g_NormalRepeats; r++)
+		{
+			referenceNormals.assign(vertexCount, glm::vec3(0.0f));
+			for (size_t i = 0; i < data.indices.size(); i += 3)
+			{
+				const GLuint* pTriangle = &data.indices[i];
+				glm::vec3 p0(data.verts[pTriangle[0] * 8], data.verts[pTriangle[0] * 8 + 1], data.verts[pTriangle[0] * 8 + 2]);
+				glm::vec3 p1(data.verts[pTriangle[1] * 8], data.verts[pTriangle[1] * 8 + 1], data.verts[pTriangle[1] * 8 + 2]);
+				glm::vec3 p2(data.verts[pTriangle[2] * 8], data.verts[pTriangle[2] * 8 + 1], data.verts[pTriangle[2] * 8 + 2]);
+				glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+				referenceNormals[pTriangle[0]] += faceNormal;
+				referenceNormals[pTriangle[1]] += faceNormal;
+				referenceNormals[pTriangle[2]] += faceNormal;
+			}
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				float length = glm::length(referenceNormals[v]);
+				referenceNormals[v] = (length > 0.0f) ? (referenceNormals[v] / length) : glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+		}
+		double referenceTime = (GetTimeInSeconds() - startTime) / g_NormalRepeats;
+
+		std::vector<float> normals(vertexCount * 3);
+		startTime = GetTimeInSeconds();
+		for (int r = 0; r < g_NormalRepeats; r++)
+		{
+			GenerateNormals(data.verts.data(), 8, vertexCount, data.indices.data(), data.indices.size(), normals.data(), 3);
+		}
+		double normalTime = (GetTimeInSeconds() - startTime) / g_NormalRepeats;
+
+		std::vector<float> tangents;
+		startTime = GetTimeInSeconds();
+		for (int r = 0; r < g_NormalRepeats; r++)
+		{
+			GenerateTangents(data.verts.data(), 8, vertexCount, data.indices.data(), data.indices.size(), 3, 6, tangents);
+		}
+		double tangentTime = (GetTimeInSeconds() - startTime) / g_NormalRepeats;
+
+		// the generated normals against the exact ones of the
+		// torus, and the tangents against the exact normals
+		float smallestNormalDot = 1.0f;
+		float largestReferenceDifference = 0.0f;
+		float largestTangentDot = 0.0f;
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			glm::vec3 exact(data.verts[v * 8 + 3], data.verts[v * 8 + 4], data.verts[v * 8 + 5]);
+			glm::vec3 normal(normals[v * 3], normals[v * 3 + 1], normals[v * 3 + 2]);
+			glm::vec3 tangent(tangents[v * 4], tangents[v * 4 + 1], tangents[v * 4 + 2]);
+			smallestNormalDot = std::min(smallestNormalDot, glm::dot(normal, exact));
+			largestReferenceDifference = std::max(largestReferenceDifference, glm::length(normal - referenceNormals[v]));
+			largestTangentDot = std::max(largestTangentDot, fabsf(glm::dot(tangent, exact)));
+		}
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< "INFO: normal-generation, torus of " << triangleCount << " triangles and "
+			<< vertexCount << " vertices, "
+			<< (IsMeshNormalsSimd() ? "AVX2 kernels" : "scalar kernels - build with AVX2 for the SIMD ones") << "\n"
+			<< "  glm per triangle          " << std::setw(9) << referenceTime * 1000.0 << " ms\n"
+			<< "  GenerateNormals()         " << std::setw(9) << normalTime * 1000.0 << " ms, "
+			<< referenceTime / normalTime << "x, largest difference " << largestReferenceDifference << "\n"
+			<< "  GenerateTangents()        " << std::setw(9) << tangentTime * 1000.0 << " ms\n"
+			<< "  largest normal error      " << std::setw(9)
+			<< glm::degrees(acosf(std::min(smallestNormalDot, 1.0f))) << " degrees\n"
+			<< "  largest tangent error     " << std::setw(9)
+			<< 90.0f - glm::degrees(acosf(std::min(largestTangentDot, 1.0f))) << " degrees"
+			<< std::defaultfloat << std::endl;
+	}
+
+	/***********************************************************
+	 *  GetTorusDistance()
+	 *
+	 *  This function is used for getting the distance of a
+	 *  point from the surface of a generated torus, whose main
+	 *  circle of radius 1 lies around the z axis.
+	 ***********************************************************/
+	float GetTorusDistance(const glm::vec3& point, float tubeRadius)
+	{
+		float ringDistance = sqrtf(point.x * point.x + point.y * point.y) - 1.0f;
+		return(fabsf(sqrtf(ringDistance * ringDistance + point.z * point.z) - tubeRadius));
+	}
+
+	/***********************************************************
+	 *  BenchmarkMeshSimplification()
+	 *
+	 *  This function is used for timing the detail levels of a
+	 *  dense torus built on one thread and on all of them, and
+	 *  for measuring how far the centers of the triangles of
+	 *  each level lie from the exact torus, next to the error
+	 *  the simplifier reports for the level.
+	 ***********************************************************/
+	void BenchmarkMeshSimplification()
+	{
+		const float tubeRadius = 0.3f;
+		OBJ_MESH_LEVELS single;
+		ShapeMeshes::BuildTorusData(g_SimplifyTorusSegments, g_SimplifyTorusSegments, tubeRadius, single.levels[0]);
+		OBJ_MESH_LEVELS parallel;
+		parallel.levels[0] = single.levels[0];
+
+		JobSystem singleThread(1);
+		JobSystem allThreads(0);
+		double startTime = GetTimeInSeconds();
+		BuildMeshLevels(&singleThread, single);
+		double singleTime = GetTimeInSeconds() - startTime;
+		startTime = GetTimeInSeconds();
+		BuildMeshLevels(&allThreads, parallel);
+		double parallelTime = GetTimeInSeconds() - startTime;
+
+		bool bSame = (single.levelCount == parallel.levelCount);
+		for (int lod = 1; (bSame == true) && (lod < single.levelCount); lod++)
+		{
+			bSame = (single.levels[lod].indices == parallel.levels[lod].indices);
+		}
+
+		std::cout << std::fixed << std::setprecision(4)
+			<< "INFO: mesh-simplification, torus of " << parallel.levels[0].indices.size() / 3 << " triangles\n"
+			<< "  1 thread:             " << std::setw(10) << singleTime * 1000.0 << " ms\n"
+			<< "  " << std::setw(2) << allThreads.GetThreadCount() << " threads:           " << std::setw(10)
+			<< parallelTime * 1000.0 << " ms, " << singleTime / parallelTime << "x"
+			<< (bSame ? "" : " - the levels differ") << "\n";
+		for (int lod = 0; lod < parallel.levelCount; lod++)
+		{
+			const ShapeMeshes::MESH_DATA& level = parallel.levels[lod];
+			float largestDistance = 0.0f;
+			for (size_t i = 0; i < level.indices.size(); i += 3)
+			{
+				glm::vec3 center(0.0f);
+				for (int corner = 0; corner < 3; corner++)
+				{
+					const float* pPosition = &level.verts[(size_t)level.indices[i + corner] * 8];
+					center += glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+				}
+				largestDistance = std::max(largestDistance, GetTorusDistance(center / 3.0f, tubeRadius));
+			}
+			std::cout << "  level " << lod << ": " << std::setw(8) << level.indices.size() / 3 << " triangles, "
+				<< std::setw(8) << level.verts.size() / 8 << " vertices, error " << parallel.errors[lod]
+				<< ", largest distance " << largestDistance << "\n";
+		}
+		std::cout << std::defaultfloat << std::flush;
+	}
+
+	// the available benchmarks
+	struct BENCHMARK
+	{
+		const char* name;
+		void (*function)();
+	};
+
+	const BENCHMARK g_Benchmarks[] = {
+		{ "transforms", BenchmarkTransforms },
+		{ "transform-batch", BenchmarkTransformBatch },
+		{ "job-scaling", BenchmarkJobScaling },
+		{ "scene-load", BenchmarkSceneLoad },
+		{ "transparency-sort", BenchmarkTransparencySort },
+		{ "mesh-generation", BenchmarkMeshGeneration },
+		{ "mesh-optimization", BenchmarkMeshOptimization },
+		{ "vertex-packing", BenchmarkVertexPacking },
+		{ "obj-import", BenchmarkObjImport },
+		{ "gltf-import", BenchmarkGltfImport },
+		{ "meshlet-culling", BenchmarkMeshletCulling },
+		{ "normal-generation", BenchmarkNormalGeneration },
+		{ "mesh-simplification", BenchmarkMeshSimplification }
+	};
+	const int g_BenchmarkCount = sizeof(g_Benchmarks) / sizeof(g_Benchmarks[0]);
+}
+
+/***********************************************************
+ *  RunBenchmark()
+ *
+ *  This function is used for running the benchmark with the
+ *  passed in name, or all of the benchmarks for "all".
+ ***********************************************************/
+bool RunBenchmark(const char* name)
+{
+	bool bFound = false;
+
+	for (int i = 0; i < g_BenchmarkCount; i++)
+	{
+		if ((strcmp(name, "all") == 0) || (strcmp(name, g_Benchmarks[i].name) == 0))
+		{
+			g_Benchmarks[i].function();
+			bFound = true;
+		}
+	}
+
+	return(bFound);
+}
+
+/***********************************************************
+ *  PrintBenchmarkNames()
+ *
+ *  This function is used for printing the names of the
+ *  available benchmarks.
+ ***********************************************************/
+void PrintBenchmarkNames()
+{
+	std::cout << "Benchmarks: all";
+	for (int i = 0; i < g_BenchmarkCount; i++)
+	{
+		std::cout << ", " << g_Benchmarks[i].name;
+	}
+	std::cout << std::endl;
+}
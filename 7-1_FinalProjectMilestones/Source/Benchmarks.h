@@ -0,0 +1,18 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarks.h
+// ============
+// console microbenchmarks for the CPU side of the renderer
+//
+//  The benchmarks are started from the command line with
+//  --benchmark <name>, run without creating a window, print their
+//  results to the console and then exit the program.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// run the named benchmark, or all of them for "all" - returns
+// false if there is no benchmark with the passed in name
+bool RunBenchmark(const char* name);
+
+// print the names of the available benchmarks
+void PrintBenchmarkNames();
@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandbuffer.cpp
+// ============
+// draw commands recorded on any thread and replayed on the GL thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CommandBuffer.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for removing all the packets, so the
+ *  buffer can be recorded again without reallocating.
+ ***********************************************************/
+void CommandBuffer::Reset()
+{
+	m_packets.clear();
+	m_data.clear();
+}
+
+/***********************************************************
+ *  BeginPacket()
+ *
+ *  This method is used for starting a new packet with the
+ *  passed in sort key at the end of the buffer.
+ ***********************************************************/
+void CommandBuffer::BeginPacket(uint64_t sortKey)
+{
+	PACKET packet;
+	packet.sortKey = sortKey;
+	packet.offset = (uint32_t)m_data.size();
+	packet.size = 0;
+	m_packets.push_back(packet);
+}
+
+/***********************************************************
+ *  SortPackets()
+ *
+ *  This method is used for sorting the packets by their
+ *  keys.  Only the small packet records move, the commands
+ *  stay where they were recorded.
+ ***********************************************************/
+void CommandBuffer::SortPackets()
+{
+	std::stable_sort(m_packets.begin(), m_packets.end(),
+		[](const PACKET& a, const PACKET& b) { return(a.sortKey < b.sortKey); });
+}
+
+/***********************************************************
+ *  CommandQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CommandQueue::CommandQueue(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_buffers.resize((NULL != pJobSystem) ? pJobSystem->GetThreadCount() : 1);
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for removing the packets of all the
+ *  buffers before a new frame is recorded.
+ ***********************************************************/
+void CommandQueue::Reset()
+{
+	for (size_t i = 0; i < m_buffers.size(); i++)
+	{
+		m_buffers[i].Reset();
+	}
+	m_order.clear();
+}
+
+/***********************************************************
+ *  GetBuffer()
+ *
+ *  This method is used for getting the buffer of the
+ *  calling thread, which no other thread writes to.
+ ***********************************************************/
+CommandBuffer& CommandQueue::GetBuffer()
+{
+	int index = (NULL != m_pJobSystem) ? m_pJobSystem->GetThreadIndex() : 0;
+	return(m_buffers[index]);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for sorting the packets of every
+ *  buffer, in parallel, and then merging the sorted buffers
+ *  into a single order.  Packets with the same key keep the
+ *  order of the buffers they came from.
+ ***********************************************************/
+void CommandQueue::Sort()
+{
+	if (NULL != m_pJobSystem)
+	{
+		m_pJobSystem->ParallelFor((int)m_buffers.size(), 1, [this](int first, int last) {
+			for (int i = first; i < last; i++)
+			{
+				m_buffers[i].SortPackets();
+			}
+		});
+	}
+	else
+	{
+		for (size_t i = 0; i < m_buffers.size(); i++)
+		{
+			m_buffers[i].SortPackets();
+		}
+	}
+
+	// merge through a heap of the next packet of every buffer
+	size_t packetCount = 0;
+	std::vector<PACKET_REFERENCE> heads;
+	for (size_t i = 0; i < m_buffers.size(); i++)
+	{
+		packetCount += m_buffers[i].GetPacketCount();
+		if (m_buffers[i].GetPacketCount() > 0)
+		{
+			PACKET_REFERENCE head;
+			head.sortKey = m_buffers[i].GetPacket(0).sortKey;
+			head.buffer = (int)i;
+			head.packet = 0;
+			heads.push_back(head);
+		}
+	}
+
+	// the heap keeps the smallest key, then the lowest buffer, on top
+	auto isAfter = [](const PACKET_REFERENCE& a, const PACKET_REFERENCE& b) {
+		return((a.sortKey > b.sortKey) || ((a.sortKey == b.sortKey) && (a.buffer > b.buffer)));
+	};
+	std::make_heap(heads.begin(), heads.end(), isAfter);
+
+	m_order.clear();
+	m_order.reserve(packetCount);
+	while (heads.empty() == false)
+	{
+		std::pop_heap(heads.begin(), heads.end(), isAfter);
+		PACKET_REFERENCE& head = heads.back();
+		m_order.push_back(head);
+
+		const CommandBuffer& buffer = m_buffers[head.buffer];
+		if (head.packet + 1 < buffer.GetPacketCount())
+		{
+			head.packet++;
+			head.sortKey = buffer.GetPacket(head.packet).sortKey;
+			std::push_heap(heads.begin(), heads.end(), isAfter);
+		}
+		else
+		{
+			heads.pop_back();
+		}
+	}
+}
+
+/***********************************************************
+ *  GetPacketCommands()
+ *
+ *  This method is used for getting the start and size of
+ *  the commands of a packet in the merged order.
+ ***********************************************************/
+const unsigned char* CommandQueue::GetPacketCommands(int position, uint32_t& size) const
+{
+	const PACKET_REFERENCE& reference = m_order[position];
+	const CommandBuffer& buffer = m_buffers[reference.buffer];
+	const CommandBuffer::PACKET& packet = buffer.GetPacket(reference.packet);
+
+	size = packet.size;
+	return(buffer.GetData() + packet.offset);
+}
+
+/***********************************************************
+ *  ReadCommand()
+ *
+ *  This method is used for reading the header of the next
+ *  command of a packet and finding its payload.
+ ***********************************************************/
+bool CommandQueue::ReadCommand(
+	const unsigned char* pCommands,
+	uint32_t size,
+	uint32_t& position,
+	RenderCommandType& type,
+	const unsigned char*& pPayload)
+{
+	CommandBuffer::COMMAND_HEADER header;
+
+	if (position + sizeof(header) > size)
+	{
+		return(false);
+	}
+
+	memcpy(&header, pCommands + position, sizeof(header));
+	type = (RenderCommandType)header.type;
+	pPayload = pCommands + position + sizeof(header);
+	position += (uint32_t)(sizeof(header) + header.size);
+	return(true);
+}
@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandbuffer.h
+// ============
+// draw commands recorded on any thread and replayed on the GL thread
+//
+//  Building the draws of a frame does not need the OpenGL context, only
+//  submitting them does.  Every draw is recorded as a packet: a 64-bit
+//  sort key followed by a few commands, each a small header and a plain
+//  data payload, written back to back into a linear buffer.  The commands
+//  describe what to draw rather than how, so they do not depend on the
+//  graphics API.  Every job system thread records into its own buffer,
+//  without locks, and the buffers are then sorted and merged into one
+//  order by key, which the GL thread replays.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// kinds of recorded commands
+enum RenderCommandType
+{
+	// use a shader program - the payload is the program ID
+	COMMAND_BIND_PROGRAM,
+	// set the per-draw shader values - the payload is DRAW_DATA
+	COMMAND_SET_DRAW_DATA,
+	// bind the buffers of a stored mesh and draw it - the
+	// payload is DRAW_SHAPE_DATA
+	COMMAND_DRAW_SHAPE,
+	// draw only the passed in index ranges of the mesh of the
+	// next COMMAND_DRAW_SHAPE - the payload is the number of
+	// ranges followed by the MESHLET_RANGE of each
+	COMMAND_SET_INDEX_RANGES
+};
+
+/***********************************************************
+ *  DRAW_DATA
+ *
+ *  This structure contains the shader values that can
+ *  change from one draw to the next.
+ ***********************************************************/
+struct DRAW_DATA
+{
+	glm::mat4 modelMatrix;
+	glm::vec4 color;
+	glm::vec2 uvScale;
+	// texture slot, or -1 to use the color
+	int textureSlot;
+	// index of the object material, or -1 for none
+	int materialIndex;
+};
+
+/***********************************************************
+ *  DRAW_SHAPE_DATA
+ *
+ *  This structure contains the mesh handle of a draw and
+ *  the bounding box used for its GPU occlusion query.
+ ***********************************************************/
+struct DRAW_SHAPE_DATA
+{
+	uint32_t mesh;
+	int lod;
+	int objectIndex;
+	// wrap the draw in an occlusion query when they are enabled
+	bool bOcclusionQuery;
+	// blended over the objects behind it
+	bool bTransparent;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+// bit of the sort key that puts the translucent draws after all
+// the opaque ones
+const uint64_t SORT_KEY_TRANSLUCENT = (uint64_t)1 << 62;
+
+/***********************************************************
+ *  GetStateSortKey()
+ *
+ *  This function is used for building the sort key of a
+ *  draw that groups the draws by program, texture, material
+ *  and mesh, so the replay changes as few shader values as
+ *  possible.  The mesh handle keeps 13 bits, so the draws
+ *  of the first 8192 meshes are grouped exactly, and the
+ *  object index the low 24 bits.
+ ***********************************************************/
+inline uint64_t GetStateSortKey(
+	unsigned int programID,
+	int textureSlot,
+	int materialIndex,
+	uint32_t mesh,
+	int lod,
+	int objectIndex)
+{
+	return(
+		((uint64_t)(programID & 0x3F) << 56) |
+		((uint64_t)((textureSlot + 1) & 0xFF) << 48) |
+		((uint64_t)((materialIndex + 1) & 0xFF) << 40) |
+		((uint64_t)(((mesh << 3) | lod) & 0xFFFF) << 24) |
+		((uint32_t)objectIndex & 0xFFFFFF));
+}
+
+/***********************************************************
+ *  GetBackToFrontSortKey()
+ *
+ *  This function is used for building the sort key of a
+ *  translucent draw that puts the draws farthest from the
+ *  camera first.  The bits of a positive float sort in the
+ *  same order as its value, so the top 30 of them are used
+ *  as they are.
+ ***********************************************************/
+inline uint64_t GetBackToFrontSortKey(
+	float distance,
+	int objectIndex)
+{
+	uint32_t bits = 0;
+	distance = (distance > 0.0f) ? distance : 0.0f;
+	memcpy(&bits, &distance, sizeof(bits));
+	return(SORT_KEY_TRANSLUCENT | ((uint64_t)(0x3FFFFFFF - (bits >> 2)) << 32) | (uint32_t)objectIndex);
+}
+
+/***********************************************************
+ *  CommandBuffer
+ *
+ *  This class contains the packets of commands recorded by
+ *  one thread.
+ ***********************************************************/
+class CommandBuffer
+{
+public:
+	// a recorded packet and the range of its commands
+	struct PACKET
+	{
+		uint64_t sortKey;
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	// header in front of the payload of every command
+	struct COMMAND_HEADER
+	{
+		uint16_t type;
+		uint16_t size;
+	};
+
+	// remove all the recorded packets, keeping the memory
+	void Reset();
+
+	// start a new packet - the commands written until the next
+	// packet is started belong to it
+	void BeginPacket(uint64_t sortKey);
+	// add a command with the passed in payload to the packet
+	template<class T>
+	void Write(RenderCommandType type, const T& payload);
+	// add a command whose payload is the number of items followed
+	// by the items, which must fit in 64 KB
+	template<class T>
+	void WriteArray(RenderCommandType type, const T* pItems, uint32_t count);
+
+	// sort the packets by key, keeping the recording order of
+	// packets with the same key
+	void SortPackets();
+
+	int GetPacketCount() const { return((int)m_packets.size()); }
+	const PACKET& GetPacket(int index) const { return(m_packets[index]); }
+	const unsigned char* GetData() const { return(m_data.data()); }
+
+private:
+	std::vector<PACKET> m_packets;
+	std::vector<unsigned char> m_data;
+};
+
+/***********************************************************
+ *  CommandQueue
+ *
+ *  This class contains one command buffer for every job
+ *  system thread and the merged order of their packets.
+ ***********************************************************/
+class CommandQueue
+{
+public:
+	// constructor
+	CommandQueue(JobSystem* pJobSystem);
+
+	// remove the packets of all the buffers
+	void Reset();
+	// the buffer that the calling thread records into
+	CommandBuffer& GetBuffer();
+
+	// sort every buffer and merge them into one order by key
+	void Sort();
+
+	// number of packets in the merged order
+	int GetPacketCount() const { return((int)m_order.size()); }
+	// get the commands of the packet at the passed in position
+	// of the merged order
+	const unsigned char* GetPacketCommands(int position, uint32_t& size) const;
+
+	// read the command at the passed in position of a packet and
+	// advance the position past it - false at the end
+	static bool ReadCommand(
+		const unsigned char* pCommands,
+		uint32_t size,
+		uint32_t& position,
+		RenderCommandType& type,
+		const unsigned char*& pPayload);
+
+private:
+	// a packet of one of the buffers
+	struct PACKET_REFERENCE
+	{
+		uint64_t sortKey;
+		int buffer;
+		int packet;
+	};
+
+	JobSystem* m_pJobSystem;
+	std::vector<CommandBuffer> m_buffers;
+	std::vector<PACKET_REFERENCE> m_order;
+};
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for appending a command header and
+ *  a copy of its payload to the current packet.
+ ***********************************************************/
+template<class T>
+void CommandBuffer::Write(RenderCommandType type, const T& payload)
+{
+	COMMAND_HEADER header;
+	header.type = (uint16_t)type;
+	header.size = (uint16_t)sizeof(T);
+
+	size_t offset = m_data.size();
+	m_data.resize(offset + sizeof(header) + sizeof(T));
+	memcpy(&m_data[offset], &header, sizeof(header));
+	memcpy(&m_data[offset + sizeof(header)], &payload, sizeof(T));
+
+	if (m_packets.empty() == false)
+	{
+		m_packets.back().size += (uint32_t)(sizeof(header) + sizeof(T));
+	}
+}
+
+/***********************************************************
+ *  WriteArray()
+ *
+ *  This method is used for appending a command header, the
+ *  number of items and a copy of the items to the current
+ *  packet.
+ ***********************************************************/
+template<class T>
+void CommandBuffer::WriteArray(RenderCommandType type, const T* pItems, uint32_t count)
+{
+	COMMAND_HEADER header;
+	size_t size = sizeof(count) + sizeof(T) * count;
+	header.type = (uint16_t)type;
+	header.size = (uint16_t)size;
+
+	size_t offset = m_data.size();
+	m_data.resize(offset + sizeof(header) + size);
+	memcpy(&m_data[offset], &header, sizeof(header));
+	memcpy(&m_data[offset + sizeof(header)], &count, sizeof(count));
+	memcpy(&m_data[offset + sizeof(header) + sizeof(count)], pItems, sizeof(T) * count);
+
+	if (m_packets.empty() == false)
+	{
+		m_packets.back().size += (uint32_t)(sizeof(header) + size);
+	}
+}
@@ -0,0 +1,450 @@
+///////////////////////////////////////////////////////////////////////////////
+// depthrasterizer.cpp
+// ============
+// CPU occlusion culling with a small SIMD depth-only rasterizer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DepthRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DEPTH_RASTERIZER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define DEPTH_RASTERIZER_SSE2
+#endif
+
+// declaration of global variables
+namespace
+{
+	// smallest clip-space w accepted in front of the camera
+	const float g_MinClipW = 0.0001f;
+
+	// corner order of the 12 triangles of an occluder box,
+	// where bit 0 selects max x, bit 1 max y and bit 2 max z
+	const int g_BoxTriangleCorners[36] = {
+		0, 2, 3,	0, 3, 1,	// -z face
+		4, 5, 7,	4, 7, 6,	// +z face
+		0, 4, 6,	0, 6, 2,	// -x face
+		1, 3, 7,	1, 7, 5,	// +x face
+		0, 1, 5,	0, 5, 4,	// -y face
+		2, 6, 7,	2, 7, 3		// +y face
+	};
+
+	// get one of the 8 corners of a bounding box
+	glm::vec3 GetBoxCorner(const glm::vec3& boxMin, const glm::vec3& boxMax, int corner)
+	{
+		return(glm::vec3(
+			(corner & 1) ? boxMax.x : boxMin.x,
+			(corner & 2) ? boxMax.y : boxMin.y,
+			(corner & 4) ? boxMax.z : boxMin.z));
+	}
+
+#if defined(DEPTH_RASTERIZER_AVX2)
+	// multiply and add 8 lanes, fused when the compiler targets FMA
+	inline __m256 MultiplyAdd(__m256 a, __m256 b, __m256 c)
+	{
+#if defined(__FMA__) || defined(_MSC_VER)
+		return(_mm256_fmadd_ps(a, b, c));
+#else
+		return(_mm256_add_ps(_mm256_mul_ps(a, b), c));
+#endif
+	}
+#endif
+}
+
+/***********************************************************
+ *  DepthRasterizer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DepthRasterizer::DepthRasterizer(int width, int height, JobSystem* pJobSystem)
+{
+	m_width = ((std::max(width, 1) + TILE_SIZE - 1) / TILE_SIZE) * TILE_SIZE;
+	m_height = ((std::max(height, 1) + TILE_SIZE - 1) / TILE_SIZE) * TILE_SIZE;
+	m_tilesX = m_width / TILE_SIZE;
+	m_tilesY = m_height / TILE_SIZE;
+	m_depth.assign(m_width * m_height, 1.0f);
+	m_tileMaxDepth.assign(m_tilesX * m_tilesY, 1.0f);
+	m_viewProjection = glm::mat4(1.0f);
+
+	// a couple of bands of whole tile rows for every thread, so
+	// a thread whose bands are cheap can take over another band
+	m_pJobSystem = pJobSystem;
+	m_bandCount = (NULL != pJobSystem) ? std::min(pJobSystem->GetThreadCount() * 2, m_tilesY) : 1;
+}
+
+/***********************************************************
+ *  ClearOccluders()
+ *
+ *  This method is used for removing all the occluders, so
+ *  the next rasterization leaves the depth buffer empty.
+ ***********************************************************/
+void DepthRasterizer::ClearOccluders()
+{
+	m_occluderVertices.clear();
+}
+
+/***********************************************************
+ *  AddOccluder()
+ *
+ *  This method is used for adding an occluder box, which is
+ *  transformed into world space with the passed in model
+ *  matrix and stored as 12 triangles.
+ ***********************************************************/
+void DepthRasterizer::AddOccluder(
+	const glm::mat4& model,
+	const glm::vec3& boxMin,
+	const glm::vec3& boxMax)
+{
+	glm::vec3 corners[8];
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner = model * glm::vec4(GetBoxCorner(boxMin, boxMax, i), 1.0f);
+		corners[i] = glm::vec3(corner.x, corner.y, corner.z);
+	}
+
+	for (int i = 0; i < 36; i++)
+	{
+		m_occluderVertices.push_back(corners[g_BoxTriangleCorners[i]]);
+	}
+}
+
+/***********************************************************
+ *  Rasterize()
+ *
+ *  This method is used for drawing all the occluders into
+ *  the depth buffer with the passed in view and projection.
+ *  The bands of rows are rasterized as parallel jobs, and
+ *  the calling thread helps until all of them are done.
+ ***********************************************************/
+void DepthRasterizer::Rasterize(const glm::mat4& viewProjection)
+{
+	m_viewProjection = viewProjection;
+	SetupTriangles();
+
+	if (NULL == m_pJobSystem)
+	{
+		RasterizeBand(0);
+		return;
+	}
+
+	m_pJobSystem->ParallelFor(m_bandCount, 1, [this](int first, int last) {
+		for (int band = first; band < last; band++)
+		{
+			RasterizeBand(band);
+		}
+	});
+}
+
+/***********************************************************
+ *  SetupTriangles()
+ *
+ *  This method is used for projecting the occluder triangles
+ *  into screen space.  Triangles that cross the near plane
+ *  are dropped rather than clipped, which only ever makes
+ *  the culling less aggressive.
+ ***********************************************************/
+void DepthRasterizer::SetupTriangles()
+{
+	m_triangles.clear();
+
+	for (size_t i = 0; i + 2 < m_occluderVertices.size(); i += 3)
+	{
+		SCREEN_TRIANGLE triangle;
+		bool bVisible = true;
+		float minX = FLT_MAX;
+		float maxX = -FLT_MAX;
+		float minY = FLT_MAX;
+		float maxY = -FLT_MAX;
+
+		for (int v = 0; v < 3; v++)
+		{
+			glm::vec4 clip = m_viewProjection * glm::vec4(m_occluderVertices[i + v], 1.0f);
+			if ((clip.w <= g_MinClipW) || (clip.z < -clip.w))
+			{
+				bVisible = false;
+				break;
+			}
+
+			// convert to pixels, with row 0 at the top of the screen,
+			// and to a depth of 0 at the near and 1 at the far plane
+			float invW = 1.0f / clip.w;
+			triangle.v[v].x = (clip.x * invW * 0.5f + 0.5f) * m_width;
+			triangle.v[v].y = (0.5f - clip.y * invW * 0.5f) * m_height;
+			triangle.v[v].z = clip.z * invW * 0.5f + 0.5f;
+
+			minX = std::min(minX, triangle.v[v].x);
+			maxX = std::max(maxX, triangle.v[v].x);
+			minY = std::min(minY, triangle.v[v].y);
+			maxY = std::max(maxY, triangle.v[v].y);
+		}
+
+		// skip the triangles that are off the screen or seen edge on
+		if ((bVisible == false) ||
+			(maxX < 0.0f) || (minX > m_width) || (maxY < 0.0f) || (minY > m_height))
+		{
+			continue;
+		}
+
+		float area =
+			(triangle.v[1].x - triangle.v[0].x) * (triangle.v[2].y - triangle.v[0].y) -
+			(triangle.v[1].y - triangle.v[0].y) * (triangle.v[2].x - triangle.v[0].x);
+		if (std::fabs(area) < 0.0001f)
+		{
+			continue;
+		}
+
+		// store every triangle with the same winding, so the edge
+		// functions are positive inside all of them
+		if (area < 0.0f)
+		{
+			std::swap(triangle.v[1], triangle.v[2]);
+		}
+
+		m_triangles.push_back(triangle);
+	}
+}
+
+/***********************************************************
+ *  RasterizeBand()
+ *
+ *  This method is used for clearing the passed in band of
+ *  rows, drawing every triangle into it, and updating the
+ *  farthest depth of each of its tiles.
+ ***********************************************************/
+void DepthRasterizer::RasterizeBand(int band)
+{
+	int tileRowsPerBand = (m_tilesY + m_bandCount - 1) / m_bandCount;
+	int firstTileRow = band * tileRowsPerBand;
+	int lastTileRow = std::min(firstTileRow + tileRowsPerBand, m_tilesY);
+	if (firstTileRow >= lastTileRow)
+	{
+		return;
+	}
+
+	int firstRow = firstTileRow * TILE_SIZE;
+	int lastRow = lastTileRow * TILE_SIZE;
+
+	std::fill(m_depth.begin() + firstRow * m_width, m_depth.begin() + lastRow * m_width, 1.0f);
+
+	for (size_t i = 0; i < m_triangles.size(); i++)
+	{
+		RasterizeTriangle(m_triangles[i], firstRow, lastRow);
+	}
+
+	// reduce the band to the farthest depth of each tile
+	for (int tileY = firstTileRow; tileY < lastTileRow; tileY++)
+	{
+		for (int tileX = 0; tileX < m_tilesX; tileX++)
+		{
+			float maxDepth = 0.0f;
+			for (int y = 0; y < TILE_SIZE; y++)
+			{
+				const float* row = &m_depth[(tileY * TILE_SIZE + y) * m_width + tileX * TILE_SIZE];
+				for (int x = 0; x < TILE_SIZE; x++)
+				{
+					maxDepth = std::max(maxDepth, row[x]);
+				}
+			}
+			m_tileMaxDepth[tileY * m_tilesX + tileX] = maxDepth;
+		}
+	}
+}
+
+/***********************************************************
+ *  RasterizeTriangle()
+ *
+ *  This method is used for drawing one triangle into the
+ *  rows of the depth buffer between the passed in limits,
+ *  keeping the nearest depth at every covered pixel center.
+ ***********************************************************/
+void DepthRasterizer::RasterizeTriangle(
+	const SCREEN_TRIANGLE& triangle,
+	int firstRow,
+	int lastRow)
+{
+	const glm::vec3& v0 = triangle.v[0];
+	const glm::vec3& v1 = triangle.v[1];
+	const glm::vec3& v2 = triangle.v[2];
+
+	// bounding rectangle of the pixel centers inside the triangle
+	int minX = std::max((int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))), 0);
+	int maxX = std::min((int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))), m_width - 1);
+	int minY = std::max((int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))), firstRow);
+	int maxY = std::min((int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))), lastRow - 1);
+	if ((minX > maxX) || (minY > maxY))
+	{
+		return;
+	}
+
+	// edge functions e = a * x + b * y + c, which are positive
+	// on the inner side of each edge
+	float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v1.y * v2.x;
+	float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v2.y * v0.x;
+	float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v0.y * v1.x;
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+
+	// the projected depth is linear in screen space, so it can be
+	// written as a plane z = zA * x + zB * y + zC
+	float invArea = 1.0f / area;
+	float zA = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * invArea;
+	float zB = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * invArea;
+	float zC = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * invArea;
+
+#if defined(DEPTH_RASTERIZER_AVX2)
+	const int LANES = 8;
+	const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 vA0 = _mm256_set1_ps(a0), vA1 = _mm256_set1_ps(a1), vA2 = _mm256_set1_ps(a2);
+	const __m256 vZA = _mm256_set1_ps(zA);
+#elif defined(DEPTH_RASTERIZER_SSE2)
+	const int LANES = 4;
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 vA0 = _mm_set1_ps(a0), vA1 = _mm_set1_ps(a1), vA2 = _mm_set1_ps(a2);
+	const __m128 vZA = _mm_set1_ps(zA);
+#else
+	const int LANES = 1;
+#endif
+
+	// the width is a multiple of the tile size, so whole groups
+	// of lanes never run past the end of a row
+	int startX = minX - (minX % LANES);
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		float py = (float)y + 0.5f;
+		float rowE0 = b0 * py + c0;
+		float rowE1 = b1 * py + c1;
+		float rowE2 = b2 * py + c2;
+		float rowZ = zB * py + zC;
+		float* row = &m_depth[y * m_width];
+
+#if defined(DEPTH_RASTERIZER_AVX2)
+		const __m256 vRowE0 = _mm256_set1_ps(rowE0);
+		const __m256 vRowE1 = _mm256_set1_ps(rowE1);
+		const __m256 vRowE2 = _mm256_set1_ps(rowE2);
+		const __m256 vRowZ = _mm256_set1_ps(rowZ);
+
+		for (int x = startX; x <= maxX; x += LANES)
+		{
+			__m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), laneOffsets);
+			__m256 e0 = MultiplyAdd(vA0, px, vRowE0);
+			__m256 e1 = MultiplyAdd(vA1, px, vRowE1);
+			__m256 e2 = MultiplyAdd(vA2, px, vRowE2);
+			__m256 inside = _mm256_cmp_ps(
+				_mm256_min_ps(e0, _mm256_min_ps(e1, e2)), zero, _CMP_GE_OQ);
+			if (_mm256_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m256 z = MultiplyAdd(vZA, px, vRowZ);
+			__m256 depth = _mm256_loadu_ps(row + x);
+			__m256 nearest = _mm256_min_ps(depth, z);
+			_mm256_storeu_ps(row + x, _mm256_blendv_ps(depth, nearest, inside));
+		}
+#elif defined(DEPTH_RASTERIZER_SSE2)
+		const __m128 vRowE0 = _mm_set1_ps(rowE0);
+		const __m128 vRowE1 = _mm_set1_ps(rowE1);
+		const __m128 vRowE2 = _mm_set1_ps(rowE2);
+		const __m128 vRowZ = _mm_set1_ps(rowZ);
+
+		for (int x = startX; x <= maxX; x += LANES)
+		{
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(vA0, px), vRowE0);
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(vA1, px), vRowE1);
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(vA2, px), vRowE2);
+			__m128 inside = _mm_cmpge_ps(_mm_min_ps(e0, _mm_min_ps(e1, e2)), zero);
+			if (_mm_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 z = _mm_add_ps(_mm_mul_ps(vZA, px), vRowZ);
+			__m128 depth = _mm_loadu_ps(row + x);
+			__m128 nearest = _mm_min_ps(depth, z);
+			_mm_storeu_ps(row + x, _mm_or_ps(
+				_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth)));
+		}
+#else
+		for (int x = startX; x <= maxX; x++)
+		{
+			float px = (float)x + 0.5f;
+			if ((a0 * px + rowE0 >= 0.0f) && (a1 * px + rowE1 >= 0.0f) && (a2 * px + rowE2 >= 0.0f))
+			{
+				row[x] = std::min(row[x], zA * px + rowZ);
+			}
+		}
+#endif
+	}
+}
+
+/***********************************************************
+ *  IsVisible()
+ *
+ *  This method is used for testing the passed in bounding
+ *  box against the depth buffer.  The screen rectangle and
+ *  nearest depth of the box are compared with the farthest
+ *  depth of every tile they touch, and the box is hidden
+ *  only when it is behind all of them.
+ ***********************************************************/
+bool DepthRasterizer::IsVisible(
+	const glm::mat4& model,
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax) const
+{
+	glm::mat4 modelViewProjection = m_viewProjection * model;
+	float minX = FLT_MAX, maxX = -FLT_MAX;
+	float minY = FLT_MAX, maxY = -FLT_MAX;
+	float minZ = FLT_MAX;
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 clip = modelViewProjection * glm::vec4(GetBoxCorner(boundsMin, boundsMax, i), 1.0f);
+
+		// a box that reaches the camera plane is always drawn
+		if (clip.w <= g_MinClipW)
+		{
+			return(true);
+		}
+
+		float invW = 1.0f / clip.w;
+		minX = std::min(minX, clip.x * invW);
+		maxX = std::max(maxX, clip.x * invW);
+		minY = std::min(minY, clip.y * invW);
+		maxY = std::max(maxY, clip.y * invW);
+		minZ = std::min(minZ, clip.z * invW * 0.5f + 0.5f);
+	}
+
+	// outside the view volume
+	if ((maxX < -1.0f) || (minX > 1.0f) || (maxY < -1.0f) || (minY > 1.0f) || (minZ > 1.0f))
+	{
+		return(false);
+	}
+
+	int pixelMinX = std::max((int)std::floor((minX * 0.5f + 0.5f) * m_width), 0);
+	int pixelMaxX = std::min((int)std::floor((maxX * 0.5f + 0.5f) * m_width), m_width - 1);
+	int pixelMinY = std::max((int)std::floor((0.5f - maxY * 0.5f) * m_height), 0);
+	int pixelMaxY = std::min((int)std::floor((0.5f - minY * 0.5f) * m_height), m_height - 1);
+
+	for (int tileY = pixelMinY / TILE_SIZE; tileY <= pixelMaxY / TILE_SIZE; tileY++)
+	{
+		for (int tileX = pixelMinX / TILE_SIZE; tileX <= pixelMaxX / TILE_SIZE; tileX++)
+		{
+			if (minZ <= m_tileMaxDepth[tileY * m_tilesX + tileX])
+			{
+				return(true);
+			}
+		}
+	}
+
+	return(false);
+}
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// depthrasterizer.h
+// ============
+// CPU occlusion culling with a small SIMD depth-only rasterizer
+//
+//  A handful of large occluders are drawn as boxes into a low resolution
+//  depth buffer, and the screen-space bounds of every other object are
+//  tested against it before the object is submitted to the GPU.  The
+//  depth buffer is split into horizontal bands that are rasterized in
+//  parallel on the job system, and each band also keeps the farthest
+//  depth of every 8x8 tile, so an object test only has to read a few
+//  tiles.  The rasterizer does not use OpenGL, so it runs without a
+//  window or context.
+//
+//  The inner loops evaluate 8 pixels at a time with AVX2 when the
+//  compiler targets it (/arch:AVX2 or -mavx2), 4 pixels at a time with
+//  SSE2 otherwise, and fall back to scalar code on other processors.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  DepthRasterizer
+ *
+ *  This class contains the code for rasterizing the occluder
+ *  boxes and testing object bounds against the result.
+ ***********************************************************/
+class DepthRasterizer
+{
+public:
+	// constructor - the width is rounded up to a multiple of
+	// the tile size, as is the height, and the bands are
+	// rasterized on the calling thread without a job system
+	DepthRasterizer(int width, int height, JobSystem* pJobSystem);
+
+	// remove all the occluders
+	void ClearOccluders();
+	// add an occluder box, given in the object space of the
+	// passed in model matrix - the box must fit inside the
+	// visible surface of the object
+	void AddOccluder(
+		const glm::mat4& model,
+		const glm::vec3& boxMin,
+		const glm::vec3& boxMax);
+
+	// rasterize all the occluders with the passed in view and
+	// projection matrix on the job system, and wait for the
+	// depth buffer to be finished
+	void Rasterize(const glm::mat4& viewProjection);
+
+	// test whether any part of the passed in bounding box may be
+	// visible - returns false only when the box is outside the
+	// view or entirely behind the rasterized occluders
+	bool IsVisible(
+		const glm::mat4& model,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax) const;
+
+	// size of the depth buffer in pixels
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	// read a depth value, for debugging and validation
+	float GetDepth(int x, int y) const { return(m_depth[y * m_width + x]); }
+
+	// size of the square tiles in pixels
+	static const int TILE_SIZE = 8;
+
+private:
+	// screen-space triangle ready for rasterization
+	struct SCREEN_TRIANGLE
+	{
+		glm::vec3 v[3];
+	};
+
+	int m_width;
+	int m_height;
+	int m_tilesX;
+	int m_tilesY;
+	// depth buffer, with 0 at the near plane and 1 at the far plane
+	std::vector<float> m_depth;
+	// farthest depth in each tile
+	std::vector<float> m_tileMaxDepth;
+
+	// occluder triangles in world space
+	std::vector<glm::vec3> m_occluderVertices;
+	// occluder triangles transformed into screen space
+	std::vector<SCREEN_TRIANGLE> m_triangles;
+	// view and projection used for the last rasterization
+	glm::mat4 m_viewProjection;
+
+	// the bands of rows are rasterized as separate jobs
+	JobSystem* m_pJobSystem;
+	int m_bandCount;
+
+	// transform the occluders into screen space triangles
+	void SetupTriangles();
+	// clear, rasterize and reduce the passed in band of rows
+	void RasterizeBand(int band);
+	// rasterize one triangle, clipped to the passed in rows
+	void RasterizeTriangle(
+		const SCREEN_TRIANGLE& triangle,
+		int firstRow,
+		int lastRow);
+};
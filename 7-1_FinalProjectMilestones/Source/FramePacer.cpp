@@ -0,0 +1,313 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.cpp
+// ============
+// limit how many frames the CPU may run ahead of the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacer.h"
+
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+// declaration of global variables
+namespace
+{
+	// nanoseconds to wait for a fence before checking again
+	const GLuint64 g_FenceTimeout = 1000000;
+}
+
+/***********************************************************
+ *  FramePacer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePacer::FramePacer()
+{
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		m_fences[i] = 0;
+	}
+	m_framesInFlight = 2;
+	m_frameNumber = 0;
+
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		m_timestampQueries[i] = 0;
+		m_queryInputTimes[i] = 0.0;
+		m_queryPending[i] = false;
+	}
+	m_queryIndex = 0;
+	m_bMeasureLatency = false;
+	m_clockOffset = 0.0;
+	m_lastReportTime = 0.0;
+	ResetAverages();
+}
+
+/***********************************************************
+ *  ~FramePacer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FramePacer::~FramePacer()
+{
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		if (m_fences[i] != 0)
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = 0;
+		}
+	}
+	if (m_timestampQueries[0] != 0)
+	{
+		glDeleteQueries(QUERY_COUNT, m_timestampQueries);
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the timestamp queries
+ *  and measuring the offset between the clocks.
+ ***********************************************************/
+void FramePacer::Initialize()
+{
+	glGenQueries(QUERY_COUNT, m_timestampQueries);
+	CalibrateClock();
+	m_lastReportTime = glfwGetTime();
+}
+
+/***********************************************************
+ *  SetFramesInFlight()
+ *
+ *  This method is used for setting how many frames can be
+ *  in flight at once.  Lowering the count takes effect at
+ *  the next BeginFrame(), which waits for the extra frames.
+ ***********************************************************/
+void FramePacer::SetFramesInFlight(int count)
+{
+	m_framesInFlight = std::min(std::max(count, 1), (int)MAX_FRAMES_IN_FLIGHT);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for waiting until no more than the
+ *  chosen number of frames, counting the one about to be
+ *  built, are unfinished.  The fences of the frames that are
+ *  recent enough to keep running are left alone.
+ ***********************************************************/
+void FramePacer::BeginFrame()
+{
+	double waitStartTime = glfwGetTime();
+
+	for (int age = MAX_FRAMES_IN_FLIGHT; age >= m_framesInFlight; age--)
+	{
+		if (age > (int)m_frameNumber)
+		{
+			continue;
+		}
+		WaitForFence((m_frameNumber - age) % MAX_FRAMES_IN_FLIGHT);
+	}
+
+	m_totalWaitTime += (glfwGetTime() - waitStartTime) * 1000.0;
+	m_waitFrames++;
+
+	if (m_bMeasureLatency == true)
+	{
+		CollectLatencies();
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing the fence of the frame
+ *  after its buffer swap and, when measuring, a timestamp
+ *  query that records when the GPU finished the frame.
+ ***********************************************************/
+void FramePacer::EndFrame(double inputTime)
+{
+	int slot = m_frameNumber % MAX_FRAMES_IN_FLIGHT;
+	if (m_fences[slot] != 0)
+	{
+		glDeleteSync(m_fences[slot]);
+	}
+	m_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_frameNumber++;
+
+	// a query still in flight is never reused, the frame is
+	// simply not measured
+	if ((m_bMeasureLatency == true) && (m_timestampQueries[0] != 0) &&
+		(m_queryPending[m_queryIndex] == false))
+	{
+		glQueryCounter(m_timestampQueries[m_queryIndex], GL_TIMESTAMP);
+		m_queryInputTimes[m_queryIndex] = inputTime;
+		m_queryPending[m_queryIndex] = true;
+		m_queryIndex = (m_queryIndex + 1) % QUERY_COUNT;
+	}
+}
+
+/***********************************************************
+ *  SetMeasureLatency()
+ *
+ *  This method is used for turning the latency measurement
+ *  on or off.
+ ***********************************************************/
+void FramePacer::SetMeasureLatency(bool bMeasure)
+{
+	if (bMeasure == m_bMeasureLatency)
+	{
+		return;
+	}
+
+	m_bMeasureLatency = bMeasure;
+	if (m_bMeasureLatency == true)
+	{
+		CalibrateClock();
+		ResetAverages();
+	}
+	else
+	{
+		// the pending results are no longer needed
+		for (int i = 0; i < QUERY_COUNT; i++)
+		{
+			m_queryPending[i] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReportLatency()
+ *
+ *  This method is used for printing the average input to
+ *  photon time and the time spent waiting on the fences
+ *  since the last report, once the passed in number of
+ *  seconds has elapsed.
+ ***********************************************************/
+void FramePacer::ReportLatency(float interval)
+{
+	double currentTime = glfwGetTime();
+	if ((currentTime - m_lastReportTime) < interval)
+	{
+		return;
+	}
+
+	std::cout << std::fixed << std::setprecision(3) << "INFO: " << m_framesInFlight
+		<< " frame(s) in flight, fence wait "
+		<< ((m_waitFrames > 0) ? (m_totalWaitTime / m_waitFrames) : 0.0) << " ms";
+	if ((m_bMeasureLatency == true) && (m_latencyFrames > 0))
+	{
+		std::cout << ", input to photon " << (m_totalLatency / m_latencyFrames)
+			<< " ms (min " << m_minimumLatency << ", max " << m_maximumLatency << ")";
+	}
+	std::cout << std::defaultfloat << std::endl;
+
+	// the clocks drift apart slowly, so they are matched again
+	// for the next interval
+	if (m_bMeasureLatency == true)
+	{
+		CalibrateClock();
+	}
+
+	m_lastReportTime = currentTime;
+	ResetAverages();
+}
+
+/***********************************************************
+ *  WaitForFence()
+ *
+ *  This method is used for waiting on the fence in the
+ *  passed in slot, flushing the commands before the first
+ *  wait so the fence is sure to be reached.
+ ***********************************************************/
+void FramePacer::WaitForFence(int slot)
+{
+	if (m_fences[slot] == 0)
+	{
+		return;
+	}
+
+	GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true)
+	{
+		GLenum result = glClientWaitSync(m_fences[slot], waitFlags, g_FenceTimeout);
+		if ((result == GL_ALREADY_SIGNALED) || (result == GL_CONDITION_SATISFIED) || (result == GL_WAIT_FAILED))
+		{
+			break;
+		}
+		waitFlags = 0;
+	}
+
+	glDeleteSync(m_fences[slot]);
+	m_fences[slot] = 0;
+}
+
+/***********************************************************
+ *  CollectLatencies()
+ *
+ *  This method is used for reading the results of the
+ *  timestamp queries that the GPU has finished, without
+ *  waiting for the ones that are still in flight.  The GPU
+ *  finishing the frame after its swap is taken as the
+ *  photon time - the display may show it up to one refresh
+ *  later when vertical sync is on.
+ ***********************************************************/
+void FramePacer::CollectLatencies()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		if (m_queryPending[i] == false)
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_timestampQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available != 0)
+		{
+			GLuint64 timestamp = 0;
+			glGetQueryObjectui64v(m_timestampQueries[i], GL_QUERY_RESULT, &timestamp);
+
+			double photonTime = (double)timestamp / 1000000000.0 + m_clockOffset;
+			double latency = (photonTime - m_queryInputTimes[i]) * 1000.0;
+			m_totalLatency += latency;
+			m_minimumLatency = std::min(m_minimumLatency, latency);
+			m_maximumLatency = std::max(m_maximumLatency, latency);
+			m_latencyFrames++;
+			m_queryPending[i] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  CalibrateClock()
+ *
+ *  This method is used for reading the GPU clock and the
+ *  CPU clock at the same moment, to convert the timestamp
+ *  query results into CPU times.
+ ***********************************************************/
+void FramePacer::CalibrateClock()
+{
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	m_clockOffset = glfwGetTime() - (double)gpuTime / 1000000000.0;
+}
+
+/***********************************************************
+ *  ResetAverages()
+ *
+ *  This method is used for clearing the accumulated times.
+ ***********************************************************/
+void FramePacer::ResetAverages()
+{
+	m_totalLatency = 0.0;
+	m_minimumLatency = 1.0e9;
+	m_maximumLatency = 0.0;
+	m_totalWaitTime = 0.0;
+	m_latencyFrames = 0;
+	m_waitFrames = 0;
+}
@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.h
+// ============
+// limit how many frames the CPU may run ahead of the GPU
+//
+//  A fence is placed after the buffer swap of every frame.  Before the CPU
+//  starts on a new frame it waits for the fence of the frame that is the
+//  chosen number of frames older, so with one frame in flight the CPU
+//  work never overlaps the GPU work of the previous frame (lowest
+//  latency), and with two or three the CPU builds the next frame while
+//  the GPU is still drawing the earlier ones (highest throughput).  The
+//  input is read after this wait, as late as possible.  In the latency
+//  measurement mode a GL_TIMESTAMP query after each swap gives the time
+//  the GPU finished the frame, which is converted to the CPU clock and
+//  compared with the time its input was read.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  FramePacer
+ *
+ *  This class contains the code for pacing the frames with
+ *  fences and measuring the time from input to photon.
+ ***********************************************************/
+class FramePacer
+{
+public:
+	// constructor
+	FramePacer();
+	// destructor
+	~FramePacer();
+
+	// most frames that can be in flight at once
+	static const int MAX_FRAMES_IN_FLIGHT = 3;
+
+	// create the timestamp queries and match the GPU clock
+	// to the CPU clock
+	void Initialize();
+
+	// set the number of frames in flight, from 1 to 3
+	void SetFramesInFlight(int count);
+	int GetFramesInFlight() const { return(m_framesInFlight); }
+
+	// wait until the GPU has finished the frames that are too
+	// old to overlap the next one - the input of the frame
+	// should be read right after this returns
+	void BeginFrame();
+	// place the fence of the frame - called after the buffers
+	// are swapped, with the time the frame's input was read
+	void EndFrame(double inputTime);
+
+	// turn the input to photon measurement on or off
+	void SetMeasureLatency(bool bMeasure);
+
+	// print the measured latencies to the console when the
+	// passed in number of seconds has elapsed since the last
+	// report
+	void ReportLatency(float interval);
+
+private:
+	// number of timestamp queries in flight
+	static const int QUERY_COUNT = 8;
+
+	// fence after the swap of each recent frame
+	GLsync m_fences[MAX_FRAMES_IN_FLIGHT];
+	int m_framesInFlight;
+	// number of the frame being built
+	unsigned int m_frameNumber;
+
+	// timestamp queries and the input times of their frames
+	GLuint m_timestampQueries[QUERY_COUNT];
+	double m_queryInputTimes[QUERY_COUNT];
+	bool m_queryPending[QUERY_COUNT];
+	int m_queryIndex;
+	bool m_bMeasureLatency;
+	// seconds to add to a GPU time stamp to get the CPU time
+	double m_clockOffset;
+
+	// accumulated times in milliseconds
+	double m_totalLatency;
+	double m_minimumLatency;
+	double m_maximumLatency;
+	double m_totalWaitTime;
+	int m_latencyFrames;
+	int m_waitFrames;
+	double m_lastReportTime;
+
+	// wait for the fence of a frame and delete it
+	void WaitForFence(int slot);
+	// read the results of the finished timestamp queries
+	void CollectLatencies();
+	// measure the offset between the GPU and CPU clocks
+	void CalibrateClock();
+	// forget the frames measured since the last report
+	void ResetAverages();
+};
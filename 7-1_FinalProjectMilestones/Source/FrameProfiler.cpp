@@ -0,0 +1,205 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.cpp
+// ============
+// measure the CPU and GPU time spent on each rendered frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameProfiler.h"
+
+#include "GLFW/glfw3.h"
+
+#include <iostream>
+#include <iomanip>
+
+/***********************************************************
+ *  FrameProfiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameProfiler::FrameProfiler()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		m_timerQueries[i] = 0;
+		m_queryPending[i] = false;
+	}
+	m_queryIndex = 0;
+	m_frameStartTime = 0.0;
+	m_lastFrameStartTime = 0.0;
+	m_lastReportTime = 0.0;
+	ResetAverages();
+}
+
+/***********************************************************
+ *  ~FrameProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameProfiler::~FrameProfiler()
+{
+	if (m_timerQueries[0] != 0)
+	{
+		glDeleteQueries(QUERY_COUNT, m_timerQueries);
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the GPU timer queries.
+ ***********************************************************/
+void FrameProfiler::Initialize()
+{
+	glGenQueries(QUERY_COUNT, m_timerQueries);
+	m_lastReportTime = glfwGetTime();
+	m_lastFrameStartTime = m_lastReportTime;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for marking the start of a frame.
+ ***********************************************************/
+void FrameProfiler::BeginFrame()
+{
+	m_frameStartTime = glfwGetTime();
+	m_totalFrameTime += (m_frameStartTime - m_lastFrameStartTime) * 1000.0;
+	m_lastFrameStartTime = m_frameStartTime;
+	m_intervalFrames++;
+
+	// pick up the results of earlier frames before the query
+	// object is reused for this frame
+	CollectGPUTimes();
+
+	if ((m_timerQueries[0] != 0) && (m_queryPending[m_queryIndex] == false))
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_queryIndex]);
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for marking the end of the CPU work
+ *  for a frame.
+ ***********************************************************/
+void FrameProfiler::EndFrame()
+{
+	if ((m_timerQueries[0] != 0) && (m_queryPending[m_queryIndex] == false))
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_queryPending[m_queryIndex] = true;
+		m_queryIndex = (m_queryIndex + 1) % QUERY_COUNT;
+	}
+
+	m_totalCPUTime += (glfwGetTime() - m_frameStartTime) * 1000.0;
+	m_cpuFrames++;
+}
+
+/***********************************************************
+ *  CollectGPUTimes()
+ *
+ *  This method is used for reading the results of the timer
+ *  queries that the GPU has finished, without waiting for
+ *  the ones that are still in flight.
+ ***********************************************************/
+void FrameProfiler::CollectGPUTimes()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		if (m_queryPending[i] == false)
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available != 0)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(m_timerQueries[i], GL_QUERY_RESULT, &elapsed);
+			m_totalGPUTime += (double)elapsed / 1000000.0;
+			m_gpuFrames++;
+			m_queryPending[i] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReportAverages()
+ *
+ *  This method is used for printing the average frame times
+ *  since the last report, once the passed in number of
+ *  seconds has elapsed.
+ ***********************************************************/
+void FrameProfiler::ReportAverages(float interval, const char* label)
+{
+	double currentTime = glfwGetTime();
+	if ((currentTime - m_lastReportTime) < interval)
+	{
+		return;
+	}
+
+	double frameTime = GetAverageFrameTime();
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "INFO: CPU " << GetAverageCPUTime() << " ms, GPU " << GetAverageGPUTime()
+		<< " ms, frame " << frameTime << " ms (" << std::setprecision(1)
+		<< ((frameTime > 0.0) ? (1000.0 / frameTime) : 0.0) << " fps)";
+	if (NULL != label)
+	{
+		std::cout << " - " << label;
+	}
+	std::cout << std::defaultfloat << std::endl;
+
+	m_lastReportTime = currentTime;
+	ResetAverages();
+}
+
+/***********************************************************
+ *  GetAverageCPUTime()
+ *
+ *  This method is used for getting the average CPU time of
+ *  the frames in milliseconds.
+ ***********************************************************/
+double FrameProfiler::GetAverageCPUTime() const
+{
+	return((m_cpuFrames > 0) ? (m_totalCPUTime / m_cpuFrames) : 0.0);
+}
+
+/***********************************************************
+ *  GetAverageGPUTime()
+ *
+ *  This method is used for getting the average GPU time of
+ *  the frames in milliseconds.
+ ***********************************************************/
+double FrameProfiler::GetAverageGPUTime() const
+{
+	return((m_gpuFrames > 0) ? (m_totalGPUTime / m_gpuFrames) : 0.0);
+}
+
+/***********************************************************
+ *  GetAverageFrameTime()
+ *
+ *  This method is used for getting the average time between
+ *  the start of consecutive frames in milliseconds.
+ ***********************************************************/
+double FrameProfiler::GetAverageFrameTime() const
+{
+	return((m_intervalFrames > 0) ? (m_totalFrameTime / m_intervalFrames) : 0.0);
+}
+
+/***********************************************************
+ *  ResetAverages()
+ *
+ *  This method is used for clearing the accumulated times.
+ ***********************************************************/
+void FrameProfiler::ResetAverages()
+{
+	m_totalCPUTime = 0.0;
+	m_totalGPUTime = 0.0;
+	m_totalFrameTime = 0.0;
+	m_cpuFrames = 0;
+	m_gpuFrames = 0;
+	m_intervalFrames = 0;
+}
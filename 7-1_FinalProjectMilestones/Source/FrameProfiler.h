@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.h
+// ============
+// measure the CPU and GPU time spent on each rendered frame
+//
+//  The GPU time is measured with GL_TIME_ELAPSED queries that are read
+//  back a few frames later, once their results are available, so the
+//  measurement itself never stalls the CPU.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  FrameProfiler
+ *
+ *  This class contains the code for timing the frames and
+ *  reporting the averaged frame times.
+ ***********************************************************/
+class FrameProfiler
+{
+public:
+	// constructor
+	FrameProfiler();
+	// destructor
+	~FrameProfiler();
+
+	// create the GPU timer queries
+	void Initialize();
+
+	// mark the start and end of the CPU work for a frame -
+	// the end should be marked before the buffers are swapped
+	void BeginFrame();
+	void EndFrame();
+
+	// print the averages to the console when the passed in
+	// number of seconds has elapsed since the last report
+	void ReportAverages(float interval, const char* label);
+
+	// averages over the frames since the last report
+	double GetAverageCPUTime() const;
+	double GetAverageGPUTime() const;
+	double GetAverageFrameTime() const;
+
+	// forget the frames measured since the last report
+	void ResetAverages();
+
+private:
+	// number of timer queries in flight
+	static const int QUERY_COUNT = 4;
+
+	GLuint m_timerQueries[QUERY_COUNT];
+	bool m_queryPending[QUERY_COUNT];
+	int m_queryIndex;
+
+	// time stamps in seconds
+	double m_frameStartTime;
+	double m_lastFrameStartTime;
+	double m_lastReportTime;
+
+	// accumulated times in milliseconds
+	double m_totalCPUTime;
+	double m_totalGPUTime;
+	double m_totalFrameTime;
+	int m_cpuFrames;
+	int m_gpuFrames;
+	int m_intervalFrames;
+
+	// read the results of the finished timer queries
+	void CollectGPUTimes();
+};
@@ -0,0 +1,1672 @@
+///////////////////////////////////////////////////////////////////////////////
+// gltfimporter.cpp
+// ============
+// import glTF 2.0 scenes into cooked scene files and shape meshes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GltfImporter.h"
+#include "SceneBuilder.h"
+#include "MeshNormals.h"
+#include "MeshOptimizer.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+// declaration of global variables
+namespace
+{
+	// the GL enums of the component types of the accessors
+	const int g_ComponentByte = 5120;
+	const int g_ComponentUnsignedByte = 5121;
+	const int g_ComponentShort = 5122;
+	const int g_ComponentUnsignedShort = 5123;
+	const int g_ComponentUnsignedInt = 5125;
+	const int g_ComponentFloat = 5126;
+	// the primitive mode of triangle lists
+	const int g_ModeTriangles = 4;
+	// position, normal and texture coordinates of each vertex
+	const int g_FloatsPerVertex = 8;
+	// share of the base color in the ambient light, as in the
+	// materials of the text scenes
+	const float g_AmbientStrength = 0.2f;
+	// the specular color of a material that is not metallic,
+	// and the highest shininess a smooth material gets
+	const float g_DielectricSpecular = 0.04f;
+	const float g_MaxShininess = 256.0f;
+	// deepest nesting of the JSON text
+	const int g_MaxJsonDepth = 64;
+
+	// the kinds of JSON values
+	enum JsonType
+	{
+		JSON_NULL,
+		JSON_FALSE,
+		JSON_TRUE,
+		JSON_NUMBER,
+		JSON_STRING,
+		JSON_ARRAY,
+		JSON_OBJECT
+	};
+
+	// a value of the JSON text, kept in one array with the
+	// children of arrays and objects linked by index
+	struct JSON_VALUE
+	{
+		JsonType type;
+		double number;
+		// the text of a string between its quotes, with its
+		// escapes, and the name of an object member
+		const char* pText;
+		size_t textLength;
+		const char* pName;
+		size_t nameLength;
+		// the first child and the next value of the same
+		// parent, or -1
+		int firstChild;
+		int nextSibling;
+	};
+
+	// the values of a JSON text, the first being the root
+	struct JSON_DOCUMENT
+	{
+		std::vector<JSON_VALUE> values;
+	};
+
+	/***********************************************************
+	 *  SkipJsonSpace()
+	 *
+	 *  This function is used for moving past the white space
+	 *  in front of the next token of a JSON text.
+	 ***********************************************************/
+	const char* SkipJsonSpace(const char* p, const char* pEnd)
+	{
+		while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')))
+		{
+			p++;
+		}
+		return(p);
+	}
+
+	/***********************************************************
+	 *  ScanJsonString()
+	 *
+	 *  This function is used for finding the end of a string
+	 *  that starts at a quote, leaving its escapes as they are
+	 *  - false if the string is not closed.
+	 ***********************************************************/
+	bool ScanJsonString(const char*& p, const char* pEnd, const char*& pText, size_t& length)
+	{
+		if ((p >= pEnd) || (*p != '"'))
+		{
+			return(false);
+		}
+		p++;
+		pText = p;
+		while ((p < pEnd) && (*p != '"'))
+		{
+			p += (*p == '\\') ? 2 : 1;
+		}
+		if (p >= pEnd)
+		{
+			return(false);
+		}
+		length = p - pText;
+		p++;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ParseJsonValue()
+	 *
+	 *  This function is used for reading one JSON value and
+	 *  everything inside it into the document, and getting its
+	 *  index - -1 if the text is not valid JSON.
+	 ***********************************************************/
+	int ParseJsonValue(const char*& p, const char* pEnd, JSON_DOCUMENT& document, int depth)
+	{
+		p = SkipJsonSpace(p, pEnd);
+		if ((p >= pEnd) || (depth > g_MaxJsonDepth))
+		{
+			return(-1);
+		}
+
+		int index = (int)document.values.size();
+		JSON_VALUE value;
+		memset(&value, 0, sizeof(value));
+		value.firstChild = -1;
+		value.nextSibling = -1;
+		document.values.push_back(value);
+
+		if ((*p == '[') || (*p == '{'))
+		{
+			bool bObject = (*p == '{');
+			char closing = bObject ? '}' : ']';
+			document.values[index].type = bObject ? JSON_OBJECT : JSON_ARRAY;
+			p = SkipJsonSpace(p + 1, pEnd);
+			int previous = -1;
+			while ((p < pEnd) && (*p != closing))
+			{
+				const char* pName = NULL;
+				size_t nameLength = 0;
+				if (bObject == true)
+				{
+					if (ScanJsonString(p, pEnd, pName, nameLength) == false)
+					{
+						return(-1);
+					}
+					p = SkipJsonSpace(p, pEnd);
+					if ((p >= pEnd) || (*p != ':'))
+					{
+						return(-1);
+					}
+					p++;
+				}
+
+				int child = ParseJsonValue(p, pEnd, document, depth + 1);
+				if (child < 0)
+				{
+					return(-1);
+				}
+				document.values[child].pName = pName;
+				document.values[child].nameLength = nameLength;
+				if (previous < 0)
+				{
+					document.values[index].firstChild = child;
+				}
+				else
+				{
+					document.values[previous].nextSibling = child;
+				}
+				previous = child;
+
+				p = SkipJsonSpace(p, pEnd);
+				if ((p < pEnd) && (*p == ','))
+				{
+					p = SkipJsonSpace(p + 1, pEnd);
+				}
+				else if ((p >= pEnd) || (*p != closing))
+				{
+					return(-1);
+				}
+			}
+			if (p >= pEnd)
+			{
+				return(-1);
+			}
+			p++;
+		}
+		else if (*p == '"')
+		{
+			document.values[index].type = JSON_STRING;
+			if (ScanJsonString(p, pEnd, document.values[index].pText, document.values[index].textLength) == false)
+			{
+				return(-1);
+			}
+		}
+		else if (((pEnd - p) >= 4) && (strncmp(p, "null", 4) == 0))
+		{
+			document.values[index].type = JSON_NULL;
+			p += 4;
+		}
+		else if (((pEnd - p) >= 4) && (strncmp(p, "true", 4) == 0))
+		{
+			document.values[index].type = JSON_TRUE;
+			p += 4;
+		}
+		else if (((pEnd - p) >= 5) && (strncmp(p, "false", 5) == 0))
+		{
+			document.values[index].type = JSON_FALSE;
+			p += 5;
+		}
+		else
+		{
+			// the text is not terminated, so the number is copied
+			// out before it is converted
+			char number[64];
+			size_t length = 0;
+			while ((p < pEnd) && (length < sizeof(number) - 1) && (*p != 0) && (strchr("+-.0123456789eE", *p) != NULL))
+			{
+				number[length++] = *p++;
+			}
+			number[length] = 0;
+			char* pNumberEnd = NULL;
+			document.values[index].type = JSON_NUMBER;
+			document.values[index].number = strtod(number, &pNumberEnd);
+			if ((length == 0) || (pNumberEnd != number + length))
+			{
+				return(-1);
+			}
+		}
+		return(index);
+	}
+
+	/***********************************************************
+	 *  ParseJson()
+	 *
+	 *  This function is used for reading a whole JSON text,
+	 *  whose root must be an object.
+	 ***********************************************************/
+	bool ParseJson(const char* pText, size_t size, JSON_DOCUMENT& document)
+	{
+		const char* p = pText;
+		const char* pEnd = pText + size;
+		document.values.clear();
+		document.values.reserve(size / 16);
+		if (ParseJsonValue(p, pEnd, document, 0) != 0)
+		{
+			return(false);
+		}
+		// a .glb chunk is padded with spaces and a text file may
+		// end with a null
+		p = SkipJsonSpace(p, pEnd);
+		return(((p == pEnd) || (*p == 0)) && (document.values[0].type == JSON_OBJECT));
+	}
+
+	/***********************************************************
+	 *  FindMember()
+	 *
+	 *  This function is used for finding a member of an object
+	 *  by name - -1 if the object does not have it.
+	 ***********************************************************/
+	int FindMember(const JSON_DOCUMENT& document, int object, const char* name)
+	{
+		if ((object < 0) || (document.values[object].type != JSON_OBJECT))
+		{
+			return(-1);
+		}
+		size_t nameLength = strlen(name);
+		for (int child = document.values[object].firstChild; child >= 0; child = document.values[child].nextSibling)
+		{
+			const JSON_VALUE& value = document.values[child];
+			if ((value.nameLength == nameLength) && (memcmp(value.pName, name, nameLength) == 0))
+			{
+				return(child);
+			}
+		}
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  GetArrayItems()
+	 *
+	 *  This function is used for getting the values of an
+	 *  array member of an object - empty if there is none.
+	 ***********************************************************/
+	std::vector<int> GetArrayItems(const JSON_DOCUMENT& document, int object, const char* name)
+	{
+		std::vector<int> items;
+		int array = FindMember(document, object, name);
+		if ((array >= 0) && (document.values[array].type == JSON_ARRAY))
+		{
+			for (int child = document.values[array].firstChild; child >= 0; child = document.values[child].nextSibling)
+			{
+				items.push_back(child);
+			}
+		}
+		return(items);
+	}
+
+	/***********************************************************
+	 *  GetNumber()
+	 *
+	 *  This function is used for getting a number member of an
+	 *  object, or the passed in default.
+	 ***********************************************************/
+	double GetNumber(const JSON_DOCUMENT& document, int object, const char* name, double defaultValue)
+	{
+		int member = FindMember(document, object, name);
+		if ((member < 0) || (document.values[member].type != JSON_NUMBER))
+		{
+			return(defaultValue);
+		}
+		return(document.values[member].number);
+	}
+
+	/***********************************************************
+	 *  GetIndex()
+	 *
+	 *  This function is used for getting a member of an object
+	 *  that is an index or a count, or the passed in default
+	 *  when it is missing, negative or not a whole number.
+	 ***********************************************************/
+	int GetIndex(const JSON_DOCUMENT& document, int object, const char* name, int defaultValue)
+	{
+		double number = GetNumber(document, object, name, -1.0);
+		if ((number < 0.0) || (number > 2147483647.0) || (number != std::floor(number)))
+		{
+			return(defaultValue);
+		}
+		return((int)number);
+	}
+
+	/***********************************************************
+	 *  GetSize()
+	 *
+	 *  This function is used for getting a byte offset, length
+	 *  or count member of an object, or the passed in default.
+	 ***********************************************************/
+	size_t GetSize(const JSON_DOCUMENT& document, int object, const char* name, size_t defaultValue)
+	{
+		double number = GetNumber(document, object, name, -1.0);
+		if ((number < 0.0) || (number > 9007199254740992.0) || (number != std::floor(number)))
+		{
+			return(defaultValue);
+		}
+		return((size_t)number);
+	}
+
+	/***********************************************************
+	 *  GetString()
+	 *
+	 *  This function is used for getting a string member of an
+	 *  object with its escapes decoded - characters outside
+	 *  ASCII in a \u escape become '?'.
+	 ***********************************************************/
+	std::string GetString(const JSON_DOCUMENT& document, int object, const char* name)
+	{
+		std::string text;
+		int member = FindMember(document, object, name);
+		if ((member < 0) || (document.values[member].type != JSON_STRING))
+		{
+			return(text);
+		}
+
+		const char* p = document.values[member].pText;
+		const char* pEnd = p + document.values[member].textLength;
+		text.reserve(pEnd - p);
+		while (p < pEnd)
+		{
+			if ((*p != '\\') || ((p + 1) >= pEnd))
+			{
+				text += *p++;
+				continue;
+			}
+			char escape = p[1];
+			p += 2;
+			switch (escape)
+			{
+			case 'b': text += '\b'; break;
+			case 'f': text += '\f'; break;
+			case 'n': text += '\n'; break;
+			case 'r': text += '\r'; break;
+			case 't': text += '\t'; break;
+			case 'u':
+			{
+				char digits[5] = { 0 };
+				size_t count = std::min((size_t)4, (size_t)(pEnd - p));
+				memcpy(digits, p, count);
+				p += count;
+				long code = strtol(digits, NULL, 16);
+				text += ((code > 0) && (code < 128)) ? (char)code : '?';
+				break;
+			}
+			default: text += escape; break;
+			}
+		}
+		return(text);
+	}
+
+	/***********************************************************
+	 *  GetNumbers()
+	 *
+	 *  This function is used for reading up to the passed in
+	 *  count of numbers from an array member of an object, and
+	 *  getting how many there were.
+	 ***********************************************************/
+	int GetNumbers(const JSON_DOCUMENT& document, int object, const char* name, float* pValues, int count)
+	{
+		std::vector<int> items = GetArrayItems(document, object, name);
+		int read = 0;
+		for (size_t i = 0; (i < items.size()) && (read < count); i++)
+		{
+			if (document.values[items[i]].type == JSON_NUMBER)
+			{
+				pValues[read++] = (float)document.values[items[i]].number;
+			}
+		}
+		return(read);
+	}
+
+	/***********************************************************
+	 *  DecodeBase64()
+	 *
+	 *  This function is used for decoding the base64 data of a
+	 *  data URI - false if it has other characters.
+	 ***********************************************************/
+	bool DecodeBase64(const std::string& text, size_t start, std::vector<unsigned char>& data)
+	{
+		data.clear();
+		data.reserve((text.size() - start) / 4 * 3);
+		uint32_t bits = 0;
+		int bitCount = 0;
+		for (size_t i = start; i < text.size(); i++)
+		{
+			char c = text[i];
+			int value = -1;
+			if ((c >= 'A') && (c <= 'Z')) value = c - 'A';
+			else if ((c >= 'a') && (c <= 'z')) value = c - 'a' + 26;
+			else if ((c >= '0') && (c <= '9')) value = c - '0' + 52;
+			else if (c == '+') value = 62;
+			else if (c == '/') value = 63;
+			else if (c == '=') break;
+			else return(false);
+
+			bits = (bits << 6) | (uint32_t)value;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				data.push_back((unsigned char)((bits >> bitCount) & 0xFF));
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  DecodeDataUri()
+	 *
+	 *  This function is used for getting the bytes of a base64
+	 *  data URI - false if the URI is not one.
+	 ***********************************************************/
+	bool DecodeDataUri(const std::string& uri, std::vector<unsigned char>& data)
+	{
+		size_t marker = uri.find(";base64,");
+		if ((uri.compare(0, 5, "data:") != 0) || (marker == std::string::npos))
+		{
+			return(false);
+		}
+		return(DecodeBase64(uri, marker + 8, data));
+	}
+
+	/***********************************************************
+	 *  DecodeUriPath()
+	 *
+	 *  This function is used for turning the percent escapes
+	 *  of a relative URI back into the characters of a path.
+	 ***********************************************************/
+	std::string DecodeUriPath(const std::string& uri)
+	{
+		std::string path;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			if ((uri[i] == '%') && ((i + 2) < uri.size()))
+			{
+				char digits[3] = { uri[i + 1], uri[i + 2], 0 };
+				path += (char)strtol(digits, NULL, 16);
+				i += 2;
+			}
+			else
+			{
+				path += uri[i];
+			}
+		}
+		return(path);
+	}
+
+	/***********************************************************
+	 *  GetComponentSize()
+	 *
+	 *  This function is used for getting the bytes of a
+	 *  component type - 0 for a type that is not valid.
+	 ***********************************************************/
+	size_t GetComponentSize(int componentType)
+	{
+		switch (componentType)
+		{
+		case g_ComponentByte:
+		case g_ComponentUnsignedByte:
+			return(1);
+		case g_ComponentShort:
+		case g_ComponentUnsignedShort:
+			return(2);
+		case g_ComponentUnsignedInt:
+		case g_ComponentFloat:
+			return(4);
+		default:
+			return(0);
+		}
+	}
+
+	/***********************************************************
+	 *  GetComponentCount()
+	 *
+	 *  This function is used for getting the components of an
+	 *  accessor type - 0 for a type that is not valid.
+	 ***********************************************************/
+	int GetComponentCount(const std::string& type)
+	{
+		if (type == "SCALAR") return(1);
+		if (type == "VEC2") return(2);
+		if (type == "VEC3") return(3);
+		if (type == "VEC4") return(4);
+		if (type == "MAT2") return(4);
+		if (type == "MAT3") return(9);
+		if (type == "MAT4") return(16);
+		return(0);
+	}
+
+	/***********************************************************
+	 *  ReadComponent()
+	 *
+	 *  This function is used for reading one component of an
+	 *  accessor as a float, scaled into -1 to 1 or 0 to 1 when
+	 *  the accessor is normalized.
+	 ***********************************************************/
+	float ReadComponent(const unsigned char* p, int componentType, bool bNormalized)
+	{
+		switch (componentType)
+		{
+		case g_ComponentFloat:
+		{
+			float value;
+			memcpy(&value, p, sizeof(value));
+			return(value);
+		}
+		case g_ComponentUnsignedByte:
+			return(bNormalized ? (*p / 255.0f) : (float)*p);
+		case g_ComponentByte:
+			return(bNormalized ? std::max((int8_t)*p / 127.0f, -1.0f) : (float)(int8_t)*p);
+		case g_ComponentUnsignedShort:
+		{
+			uint16_t value;
+			memcpy(&value, p, sizeof(value));
+			return(bNormalized ? (value / 65535.0f) : (float)value);
+		}
+		case g_ComponentShort:
+		{
+			int16_t value;
+			memcpy(&value, p, sizeof(value));
+			return(bNormalized ? std::max(value / 32767.0f, -1.0f) : (float)value);
+		}
+		default:
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(value));
+			return((float)value);
+		}
+		}
+	}
+
+	/***********************************************************
+	 *  ReadIndex()
+	 *
+	 *  This function is used for reading one index of an
+	 *  accessor of unsigned integers.
+	 ***********************************************************/
+	uint32_t ReadIndex(const unsigned char* p, int componentType)
+	{
+		if (componentType == g_ComponentUnsignedByte)
+		{
+			return(*p);
+		}
+		if (componentType == g_ComponentUnsignedShort)
+		{
+			uint16_t value;
+			memcpy(&value, p, sizeof(value));
+			return(value);
+		}
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return(value);
+	}
+
+	/***********************************************************
+	 *  ToString()
+	 *
+	 *  This function is used for writing a number as text.
+	 ***********************************************************/
+	std::string ToString(int value)
+	{
+		char text[16];
+		snprintf(text, sizeof(text), "%d", value);
+		return(text);
+	}
+}
+
+/***********************************************************
+ *  GltfFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GltfFile::GltfFile()
+{
+}
+
+/***********************************************************
+ *  ~GltfFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GltfFile::~GltfFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a glTF file and reading
+ *  its arrays.  A .glb file holds its JSON text and its
+ *  first buffer in two chunks; a .gltf file is the JSON
+ *  text, with its buffers in .bin files or data URIs.  The
+ *  buffer files stay mapped until the file is closed.
+ ***********************************************************/
+bool GltfFile::Open(const char* filename)
+{
+	Close();
+
+	m_filename = filename;
+	size_t directory = m_filename.find_last_of("/\\");
+	m_directory = (directory != std::string::npos) ? m_filename.substr(0, directory + 1) : std::string();
+
+	if (m_file.Open(filename) == false)
+	{
+		std::cerr << "Could not open glTF file: " << filename << std::endl;
+		return(false);
+	}
+
+	const unsigned char* pData = m_file.GetData();
+	size_t size = m_file.GetSize();
+	uint32_t header[3] = { 0, 0, 0 };
+	if (size >= sizeof(header))
+	{
+		memcpy(header, pData, sizeof(header));
+	}
+
+	bool bRead = false;
+	if (header[0] != GLB_MAGIC)
+	{
+		bRead = ReadDocument((const char*)pData, size, NULL, 0);
+	}
+	else if ((header[1] == GLB_VERSION) && (header[2] <= size))
+	{
+		// a chunk is its length, its type and its data
+		size_t position = sizeof(header);
+		uint32_t chunk[2] = { 0, 0 };
+		const unsigned char* pJson = NULL;
+		size_t jsonSize = 0;
+		const unsigned char* pBinary = NULL;
+		size_t binarySize = 0;
+		while ((position + sizeof(chunk)) <= header[2])
+		{
+			memcpy(chunk, pData + position, sizeof(chunk));
+			position += sizeof(chunk);
+			if (chunk[0] > header[2] - position)
+			{
+				break;
+			}
+			if ((chunk[1] == GLB_CHUNK_JSON) && (NULL == pJson))
+			{
+				pJson = pData + position;
+				jsonSize = chunk[0];
+			}
+			else if ((chunk[1] == GLB_CHUNK_BIN) && (NULL == pBinary))
+			{
+				pBinary = pData + position;
+				binarySize = chunk[0];
+			}
+			position += chunk[0];
+		}
+		bRead = (NULL != pJson) && ReadDocument((const char*)pJson, jsonSize, pBinary, binarySize);
+	}
+
+	if (bRead == false)
+	{
+		std::cerr << "Could not read glTF file: " << filename << std::endl;
+		Close();
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the file and its
+ *  buffers.  The GL buffers the meshes were stored in are
+ *  kept, as the meshes still draw from them.
+ ***********************************************************/
+void GltfFile::Close()
+{
+	for (size_t i = 0; i < m_bufferFiles.size(); i++)
+	{
+		delete m_bufferFiles[i];
+	}
+	m_bufferFiles.clear();
+	m_decodedBuffers.clear();
+	m_bufferData.clear();
+	m_bufferSizes.clear();
+	m_meshRangeBegin.clear();
+	m_meshRangeEnd.clear();
+	m_glBuffers.clear();
+	m_bufferViews.clear();
+	m_accessors.clear();
+	m_meshes.clear();
+	m_materials.clear();
+	m_images.clear();
+	m_nodes.clear();
+	m_sceneRoots.clear();
+	m_file.Close();
+}
+
+/***********************************************************
+ *  ReadDocument()
+ *
+ *  This method is used for reading the arrays of the JSON
+ *  text that the scene and the meshes need.  Animations,
+ *  skins, cameras and the material values other than the
+ *  base color, metalness and roughness are ignored, and a
+ *  file that requires an extension is not read.
+ ***********************************************************/
+bool GltfFile::ReadDocument(
+	const char* pText,
+	size_t size,
+	const unsigned char* pBinaryChunk,
+	size_t binaryChunkSize)
+{
+	JSON_DOCUMENT document;
+	if (ParseJson(pText, size, document) == false)
+	{
+		std::cerr << "The JSON text of the glTF file is not valid" << std::endl;
+		return(false);
+	}
+
+	std::string version = GetString(document, FindMember(document, 0, "asset"), "version");
+	if ((version.empty() == true) || (version[0] != '2'))
+	{
+		std::cerr << "The glTF file is not version 2.0 but " << version << std::endl;
+		return(false);
+	}
+	std::vector<int> required = GetArrayItems(document, 0, "extensionsRequired");
+	if (required.empty() == false)
+	{
+		std::cerr << "The glTF file requires an extension that is not supported" << std::endl;
+		return(false);
+	}
+
+	std::vector<int> items = GetArrayItems(document, 0, "buffers");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		size_t byteLength = GetSize(document, items[i], "byteLength", 0);
+		std::string uri = GetString(document, items[i], "uri");
+		const unsigned char* pData = NULL;
+		size_t dataSize = 0;
+		if (uri.empty() == true)
+		{
+			// only the first buffer of a .glb file is its chunk
+			if (i == 0)
+			{
+				pData = pBinaryChunk;
+				dataSize = binaryChunkSize;
+			}
+		}
+		else if (uri.compare(0, 5, "data:") == 0)
+		{
+			m_decodedBuffers.push_back(std::vector<unsigned char>());
+			if (DecodeDataUri(uri, m_decodedBuffers.back()) == true)
+			{
+				pData = m_decodedBuffers.back().data();
+				dataSize = m_decodedBuffers.back().size();
+			}
+		}
+		else
+		{
+			MappedFile* pFile = new MappedFile();
+			m_bufferFiles.push_back(pFile);
+			if (pFile->Open((m_directory + DecodeUriPath(uri)).c_str()) == true)
+			{
+				pData = pFile->GetData();
+				dataSize = pFile->GetSize();
+			}
+		}
+
+		if ((NULL == pData) || (dataSize < byteLength))
+		{
+			std::cerr << "Could not read buffer " << i << " of the glTF file" << std::endl;
+			return(false);
+		}
+		m_bufferData.push_back(pData);
+		m_bufferSizes.push_back(byteLength);
+	}
+
+	items = GetArrayItems(document, 0, "bufferViews");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		GLTF_BUFFER_VIEW view;
+		view.buffer = GetIndex(document, items[i], "buffer", -1);
+		view.offset = GetSize(document, items[i], "byteOffset", 0);
+		view.length = GetSize(document, items[i], "byteLength", 0);
+		view.stride = GetSize(document, items[i], "byteStride", 0);
+		m_bufferViews.push_back(view);
+	}
+
+	items = GetArrayItems(document, 0, "accessors");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		GLTF_ACCESSOR accessor;
+		accessor.bufferView = GetIndex(document, items[i], "bufferView", -1);
+		accessor.offset = GetSize(document, items[i], "byteOffset", 0);
+		accessor.componentType = GetIndex(document, items[i], "componentType", 0);
+		accessor.componentCount = GetComponentCount(GetString(document, items[i], "type"));
+		accessor.count = GetSize(document, items[i], "count", 0);
+		int normalized = FindMember(document, items[i], "normalized");
+		accessor.bNormalized = (normalized >= 0) && (document.values[normalized].type == JSON_TRUE);
+		accessor.bHasBounds =
+			(GetNumbers(document, items[i], "min", &accessor.boundsMin[0], 3) == 3) &&
+			(GetNumbers(document, items[i], "max", &accessor.boundsMax[0], 3) == 3);
+		m_accessors.push_back(accessor);
+	}
+
+	items = GetArrayItems(document, 0, "meshes");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		GLTF_MESH mesh;
+		std::vector<int> primitives = GetArrayItems(document, items[i], "primitives");
+		for (size_t p = 0; p < primitives.size(); p++)
+		{
+			int attributes = FindMember(document, primitives[p], "attributes");
+			GLTF_PRIMITIVE primitive;
+			primitive.position = GetIndex(document, attributes, "POSITION", -1);
+			primitive.normal = GetIndex(document, attributes, "NORMAL", -1);
+			primitive.uv = GetIndex(document, attributes, "TEXCOORD_0", -1);
+			primitive.indices = GetIndex(document, primitives[p], "indices", -1);
+			primitive.material = GetIndex(document, primitives[p], "material", -1);
+			primitive.mode = GetIndex(document, primitives[p], "mode", g_ModeTriangles);
+			mesh.primitives.push_back(primitive);
+		}
+		m_meshes.push_back(mesh);
+	}
+
+	// the textures only connect the materials to the images
+	std::vector<int> textureImages;
+	items = GetArrayItems(document, 0, "textures");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		textureImages.push_back(GetIndex(document, items[i], "source", -1));
+	}
+
+	items = GetArrayItems(document, 0, "materials");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		int pbr = FindMember(document, items[i], "pbrMetallicRoughness");
+		GLTF_MATERIAL material;
+		material.baseColor = glm::vec4(1.0f);
+		GetNumbers(document, pbr, "baseColorFactor", &material.baseColor[0], 4);
+		material.metallic = (float)GetNumber(document, pbr, "metallicFactor", 1.0);
+		material.roughness = (float)GetNumber(document, pbr, "roughnessFactor", 1.0);
+		int texture = GetIndex(document, FindMember(document, pbr, "baseColorTexture"), "index", -1);
+		material.baseColorImage = ((texture >= 0) && (texture < (int)textureImages.size())) ? textureImages[texture] : -1;
+		material.bBlend = (GetString(document, items[i], "alphaMode") == "BLEND");
+		m_materials.push_back(material);
+	}
+
+	items = GetArrayItems(document, 0, "images");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		GLTF_IMAGE image;
+		image.uri = GetString(document, items[i], "uri");
+		image.bufferView = GetIndex(document, items[i], "bufferView", -1);
+		image.mimeType = GetString(document, items[i], "mimeType");
+		m_images.push_back(image);
+	}
+
+	items = GetArrayItems(document, 0, "nodes");
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		GLTF_NODE node;
+		node.mesh = GetIndex(document, items[i], "mesh", -1);
+		float matrix[16];
+		if (GetNumbers(document, items[i], "matrix", matrix, 16) == 16)
+		{
+			// both are column-major
+			memcpy(&node.localMatrix[0][0], matrix, sizeof(matrix));
+		}
+		else
+		{
+			glm::vec3 translation(0.0f);
+			float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+			glm::vec3 scale(1.0f);
+			GetNumbers(document, items[i], "translation", &translation[0], 3);
+			GetNumbers(document, items[i], "rotation", rotation, 4);
+			GetNumbers(document, items[i], "scale", &scale[0], 3);
+			node.localMatrix = glm::translate(translation) *
+				glm::mat4_cast(glm::quat(rotation[3], rotation[0], rotation[1], rotation[2])) *
+				glm::scale(scale);
+		}
+		std::vector<int> children = GetArrayItems(document, items[i], "children");
+		for (size_t c = 0; c < children.size(); c++)
+		{
+			node.children.push_back((document.values[children[c]].type == JSON_NUMBER) ? (int)document.values[children[c]].number : -1);
+		}
+		m_nodes.push_back(node);
+	}
+
+	// the default scene, or else every node that is not the
+	// child of another one
+	std::vector<int> scenes = GetArrayItems(document, 0, "scenes");
+	int scene = GetIndex(document, 0, "scene", 0);
+	if (scene < (int)scenes.size())
+	{
+		std::vector<int> roots = GetArrayItems(document, scenes[scene], "nodes");
+		for (size_t i = 0; i < roots.size(); i++)
+		{
+			m_sceneRoots.push_back((document.values[roots[i]].type == JSON_NUMBER) ? (int)document.values[roots[i]].number : -1);
+		}
+	}
+	else
+	{
+		std::vector<bool> bIsChild(m_nodes.size(), false);
+		for (size_t i = 0; i < m_nodes.size(); i++)
+		{
+			for (size_t c = 0; c < m_nodes[i].children.size(); c++)
+			{
+				if ((m_nodes[i].children[c] >= 0) && (m_nodes[i].children[c] < (int)m_nodes.size()))
+				{
+					bIsChild[m_nodes[i].children[c]] = true;
+				}
+			}
+		}
+		for (size_t i = 0; i < m_nodes.size(); i++)
+		{
+			if (bIsChild[i] == false)
+			{
+				m_sceneRoots.push_back((int)i);
+			}
+		}
+	}
+
+	return(ValidateDocument());
+}
+
+/***********************************************************
+ *  ValidateDocument()
+ *
+ *  This method is used for checking every index between
+ *  the arrays and every range of the buffers once, so the
+ *  rest of the code can use them without checks.  The part
+ *  of each buffer that the meshes read is found here too.
+ ***********************************************************/
+bool GltfFile::ValidateDocument()
+{
+	for (size_t i = 0; i < m_bufferViews.size(); i++)
+	{
+		const GLTF_BUFFER_VIEW& view = m_bufferViews[i];
+		if ((view.buffer < 0) || (view.buffer >= (int)m_bufferData.size()) ||
+			(view.offset > m_bufferSizes[view.buffer]) ||
+			(view.length > m_bufferSizes[view.buffer] - view.offset))
+		{
+			std::cerr << "Buffer view " << i << " of the glTF file is outside its buffer" << std::endl;
+			return(false);
+		}
+	}
+
+	for (size_t i = 0; i < m_accessors.size(); i++)
+	{
+		const GLTF_ACCESSOR& accessor = m_accessors[i];
+		size_t elementSize = GetComponentSize(accessor.componentType) * accessor.componentCount;
+		bool bValid = (elementSize > 0);
+		if ((bValid == true) && (accessor.bufferView >= 0))
+		{
+			bValid = (accessor.bufferView < (int)m_bufferViews.size());
+			if ((bValid == true) && (accessor.count > 0))
+			{
+				const GLTF_BUFFER_VIEW& view = m_bufferViews[accessor.bufferView];
+				size_t stride = (view.stride > 0) ? view.stride : elementSize;
+				bValid = (accessor.count <= view.length) &&
+					(accessor.offset <= view.length) &&
+					((stride * (accessor.count - 1) + elementSize) <= (view.length - accessor.offset));
+			}
+		}
+		if (bValid == false)
+		{
+			std::cerr << "Accessor " << i << " of the glTF file is outside its buffer view" << std::endl;
+			return(false);
+		}
+	}
+
+	int accessorCount = (int)m_accessors.size();
+	m_meshRangeBegin.assign(m_bufferData.size(), 0);
+	m_meshRangeEnd.assign(m_bufferData.size(), 0);
+	m_glBuffers.assign(m_bufferData.size(), 0);
+	std::vector<bool> bBufferUsed(m_bufferData.size(), false);
+	for (size_t m = 0; m < m_meshes.size(); m++)
+	{
+		for (size_t p = 0; p < m_meshes[m].primitives.size(); p++)
+		{
+			const GLTF_PRIMITIVE& primitive = m_meshes[m].primitives[p];
+			const int accessors[4] = { primitive.position, primitive.normal, primitive.uv, primitive.indices };
+			if ((primitive.position < 0) ||
+				(primitive.material >= (int)m_materials.size()))
+			{
+				std::cerr << "Primitive " << p << " of mesh " << m << " of the glTF file is not valid" << std::endl;
+				return(false);
+			}
+			for (int a = 0; a < 4; a++)
+			{
+				if (accessors[a] >= accessorCount)
+				{
+					std::cerr << "Primitive " << p << " of mesh " << m << " of the glTF file is not valid" << std::endl;
+					return(false);
+				}
+				if ((accessors[a] < 0) || (m_accessors[accessors[a]].bufferView < 0))
+				{
+					continue;
+				}
+				const GLTF_BUFFER_VIEW& view = m_bufferViews[m_accessors[accessors[a]].bufferView];
+				size_t begin = (bBufferUsed[view.buffer] == true) ? std::min(m_meshRangeBegin[view.buffer], view.offset) : view.offset;
+				m_meshRangeEnd[view.buffer] = std::max(m_meshRangeEnd[view.buffer], view.offset + view.length);
+				m_meshRangeBegin[view.buffer] = begin;
+				bBufferUsed[view.buffer] = true;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < m_materials.size(); i++)
+	{
+		if (m_materials[i].baseColorImage >= (int)m_images.size())
+		{
+			m_materials[i].baseColorImage = -1;
+		}
+	}
+	for (size_t i = 0; i < m_images.size(); i++)
+	{
+		if (m_images[i].bufferView >= (int)m_bufferViews.size())
+		{
+			m_images[i].bufferView = -1;
+		}
+	}
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		bool bValid = (m_nodes[i].mesh < (int)m_meshes.size());
+		for (size_t c = 0; c < m_nodes[i].children.size(); c++)
+		{
+			bValid = bValid && (m_nodes[i].children[c] >= 0) && (m_nodes[i].children[c] < (int)m_nodes.size());
+		}
+		if (bValid == false)
+		{
+			std::cerr << "Node " << i << " of the glTF file is not valid" << std::endl;
+			return(false);
+		}
+	}
+	for (size_t i = 0; i < m_sceneRoots.size(); i++)
+	{
+		if ((m_sceneRoots[i] < 0) || (m_sceneRoots[i] >= (int)m_nodes.size()))
+		{
+			std::cerr << "The scene of the glTF file has a node that is not valid" << std::endl;
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  AddToScene()
+ *
+ *  This method is used for adding the default scene to a
+ *  scene builder.  The nodes are walked from the roots down
+ *  with their world matrices, and each primitive of a node
+ *  becomes a scene node.  The primitives of any meshes that
+ *  use the same accessors get one mesh reference, so the
+ *  nodes that draw them share one stored mesh.  The texture
+ *  coordinates of glTF start at the top of an image, and
+ *  the images are flipped when they are loaded, so the nodes
+ *  scale the coordinates by -1 vertically, which the
+ *  repeating textures turn back into 1 - v.
+ ***********************************************************/
+bool GltfFile::AddToScene(SceneBuilder& builder)
+{
+	std::vector<int> textures(m_images.size(), -1);
+	std::vector<int> materials(m_materials.size(), -1);
+	for (size_t i = 0; i < m_materials.size(); i++)
+	{
+		const GLTF_MATERIAL& material = m_materials[i];
+		glm::vec3 baseColor(material.baseColor.r, material.baseColor.g, material.baseColor.b);
+		// the exponent of Blinn-Phong that matches the spread of
+		// the highlight of the roughness
+		float roughness = std::max(material.roughness, 0.05f);
+		float shininess = glm::clamp(2.0f / (roughness * roughness * roughness * roughness) - 2.0f, 1.0f, g_MaxShininess);
+		materials[i] = builder.AddMaterial(
+			m_filename + "#material" + ToString((int)i),
+			baseColor,
+			g_AmbientStrength,
+			baseColor,
+			glm::mix(glm::vec3(g_DielectricSpecular), baseColor, glm::clamp(material.metallic, 0.0f, 1.0f)),
+			shininess);
+
+		int image = material.baseColorImage;
+		if ((image >= 0) && (textures[image] < 0))
+		{
+			std::string path = GetImagePath(image);
+			if (path.empty() == false)
+			{
+				textures[image] = builder.AddTexture(m_filename + "#image" + ToString(image), path);
+			}
+		}
+	}
+
+	// the renderer has a fixed number of texture slots, and the
+	// materials of the textures past them are drawn with their
+	// base colors
+	int textureCount = (int)std::count_if(textures.begin(), textures.end(), [](int texture) { return(texture >= 0); });
+	if (textureCount > SCENE_MAX_TEXTURES)
+	{
+		std::cerr << "The glTF file uses " << textureCount << " textures, only the first "
+			<< SCENE_MAX_TEXTURES << " are drawn" << std::endl;
+	}
+
+	// the first primitive with each set of accessors names
+	// the mesh reference of all of them
+	std::map<std::vector<int>, int> sharedMeshes;
+	std::vector<std::vector<int> > meshReferences(m_meshes.size());
+	for (size_t m = 0; m < m_meshes.size(); m++)
+	{
+		for (size_t p = 0; p < m_meshes[m].primitives.size(); p++)
+		{
+			const GLTF_PRIMITIVE& primitive = m_meshes[m].primitives[p];
+			std::vector<int> key(5);
+			key[0] = primitive.position;
+			key[1] = primitive.normal;
+			key[2] = primitive.uv;
+			key[3] = primitive.indices;
+			key[4] = primitive.mode;
+			std::map<std::vector<int>, int>::iterator shared = sharedMeshes.find(key);
+			if (shared == sharedMeshes.end())
+			{
+				shared = sharedMeshes.insert(std::make_pair(key,
+					builder.AddMesh(GetGltfMeshName(m_filename, (int)m, (int)p)))).first;
+			}
+			meshReferences[m].push_back(shared->second);
+		}
+	}
+
+	// a node is only visited once, even if a broken file gives
+	// it several parents
+	std::vector<bool> bVisited(m_nodes.size(), false);
+	std::vector<std::pair<int, glm::mat4> > stack;
+	for (size_t i = 0; i < m_sceneRoots.size(); i++)
+	{
+		stack.push_back(std::make_pair(m_sceneRoots[i], glm::mat4(1.0f)));
+	}
+	while (stack.empty() == false)
+	{
+		int nodeIndex = stack.back().first;
+		glm::mat4 parentMatrix = stack.back().second;
+		stack.pop_back();
+		if (bVisited[nodeIndex] == true)
+		{
+			continue;
+		}
+		bVisited[nodeIndex] = true;
+
+		const GLTF_NODE& node = m_nodes[nodeIndex];
+		glm::mat4 worldMatrix = parentMatrix * node.localMatrix;
+		for (size_t c = 0; c < node.children.size(); c++)
+		{
+			stack.push_back(std::make_pair(node.children[c], worldMatrix));
+		}
+		if (node.mesh < 0)
+		{
+			continue;
+		}
+
+		const GLTF_MESH& mesh = m_meshes[node.mesh];
+		for (size_t p = 0; p < mesh.primitives.size(); p++)
+		{
+			int material = mesh.primitives[p].material;
+			int texture = -1;
+			glm::vec4 color(1.0f);
+			if (material >= 0)
+			{
+				color = m_materials[material].baseColor;
+				color.a = (m_materials[material].bBlend == true) ? color.a : 1.0f;
+				if (m_materials[material].baseColorImage >= 0)
+				{
+					texture = textures[m_materials[material].baseColorImage];
+				}
+			}
+			builder.AddNode(
+				meshReferences[node.mesh][p],
+				worldMatrix,
+				texture,
+				(material >= 0) ? materials[material] : -1,
+				color,
+				glm::vec2(1.0f, -1.0f),
+				0);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  GetAccessorData()
+ *
+ *  This method is used for getting the address of the
+ *  first element of an accessor that has a buffer view,
+ *  and the bytes from one element to the next.
+ ***********************************************************/
+const unsigned char* GltfFile::GetAccessorData(
+	const GLTF_ACCESSOR& accessor,
+	size_t& stride) const
+{
+	const GLTF_BUFFER_VIEW& view = m_bufferViews[accessor.bufferView];
+	stride = (view.stride > 0) ? view.stride : GetComponentSize(accessor.componentType) * accessor.componentCount;
+	return(m_bufferData[view.buffer] + view.offset + accessor.offset);
+}
+
+/***********************************************************
+ *  CanDrawFromBuffer()
+ *
+ *  This method is used for checking whether a primitive
+ *  has float positions and normals, float texture
+ *  coordinates or none and unsigned indices, all in one
+ *  buffer and aligned the way GL reads them.
+ ***********************************************************/
+bool GltfFile::CanDrawFromBuffer(const GLTF_PRIMITIVE& primitive) const
+{
+	if ((primitive.normal < 0) || (primitive.indices < 0))
+	{
+		return(false);
+	}
+
+	const int attributes[3] = { primitive.position, primitive.normal, primitive.uv };
+	const int componentCounts[3] = { 3, 3, 2 };
+	const GLTF_ACCESSOR& position = m_accessors[primitive.position];
+	if ((position.bufferView < 0) || (position.bHasBounds == false))
+	{
+		return(false);
+	}
+	int buffer = m_bufferViews[position.bufferView].buffer;
+	for (int a = 0; a < 3; a++)
+	{
+		if (attributes[a] < 0)
+		{
+			continue;
+		}
+		const GLTF_ACCESSOR& accessor = m_accessors[attributes[a]];
+		if ((accessor.bufferView < 0) ||
+			(accessor.componentType != g_ComponentFloat) ||
+			(accessor.componentCount != componentCounts[a]) ||
+			(accessor.count != position.count))
+		{
+			return(false);
+		}
+		const GLTF_BUFFER_VIEW& view = m_bufferViews[accessor.bufferView];
+		if ((view.buffer != buffer) || (((view.offset + accessor.offset) % 4) != 0) || ((view.stride % 4) != 0))
+		{
+			return(false);
+		}
+	}
+
+	const GLTF_ACCESSOR& indices = m_accessors[primitive.indices];
+	size_t indexSize = GetComponentSize(indices.componentType);
+	return((indices.bufferView >= 0) &&
+		((indices.componentType == g_ComponentUnsignedByte) ||
+		(indices.componentType == g_ComponentUnsignedShort) ||
+		(indices.componentType == g_ComponentUnsignedInt)) &&
+		(indices.componentCount == 1) &&
+		(m_bufferViews[indices.bufferView].buffer == buffer) &&
+		(m_bufferViews[indices.bufferView].stride == 0) &&
+		(((m_bufferViews[indices.bufferView].offset + indices.offset) % indexSize) == 0));
+}
+
+/***********************************************************
+ *  ValidateIndices()
+ *
+ *  This method is used for checking that the indices of a
+ *  primitive are unsigned integers below its number of
+ *  vertices, so a broken file can not make GL read past
+ *  the end of the vertices.
+ ***********************************************************/
+bool GltfFile::ValidateIndices(const GLTF_PRIMITIVE& primitive) const
+{
+	if (primitive.indices < 0)
+	{
+		return(true);
+	}
+
+	const GLTF_ACCESSOR& indices = m_accessors[primitive.indices];
+	if ((indices.bufferView < 0) || (indices.componentCount != 1) ||
+		((indices.componentType != g_ComponentUnsignedByte) &&
+		(indices.componentType != g_ComponentUnsignedShort) &&
+		(indices.componentType != g_ComponentUnsignedInt)))
+	{
+		return(false);
+	}
+
+	size_t vertexCount = m_accessors[primitive.position].count;
+	size_t stride = 0;
+	const unsigned char* pIndex = GetAccessorData(indices, stride);
+	for (size_t i = 0; i < indices.count; i++, pIndex += stride)
+	{
+		if (ReadIndex(pIndex, indices.componentType) >= vertexCount)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  ReadPrimitive()
+ *
+ *  This method is used for converting a primitive of any
+ *  component types into interleaved float vertices.  A
+ *  primitive without indices gets one for every vertex,
+ *  missing texture coordinates are 0, and missing normals
+ *  are the area weighted normals of the triangles around
+ *  each vertex.
+ ***********************************************************/
+bool GltfFile::ReadPrimitive(
+	const GLTF_PRIMITIVE& primitive,
+	ShapeMeshes::MESH_DATA& data) const
+{
+	const GLTF_ACCESSOR& position = m_accessors[primitive.position];
+	size_t vertexCount = position.count;
+	if ((vertexCount == 0) || (vertexCount > 0xFFFFFFFF))
+	{
+		return(false);
+	}
+
+	data.verts.assign(vertexCount * g_FloatsPerVertex, 0.0f);
+	const int attributes[3] = { primitive.position, primitive.normal, primitive.uv };
+	const int firstFloats[3] = { 0, 3, 6 };
+	const int componentCounts[3] = { 3, 3, 2 };
+	for (int a = 0; a < 3; a++)
+	{
+		if (attributes[a] < 0)
+		{
+			continue;
+		}
+		const GLTF_ACCESSOR& accessor = m_accessors[attributes[a]];
+		if ((accessor.bufferView < 0) || (accessor.count != vertexCount) || (accessor.componentCount < componentCounts[a]))
+		{
+			return(false);
+		}
+
+		size_t stride = 0;
+		size_t componentSize = GetComponentSize(accessor.componentType);
+		const unsigned char* pElement = GetAccessorData(accessor, stride);
+		for (size_t v = 0; v < vertexCount; v++, pElement += stride)
+		{
+			float* pVertex = &data.verts[v * g_FloatsPerVertex + firstFloats[a]];
+			for (int c = 0; c < componentCounts[a]; c++)
+			{
+				pVertex[c] = ReadComponent(pElement + c * componentSize, accessor.componentType, accessor.bNormalized);
+			}
+		}
+	}
+
+	if (primitive.indices >= 0)
+	{
+		const GLTF_ACCESSOR& indices = m_accessors[primitive.indices];
+		size_t stride = 0;
+		const unsigned char* pIndex = GetAccessorData(indices, stride);
+		data.indices.resize(indices.count - (indices.count % 3));
+		for (size_t i = 0; i < data.indices.size(); i++, pIndex += stride)
+		{
+			data.indices[i] = ReadIndex(pIndex, indices.componentType);
+		}
+	}
+	else
+	{
+		data.indices.resize(vertexCount - (vertexCount % 3));
+		for (size_t i = 0; i < data.indices.size(); i++)
+		{
+			data.indices[i] = (GLuint)i;
+		}
+	}
+	if (data.indices.empty() == true)
+	{
+		return(false);
+	}
+
+	if (primitive.normal < 0)
+	{
+		GenerateNormals(
+			data.verts.data(), g_FloatsPerVertex, vertexCount,
+			data.indices.data(), data.indices.size(),
+			data.verts.data() + 3, g_FloatsPerVertex);
+	}
+
+	data.rangeEnds.clear();
+	return(true);
+}
+
+/***********************************************************
+ *  LoadPrimitive()
+ *
+ *  This method is used for storing a primitive in the shape
+ *  meshes.  A primitive in the float layout is drawn from
+ *  its buffer, which is uploaded on first use straight from
+ *  the mapped file - only the part of the buffer that the
+ *  meshes read, so embedded images are left out.  Packed
+ *  vertices, or other component types, are converted into
+ *  the interleaved layout and optimized first.
+ ***********************************************************/
+bool GltfFile::LoadPrimitive(
+	int mesh,
+	int primitive,
+	ShapeMeshes* pShapeMeshes,
+	ShapeMeshes::MeshHandle& handle)
+{
+	if ((mesh < 0) || (mesh >= (int)m_meshes.size()) ||
+		(primitive < 0) || (primitive >= (int)m_meshes[mesh].primitives.size()))
+	{
+		std::cerr << "The glTF file has no primitive " << primitive << " of mesh " << mesh << ": " << m_filename << std::endl;
+		return(false);
+	}
+
+	const GLTF_PRIMITIVE& source = m_meshes[mesh].primitives[primitive];
+	if (source.mode != g_ModeTriangles)
+	{
+		std::cerr << "Only the triangles of glTF meshes are supported, not mode " << source.mode << std::endl;
+		return(false);
+	}
+	if (ValidateIndices(source) == false)
+	{
+		std::cerr << "The indices of primitive " << primitive << " of mesh " << mesh << " are not valid" << std::endl;
+		return(false);
+	}
+
+	if ((pShapeMeshes->IsPackedVertices() == false) && (CanDrawFromBuffer(source) == true))
+	{
+		const GLTF_ACCESSOR& position = m_accessors[source.position];
+		int buffer = m_bufferViews[position.bufferView].buffer;
+		size_t base = m_meshRangeBegin[buffer];
+		if (m_glBuffers[buffer] == 0)
+		{
+			m_glBuffers[buffer] = pShapeMeshes->CreateMeshBuffer(
+				m_bufferData[buffer] + base,
+				m_meshRangeEnd[buffer] - base);
+		}
+
+		ShapeMeshes::BUFFER_MESH_DATA data;
+		const GLTF_ACCESSOR& normal = m_accessors[source.normal];
+		const GLTF_ACCESSOR& indices = m_accessors[source.indices];
+		data.buffer = m_glBuffers[buffer];
+		data.positionOffset = m_bufferViews[position.bufferView].offset + position.offset - base;
+		data.positionStride = (GLsizei)m_bufferViews[position.bufferView].stride;
+		data.normalOffset = m_bufferViews[normal.bufferView].offset + normal.offset - base;
+		data.normalStride = (GLsizei)m_bufferViews[normal.bufferView].stride;
+		data.bHasUVs = (source.uv >= 0);
+		data.uvOffset = 0;
+		data.uvStride = 0;
+		if (data.bHasUVs == true)
+		{
+			const GLTF_ACCESSOR& uv = m_accessors[source.uv];
+			data.uvOffset = m_bufferViews[uv.bufferView].offset + uv.offset - base;
+			data.uvStride = (GLsizei)m_bufferViews[uv.bufferView].stride;
+		}
+		data.nVertices = (GLuint)position.count;
+		data.indexType = (GLenum)indices.componentType;
+		data.indexOffset = m_bufferViews[indices.bufferView].offset + indices.offset - base;
+		data.nIndices = (GLuint)indices.count;
+		data.boundsMin = position.boundsMin;
+		data.boundsMax = position.boundsMax;
+
+		// the meshlets are built from the positions in place and
+		// from the indices widened to 32 bits
+		size_t stride = 0;
+		const unsigned char* pIndexData = GetAccessorData(indices, stride);
+		std::vector<GLuint> meshletIndices(indices.count);
+		for (size_t i = 0; i < indices.count; i++)
+		{
+			meshletIndices[i] = ReadIndex(pIndexData + i * stride, indices.componentType);
+		}
+		data.pPositions = (const GLfloat*)GetAccessorData(position, stride);
+		data.pIndices = meshletIndices.data();
+		handle = pShapeMeshes->LoadBufferMesh(data);
+		return(true);
+	}
+
+	ShapeMeshes::MESH_DATA data;
+	if (ReadPrimitive(source, data) == false)
+	{
+		std::cerr << "Could not read primitive " << primitive << " of mesh " << mesh << ": " << m_filename << std::endl;
+		return(false);
+	}
+	OptimizeMesh(data.verts, g_FloatsPerVertex, data.indices, data.rangeEnds);
+	handle = pShapeMeshes->LoadImportedMesh(data);
+	return(true);
+}
+
+/***********************************************************
+ *  GetImagePath()
+ *
+ *  This method is used for getting a path the texture
+ *  loader can read an image from.  An image in a buffer
+ *  view or a data URI is written next to the glTF file
+ *  first, with the number of the image in its name.
+ ***********************************************************/
+std::string GltfFile::GetImagePath(int image) const
+{
+	const GLTF_IMAGE& source = m_images[image];
+	if ((source.uri.empty() == false) && (source.uri.compare(0, 5, "data:") != 0))
+	{
+		return(m_directory + DecodeUriPath(source.uri));
+	}
+
+	std::vector<unsigned char> decoded;
+	const unsigned char* pData = NULL;
+	size_t size = 0;
+	std::string mimeType = source.mimeType;
+	if (source.uri.empty() == false)
+	{
+		if (DecodeDataUri(source.uri, decoded) == true)
+		{
+			pData = decoded.data();
+			size = decoded.size();
+			mimeType = source.uri.substr(5, source.uri.find(';') - 5);
+		}
+	}
+	else if (source.bufferView >= 0)
+	{
+		const GLTF_BUFFER_VIEW& view = m_bufferViews[source.bufferView];
+		pData = m_bufferData[view.buffer] + view.offset;
+		size = view.length;
+	}
+	if ((NULL == pData) || (size == 0))
+	{
+		std::cerr << "Could not read image " << image << " of the glTF file" << std::endl;
+		return(std::string());
+	}
+
+	size_t extension = m_filename.rfind('.');
+	std::string path = m_filename.substr(0, extension) + ".image" + ToString(image) +
+		((mimeType == "image/jpeg") ? ".jpg" : ".png");
+	std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+	file.write((const char*)pData, (std::streamsize)size);
+	if (!file)
+	{
+		std::cerr << "Could not write image file: " << path << std::endl;
+		return(std::string());
+	}
+	return(path);
+}
+
+/***********************************************************
+ *  IsGltfFilename()
+ *
+ *  This function is used for checking whether a file name
+ *  has the extension of a glTF file.
+ ***********************************************************/
+bool IsGltfFilename(const std::string& filename)
+{
+	size_t extension = filename.rfind('.');
+	return((extension != std::string::npos) &&
+		((filename.compare(extension, std::string::npos, ".gltf") == 0) ||
+		(filename.compare(extension, std::string::npos, ".glb") == 0)));
+}
+
+/***********************************************************
+ *  GetGltfMeshName()
+ *
+ *  This function is used for getting the name of a
+ *  primitive as a mesh reference of a cooked scene - the
+ *  path of the file, a '#' and the mesh and primitive
+ *  numbers.
+ ***********************************************************/
+std::string GetGltfMeshName(
+	const std::string& filename,
+	int mesh,
+	int primitive)
+{
+	return(filename + "#" + ToString(mesh) + "." + ToString(primitive));
+}
+
+/***********************************************************
+ *  ParseGltfMeshName()
+ *
+ *  This function is used for splitting a mesh name made by
+ *  GetGltfMeshName() back up.
+ ***********************************************************/
+bool ParseGltfMeshName(
+	const std::string& name,
+	std::string& filename,
+	int& mesh,
+	int& primitive)
+{
+	size_t marker = name.rfind('#');
+	if (marker == std::string::npos)
+	{
+		return(false);
+	}
+
+	int consumed = 0;
+	filename = name.substr(0, marker);
+	return((IsGltfFilename(filename) == true) &&
+		(sscanf(name.c_str() + marker + 1, "%d.%d%n", &mesh, &primitive, &consumed) == 2) &&
+		((size_t)consumed == name.size() - marker - 1));
+}
+
+/***********************************************************
+ *  CookGltfScene()
+ *
+ *  This function is used for converting the default scene
+ *  of a glTF file into a cooked scene file.
+ ***********************************************************/
+bool CookGltfScene(const char* gltfFilename, const char* sceneFilename)
+{
+	GltfFile file;
+	SceneBuilder builder;
+
+	if ((file.Open(gltfFilename) == false) ||
+		(file.AddToScene(builder) == false) ||
+		(builder.Write(sceneFilename) == false))
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Cooked " << builder.GetNodeCount() << " scene nodes from "
+		<< gltfFilename << " into " << sceneFilename << std::endl;
+	return(true);
+}
@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////////
+// gltfimporter.h
+// ============
+// import glTF 2.0 scenes into cooked scene files and shape meshes
+//
+//  A .gltf or .glb file is cooked like a text scene description: the nodes
+//  of its default scene become scene nodes with their world matrices, its
+//  materials become object materials and the images of their base colors
+//  become scene textures.  Every primitive of a mesh is named in the
+//  cooked file by the path of the glTF file and its mesh and primitive
+//  numbers, and the primitives whose attributes and indices are the same
+//  accessors share one name, so a mesh used by many nodes is stored once
+//  and all its nodes draw from the same buffers.  When the scene is
+//  loaded, each named primitive is stored in the shape meshes.  A buffer
+//  is uploaded as it is, straight from the mapped .glb or .bin file, and
+//  the primitives of the usual float layout are drawn from it without a
+//  copy - any other primitive is converted into the interleaved layout.
+//  The file is read in one pass over its JSON text and its arrays, so the
+//  import time grows with the size of the file and not with the number
+//  of nodes that share its meshes.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+#include "ShapeMeshes.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SceneBuilder;
+
+// "glTF" as the first bytes of a binary .glb file, and the
+// types of its JSON and binary chunks
+const uint32_t GLB_MAGIC = 0x46546C67;
+const uint32_t GLB_VERSION = 2;
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+// a range of a buffer
+struct GLTF_BUFFER_VIEW
+{
+	int buffer;
+	size_t offset;
+	size_t length;
+	// bytes between the elements, or 0 when tightly packed
+	size_t stride;
+};
+
+// typed elements in a buffer view
+struct GLTF_ACCESSOR
+{
+	// -1 for an accessor of zeros, which is not supported
+	int bufferView;
+	size_t offset;
+	// the GL enum of the component type, and the components
+	// of each element
+	int componentType;
+	int componentCount;
+	size_t count;
+	bool bNormalized;
+	// the bounds of the first three components, which every
+	// position accessor has
+	bool bHasBounds;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+// the accessors of a drawn part of a mesh, or -1 for none
+struct GLTF_PRIMITIVE
+{
+	int position;
+	int normal;
+	int uv;
+	int indices;
+	int material;
+	// 4 for triangles
+	int mode;
+};
+
+struct GLTF_MESH
+{
+	std::vector<GLTF_PRIMITIVE> primitives;
+};
+
+// the metallic roughness values of a material, and the image
+// of its base color or -1
+struct GLTF_MATERIAL
+{
+	glm::vec4 baseColor;
+	float metallic;
+	float roughness;
+	int baseColorImage;
+	bool bBlend;
+};
+
+// an image in its own file, in a data URI or in a buffer view
+struct GLTF_IMAGE
+{
+	std::string uri;
+	int bufferView;
+	std::string mimeType;
+};
+
+struct GLTF_NODE
+{
+	// the mesh of the node or -1, and its transform relative
+	// to its parent
+	int mesh;
+	glm::mat4 localMatrix;
+	std::vector<int> children;
+};
+
+/***********************************************************
+ *  GltfFile
+ *
+ *  This class contains the code for reading a glTF file,
+ *  adding its scene to a scene builder and storing its
+ *  primitives in the shape meshes.
+ ***********************************************************/
+class GltfFile
+{
+public:
+	// constructor
+	GltfFile();
+	// destructor
+	~GltfFile();
+
+	// map and read a .gltf or .glb file and its buffers -
+	// false if it is missing, damaged or uses a feature that
+	// is not supported
+	bool Open(const char* filename);
+	void Close();
+
+	// add the materials, base color images and nodes of the
+	// default scene to a builder, with the nodes of the same
+	// primitives sharing a mesh reference
+	bool AddToScene(SceneBuilder& builder);
+	// store a primitive of a mesh in the shape meshes and get
+	// the handle that draws it
+	bool LoadPrimitive(
+		int mesh,
+		int primitive,
+		ShapeMeshes* pShapeMeshes,
+		ShapeMeshes::MeshHandle& handle);
+
+private:
+	std::string m_filename;
+	// directory of the file, which its URIs are relative to
+	std::string m_directory;
+	MappedFile m_file;
+	// the contents and sizes of the buffers, either in the
+	// mapped file, in a mapped .bin file or decoded from a
+	// data URI
+	std::vector<const unsigned char*> m_bufferData;
+	std::vector<size_t> m_bufferSizes;
+	std::vector<MappedFile*> m_bufferFiles;
+	std::vector<std::vector<unsigned char> > m_decodedBuffers;
+	// the part of each buffer read by the meshes, and the GL
+	// buffer it is uploaded to on first use, or 0
+	std::vector<size_t> m_meshRangeBegin;
+	std::vector<size_t> m_meshRangeEnd;
+	std::vector<GLuint> m_glBuffers;
+
+	std::vector<GLTF_BUFFER_VIEW> m_bufferViews;
+	std::vector<GLTF_ACCESSOR> m_accessors;
+	std::vector<GLTF_MESH> m_meshes;
+	std::vector<GLTF_MATERIAL> m_materials;
+	std::vector<GLTF_IMAGE> m_images;
+	std::vector<GLTF_NODE> m_nodes;
+	// the nodes at the top of the default scene
+	std::vector<int> m_sceneRoots;
+
+	// not copyable, as it owns the mapped buffer files
+	GltfFile(const GltfFile&);
+	GltfFile& operator=(const GltfFile&);
+
+	// read the JSON text into the arrays of the file
+	bool ReadDocument(
+		const char* pText,
+		size_t size,
+		const unsigned char* pBinaryChunk,
+		size_t binaryChunkSize);
+	// check that every reference of the arrays is in range
+	bool ValidateDocument();
+	// get the address of the first element of an accessor and
+	// the bytes between its elements
+	const unsigned char* GetAccessorData(
+		const GLTF_ACCESSOR& accessor,
+		size_t& stride) const;
+	// check whether a primitive can be drawn straight from
+	// its uploaded buffer
+	bool CanDrawFromBuffer(const GLTF_PRIMITIVE& primitive) const;
+	// check that the indices of a primitive refer to its
+	// vertices
+	bool ValidateIndices(const GLTF_PRIMITIVE& primitive) const;
+	// convert a primitive into interleaved vertices
+	bool ReadPrimitive(
+		const GLTF_PRIMITIVE& primitive,
+		ShapeMeshes::MESH_DATA& data) const;
+	// get the path of an image for the texture loader, writing
+	// it next to the glTF file when it is embedded
+	std::string GetImagePath(int image) const;
+};
+
+// check whether a file name has the .gltf or .glb extension
+bool IsGltfFilename(const std::string& filename);
+// get the mesh name of a primitive in a cooked scene, and split
+// a mesh name back up - false if it does not name a primitive
+std::string GetGltfMeshName(
+	const std::string& filename,
+	int mesh,
+	int primitive);
+bool ParseGltfMeshName(
+	const std::string& name,
+	std::string& filename,
+	int& mesh,
+	int& primitive);
+// convert a glTF file into a cooked scene file
+bool CookGltfScene(const char* gltfFilename, const char* sceneFilename);
@@ -0,0 +1,498 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.cpp
+// ============
+// cull the scene objects on the GPU into indirect draw commands
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuCuller.h"
+
+#include <algorithm>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_DepthTextureName = "depthTexture";
+	const char* g_DepthPyramidName = "depthPyramid";
+
+	// texture units of the depth copy and the depth pyramid,
+	// above the units of the scene textures and the targets of
+	// the weighted transparency
+	const int g_DepthUnit = 18;
+	const int g_PyramidUnit = 19;
+
+	// invocations in a work group of the culling shader, and
+	// texels across a work group of the pyramid shader
+	const int g_CullGroupSize = 64;
+	const int g_PyramidGroupSize = 8;
+
+	// the command read by the indirect draws, written by the
+	// culling shader
+	struct DRAW_ELEMENTS_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+}
+
+/***********************************************************
+ *  GpuCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuCuller::GpuCuller(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_cullShader.m_programID = 0;
+	m_depthPyramidShader.m_programID = 0;
+	for (int i = 0; i < BUFFER_COUNT; i++)
+	{
+		m_buffers[i] = 0;
+	}
+	m_objectCount = 0;
+	m_bIndirectCount = false;
+	m_bSupported = false;
+	m_bEnabled = false;
+	m_levelsPerMesh = 1;
+	m_lodHysteresis = 0.0f;
+	m_depthFramebuffer = 0;
+	m_depthTexture = 0;
+	m_pyramidTexture = 0;
+	m_width = 0;
+	m_height = 0;
+	m_pyramidLevels = 0;
+	m_viewProjection = glm::mat4(1.0f);
+	m_pyramidViewProjection = glm::mat4(1.0f);
+	m_bPyramidValid = false;
+	m_bPyramidFailed = false;
+}
+
+/***********************************************************
+ *  ~GpuCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GpuCuller::~GpuCuller()
+{
+	DestroyPyramid();
+
+	if (m_buffers[0] != 0)
+	{
+		glDeleteBuffers(BUFFER_COUNT, m_buffers);
+	}
+	if (m_cullShader.m_programID != 0)
+	{
+		glDeleteProgram(m_cullShader.m_programID);
+	}
+	if (m_depthPyramidShader.m_programID != 0)
+	{
+		glDeleteProgram(m_depthPyramidShader.m_programID);
+	}
+	m_pShaderManager = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the compute shaders that
+ *  cull the objects and build the depth pyramid, and for
+ *  creating the buffers.  Compute shaders, storage buffers
+ *  and indirect draws all need OpenGL 4.3, and counting the
+ *  draws in a buffer needs OpenGL 4.6 or
+ *  ARB_indirect_parameters.
+ ***********************************************************/
+bool GpuCuller::Initialize()
+{
+	if (!GLEW_VERSION_4_3)
+	{
+		std::cerr << "GPU driven culling needs OpenGL 4.3, the objects are culled on the CPU" << std::endl;
+		return(false);
+	}
+
+	m_cullShader.LoadComputeShader("../../Utilities/shaders/cullComputeShader.glsl");
+	m_depthPyramidShader.LoadComputeShader("../../Utilities/shaders/hiZComputeShader.glsl");
+	if ((m_cullShader.m_programID == 0) || (m_depthPyramidShader.m_programID == 0))
+	{
+		std::cerr << "Could not load the GPU culling shaders, the objects are culled on the CPU" << std::endl;
+		return(false);
+	}
+
+	m_cullShader.use();
+	m_cullShader.setSampler2DValue(g_DepthPyramidName, g_PyramidUnit);
+	m_depthPyramidShader.use();
+	m_depthPyramidShader.setSampler2DValue(g_DepthTextureName, g_DepthUnit);
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->use();
+	}
+
+	glGenBuffers(BUFFER_COUNT, m_buffers);
+	m_bIndirectCount = (GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters);
+	m_bSupported = true;
+	return(true);
+}
+
+/***********************************************************
+ *  SetLevelThresholds()
+ *
+ *  This method is used for setting the screen sizes of the
+ *  detail levels used by the compute shader, the same ones
+ *  the objects culled on the CPU use.
+ ***********************************************************/
+void GpuCuller::SetLevelThresholds(
+	const float* pThresholds,
+	int levelsPerMesh,
+	float hysteresis)
+{
+	m_lodThresholds.assign(pThresholds, pThresholds + std::max(levelsPerMesh - 1, 0));
+	m_levelsPerMesh = levelsPerMesh;
+	m_lodHysteresis = hysteresis;
+}
+
+/***********************************************************
+ *  SetObjects()
+ *
+ *  This method is used for uploading the objects, the
+ *  detail levels of their meshes and the first object of
+ *  each batch, and for sizing the command buffer to one
+ *  command per object.  The objects of a batch must follow
+ *  each other, so each batch owns the commands of its own
+ *  objects.
+ ***********************************************************/
+void GpuCuller::SetObjects(
+	const std::vector<GPU_OBJECT>& objects,
+	const std::vector<GPU_MESH_LEVEL>& meshLevels,
+	const std::vector<int>& batchCounts)
+{
+	m_objectCount = 0;
+	m_batchStarts.clear();
+	m_batchCounts.clear();
+	m_bPyramidValid = false;
+	if ((m_bSupported == false) || (objects.empty() == true) || (meshLevels.empty() == true))
+	{
+		return;
+	}
+
+	std::vector<GLuint> batchStarts;
+	int start = 0;
+	for (size_t i = 0; i < batchCounts.size(); i++)
+	{
+		m_batchStarts.push_back(start);
+		m_batchCounts.push_back(batchCounts[i]);
+		batchStarts.push_back((GLuint)start);
+		start += batchCounts[i];
+	}
+
+	// the vertex attribute of the object index of each draw is
+	// read at its base instance, which is its object
+	std::vector<GLuint> objectIndices(objects.size());
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		objectIndices[i] = (GLuint)i;
+	}
+	std::vector<GLuint> drawCounts(batchCounts.size(), 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffers[BUFFER_OBJECT_DRAWS]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPU_OBJECT) * objects.size(), objects.data(), GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffers[BUFFER_MESH_LEVELS]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPU_MESH_LEVEL) * meshLevels.size(), meshLevels.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffers[BUFFER_BATCH_STARTS]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * batchStarts.size(), batchStarts.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffers[BUFFER_DRAW_COMMANDS]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DRAW_ELEMENTS_COMMAND) * objects.size(), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffers[BUFFER_DRAW_COUNTS]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * drawCounts.size(), drawCounts.data(), GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, m_buffers[BUFFER_OBJECT_INDICES]);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint) * objectIndices.size(), objectIndices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_objectCount = (int)objects.size();
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used for turning the culling on or off.
+ *  The depth pyramid is from the last frame drawn with the
+ *  culling on, so it is forgotten.
+ ***********************************************************/
+void GpuCuller::SetEnabled(bool bEnabled)
+{
+	if (bEnabled == m_bEnabled)
+	{
+		return;
+	}
+
+	m_bEnabled = bEnabled;
+	m_bPyramidValid = false;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for running the compute shader that
+ *  writes the draw commands of the visible objects.  With
+ *  the draw counts, the commands of each batch are appended
+ *  from its start and counted, else every object writes its
+ *  own command, empty when it is hidden.  The scene shader
+ *  program is in use again afterwards.
+ ***********************************************************/
+void GpuCuller::Cull(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	bool bLevelOfDetail)
+{
+	m_viewProjection = projection * view;
+	if ((m_bEnabled == false) || (m_objectCount == 0))
+	{
+		return;
+	}
+
+	if (m_bIndirectCount == true)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffers[BUFFER_DRAW_COUNTS]);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_DRAWS_BINDING, m_buffers[BUFFER_OBJECT_DRAWS]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_LEVELS_BINDING, m_buffers[BUFFER_MESH_LEVELS]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BATCH_STARTS_BINDING, m_buffers[BUFFER_BATCH_STARTS]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COMMANDS_BINDING, m_buffers[BUFFER_DRAW_COMMANDS]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNTS_BINDING, m_buffers[BUFFER_DRAW_COUNTS]);
+
+	m_cullShader.use();
+	m_cullShader.setIntValue("objectCount", m_objectCount);
+	m_cullShader.setMat4Value("viewProjection", m_viewProjection);
+	m_cullShader.setMat4Value("view", view);
+	m_cullShader.setFloatValue("projectionScale", projection[1][1]);
+	m_cullShader.setBoolValue("bPerspective", projection[2][3] != 0.0f);
+	m_cullShader.setBoolValue("bDepthPyramid", m_bPyramidValid);
+	m_cullShader.setMat4Value("pyramidViewProjection", m_pyramidViewProjection);
+	m_cullShader.setIntValue("pyramidLevels", m_pyramidLevels);
+	m_cullShader.setBoolValue("bLevelOfDetail", bLevelOfDetail);
+	m_cullShader.setIntValue("levelsPerMesh", m_levelsPerMesh);
+	if (m_lodThresholds.empty() == false)
+	{
+		glUniform1fv(glGetUniformLocation(m_cullShader.m_programID, "lodThresholds"),
+			(GLsizei)m_lodThresholds.size(), m_lodThresholds.data());
+	}
+	m_cullShader.setFloatValue("lodHysteresis", m_lodHysteresis);
+	m_cullShader.setBoolValue("bCompactCommands", m_bIndirectCount);
+	glDispatchCompute((m_objectCount + g_CullGroupSize - 1) / g_CullGroupSize, 1, 1);
+
+	// the draws read the commands and the counts, and the
+	// vertex shader the objects
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->use();
+	}
+}
+
+/***********************************************************
+ *  BeginDraws()
+ *
+ *  This method is used for binding the objects for the
+ *  vertex shader, and the commands and their counts for
+ *  the indirect draws of the batches.
+ ***********************************************************/
+void GpuCuller::BeginDraws()
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_DRAWS_BINDING, m_buffers[BUFFER_OBJECT_DRAWS]);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_buffers[BUFFER_DRAW_COMMANDS]);
+	if (m_bIndirectCount == true)
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, m_buffers[BUFFER_DRAW_COUNTS]);
+	}
+}
+
+/***********************************************************
+ *  DrawBatch()
+ *
+ *  This method is used for drawing the commands of a batch
+ *  with one call.  With the draw counts, the GPU reads how
+ *  many commands the culling appended to the batch, else
+ *  every object of the batch is drawn, and the hidden ones
+ *  have no instances.
+ ***********************************************************/
+void GpuCuller::DrawBatch(int batch)
+{
+	if ((m_bEnabled == false) || (batch < 0) || (batch >= (int)m_batchStarts.size()) || (m_batchCounts[batch] == 0))
+	{
+		return;
+	}
+
+	const void* pCommands = (const void*)(sizeof(DRAW_ELEMENTS_COMMAND) * m_batchStarts[batch]);
+	if ((m_bIndirectCount == true) && GLEW_VERSION_4_6)
+	{
+		glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands,
+			(GLintptr)(sizeof(GLuint) * batch), m_batchCounts[batch], sizeof(DRAW_ELEMENTS_COMMAND));
+	}
+	else if (m_bIndirectCount == true)
+	{
+		glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands,
+			(GLintptr)(sizeof(GLuint) * batch), m_batchCounts[batch], sizeof(DRAW_ELEMENTS_COMMAND));
+	}
+	else
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands,
+			m_batchCounts[batch], sizeof(DRAW_ELEMENTS_COMMAND));
+	}
+}
+
+/***********************************************************
+ *  BuildDepthPyramid()
+ *
+ *  This method is used for copying the depth buffer of the
+ *  window and reducing it level by level into the pyramid,
+ *  each texel keeping the farthest depth under it, and for
+ *  keeping the camera of the frame for the next culling.
+ *  The scene shader program is in use again afterwards.
+ ***********************************************************/
+void GpuCuller::BuildDepthPyramid()
+{
+	if ((m_bEnabled == false) || (m_objectCount == 0) || (m_bPyramidFailed == true))
+	{
+		return;
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	bool bNewPyramid = (viewport[2] != m_width) || (viewport[3] != m_height);
+	if ((bNewPyramid == true) && (CreatePyramid(viewport[2], viewport[3]) == false))
+	{
+		std::cerr << "Could not create the depth pyramid, the GPU culling only tests the frustum" << std::endl;
+		DestroyPyramid();
+		m_bPyramidFailed = true;
+		return;
+	}
+
+	// the depth formats of the window and the copy must match,
+	// which is checked the first time
+	if (bNewPyramid == true)
+	{
+		while (glGetError() != GL_NO_ERROR)
+		{
+		}
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_depthFramebuffer);
+	glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if ((bNewPyramid == true) && (glGetError() != GL_NO_ERROR))
+	{
+		std::cerr << "Could not copy the window depth for the depth pyramid, the GPU culling only tests the frustum" << std::endl;
+		DestroyPyramid();
+		m_bPyramidFailed = true;
+		return;
+	}
+
+	// the first level copies the depth, and every other level
+	// is reduced from the one before it
+	m_depthPyramidShader.use();
+	int width = m_width;
+	int height = m_height;
+	for (int level = 0; level < m_pyramidLevels; level++)
+	{
+		if (level > 0)
+		{
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+			glBindImageTexture(0, m_pyramidTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		}
+		glBindImageTexture(1, m_pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		m_depthPyramidShader.setBoolValue("bCopyDepth", level == 0);
+		glDispatchCompute((width + g_PyramidGroupSize - 1) / g_PyramidGroupSize,
+			(height + g_PyramidGroupSize - 1) / g_PyramidGroupSize, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	// the culling of the next frame fetches the pyramid texels
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	m_pyramidViewProjection = m_viewProjection;
+	m_bPyramidValid = true;
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->use();
+	}
+}
+
+/***********************************************************
+ *  CreatePyramid()
+ *
+ *  This method is used for creating the depth copy, in the
+ *  format of the depth buffer of the window, and the
+ *  pyramid with every level down to a single texel.  Both
+ *  stay bound to their own texture units.
+ ***********************************************************/
+bool GpuCuller::CreatePyramid(int width, int height)
+{
+	DestroyPyramid();
+	m_width = width;
+	m_height = height;
+	m_pyramidLevels = 1;
+	while ((std::max(width, height) >> m_pyramidLevels) > 0)
+	{
+		m_pyramidLevels++;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + g_DepthUnit);
+	glGenTextures(1, &m_depthTexture);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glActiveTexture(GL_TEXTURE0 + g_PyramidUnit);
+	glGenTextures(1, &m_pyramidTexture);
+	glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+	glTexStorage2D(GL_TEXTURE_2D, m_pyramidLevels, GL_R32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glActiveTexture(GL_TEXTURE0);
+
+	glGenFramebuffers(1, &m_depthFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_depthFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return(bComplete);
+}
+
+/***********************************************************
+ *  DestroyPyramid()
+ *
+ *  This method is used for freeing the depth copy and the
+ *  pyramid.
+ ***********************************************************/
+void GpuCuller::DestroyPyramid()
+{
+	if (m_depthFramebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_depthFramebuffer);
+		m_depthFramebuffer = 0;
+	}
+	if (m_depthTexture != 0)
+	{
+		glDeleteTextures(1, &m_depthTexture);
+		m_depthTexture = 0;
+	}
+	if (m_pyramidTexture != 0)
+	{
+		glDeleteTextures(1, &m_pyramidTexture);
+		m_pyramidTexture = 0;
+	}
+	m_width = 0;
+	m_height = 0;
+	m_pyramidLevels = 0;
+	m_bPyramidValid = false;
+}
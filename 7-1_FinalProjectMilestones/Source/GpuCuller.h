@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.h
+// ============
+// cull the scene objects on the GPU into indirect draw commands
+//
+//  The values of every object culled this way - its model matrix, color,
+//  material, world-space bounding box and the mesh it draws - are
+//  uploaded once into a shader storage buffer.  Every frame a compute
+//  shader tests each object against the frustum of the camera and
+//  against a depth pyramid built from the depth buffer of the previous
+//  frame, chooses its detail level from its size on the screen, and
+//  appends a draw command for each visible object to the batch of its
+//  texture in an indirect draw buffer, counting the commands of each
+//  batch in a parameter buffer.  Each batch is then drawn with one
+//  glMultiDrawElementsIndirectCount() call, so the CPU does the same
+//  work every frame however many objects there are.  Every command has
+//  its object as its base instance, from which the vertex shader reads
+//  the values of the object.  Without OpenGL 4.6 or
+//  ARB_indirect_parameters, every object keeps a command of its own that
+//  is left empty when it is hidden, and the whole batch is drawn with
+//  glMultiDrawElementsIndirect().  The depth pyramid holds the farthest
+//  depth under each of its texels, so an object whose box is behind it
+//  is hidden - a test one frame late, like the occlusion queries, that
+//  never stalls the CPU.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <vector>
+
+// shader storage buffer bindings shared by the shaders and the
+// code - the binding qualifiers of the shaders match these
+enum StorageBlockBinding
+{
+	// the ObjectDraws buffer, read by the vertex shader too
+	OBJECT_DRAWS_BINDING = 0,
+	MESH_LEVELS_BINDING = 1,
+	BATCH_STARTS_BINDING = 2,
+	DRAW_COMMANDS_BINDING = 3,
+	DRAW_COUNTS_BINDING = 4,
+	// the Materials buffer of the fragment shader, uploaded once
+	// with the scene
+	MATERIALS_BINDING = 5
+};
+
+/***********************************************************
+ *  GPU_OBJECT
+ *
+ *  This structure matches the std430 layout of one entry
+ *  of the ObjectDraws buffer in the shaders.
+ ***********************************************************/
+struct GPU_OBJECT
+{
+	// model matrix with the position decode of the mesh
+	glm::mat4 model;
+	glm::vec4 objectColor;
+	// world-space bounding box, with w unused
+	glm::vec4 boundsCenter;
+	glm::vec4 boundsExtents;
+	glm::vec2 UVscale;
+	int bUseTexture;
+	int materialIndex;
+	// batch the object is drawn in, and the mesh whose levels
+	// it draws from the mesh level buffer
+	GLuint batch;
+	GLuint mesh;
+	// detail level, kept by the compute shader between frames
+	int lod;
+	int padding;
+};
+
+/***********************************************************
+ *  GPU_MESH_LEVEL
+ *
+ *  This structure matches the std430 layout of one entry
+ *  of the MeshLevels buffer in the compute shader.
+ ***********************************************************/
+struct GPU_MESH_LEVEL
+{
+	GLuint indexCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint padding;
+};
+
+/***********************************************************
+ *  GpuCuller
+ *
+ *  This class contains the code for culling the objects
+ *  with a compute shader, drawing the visible ones with
+ *  indirect commands and building the depth pyramid.
+ ***********************************************************/
+class GpuCuller
+{
+public:
+	// constructor
+	GpuCuller(ShaderManager* pShaderManager);
+	// destructor
+	~GpuCuller();
+
+	// load the compute shaders - false when compute shaders
+	// are not supported, in which case nothing is culled here
+	bool Initialize();
+	bool IsSupported() const { return(m_bSupported); }
+
+	// set the screen sizes below which each detail level
+	// switches to the next coarser one, for the passed in
+	// number of levels per mesh, and how far past a threshold
+	// the size must move before the level changes
+	void SetLevelThresholds(
+		const float* pThresholds,
+		int levelsPerMesh,
+		float hysteresis);
+
+	// upload the objects, sorted by batch, the detail levels of
+	// the meshes by mesh handle, with the levels per mesh of
+	// the thresholds, and the number of objects of each batch
+	void SetObjects(
+		const std::vector<GPU_OBJECT>& objects,
+		const std::vector<GPU_MESH_LEVEL>& meshLevels,
+		const std::vector<int>& batchCounts);
+	int GetObjectCount() const { return(m_objectCount); }
+	int GetBatchCount() const { return((int)m_batchStarts.size()); }
+
+	// enable or disable the culling - the depth pyramid of a
+	// frame drawn before the culling was turned off is stale,
+	// so it is forgotten
+	void SetEnabled(bool bEnabled);
+	bool IsEnabled() const { return(m_bEnabled); }
+
+	// test all the objects against the camera of the frame and
+	// the depth pyramid of the previous frame, and write the
+	// draw commands of the visible ones
+	void Cull(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		bool bLevelOfDetail);
+	// bind the buffers the draws read - the scene program and
+	// the vertex array of the indirect draws must be bound
+	void BeginDraws();
+	// draw the commands of a batch with one call
+	void DrawBatch(int batch);
+	// get the buffer of the object indices, read per instance
+	// by the indirect draws
+	GLuint GetObjectIndexBuffer() const { return(m_buffers[BUFFER_OBJECT_INDICES]); }
+
+	// copy the depth buffer of the window and reduce it into
+	// the depth pyramid, for culling the next frame - called
+	// once the opaque objects are drawn
+	void BuildDepthPyramid();
+
+private:
+	// buffers of the objects, their meshes and their commands
+	enum BufferType
+	{
+		BUFFER_OBJECT_DRAWS,
+		BUFFER_MESH_LEVELS,
+		BUFFER_BATCH_STARTS,
+		BUFFER_DRAW_COMMANDS,
+		BUFFER_DRAW_COUNTS,
+		BUFFER_OBJECT_INDICES,
+		BUFFER_COUNT
+	};
+
+	// pointer to the shader manager of the scene shaders
+	ShaderManager* m_pShaderManager;
+	// programs that cull the objects and build the pyramid
+	ShaderManager m_cullShader;
+	ShaderManager m_depthPyramidShader;
+	GLuint m_buffers[BUFFER_COUNT];
+	int m_objectCount;
+	// first object and number of objects of each batch
+	std::vector<int> m_batchStarts;
+	std::vector<int> m_batchCounts;
+	// whether the visible commands are counted for drawing
+	// with glMultiDrawElementsIndirectCount()
+	bool m_bIndirectCount;
+	bool m_bSupported;
+	bool m_bEnabled;
+
+	// detail level thresholds of the compute shader
+	std::vector<float> m_lodThresholds;
+	int m_levelsPerMesh;
+	float m_lodHysteresis;
+
+	// window depth copied after the opaque objects, and the
+	// pyramid of the farthest depths reduced from it
+	GLuint m_depthFramebuffer;
+	GLuint m_depthTexture;
+	GLuint m_pyramidTexture;
+	int m_width;
+	int m_height;
+	int m_pyramidLevels;
+	// camera of the frame being culled, and of the frame the
+	// pyramid was built in
+	glm::mat4 m_viewProjection;
+	glm::mat4 m_pyramidViewProjection;
+	bool m_bPyramidValid;
+	// set once the pyramid failed, so it is not tried again
+	bool m_bPyramidFailed;
+
+	// create the depth copy and the pyramid at the size of
+	// the viewport
+	bool CreatePyramid(int width, int height);
+	void DestroyPyramid();
+};
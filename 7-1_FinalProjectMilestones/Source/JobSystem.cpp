@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// work-stealing scheduler for the per-frame CPU work
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+// declaration of global variables
+namespace
+{
+	// the job system and queue index of the calling thread - set
+	// only on worker threads, every other thread uses queue 0
+	thread_local const JobSystem* t_pJobSystem = NULL;
+	thread_local int t_threadIndex = 0;
+
+	// attempts to find a job before an idle worker goes to sleep
+	const int g_IdleSpinCount = 64;
+}
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem(int threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = (int)std::thread::hardware_concurrency();
+	}
+	m_threadCount = std::max(threadCount, 1);
+	m_pQueues = new JOB_QUEUE[m_threadCount];
+	m_queuedJobs = 0;
+	m_sleepingWorkers = 0;
+	m_bShutdown = false;
+
+	// queue 0 belongs to the creating thread
+	for (int i = 1; i < m_threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_bShutdown = true;
+	}
+	m_jobQueued.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+
+	delete[] m_pQueues;
+	m_pQueues = NULL;
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for adding a job to the back of the
+ *  queue of the calling thread and waking up a sleeping
+ *  worker to take it.
+ ***********************************************************/
+void JobSystem::Run(
+	JobFunction function,
+	void* pData,
+	int first,
+	int last,
+	JOB_COUNTER* pCounter)
+{
+	JOB job;
+	job.function = function;
+	job.pData = pData;
+	job.first = first;
+	job.last = last;
+	job.pCounter = pCounter;
+
+	// count the job before it can be taken, so the counter
+	// cannot reach zero while the job is still queued
+	if (NULL != pCounter)
+	{
+		pCounter->pending++;
+	}
+
+	JOB_QUEUE& queue = m_pQueues[GetThreadIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+	m_queuedJobs++;
+
+	// a worker counts itself as sleeping before it checks for
+	// queued jobs, so either it sees this job or it is woken
+	if (m_sleepingWorkers > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_jobQueued.notify_one();
+	}
+}
+
+/***********************************************************
+ *  Wait()
+ *
+ *  This method is used for running queued jobs, from any
+ *  thread, until all the jobs of the passed in counter are
+ *  finished.
+ ***********************************************************/
+void JobSystem::Wait(JOB_COUNTER* pCounter)
+{
+	int threadIndex = GetThreadIndex();
+
+	while (pCounter->pending > 0)
+	{
+		if (RunQueuedJob(threadIndex) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/***********************************************************
+ *  GetThreadIndex()
+ *
+ *  This method is used for getting the index of the queue
+ *  that belongs to the calling thread.
+ ***********************************************************/
+int JobSystem::GetThreadIndex() const
+{
+	return((t_pJobSystem == this) ? t_threadIndex : 0);
+}
+
+/***********************************************************
+ *  PopJob()
+ *
+ *  This method is used for taking the newest job from the
+ *  queue of the passed in thread, or when that queue is
+ *  empty, the oldest job from the queue of another thread.
+ ***********************************************************/
+bool JobSystem::PopJob(int threadIndex, JOB& job)
+{
+	if (m_queuedJobs <= 0)
+	{
+		return(false);
+	}
+
+	{
+		JOB_QUEUE& queue = m_pQueues[threadIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty() == false)
+		{
+			job = queue.jobs.back();
+			queue.jobs.pop_back();
+			m_queuedJobs--;
+			return(true);
+		}
+	}
+
+	for (int i = 1; i < m_threadCount; i++)
+	{
+		JOB_QUEUE& queue = m_pQueues[(threadIndex + i) % m_threadCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty() == false)
+		{
+			job = queue.jobs.front();
+			queue.jobs.pop_front();
+			m_queuedJobs--;
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  RunQueuedJob()
+ *
+ *  This method is used for running one queued job and
+ *  counting it as finished.
+ ***********************************************************/
+bool JobSystem::RunQueuedJob(int threadIndex)
+{
+	JOB job;
+
+	if (PopJob(threadIndex, job) == false)
+	{
+		return(false);
+	}
+
+	job.function(job.pData, job.first, job.last);
+	if (NULL != job.pCounter)
+	{
+		job.pCounter->pending--;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for running a worker thread, which
+ *  runs jobs while there are any and otherwise sleeps until
+ *  a new job is queued.
+ ***********************************************************/
+void JobSystem::WorkerLoop(int threadIndex)
+{
+	t_pJobSystem = this;
+	t_threadIndex = threadIndex;
+
+	while (true)
+	{
+		// keep looking for a while before sleeping, since the
+		// jobs of one frame are queued in quick succession
+		bool bFound = false;
+		for (int i = 0; (i < g_IdleSpinCount) && (bFound == false); i++)
+		{
+			bFound = RunQueuedJob(threadIndex);
+			if (bFound == false)
+			{
+				std::this_thread::yield();
+			}
+		}
+		if (bFound)
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleepingWorkers++;
+		m_jobQueued.wait(lock, [this]() { return(m_bShutdown || (m_queuedJobs > 0)); });
+		m_sleepingWorkers--;
+		if (m_bShutdown)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// work-stealing scheduler for the per-frame CPU work
+//
+//  Every thread of the job system, including the thread that created it,
+//  has its own queue of jobs.  A thread adds new jobs to the back of its
+//  own queue and takes its next job from the back as well, so the work it
+//  just split up stays in its cache.  A thread whose queue is empty steals
+//  the oldest job from the front of another thread's queue, which is
+//  usually the largest piece of remaining work.  A thread that waits for
+//  its jobs to finish runs queued jobs in the meantime instead of
+//  blocking, so jobs can start and wait for child jobs of their own.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class contains the worker threads and job queues
+ *  that run ranges of work in parallel.
+ ***********************************************************/
+class JobSystem
+{
+public:
+	// function run by a job for the items from first up to
+	// but not including last
+	typedef void (*JobFunction)(void* pData, int first, int last);
+
+	// number of jobs started with the counter that have not
+	// finished - a job that starts child jobs with the counter
+	// of its parent keeps the parent waiting until the child
+	// jobs are finished as well
+	struct JOB_COUNTER
+	{
+		std::atomic<int> pending;
+
+		JOB_COUNTER() : pending(0) {}
+	};
+
+	// constructor - the thread count includes the calling
+	// thread, and 0 uses one thread per hardware thread
+	JobSystem(int threadCount);
+	// destructor
+	~JobSystem();
+
+	// number of threads that run jobs, including the thread
+	// that created the job system
+	int GetThreadCount() const { return(m_threadCount); }
+	// index of the calling thread, from 0 up to the thread
+	// count - threads outside the job system share index 0
+	int GetThreadIndex() const;
+
+	// queue a job on the calling thread, counted by the
+	// passed in counter
+	void Run(
+		JobFunction function,
+		void* pData,
+		int first,
+		int last,
+		JOB_COUNTER* pCounter);
+	// run queued jobs until all the jobs of the passed in
+	// counter are finished
+	void Wait(JOB_COUNTER* pCounter);
+
+	// call body(first, last) over ranges that together cover
+	// the items from 0 up to count, on all the threads, and
+	// return when every range is finished - ranges are never
+	// smaller than the grain size, except the last one
+	template<class Body>
+	void ParallelFor(int count, int grainSize, const Body& body);
+
+private:
+	// a range of work waiting to be run
+	struct JOB
+	{
+		JobFunction function;
+		void* pData;
+		int first;
+		int last;
+		JOB_COUNTER* pCounter;
+	};
+
+	// the jobs queued by one thread - padded so the queues of
+	// different threads are not on the same cache line
+	struct JOB_QUEUE
+	{
+		std::mutex mutex;
+		std::deque<JOB> jobs;
+		char padding[64];
+	};
+
+	int m_threadCount;
+	JOB_QUEUE* m_pQueues;
+	std::vector<std::thread> m_workers;
+	// jobs waiting in all the queues
+	std::atomic<int> m_queuedJobs;
+	// idle worker threads sleep until a job is queued
+	std::mutex m_sleepMutex;
+	std::condition_variable m_jobQueued;
+	std::atomic<int> m_sleepingWorkers;
+	bool m_bShutdown;
+
+	// take a job from the queue of the passed in thread, or
+	// steal one from another thread - false if none was found
+	bool PopJob(int threadIndex, JOB& job);
+	// run one queued job - false if none was found
+	bool RunQueuedJob(int threadIndex);
+	// the loop run by every worker thread
+	void WorkerLoop(int threadIndex);
+
+	// call the body of a ParallelFor() for a range
+	template<class Body>
+	static void RunBody(void* pData, int first, int last)
+	{
+		(*static_cast<const Body*>(pData))(first, last);
+	}
+};
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method is used for splitting the items from 0 up to
+ *  count into ranges of at least the grain size, queueing
+ *  all the ranges but the first, running the first one on
+ *  the calling thread and then helping with the rest.
+ ***********************************************************/
+template<class Body>
+void JobSystem::ParallelFor(int count, int grainSize, const Body& body)
+{
+	// a few ranges per thread, so a thread that falls behind
+	// can have its work stolen
+	int rangeSize = std::max(std::max(grainSize, 1), count / (m_threadCount * 4));
+
+	if ((m_threadCount <= 1) || (count <= rangeSize))
+	{
+		if (count > 0)
+		{
+			body(0, count);
+		}
+		return;
+	}
+
+	JOB_COUNTER counter;
+	for (int first = rangeSize; first < count; first += rangeSize)
+	{
+		Run(&RunBody<Body>, (void*)&body, first, std::min(first + rangeSize, count), &counter);
+	}
+	body(0, rangeSize);
+	Wait(&counter);
+}
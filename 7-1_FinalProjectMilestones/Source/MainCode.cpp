@@ -1,5 +1,11 @@
 #include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
+#include <cstdlib>          // EXIT_FAILURE, atoi
+#include <cstdio>           // remove
+#include <cstring>          // strcmp
+#include <string>           // frame report label
+#include <vector>           // stress scene sizes
+#include <fstream>          // stress report
+#include <algorithm>        // std::min, std::max
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +19,12 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "FrameProfiler.h"
+#include "FramePacer.h"
+#include "RenderSettings.h"
+#include "Benchmarks.h"
+#include "SceneBuilder.h"
+#include "StressScene.h"
 
 // Namespace for declaring global variables
 namespace
@@ -29,12 +41,41 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// frame profiler object for measuring the CPU and GPU frame times
+	FrameProfiler* g_FrameProfiler = nullptr;
+	// frame pacer object for limiting the frames in flight
+	FramePacer* g_FramePacer = nullptr;
+
+	// switches for the optional rendering features
+	RENDER_SETTINGS g_RenderSettings;
+	// name of the benchmark to run instead of the scene
+	const char* g_BenchmarkName = nullptr;
+	// text scene description and scene file to cook instead
+	// of running the scene
+	const char* g_CookTextFile = nullptr;
+	const char* g_CookSceneFile = nullptr;
+
+	// object counts of the stress scenes to measure instead of
+	// running the scene, and how they are generated and run
+	std::vector<int> g_StressSizes;
+	STRESS_SCENE_SETTINGS g_StressSettings;
+	const char* g_StressReportFile = "stress.csv";
+	const char* g_StressSceneFile = "stress.scene";
+	int g_StressFrames = 300;
+	// frames drawn before the measuring starts, and the number
+	// of points of the camera path
+	const int g_StressWarmupFrames = 30;
+	const int g_StressPathPoints = 8;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+bool ParseCommandLine(int argc, char* argv[]);
+bool ParseStressSizes(const char* text);
+void RenderFrame();
+bool RunStressTest();
 
 
 /***********************************************************
@@ -45,6 +86,34 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// read the rendering switches from the command line
+	if (ParseCommandLine(argc, argv) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// run the requested benchmark without opening a window
+	if (NULL != g_BenchmarkName)
+	{
+		if (RunBenchmark(g_BenchmarkName) == false)
+		{
+			std::cerr << "Unknown benchmark: " << g_BenchmarkName << std::endl;
+			PrintBenchmarkNames();
+			return(EXIT_FAILURE);
+		}
+		return(EXIT_SUCCESS);
+	}
+
+	// convert a text scene description without opening a window
+	if (NULL != g_CookTextFile)
+	{
+		if (CookSceneFile(g_CookTextFile, g_CookSceneFile) == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		return(EXIT_SUCCESS);
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -55,7 +124,8 @@ int main(int argc, char* argv[])
 	g_ShaderManager = new ShaderManager();
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_ShaderManager,
+		&g_RenderSettings);
 
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
@@ -72,36 +142,45 @@ int main(int argc, char* argv[])
 		"../../Utilities/shaders/fragmentShader.glsl");
 	g_ShaderManager->use();
 
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
+	// try to create a new frame profiler object for timing the frames
+	g_FrameProfiler = new FrameProfiler();
+	g_FrameProfiler->Initialize();
 
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
-	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+	// try to create a new frame pacer object for the frames in flight
+	g_FramePacer = new FramePacer();
+	g_FramePacer->Initialize();
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
-
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+	bool bSuccess = true;
+	if (g_StressSizes.empty() == false)
+	{
+		// measure the generated stress scenes, then exit
+		bSuccess = RunStressTest();
+	}
+	else
+	{
+		// try to create a new scene manager object and prepare the 3D scene
+		g_SceneManager = new SceneManager(g_ShaderManager, &g_RenderSettings);
+		g_SceneManager->PrepareScene();
 
-		// query the latest GLFW events
-		glfwPollEvents();
+		// loop will keep running until the application is closed 
+		// or until an error has occurred
+		while (!glfwWindowShouldClose(g_Window))
+		{
+			RenderFrame();
+		}
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != g_FramePacer)
+	{
+		delete g_FramePacer;
+		g_FramePacer = NULL;
+	}
+	if (NULL != g_FrameProfiler)
+	{
+		delete g_FrameProfiler;
+		g_FrameProfiler = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
@@ -119,7 +198,365 @@ int main(int argc, char* argv[])
 	}
 
 	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	exit(bSuccess ? EXIT_SUCCESS : EXIT_FAILURE); 
+}
+
+/***********************************************************
+ *	RenderFrame()
+ *
+ *  This function is used to render one frame of the scene
+ *  and present it.
+ ***********************************************************/
+void RenderFrame()
+{
+	// wait until the GPU is far enough along, then read the
+	// input as late as possible before building the frame
+	g_FramePacer->SetFramesInFlight(g_RenderSettings.framesInFlight);
+	g_FramePacer->SetMeasureLatency(g_RenderSettings.bMeasureLatency);
+	g_FramePacer->BeginFrame();
+
+	// query the latest GLFW events
+	glfwPollEvents();
+	double inputTime = glfwGetTime();
+
+	// start timing the CPU and GPU work for this frame
+	g_FrameProfiler->BeginFrame();
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// convert from 3D object space to 2D view
+	g_ViewManager->PrepareSceneView();
+
+	// record the draws of the 3D scene, on the job system
+	// threads, then replay them here on the GL thread
+	g_SceneManager->SetViewProjection(
+		g_ViewManager->GetViewMatrix(),
+		g_ViewManager->GetProjectionMatrix());
+	g_SceneManager->RenderScene();
+	g_SceneManager->SubmitScene();
+
+	// stop timing before waiting on the buffer swap
+	g_FrameProfiler->EndFrame();
+	if (g_RenderSettings.bReportFrameTime)
+	{
+		std::string label = GetOcclusionModeName(g_RenderSettings.occlusionMode);
+		label += ", ";
+		label += GetTransparencyModeName(g_RenderSettings.transparencyMode);
+		label += g_RenderSettings.bLevelOfDetail ? ", LOD on, " : ", LOD off, ";
+		label += std::to_string(g_SceneManager->GetDrawnVertexCount()) + " vertices, ";
+		label += std::to_string(g_SceneManager->GetVertexArrayBindCount()) + " VAO binds";
+		g_FrameProfiler->ReportAverages(
+			g_RenderSettings.frameReportInterval,
+			label.c_str());
+	}
+
+	// Flips the the back buffer with the front buffer every frame.
+	glfwSwapBuffers(g_Window);
+
+	// fence the frame for the pacing of the next ones
+	g_FramePacer->EndFrame(inputTime);
+	if (g_RenderSettings.bReportFrameTime || g_RenderSettings.bMeasureLatency)
+	{
+		g_FramePacer->ReportLatency(g_RenderSettings.frameReportInterval);
+	}
+}
+
+/***********************************************************
+ *	RunStressTest()
+ *
+ *  This function is used to generate a stress scene of each
+ *  requested size from the scene, fly the camera along the
+ *  same path through it and write the average CPU and GPU
+ *  frame times, draws and triangles of each size as one
+ *  line of a CSV file.  The triangles of the scene draws are
+ *  counted by the GPU, without the boxes of the occlusion
+ *  queries and the transparency composite.
+ ***********************************************************/
+bool RunStressTest()
+{
+	std::string templateFilename;
+	if (CookSceneIfChanged(g_RenderSettings.sceneFile, templateFilename) == false)
+	{
+		return(false);
+	}
+
+	std::ofstream report(g_StressReportFile, std::ios::trunc);
+	if (!report)
+	{
+		std::cerr << "Could not create stress report: " << g_StressReportFile << std::endl;
+		return(false);
+	}
+	report << "objects,transparency,frames,cpu_ms,gpu_ms,frame_ms,draw_calls,triangles" << std::endl;
+
+	// the frames are not held back by the display, and the
+	// periodic reports would reset the averages
+	glfwSwapInterval(0);
+	g_RenderSettings.bReportFrameTime = false;
+
+	bool bSuccess = true;
+	for (int i = 0; (i < (int)g_StressSizes.size()) && !glfwWindowShouldClose(g_Window); i++)
+	{
+		STRESS_SCENE_INFO info;
+		if (GenerateStressScene(templateFilename.c_str(), g_StressSizes[i], g_StressSettings,
+			g_StressSceneFile, info) == false)
+		{
+			bSuccess = false;
+			break;
+		}
+
+		g_RenderSettings.sceneFile = g_StressSceneFile;
+		g_SceneManager = new SceneManager(g_ShaderManager, &g_RenderSettings);
+		g_SceneManager->PrepareScene();
+
+		StressCameraPath cameraPath;
+		cameraPath.Generate(info.boundsMin, info.boundsMax, g_StressSettings.seed, g_StressPathPoints);
+
+		int totalFrames = g_StressWarmupFrames + g_StressFrames;
+		int measuredFrames = 0;
+		double drawCalls = 0.0;
+		for (int frame = 0; (frame < totalFrames) && !glfwWindowShouldClose(g_Window); frame++)
+		{
+			if (frame == g_StressWarmupFrames)
+			{
+				g_FrameProfiler->ResetAverages();
+				g_SceneManager->StartPrimitiveCount();
+			}
+
+			glm::vec3 position;
+			glm::vec3 target;
+			cameraPath.GetPose((float)frame / (float)totalFrames, position, target);
+			g_ViewManager->SetCameraPose(position, target);
+			RenderFrame();
+
+			if (frame >= g_StressWarmupFrames)
+			{
+				drawCalls += g_SceneManager->GetDrawCallCount();
+				measuredFrames++;
+			}
+		}
+
+		GLuint64 primitives = 0;
+		if (measuredFrames > 0)
+		{
+			primitives = g_SceneManager->StopPrimitiveCount();
+
+			report << g_StressSizes[i] << ","
+				<< ((g_RenderSettings.transparencyMode == TRANSPARENCY_WEIGHTED) ? "weighted" : "sorted") << ","
+				<< measuredFrames << ","
+				<< g_FrameProfiler->GetAverageCPUTime() << ","
+				<< g_FrameProfiler->GetAverageGPUTime() << ","
+				<< g_FrameProfiler->GetAverageFrameTime() << ","
+				<< (drawCalls / measuredFrames) << ","
+				<< ((double)primitives / measuredFrames) << std::endl;
+			std::cout << "INFO: Stress scene of " << g_StressSizes[i] << " objects - CPU "
+				<< g_FrameProfiler->GetAverageCPUTime() << " ms, GPU "
+				<< g_FrameProfiler->GetAverageGPUTime() << " ms, "
+				<< (drawCalls / measuredFrames) << " draws, "
+				<< ((double)primitives / measuredFrames) << " triangles" << std::endl;
+		}
+
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+		std::remove(g_StressSceneFile);
+	}
+
+	if (!report)
+	{
+		std::cerr << "Could not write stress report: " << g_StressReportFile << std::endl;
+		return(false);
+	}
+	std::cout << "INFO: Wrote the stress report to " << g_StressReportFile << std::endl;
+	return(bSuccess);
+}
+
+/***********************************************************
+ *	ParseStressSizes()
+ *
+ *  This function is used to read the comma separated object
+ *  counts of the stress scenes.
+ ***********************************************************/
+bool ParseStressSizes(const char* text)
+{
+	g_StressSizes.clear();
+	while (*text != '\0')
+	{
+		int count = atoi(text);
+		if ((count < 1) || (count > 1000000))
+		{
+			std::cerr << "Stress scene sizes must be from 1 to 1000000: " << text << std::endl;
+			return(false);
+		}
+		g_StressSizes.push_back(count);
+
+		const char* pComma = strchr(text, ',');
+		if (NULL == pComma)
+		{
+			break;
+		}
+		text = pComma + 1;
+	}
+	return(g_StressSizes.empty() == false);
+}
+
+/***********************************************************
+ *	ParseCommandLine()
+ *
+ *  This function is used to read the rendering switches
+ *  from the command line arguments.
+ ***********************************************************/
+bool ParseCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--no-occlusion-culling") == 0)
+		{
+			g_RenderSettings.occlusionMode = OCCLUSION_OFF;
+		}
+		else if (strcmp(argv[i], "--occlusion=off") == 0)
+		{
+			g_RenderSettings.occlusionMode = OCCLUSION_OFF;
+		}
+		else if (strcmp(argv[i], "--occlusion=gpu") == 0)
+		{
+			g_RenderSettings.occlusionMode = OCCLUSION_GPU_QUERIES;
+		}
+		else if (strcmp(argv[i], "--occlusion=cpu") == 0)
+		{
+			g_RenderSettings.occlusionMode = OCCLUSION_CPU_RASTER;
+		}
+		else if (strcmp(argv[i], "--occlusion=gpu-driven") == 0)
+		{
+			g_RenderSettings.occlusionMode = OCCLUSION_GPU_DRIVEN;
+		}
+		else if (strcmp(argv[i], "--transparency=sorted") == 0)
+		{
+			g_RenderSettings.transparencyMode = TRANSPARENCY_SORTED;
+		}
+		else if (strcmp(argv[i], "--transparency=weighted") == 0)
+		{
+			g_RenderSettings.transparencyMode = TRANSPARENCY_WEIGHTED;
+		}
+		else if (strcmp(argv[i], "--no-lod") == 0)
+		{
+			g_RenderSettings.bLevelOfDetail = false;
+		}
+		else if (strcmp(argv[i], "--no-meshlet-culling") == 0)
+		{
+			g_RenderSettings.bMeshletCulling = false;
+		}
+		else if (strcmp(argv[i], "--packed-vertices") == 0)
+		{
+			g_RenderSettings.bPackedVertices = true;
+		}
+		else if ((strcmp(argv[i], "--threads") == 0) && ((i + 1) < argc))
+		{
+			g_RenderSettings.jobThreadCount = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--benchmark") == 0) && ((i + 1) < argc))
+		{
+			g_BenchmarkName = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--frames-in-flight") == 0) && ((i + 1) < argc))
+		{
+			g_RenderSettings.framesInFlight = std::min(std::max(atoi(argv[++i]), 1), 3);
+		}
+		else if (strcmp(argv[i], "--measure-latency") == 0)
+		{
+			g_RenderSettings.bMeasureLatency = true;
+		}
+		else if ((strcmp(argv[i], "--scene") == 0) && ((i + 1) < argc))
+		{
+			g_RenderSettings.sceneFile = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--cook") == 0) && ((i + 2) < argc))
+		{
+			g_CookTextFile = argv[++i];
+			g_CookSceneFile = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--stress") == 0) && ((i + 1) < argc))
+		{
+			if (ParseStressSizes(argv[++i]) == false)
+			{
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--stress-frames") == 0) && ((i + 1) < argc))
+		{
+			g_StressFrames = std::max(atoi(argv[++i]), 1);
+		}
+		else if ((strcmp(argv[i], "--stress-report") == 0) && ((i + 1) < argc))
+		{
+			g_StressReportFile = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--stress-seed") == 0) && ((i + 1) < argc))
+		{
+			g_StressSettings.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		}
+		else if ((strcmp(argv[i], "--stress-jitter") == 0) && ((i + 2) < argc))
+		{
+			g_StressSettings.positionJitter = (float)atof(argv[++i]);
+			g_StressSettings.rotationJitter = (float)atof(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--stress-mix") == 0) && ((i + 3) < argc))
+		{
+			g_StressSettings.meshMix = (float)atof(argv[++i]);
+			g_StressSettings.textureMix = (float)atof(argv[++i]);
+			g_StressSettings.materialMix = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--no-frame-report") == 0)
+		{
+			g_RenderSettings.bReportFrameTime = false;
+		}
+		else
+		{
+			std::cerr << "Unknown option: " << argv[i] << "\n"
+				<< "Options:\n"
+				<< "  --occlusion=off|gpu|cpu|gpu-driven\n"
+				<< "                           start with occlusion culling off, using GPU\n"
+				<< "                           queries, using the CPU rasterizer, or culling\n"
+				<< "                           on the GPU into indirect draws (cycle with C)\n"
+				<< "  --no-occlusion-culling   same as --occlusion=off\n"
+				<< "  --transparency=sorted|weighted\n"
+				<< "                           blend the translucent objects sorted from back\n"
+				<< "                           to front, or with weighted blended order\n"
+				<< "                           independent transparency (toggle with T)\n"
+				<< "  --no-lod                 start with level of detail off (toggle with L)\n"
+				<< "  --no-meshlet-culling     start with meshlet culling off (toggle with K)\n"
+				<< "  --packed-vertices        store the meshes in 16 bytes per vertex\n"
+				<< "  --threads <count>        threads for the per-frame CPU work, including\n"
+				<< "                           the main thread (default: one per hardware thread)\n"
+				<< "  --frames-in-flight <1-3> frames the CPU may build ahead of the GPU\n"
+				<< "                           (default: 2, cycle with F)\n"
+				<< "  --measure-latency        report the time from input to photon (toggle with M)\n"
+				<< "  --scene <file>           scene to draw - a .txt description is cooked\n"
+				<< "                           into a .scene file next to it when changed\n"
+				<< "  --cook <text> <scene>    convert a text scene description into a\n"
+				<< "                           scene file without opening a window\n"
+				<< "  --stress <counts>        measure stress scenes with the comma separated\n"
+				<< "                           object counts (1 to 1000000), made by repeating\n"
+				<< "                           the scene on a grid, and exit\n"
+				<< "  --stress-frames <count>  frames measured for each stress scene (default: 300)\n"
+				<< "  --stress-report <file>   CSV file of the stress results (default: stress.csv)\n"
+				<< "  --stress-seed <seed>     seed of the stress scenes and camera path\n"
+				<< "  --stress-jitter <move> <degrees>\n"
+				<< "                           random move of each copy, as a fraction of its\n"
+				<< "                           cell, and turn (default: 0.05 10)\n"
+				<< "  --stress-mix <meshes> <textures> <materials>\n"
+				<< "                           fractions of the objects given a random mesh,\n"
+				<< "                           texture and material (default: 0 0 0)\n"
+				<< "  --no-frame-report        do not print the average frame times\n"
+				<< "  --benchmark <name>       run a CPU benchmark without opening a window\n";
+			PrintBenchmarkNames();
+			return(false);
+		}
+	}
+
+	return(true);
 }
 
 /***********************************************************
@@ -139,7 +576,8 @@ bool InitializeGLFW()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #else
-	// set the version of OpenGL and profile to use
+	// set the version of OpenGL and profile to use, older
+	// core contexts are tried when creating the window
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// read-only memory mapping of a whole file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+	m_hFile = NULL;
+	m_hMapping = NULL;
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a file read-only into
+ *  memory.  Mapping takes the same short time whatever the
+ *  size of the file, since nothing is read yet.
+ ***********************************************************/
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if ((GetFileSizeEx(hFile, &fileSize) == FALSE) || (fileSize.QuadPart <= 0))
+	{
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL == hMapping)
+	{
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (NULL == pView)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+	m_pData = (const unsigned char*)pView;
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+
+	struct stat fileInfo;
+	if ((fstat(file, &fileInfo) != 0) || (fileInfo.st_size <= 0))
+	{
+		close(file);
+		return(false);
+	}
+
+	void* pView = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	// the mapping stays valid after the file is closed
+	close(file);
+	if (pView == MAP_FAILED)
+	{
+		return(false);
+	}
+
+	m_pData = (const unsigned char*)pView;
+	m_size = (size_t)fileInfo.st_size;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the current file.
+ ***********************************************************/
+void MappedFile::Close()
+{
+	if (NULL == m_pData)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+	CloseHandle((HANDLE)m_hMapping);
+	CloseHandle((HANDLE)m_hFile);
+	m_hMapping = NULL;
+	m_hFile = NULL;
+#else
+	munmap((void*)m_pData, m_size);
+#endif
+
+	m_pData = NULL;
+	m_size = 0;
+}
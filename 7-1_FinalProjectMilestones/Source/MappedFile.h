@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// read-only memory mapping of a whole file
+//
+//  A mapped file is read through a pointer, as if it had been loaded into
+//  memory, but the operating system only reads the pages that are
+//  actually touched, from its disk cache, and several threads can read
+//  different parts of it at once without any locking.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class contains the code for mapping a file into
+ *  memory on Windows and on POSIX systems.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the passed in file - false if it is missing or empty
+	bool Open(const char* filename);
+	// unmap the current file
+	void Close();
+	bool IsOpen() const { return(NULL != m_pData); }
+
+	const unsigned char* GetData() const { return(m_pData); }
+	size_t GetSize() const { return(m_size); }
+
+private:
+	// start and size of the mapped file
+	const unsigned char* m_pData;
+	size_t m_size;
+	// handles of the mapping on Windows
+	void* m_hFile;
+	void* m_hMapping;
+
+	// a mapping can not be shared by two objects
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
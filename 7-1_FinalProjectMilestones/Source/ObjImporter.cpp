@@ -0,0 +1,1324 @@
+///////////////////////////////////////////////////////////////////////////////
+// objimporter.cpp
+// ============
+// import Wavefront OBJ meshes on several threads, with a binary cache
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ObjImporter.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include "MeshNormals.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// fewest bytes of text parsed by one job, and the bytes of
+	// the file hashed by one job - the hash does not depend on
+	// the number of threads
+	const size_t g_MinChunkSize = 1 << 20;
+	const size_t g_HashBlockSize = 1 << 20;
+	// position, normal and texture coordinates of each vertex
+	const int g_FloatsPerVertex = 8;
+	// a corner without a texture coordinate or normal
+	const uint32_t g_NoIndex = 0xFFFFFFFF;
+	// the numbers of more than this many digits only keep
+	// their first digits, which is beyond float precision
+	const int g_MaxMantissaDigits = 18;
+
+	// each reduced detail level aims for this fraction of the
+	// triangles of the level before it, within an error that
+	// is a fraction of the bounding radius of the mesh - the
+	// scene manager switches to the levels below 1/4, 0.08 and
+	// 0.025 of half the screen height, where these errors are
+	// about a pixel at 1080 rows
+	const float g_LODTriangleFraction = 0.25f;
+	const float g_LODErrors[ShapeMeshes::LOD_COUNT - 1] = { 0.0075f, 0.025f, 0.075f };
+	// a level that removes less than this fraction of the
+	// triangles is not worth its memory, and ends the levels
+	const float g_LODMinReduction = 0.2f;
+	// meshes of fewer triangles get no reduced levels
+	const size_t g_LODMinTriangles = 1024;
+	// triangles simplified together by one job - a larger mesh
+	// is cut into cells of about this many - and the most cells
+	// of the grid
+	const size_t g_SimplifyCellTriangles = 1 << 17;
+	const size_t g_MaxSimplifyCells = 1 << 20;
+	// a position used by the triangles of more than one cell
+	const int g_SharedCell = -2;
+
+	// the indices of one corner of a face
+	struct OBJ_CORNER
+	{
+		uint32_t position;
+		uint32_t uv;
+		uint32_t normal;
+	};
+
+	// a part of the file, starting and ending at a line break,
+	// and the corners of the triangles of its faces
+	struct OBJ_CHUNK
+	{
+		const char* pBegin;
+		const char* pEnd;
+		// lines of each kind in the chunk, and in all the
+		// chunks before it
+		uint32_t positionCount;
+		uint32_t uvCount;
+		uint32_t normalCount;
+		uint32_t firstPosition;
+		uint32_t firstUV;
+		uint32_t firstNormal;
+		std::vector<OBJ_CORNER> corners;
+		// line of the first face that could not be read, or 0
+		int errorLine;
+	};
+
+	// the whole arrays of the file, filled in by every chunk
+	struct OBJ_ARRAYS
+	{
+		std::vector<float> positions;
+		std::vector<float> uvs;
+		std::vector<float> normals;
+	};
+
+	/***********************************************************
+	 *  GetMilliseconds()
+	 *
+	 *  This function is used for getting the milliseconds
+	 *  since the passed in time.
+	 ***********************************************************/
+	double GetMilliseconds(std::chrono::steady_clock::time_point startTime)
+	{
+		return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+	}
+
+	/***********************************************************
+	 *  RunParallel()
+	 *
+	 *  This function is used for running a body over ranges of
+	 *  the items on the job system, or on the calling thread
+	 *  when there is no job system.
+	 ***********************************************************/
+	template<class Body>
+	void RunParallel(JobSystem* pJobSystem, int count, const Body& body)
+	{
+		if (NULL != pJobSystem)
+		{
+			pJobSystem->ParallelFor(count, 1, body);
+		}
+		else if (count > 0)
+		{
+			body(0, count);
+		}
+	}
+
+	/***********************************************************
+	 *  IsBlank()
+	 *
+	 *  This function is used for checking for the characters
+	 *  that separate the values of a line.
+	 ***********************************************************/
+	inline bool IsBlank(char c)
+	{
+		return((c == ' ') || (c == '\t') || (c == '\r'));
+	}
+
+	/***********************************************************
+	 *  SkipBlanks()
+	 *
+	 *  This function is used for moving past the blanks in
+	 *  front of the next value of a line.
+	 ***********************************************************/
+	inline const char* SkipBlanks(const char* p, const char* pEnd)
+	{
+		while ((p < pEnd) && (IsBlank(*p) == true))
+		{
+			p++;
+		}
+		return(p);
+	}
+
+	/***********************************************************
+	 *  GetPowerOf10()
+	 *
+	 *  This function is used for getting 10 to the power of
+	 *  the passed in exponent, from a table for the exponents
+	 *  that are exact in a double.
+	 ***********************************************************/
+	double GetPowerOf10(int exponent)
+	{
+		static const double powers[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		double power = 1.0;
+		while (exponent > 22)
+		{
+			power *= 1e22;
+			exponent -= 22;
+		}
+		return(power * powers[exponent]);
+	}
+
+	/***********************************************************
+	 *  ParseFloat()
+	 *
+	 *  This function is used for reading a decimal number with
+	 *  an optional sign, fraction and exponent.  The digits are
+	 *  gathered into a 64 bit integer and scaled once by a
+	 *  power of 10, which is exact to within a unit of the
+	 *  last place of a float.  False if there is no number.
+	 ***********************************************************/
+	bool ParseFloat(const char*& p, const char* pEnd, float& value)
+	{
+		p = SkipBlanks(p, pEnd);
+
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		uint64_t mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		bool bAnyDigit = false;
+		while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+		{
+			if (digits < g_MaxMantissaDigits)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += (mantissa != 0) ? 1 : 0;
+			}
+			else
+			{
+				exponent++;
+			}
+			bAnyDigit = true;
+			p++;
+		}
+		if ((p < pEnd) && (*p == '.'))
+		{
+			p++;
+			while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+			{
+				if (digits < g_MaxMantissaDigits)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					digits += (mantissa != 0) ? 1 : 0;
+					exponent--;
+				}
+				bAnyDigit = true;
+				p++;
+			}
+		}
+		if (bAnyDigit == false)
+		{
+			return(false);
+		}
+
+		if ((p < pEnd) && ((*p == 'e') || (*p == 'E')))
+		{
+			const char* pExponent = p + 1;
+			bool bNegativeExponent = false;
+			if ((pExponent < pEnd) && ((*pExponent == '-') || (*pExponent == '+')))
+			{
+				bNegativeExponent = (*pExponent == '-');
+				pExponent++;
+			}
+			if ((pExponent < pEnd) && (*pExponent >= '0') && (*pExponent <= '9'))
+			{
+				int written = 0;
+				while ((pExponent < pEnd) && (*pExponent >= '0') && (*pExponent <= '9'))
+				{
+					written = (written < 1000) ? (written * 10 + (*pExponent - '0')) : written;
+					pExponent++;
+				}
+				exponent += bNegativeExponent ? -written : written;
+				p = pExponent;
+			}
+		}
+
+		double result = (double)mantissa;
+		if (mantissa != 0)
+		{
+			if (exponent < -300)
+			{
+				result = 0.0;
+			}
+			else if (exponent < 0)
+			{
+				result /= GetPowerOf10(-exponent);
+			}
+			else if (exponent > 0)
+			{
+				result *= GetPowerOf10((exponent < 300) ? exponent : 300);
+			}
+		}
+		value = (float)(bNegative ? -result : result);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ParseInteger()
+	 *
+	 *  This function is used for reading a whole number with
+	 *  an optional minus sign - false if there is no number.
+	 ***********************************************************/
+	bool ParseInteger(const char*& p, const char* pEnd, int64_t& value)
+	{
+		bool bNegative = false;
+		if ((p < pEnd) && (*p == '-'))
+		{
+			bNegative = true;
+			p++;
+		}
+		if ((p >= pEnd) || (*p < '0') || (*p > '9'))
+		{
+			return(false);
+		}
+
+		int64_t result = 0;
+		while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+		{
+			result = (result < 0x7FFFFFFF) ? (result * 10 + (*p - '0')) : result;
+			p++;
+		}
+		value = bNegative ? -result : result;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ResolveIndex()
+	 *
+	 *  This function is used for turning an index of a face,
+	 *  counted from 1 or backwards from the last element read
+	 *  before the face, into an index from 0 - false if it is
+	 *  0 or outside the elements of the file.
+	 ***********************************************************/
+	bool ResolveIndex(int64_t index, uint32_t readBefore, uint32_t total, uint32_t& resolved)
+	{
+		int64_t result = (index > 0) ? (index - 1) : ((int64_t)readBefore + index);
+		if ((index == 0) || (result < 0) || (result >= (int64_t)total))
+		{
+			return(false);
+		}
+		resolved = (uint32_t)result;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetLineType()
+	 *
+	 *  This function is used for finding the kind of a line
+	 *  from its first characters, and moving past them: 'v'
+	 *  for a position, 't' for a texture coordinate, 'n' for a
+	 *  normal, 'f' for a face and 0 for anything else.
+	 ***********************************************************/
+	char GetLineType(const char*& p, const char* pEnd)
+	{
+		p = SkipBlanks(p, pEnd);
+		if ((pEnd - p) < 2)
+		{
+			return(0);
+		}
+
+		if (p[0] == 'v')
+		{
+			if (IsBlank(p[1]) == true)
+			{
+				p += 1;
+				return('v');
+			}
+			if (((p[1] == 't') || (p[1] == 'n')) && ((pEnd - p) > 2) && (IsBlank(p[2]) == true))
+			{
+				p += 2;
+				return(p[-1]);
+			}
+		}
+		else if ((p[0] == 'f') && (IsBlank(p[1]) == true))
+		{
+			p += 1;
+			return('f');
+		}
+		return(0);
+	}
+
+	/***********************************************************
+	 *  GetLineEnd()
+	 *
+	 *  This function is used for finding the end of the line
+	 *  that starts at the passed in position.
+	 ***********************************************************/
+	inline const char* GetLineEnd(const char* p, const char* pEnd)
+	{
+		const char* pLineEnd = (const char*)memchr(p, '\n', pEnd - p);
+		return((NULL != pLineEnd) ? pLineEnd : pEnd);
+	}
+
+	/***********************************************************
+	 *  CountChunkElements()
+	 *
+	 *  This function is used for counting the positions,
+	 *  texture coordinates and normals of a chunk, without
+	 *  reading their values.
+	 ***********************************************************/
+	void CountChunkElements(OBJ_CHUNK& chunk)
+	{
+		chunk.positionCount = 0;
+		chunk.uvCount = 0;
+		chunk.normalCount = 0;
+
+		const char* p = chunk.pBegin;
+		while (p < chunk.pEnd)
+		{
+			const char* pLineEnd = GetLineEnd(p, chunk.pEnd);
+			switch (GetLineType(p, pLineEnd))
+			{
+			case 'v': chunk.positionCount++; break;
+			case 't': chunk.uvCount++; break;
+			case 'n': chunk.normalCount++; break;
+			}
+			p = pLineEnd + 1;
+		}
+	}
+
+	/***********************************************************
+	 *  ParseFace()
+	 *
+	 *  This function is used for reading the corners of a face
+	 *  line and adding it to the chunk as a fan of triangles.
+	 *  False if a corner can not be read or has an index
+	 *  outside the file.
+	 ***********************************************************/
+	bool ParseFace(
+		const char* p,
+		const char* pEnd,
+		OBJ_CHUNK& chunk,
+		uint32_t positionsBefore,
+		uint32_t uvsBefore,
+		uint32_t normalsBefore,
+		const OBJ_CHUNK& totals,
+		std::vector<OBJ_CORNER>& polygon)
+	{
+		polygon.clear();
+		while (true)
+		{
+			p = SkipBlanks(p, pEnd);
+			if (p >= pEnd)
+			{
+				break;
+			}
+
+			OBJ_CORNER corner;
+			corner.uv = g_NoIndex;
+			corner.normal = g_NoIndex;
+			int64_t index = 0;
+			if ((ParseInteger(p, pEnd, index) == false) ||
+				(ResolveIndex(index, positionsBefore, totals.positionCount, corner.position) == false))
+			{
+				return(false);
+			}
+			if ((p < pEnd) && (*p == '/'))
+			{
+				p++;
+				if ((p < pEnd) && (*p != '/') &&
+					((ParseInteger(p, pEnd, index) == false) ||
+					(ResolveIndex(index, uvsBefore, totals.uvCount, corner.uv) == false)))
+				{
+					return(false);
+				}
+				if ((p < pEnd) && (*p == '/'))
+				{
+					p++;
+					if ((ParseInteger(p, pEnd, index) == false) ||
+						(ResolveIndex(index, normalsBefore, totals.normalCount, corner.normal) == false))
+					{
+						return(false);
+					}
+				}
+			}
+			if ((p < pEnd) && (IsBlank(*p) == false))
+			{
+				return(false);
+			}
+			polygon.push_back(corner);
+		}
+
+		if (polygon.size() < 3)
+		{
+			return(false);
+		}
+		for (size_t i = 1; (i + 1) < polygon.size(); i++)
+		{
+			chunk.corners.push_back(polygon[0]);
+			chunk.corners.push_back(polygon[i]);
+			chunk.corners.push_back(polygon[i + 1]);
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ParseChunk()
+	 *
+	 *  This function is used for reading the lines of a chunk
+	 *  into the shared arrays, starting at the elements of the
+	 *  chunks before it, and into the triangles of the chunk.
+	 *  Lines of any other kind, such as groups and materials,
+	 *  are skipped.
+	 ***********************************************************/
+	void ParseChunk(OBJ_CHUNK& chunk, const OBJ_CHUNK& totals, OBJ_ARRAYS& arrays)
+	{
+		float* pPosition = arrays.positions.data() + (size_t)chunk.firstPosition * 3;
+		float* pUV = arrays.uvs.data() + (size_t)chunk.firstUV * 2;
+		float* pNormal = arrays.normals.data() + (size_t)chunk.firstNormal * 3;
+		uint32_t positions = 0;
+		uint32_t uvs = 0;
+		uint32_t normals = 0;
+		std::vector<OBJ_CORNER> polygon;
+
+		chunk.corners.clear();
+		chunk.errorLine = 0;
+		int line = 0;
+		const char* p = chunk.pBegin;
+		while (p < chunk.pEnd)
+		{
+			const char* pLineEnd = GetLineEnd(p, chunk.pEnd);
+			line++;
+			switch (GetLineType(p, pLineEnd))
+			{
+			case 'v':
+				// a missing value is read as 0
+				for (int axis = 0; axis < 3; axis++)
+				{
+					pPosition[axis] = 0.0f;
+					ParseFloat(p, pLineEnd, pPosition[axis]);
+				}
+				pPosition += 3;
+				positions++;
+				break;
+			case 't':
+				for (int axis = 0; axis < 2; axis++)
+				{
+					pUV[axis] = 0.0f;
+					ParseFloat(p, pLineEnd, pUV[axis]);
+				}
+				pUV += 2;
+				uvs++;
+				break;
+			case 'n':
+				for (int axis = 0; axis < 3; axis++)
+				{
+					pNormal[axis] = 0.0f;
+					ParseFloat(p, pLineEnd, pNormal[axis]);
+				}
+				pNormal += 3;
+				normals++;
+				break;
+			case 'f':
+				if ((ParseFace(p, pLineEnd, chunk,
+					chunk.firstPosition + positions,
+					chunk.firstUV + uvs,
+					chunk.firstNormal + normals,
+					totals, polygon) == false) && (chunk.errorLine == 0))
+				{
+					chunk.errorLine = line;
+				}
+				break;
+			}
+			p = pLineEnd + 1;
+		}
+	}
+
+	/***********************************************************
+	 *  HashCorner()
+	 *
+	 *  This function is used for mixing the indices of a
+	 *  corner into the slot of the weld table.
+	 ***********************************************************/
+	inline uint32_t HashCorner(const OBJ_CORNER& corner)
+	{
+		uint64_t hash = (uint64_t)corner.position * 0x9E3779B97F4A7C15ull;
+		hash ^= ((uint64_t)corner.uv + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+		hash ^= ((uint64_t)corner.normal + 0x165667B19E3779F9ull) * 0x85EBCA77C2B2AE63ull;
+		return((uint32_t)(hash >> 32) ^ (uint32_t)hash);
+	}
+
+	/***********************************************************
+	 *  WeldCorners()
+	 *
+	 *  This function is used for giving every distinct corner
+	 *  of the triangles a vertex, with an open addressing hash
+	 *  table of the vertices, and writing the indices.  The
+	 *  table is kept at most half full.
+	 ***********************************************************/
+	void WeldCorners(
+		const std::vector<OBJ_CHUNK>& chunks,
+		size_t expectedVertices,
+		std::vector<OBJ_CORNER>& vertices,
+		std::vector<GLuint>& indices)
+	{
+		size_t capacity = 1024;
+		while (capacity < expectedVertices * 2)
+		{
+			capacity *= 2;
+		}
+		std::vector<uint32_t> table(capacity, g_NoIndex);
+		vertices.clear();
+		vertices.reserve(expectedVertices);
+
+		size_t next = 0;
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			const std::vector<OBJ_CORNER>& corners = chunks[c].corners;
+			for (size_t i = 0; i < corners.size(); i++)
+			{
+				const OBJ_CORNER& corner = corners[i];
+				size_t mask = capacity - 1;
+				size_t slot = HashCorner(corner) & mask;
+				while ((table[slot] != g_NoIndex) &&
+					((vertices[table[slot]].position != corner.position) ||
+					(vertices[table[slot]].uv != corner.uv) ||
+					(vertices[table[slot]].normal != corner.normal)))
+				{
+					slot = (slot + 1) & mask;
+				}
+
+				if (table[slot] == g_NoIndex)
+				{
+					table[slot] = (uint32_t)vertices.size();
+					vertices.push_back(corner);
+
+					// double the table and insert the vertices again
+					if ((vertices.size() * 2) > capacity)
+					{
+						capacity *= 2;
+						mask = capacity - 1;
+						table.assign(capacity, g_NoIndex);
+						for (size_t v = 0; v < vertices.size(); v++)
+						{
+							size_t newSlot = HashCorner(vertices[v]) & mask;
+							while (table[newSlot] != g_NoIndex)
+							{
+								newSlot = (newSlot + 1) & mask;
+							}
+							table[newSlot] = (uint32_t)v;
+						}
+						indices[next++] = (GLuint)(vertices.size() - 1);
+						continue;
+					}
+				}
+				indices[next++] = table[slot];
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  CalculatePositionNormals()
+	 *
+	 *  This function is used for calculating the area weighted
+	 *  normals of the positions, for the corners that have no
+	 *  normal in the file.  The triangles are turned into
+	 *  triangles of positions, as the corners of the welded
+	 *  vertices that share a position share its normal.
+	 ***********************************************************/
+	void CalculatePositionNormals(
+		const std::vector<float>& positions,
+		const std::vector<OBJ_CORNER>& vertices,
+		const std::vector<GLuint>& indices,
+		std::vector<float>& normals)
+	{
+		std::vector<GLuint> positionIndices(indices.size() - (indices.size() % 3));
+		for (size_t i = 0; i < positionIndices.size(); i++)
+		{
+			positionIndices[i] = vertices[indices[i]].position;
+		}
+		normals.resize(positions.size());
+		GenerateNormals(
+			positions.data(), 3, positions.size() / 3,
+			positionIndices.data(), positionIndices.size(),
+			normals.data(), 3);
+	}
+
+	/***********************************************************
+	 *  HashFileContents()
+	 *
+	 *  This function is used for hashing a whole file, in
+	 *  blocks of a fixed size on the job system, 8 bytes at a
+	 *  time.  The hashes of the blocks are then combined in
+	 *  order with the size of the file.
+	 ***********************************************************/
+	uint64_t HashFileContents(const unsigned char* pData, size_t size, JobSystem* pJobSystem)
+	{
+		const uint64_t prime = 0x100000001B3ull;
+		int blockCount = (int)((size + g_HashBlockSize - 1) / g_HashBlockSize);
+		std::vector<uint64_t> blockHashes(blockCount);
+
+		RunParallel(pJobSystem, blockCount, [&](int first, int last) {
+			for (int block = first; block < last; block++)
+			{
+				size_t begin = (size_t)block * g_HashBlockSize;
+				size_t end = std::min(begin + g_HashBlockSize, size);
+				uint64_t hash = 0xCBF29CE484222325ull;
+				size_t i = begin;
+				for (; (i + 8) <= end; i += 8)
+				{
+					uint64_t word;
+					memcpy(&word, pData + i, sizeof(word));
+					hash = (hash ^ word) * prime;
+					hash ^= hash >> 29;
+				}
+				for (; i < end; i++)
+				{
+					hash = (hash ^ pData[i]) * prime;
+				}
+				blockHashes[block] = hash;
+			}
+		});
+
+		uint64_t hash = (0xCBF29CE484222325ull ^ (uint64_t)size) * prime;
+		for (int block = 0; block < blockCount; block++)
+		{
+			hash = (hash ^ blockHashes[block]) * prime;
+			hash ^= hash >> 29;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  SimplifyInCells()
+	 *
+	 *  This function is used for simplifying the triangles of a
+	 *  mesh towards a target number of indices and an error on
+	 *  the job system.  The triangles are sorted into the cells
+	 *  of a grid by their centers, with the cells sized from
+	 *  the area of the surface so each holds about the same
+	 *  number of triangles, and the positions shared by the
+	 *  triangles of two cells are locked.  Every cell is then
+	 *  simplified on its own, with only its own vertices in
+	 *  memory, and keeps its share of the target.  The grid is
+	 *  moved by half a cell when asked, so the positions locked
+	 *  for one level are free to move at the next.
+	 ***********************************************************/
+	float SimplifyInCells(
+		const std::vector<float>& verts,
+		const std::vector<GLuint>& positionRemap,
+		const std::vector<GLuint>& indices,
+		size_t targetIndexCount,
+		float targetError,
+		bool bOffsetCells,
+		JobSystem* pJobSystem,
+		std::vector<GLuint>& result)
+	{
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount <= g_SimplifyCellTriangles)
+		{
+			return(SimplifyMesh(verts.data(), g_FloatsPerVertex, verts.size() / g_FloatsPerVertex,
+				indices.data(), triangleCount * 3, NULL, targetIndexCount, targetError, result));
+		}
+
+		// size the cells so the area of the surface in each one
+		// is that of about the number of triangles of a cell
+		glm::vec3 boundsMin(FLT_MAX);
+		glm::vec3 boundsMax(-FLT_MAX);
+		double area = 0.0;
+		for (size_t i = 0; i < triangleCount * 3; i += 3)
+		{
+			glm::vec3 corners[3];
+			for (int corner = 0; corner < 3; corner++)
+			{
+				const float* pPosition = &verts[(size_t)indices[i + corner] * g_FloatsPerVertex];
+				corners[corner] = glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+				boundsMin = glm::min(boundsMin, corners[corner]);
+				boundsMax = glm::max(boundsMax, corners[corner]);
+			}
+			area += 0.5 * glm::length(glm::cross(corners[1] - corners[0], corners[2] - corners[0]));
+		}
+		glm::vec3 extents = boundsMax - boundsMin;
+		float cellSize = (float)sqrt(area * g_SimplifyCellTriangles / triangleCount);
+		cellSize = std::max(cellSize, std::max(extents.x, std::max(extents.y, extents.z)) / 1024.0f);
+		if (cellSize <= 0.0f)
+		{
+			cellSize = 1.0f;
+		}
+		size_t cellsX;
+		size_t cellsY;
+		size_t cellsZ;
+		for (;;)
+		{
+			cellsX = (size_t)(extents.x / cellSize) + 2;
+			cellsY = (size_t)(extents.y / cellSize) + 2;
+			cellsZ = (size_t)(extents.z / cellSize) + 2;
+			if (cellsX * cellsY * cellsZ <= g_MaxSimplifyCells)
+			{
+				break;
+			}
+			cellSize *= 1.25f;
+		}
+
+		// sort the triangles by their cells
+		float offset = bOffsetCells ? 0.5f : 0.0f;
+		std::vector<uint32_t> triangleCells(triangleCount);
+		std::vector<size_t> cellStarts(cellsX * cellsY * cellsZ + 1, 0);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			glm::vec3 center(0.0f);
+			for (int corner = 0; corner < 3; corner++)
+			{
+				const float* pPosition = &verts[(size_t)indices[t * 3 + corner] * g_FloatsPerVertex];
+				center += glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+			}
+			glm::vec3 cell = (center / 3.0f - boundsMin) / cellSize + offset;
+			size_t x = std::min((size_t)std::max(cell.x, 0.0f), cellsX - 1);
+			size_t y = std::min((size_t)std::max(cell.y, 0.0f), cellsY - 1);
+			size_t z = std::min((size_t)std::max(cell.z, 0.0f), cellsZ - 1);
+			triangleCells[t] = (uint32_t)(x + cellsX * (y + cellsY * z));
+			cellStarts[triangleCells[t] + 1]++;
+		}
+		std::vector<size_t> usedCells;
+		for (size_t cell = 0; cell + 1 < cellStarts.size(); cell++)
+		{
+			if (cellStarts[cell + 1] > 0)
+			{
+				usedCells.push_back(cell);
+			}
+			cellStarts[cell + 1] += cellStarts[cell];
+		}
+		std::vector<GLuint> cellTriangles(triangleCount);
+		std::vector<size_t> cellEnds(cellStarts.begin(), cellStarts.end() - 1);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			cellTriangles[cellEnds[triangleCells[t]]++] = (GLuint)t;
+		}
+
+		// lock the positions that the triangles of two cells use
+		std::vector<int> positionCells(positionRemap.size(), -1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+		{
+			int& positionCell = positionCells[positionRemap[indices[i]]];
+			int cell = (int)triangleCells[i / 3];
+			if (positionCell == -1)
+			{
+				positionCell = cell;
+			}
+			else if (positionCell != cell)
+			{
+				positionCell = g_SharedCell;
+			}
+		}
+		triangleCells.clear();
+
+		// simplify every cell with its own vertices, in the
+		// order of its sorted vertex indices
+		std::vector<std::vector<GLuint> > cellResults(usedCells.size());
+		std::vector<float> cellErrors(usedCells.size(), 0.0f);
+		RunParallel(pJobSystem, (int)usedCells.size(), [&](int first, int last) {
+			for (int c = first; c < last; c++)
+			{
+				size_t begin = cellStarts[usedCells[c]];
+				size_t end = cellStarts[usedCells[c] + 1];
+				std::vector<GLuint> cellIndices;
+				cellIndices.reserve((end - begin) * 3);
+				for (size_t i = begin; i < end; i++)
+				{
+					const GLuint* pTriangle = &indices[(size_t)cellTriangles[i] * 3];
+					cellIndices.insert(cellIndices.end(), pTriangle, pTriangle + 3);
+				}
+				std::vector<GLuint> cellVertices(cellIndices);
+				std::sort(cellVertices.begin(), cellVertices.end());
+				cellVertices.erase(std::unique(cellVertices.begin(), cellVertices.end()), cellVertices.end());
+
+				std::vector<float> positions(cellVertices.size() * 3);
+				std::vector<unsigned char> locked(cellVertices.size());
+				for (size_t v = 0; v < cellVertices.size(); v++)
+				{
+					memcpy(&positions[v * 3], &verts[(size_t)cellVertices[v] * g_FloatsPerVertex], sizeof(float) * 3);
+					locked[v] = (positionCells[positionRemap[cellVertices[v]]] == g_SharedCell) ? 1 : 0;
+				}
+				for (size_t i = 0; i < cellIndices.size(); i++)
+				{
+					cellIndices[i] = (GLuint)(std::lower_bound(cellVertices.begin(), cellVertices.end(), cellIndices[i]) - cellVertices.begin());
+				}
+
+				size_t cellTarget = (size_t)((double)cellIndices.size() * targetIndexCount / (triangleCount * 3)) / 3 * 3;
+				std::vector<GLuint>& cellResult = cellResults[c];
+				cellErrors[c] = SimplifyMesh(positions.data(), 3, cellVertices.size(),
+					cellIndices.data(), cellIndices.size(), locked.data(), cellTarget, targetError, cellResult);
+				for (size_t i = 0; i < cellResult.size(); i++)
+				{
+					cellResult[i] = cellVertices[cellResult[i]];
+				}
+			}
+		});
+
+		float error = 0.0f;
+		result.clear();
+		for (size_t c = 0; c < cellResults.size(); c++)
+		{
+			result.insert(result.end(), cellResults[c].begin(), cellResults[c].end());
+			error = std::max(error, cellErrors[c]);
+		}
+		return(error);
+	}
+
+	/***********************************************************
+	 *  CompactLevel()
+	 *
+	 *  This function is used for giving a reduced detail level
+	 *  a copy of only the vertices of the full detail mesh that
+	 *  its indices use, in the order they are first used.
+	 ***********************************************************/
+	void CompactLevel(
+		const std::vector<float>& verts,
+		ShapeMeshes::MESH_DATA& level)
+	{
+		std::vector<GLuint> vertexMap(verts.size() / g_FloatsPerVertex, g_NoIndex);
+		level.verts.clear();
+		for (size_t i = 0; i < level.indices.size(); i++)
+		{
+			GLuint& vertex = vertexMap[level.indices[i]];
+			if (vertex == g_NoIndex)
+			{
+				vertex = (GLuint)(level.verts.size() / g_FloatsPerVertex);
+				const float* pVertex = &verts[(size_t)level.indices[i] * g_FloatsPerVertex];
+				level.verts.insert(level.verts.end(), pVertex, pVertex + g_FloatsPerVertex);
+			}
+			level.indices[i] = vertex;
+		}
+		level.rangeEnds.clear();
+	}
+
+	/***********************************************************
+	 *  ReadMeshCache()
+	 *
+	 *  This function is used for reading the detail levels in
+	 *  a mesh cache file - false if it is missing, of another
+	 *  version, damaged, or made from another OBJ file than the
+	 *  passed in one.
+	 ***********************************************************/
+	bool ReadMeshCache(
+		const std::string& cacheFilename,
+		uint64_t sourceHash,
+		uint64_t sourceSize,
+		OBJ_MESH_LEVELS& levels)
+	{
+		MappedFile file;
+		if ((file.Open(cacheFilename.c_str()) == false) || (file.GetSize() < sizeof(MESH_CACHE_FILE_HEADER)))
+		{
+			return(false);
+		}
+
+		MESH_CACHE_FILE_HEADER header;
+		memcpy(&header, file.GetData(), sizeof(header));
+		if ((header.magic != MESH_CACHE_FILE_MAGIC) ||
+			(header.version != MESH_CACHE_FILE_VERSION) ||
+			(header.sourceHash != sourceHash) ||
+			(header.sourceSize != sourceSize) ||
+			(header.levelCount < 1) ||
+			(header.levelCount > ShapeMeshes::LOD_COUNT))
+		{
+			return(false);
+		}
+		uint64_t size = sizeof(header);
+		for (uint32_t lod = 0; lod < header.levelCount; lod++)
+		{
+			size += (uint64_t)header.vertexCounts[lod] * g_FloatsPerVertex * sizeof(float);
+			size += (uint64_t)header.indexCounts[lod] * sizeof(GLuint);
+		}
+		if (file.GetSize() != size)
+		{
+			return(false);
+		}
+
+		const unsigned char* pData = file.GetData() + sizeof(header);
+		levels.levelCount = (int)header.levelCount;
+		for (int lod = 0; lod < levels.levelCount; lod++)
+		{
+			ShapeMeshes::MESH_DATA& data = levels.levels[lod];
+			size_t vertexBytes = (size_t)header.vertexCounts[lod] * g_FloatsPerVertex * sizeof(float);
+			size_t indexBytes = (size_t)header.indexCounts[lod] * sizeof(GLuint);
+			data.verts.resize((size_t)header.vertexCounts[lod] * g_FloatsPerVertex);
+			memcpy(data.verts.data(), pData, vertexBytes);
+			data.indices.resize(header.indexCounts[lod]);
+			memcpy(data.indices.data(), pData + vertexBytes, indexBytes);
+			data.rangeEnds.clear();
+			levels.errors[lod] = header.levelErrors[lod];
+			pData += vertexBytes + indexBytes;
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  WriteMeshCache()
+	 *
+	 *  This function is used for writing the detail levels of
+	 *  a mesh to a cache file, with the hash of the OBJ file
+	 *  they were made from.
+	 ***********************************************************/
+	bool WriteMeshCache(
+		const std::string& cacheFilename,
+		uint64_t sourceHash,
+		uint64_t sourceSize,
+		const OBJ_MESH_LEVELS& levels)
+	{
+		std::ofstream file(cacheFilename.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			return(false);
+		}
+
+		// cleared first, so the padding is written as zeros
+		MESH_CACHE_FILE_HEADER header;
+		memset(&header, 0, sizeof(header));
+		header.magic = MESH_CACHE_FILE_MAGIC;
+		header.version = MESH_CACHE_FILE_VERSION;
+		header.sourceHash = sourceHash;
+		header.sourceSize = sourceSize;
+		header.levelCount = (uint32_t)levels.levelCount;
+		for (int lod = 0; lod < levels.levelCount; lod++)
+		{
+			header.vertexCounts[lod] = (uint32_t)(levels.levels[lod].verts.size() / g_FloatsPerVertex);
+			header.indexCounts[lod] = (uint32_t)levels.levels[lod].indices.size();
+			header.levelErrors[lod] = levels.errors[lod];
+		}
+		file.write((const char*)&header, sizeof(header));
+		for (int lod = 0; lod < levels.levelCount; lod++)
+		{
+			const ShapeMeshes::MESH_DATA& data = levels.levels[lod];
+			file.write((const char*)data.verts.data(), sizeof(float) * data.verts.size());
+			file.write((const char*)data.indices.data(), sizeof(GLuint) * data.indices.size());
+		}
+		return(file.good());
+	}
+}
+
+/***********************************************************
+ *  ParseObjMesh()
+ *
+ *  This function is used for parsing the text of an OBJ
+ *  file into one interleaved mesh.  Faces of more than three
+ *  corners are split into fans of triangles.  A corner
+ *  without a texture coordinate gets (0, 0), and the corners
+ *  without a normal get the average normal of the triangles
+ *  around their position.  Groups, objects and materials
+ *  are ignored, so the whole file becomes a single mesh.
+ ***********************************************************/
+bool ParseObjMesh(
+	const char* pText,
+	size_t size,
+	JobSystem* pJobSystem,
+	ShapeMeshes::MESH_DATA& data,
+	OBJ_IMPORT_STATS* pStats)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	const char* pTextEnd = pText + size;
+
+	// cut the text into a few chunks per thread, each ending
+	// after a line break
+	int threadCount = (NULL != pJobSystem) ? pJobSystem->GetThreadCount() : 1;
+	size_t chunkCount = std::max((size_t)1, std::min(size / g_MinChunkSize, (size_t)threadCount * 4));
+	std::vector<OBJ_CHUNK> chunks;
+	chunks.reserve(chunkCount);
+	const char* pChunkBegin = pText;
+	for (size_t i = 1; (i <= chunkCount) && (pChunkBegin < pTextEnd); i++)
+	{
+		const char* pChunkEnd = pTextEnd;
+		if (i < chunkCount)
+		{
+			pChunkEnd = std::max(pText + size / chunkCount * i, pChunkBegin);
+			pChunkEnd = std::min(GetLineEnd(pChunkEnd, pTextEnd) + 1, pTextEnd);
+		}
+		OBJ_CHUNK chunk;
+		chunk.pBegin = pChunkBegin;
+		chunk.pEnd = pChunkEnd;
+		chunks.push_back(chunk);
+		pChunkBegin = pChunkEnd;
+	}
+
+	// count the elements of every chunk, so each one knows
+	// where its elements start
+	RunParallel(pJobSystem, (int)chunks.size(), [&](int first, int last) {
+		for (int i = first; i < last; i++)
+		{
+			CountChunkElements(chunks[i]);
+		}
+	});
+
+	OBJ_CHUNK totals;
+	totals.positionCount = 0;
+	totals.uvCount = 0;
+	totals.normalCount = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].firstPosition = totals.positionCount;
+		chunks[i].firstUV = totals.uvCount;
+		chunks[i].firstNormal = totals.normalCount;
+		totals.positionCount += chunks[i].positionCount;
+		totals.uvCount += chunks[i].uvCount;
+		totals.normalCount += chunks[i].normalCount;
+	}
+
+	OBJ_ARRAYS arrays;
+	arrays.positions.resize((size_t)totals.positionCount * 3);
+	arrays.uvs.resize((size_t)totals.uvCount * 2);
+	arrays.normals.resize((size_t)totals.normalCount * 3);
+	RunParallel(pJobSystem, (int)chunks.size(), [&](int first, int last) {
+		for (int i = first; i < last; i++)
+		{
+			ParseChunk(chunks[i], totals, arrays);
+		}
+	});
+
+	size_t cornerCount = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		if (chunks[i].errorLine != 0)
+		{
+			std::cerr << "Could not read a face of the OBJ mesh, on line " << chunks[i].errorLine
+				<< " of its part " << (i + 1) << " of " << chunks.size() << std::endl;
+			return(false);
+		}
+		cornerCount += chunks[i].corners.size();
+	}
+	if ((cornerCount == 0) || (cornerCount > 0xFFFFFFFF))
+	{
+		std::cerr << "The OBJ mesh has no faces or too many of them" << std::endl;
+		return(false);
+	}
+	double parseTime = GetMilliseconds(startTime);
+
+	// weld the corners into vertices
+	startTime = std::chrono::steady_clock::now();
+	std::vector<OBJ_CORNER> vertices;
+	data.indices.resize(cornerCount);
+	WeldCorners(chunks, std::max((size_t)totals.positionCount, cornerCount / 6), vertices, data.indices);
+	chunks.clear();
+
+	std::vector<float> positionNormals;
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		if (vertices[i].normal == g_NoIndex)
+		{
+			CalculatePositionNormals(arrays.positions, vertices, data.indices, positionNormals);
+			break;
+		}
+	}
+
+	data.verts.resize(vertices.size() * g_FloatsPerVertex);
+	RunParallel(pJobSystem, (int)vertices.size(), [&](int first, int last) {
+		for (int i = first; i < last; i++)
+		{
+			const OBJ_CORNER& vertex = vertices[i];
+			float* pVertex = &data.verts[(size_t)i * g_FloatsPerVertex];
+			memcpy(pVertex, &arrays.positions[(size_t)vertex.position * 3], sizeof(float) * 3);
+			if (vertex.normal != g_NoIndex)
+			{
+				memcpy(pVertex + 3, &arrays.normals[(size_t)vertex.normal * 3], sizeof(float) * 3);
+			}
+			else
+			{
+				memcpy(pVertex + 3, &positionNormals[(size_t)vertex.position * 3], sizeof(float) * 3);
+			}
+			if (vertex.uv != g_NoIndex)
+			{
+				memcpy(pVertex + 6, &arrays.uvs[(size_t)vertex.uv * 2], sizeof(float) * 2);
+			}
+			else
+			{
+				pVertex[6] = 0.0f;
+				pVertex[7] = 0.0f;
+			}
+		}
+	});
+	data.rangeEnds.clear();
+
+	if (NULL != pStats)
+	{
+		pStats->positionCount = (int)totals.positionCount;
+		pStats->triangleCount = (int)(data.indices.size() / 3);
+		pStats->vertexCount = (int)vertices.size();
+		pStats->parseTime = parseTime;
+		pStats->weldTime = GetMilliseconds(startTime);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  BuildMeshLevels()
+ *
+ *  This function is used for building the reduced detail
+ *  levels of the mesh in the first level.  Each level is
+ *  simplified from the indices of the one before it, over
+ *  the same vertices, to a fraction of its triangles within
+ *  what is left of the error of the level once the errors
+ *  of the levels before it are taken off, and then gets a
+ *  copy of only the vertices it uses.  The levels stop when
+ *  one removes too few triangles, or when no error is left.
+ ***********************************************************/
+void BuildMeshLevels(
+	JobSystem* pJobSystem,
+	OBJ_MESH_LEVELS& levels)
+{
+	const ShapeMeshes::MESH_DATA& full = levels.levels[0];
+	size_t vertexCount = full.verts.size() / g_FloatsPerVertex;
+	levels.levelCount = 1;
+	levels.errors[0] = 0.0f;
+	if (full.indices.size() / 3 < g_LODMinTriangles)
+	{
+		return;
+	}
+
+	glm::vec3 boundsMin(FLT_MAX);
+	glm::vec3 boundsMax(-FLT_MAX);
+	for (size_t i = 0; i < full.verts.size(); i += g_FloatsPerVertex)
+	{
+		glm::vec3 position(full.verts[i], full.verts[i + 1], full.verts[i + 2]);
+		boundsMin = glm::min(boundsMin, position);
+		boundsMax = glm::max(boundsMax, position);
+	}
+	float radius = 0.5f * glm::length(boundsMax - boundsMin);
+
+	std::vector<GLuint> positionRemap;
+	WeldPositions(full.verts.data(), g_FloatsPerVertex, vertexCount, positionRemap);
+
+	float error = 0.0f;
+	for (int lod = 1; lod < ShapeMeshes::LOD_COUNT; lod++)
+	{
+		const std::vector<GLuint>& previous = levels.levels[lod - 1].indices;
+		std::vector<GLuint>& indices = levels.levels[lod].indices;
+		float targetError = g_LODErrors[lod - 1] * radius - error;
+		if (targetError <= 0.0f)
+		{
+			break;
+		}
+
+		size_t targetIndexCount = (size_t)(previous.size() / 3 * g_LODTriangleFraction) * 3;
+		float levelError = SimplifyInCells(full.verts, positionRemap, previous,
+			targetIndexCount, targetError, (lod % 2) == 0, pJobSystem, indices);
+		if ((float)indices.size() > (float)previous.size() * (1.0f - g_LODMinReduction))
+		{
+			indices.clear();
+			break;
+		}
+		error += levelError;
+		levels.errors[lod] = error;
+		levels.levelCount = lod + 1;
+	}
+
+	RunParallel(pJobSystem, levels.levelCount - 1, [&](int first, int last) {
+		for (int lod = first + 1; lod <= last; lod++)
+		{
+			CompactLevel(full.verts, levels.levels[lod]);
+		}
+	});
+}
+
+/***********************************************************
+ *  ImportObjMesh()
+ *
+ *  This function is used for importing an OBJ file and its
+ *  detail levels.  The file is hashed first, and its cache
+ *  file is used when it was made from a file with the same
+ *  hash and size.  Else the file is parsed, its detail
+ *  levels are built, each level is optimized for the vertex
+ *  cache and the cache file is written again.  The cache
+ *  file is only a shortcut, so failing to write it is not
+ *  an error.
+ ***********************************************************/
+bool ImportObjMesh(
+	const char* filename,
+	JobSystem* pJobSystem,
+	OBJ_MESH_LEVELS& levels,
+	OBJ_IMPORT_STATS* pStats)
+{
+	OBJ_IMPORT_STATS stats;
+	memset(&stats, 0, sizeof(stats));
+
+	MappedFile source;
+	if (source.Open(filename) == false)
+	{
+		std::cerr << "Could not open mesh file: " << filename << std::endl;
+		return(false);
+	}
+	stats.fileSize = source.GetSize();
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	uint64_t sourceHash = HashFileContents(source.GetData(), source.GetSize(), pJobSystem);
+	stats.hashTime = GetMilliseconds(startTime);
+
+	std::string cacheFilename = GetMeshCacheFilename(filename);
+	startTime = std::chrono::steady_clock::now();
+	if (ReadMeshCache(cacheFilename, sourceHash, source.GetSize(), levels) == true)
+	{
+		stats.bFromCache = true;
+		stats.triangleCount = (int)(levels.levels[0].indices.size() / 3);
+		stats.vertexCount = (int)(levels.levels[0].verts.size() / g_FloatsPerVertex);
+		stats.cacheTime = GetMilliseconds(startTime);
+	}
+	else
+	{
+		if (ParseObjMesh((const char*)source.GetData(), source.GetSize(), pJobSystem, levels.levels[0], &stats) == false)
+		{
+			std::cerr << "Could not import mesh file: " << filename << std::endl;
+			return(false);
+		}
+
+		startTime = std::chrono::steady_clock::now();
+		BuildMeshLevels(pJobSystem, levels);
+		stats.simplifyTime = GetMilliseconds(startTime);
+
+		startTime = std::chrono::steady_clock::now();
+		RunParallel(pJobSystem, levels.levelCount, [&](int first, int last) {
+			for (int lod = first; lod < last; lod++)
+			{
+				ShapeMeshes::MESH_DATA& data = levels.levels[lod];
+				OptimizeMesh(data.verts, g_FloatsPerVertex, data.indices, data.rangeEnds);
+			}
+		});
+		stats.optimizeTime = GetMilliseconds(startTime);
+
+		startTime = std::chrono::steady_clock::now();
+		if (WriteMeshCache(cacheFilename, sourceHash, source.GetSize(), levels) == false)
+		{
+			std::cerr << "Could not write mesh cache file: " << cacheFilename << std::endl;
+		}
+		stats.cacheTime = GetMilliseconds(startTime);
+	}
+	stats.levelCount = levels.levelCount;
+
+	if (NULL != pStats)
+	{
+		*pStats = stats;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  GetMeshCacheFilename()
+ *
+ *  This function is used for getting the name of the cache
+ *  file of an OBJ file, next to it.
+ ***********************************************************/
+std::string GetMeshCacheFilename(const std::string& filename)
+{
+	size_t extension = filename.rfind('.');
+	size_t directory = filename.find_last_of("/\\");
+	if ((extension == std::string::npos) ||
+		((directory != std::string::npos) && (extension < directory)))
+	{
+		return(filename + ".mesh");
+	}
+	return(filename.substr(0, extension) + ".mesh");
+}
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// objimporter.h
+// ============
+// import Wavefront OBJ meshes on several threads, with a binary cache
+//
+//  The OBJ file is mapped into memory and cut into chunks at line breaks,
+//  which the job system parses at the same time.  A first pass over the
+//  chunks only counts the positions, texture coordinates and normals in
+//  each one, so the second pass knows where every chunk starts in the
+//  shared arrays and can resolve the relative indices of its faces on its
+//  own.  The numbers are read by a small parser of its own instead of the
+//  C or C++ libraries, which are many times slower.  The corners of the
+//  faces are then welded - every distinct combination of position,
+//  texture coordinate and normal becomes one vertex of the interleaved
+//  layout of the shape meshes.  The reduced detail levels are built next,
+//  each simplified from the one before it with the quadric error metric
+//  to a quarter of its triangles, within an error that is about a pixel
+//  at the screen size where the scene manager switches to the level.  A
+//  large mesh is cut into cells of a grid that are simplified at the same
+//  time, with the positions the cells share locked, so the memory of each
+//  job only grows with its cell.  Every level is then optimized for the
+//  vertex cache.  The levels are written to a binary cache file next to
+//  the OBJ file, with a hash of the OBJ file, and the next import of an
+//  unchanged file reads the cache instead of cooking the mesh again.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeMeshes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class JobSystem;
+
+// "MESH" as the first bytes of a mesh cache file
+const uint32_t MESH_CACHE_FILE_MAGIC = 0x4853454D;
+// changed whenever the layout of the file changes
+const uint32_t MESH_CACHE_FILE_VERSION = 2;
+
+// start of every mesh cache file, followed by the interleaved
+// vertices and then the indices of each detail level in turn
+struct MESH_CACHE_FILE_HEADER
+{
+	uint32_t magic;
+	uint32_t version;
+	// hash and size of the OBJ file the mesh was imported from
+	uint64_t sourceHash;
+	uint64_t sourceSize;
+	// detail levels in the file, and the vertices, indices
+	// and error of each one
+	uint32_t levelCount;
+	uint32_t vertexCounts[ShapeMeshes::LOD_COUNT];
+	uint32_t indexCounts[ShapeMeshes::LOD_COUNT];
+	float levelErrors[ShapeMeshes::LOD_COUNT];
+};
+
+// the detail levels of an imported mesh, full detail first,
+// and the error of each level as the furthest its surface
+// may lie from the full detail one, in the units of the
+// positions
+struct OBJ_MESH_LEVELS
+{
+	int levelCount;
+	ShapeMeshes::MESH_DATA levels[ShapeMeshes::LOD_COUNT];
+	float errors[ShapeMeshes::LOD_COUNT];
+};
+
+// counts and times of one import
+struct OBJ_IMPORT_STATS
+{
+	size_t fileSize;
+	// read from the cache file instead of the OBJ text
+	bool bFromCache;
+	int positionCount;
+	int triangleCount;
+	int vertexCount;
+	int levelCount;
+	// milliseconds spent in each step
+	double hashTime;
+	double parseTime;
+	double weldTime;
+	double simplifyTime;
+	double optimizeTime;
+	double cacheTime;
+};
+
+// parse the text of an OBJ file into one mesh of position,
+// normal and texture coordinate vertices - the job system can
+// be NULL to parse on the calling thread only
+bool ParseObjMesh(
+	const char* pText,
+	size_t size,
+	JobSystem* pJobSystem,
+	ShapeMeshes::MESH_DATA& data,
+	OBJ_IMPORT_STATS* pStats = NULL);
+
+// build the reduced detail levels of the mesh in the first
+// level, before it is optimized, by simplifying each level
+// into the next - the job system can be NULL to simplify on
+// the calling thread only
+void BuildMeshLevels(
+	JobSystem* pJobSystem,
+	OBJ_MESH_LEVELS& levels);
+
+// import an OBJ file and its detail levels, from its cache
+// file when that was made from the same file, or else by
+// parsing, simplifying and optimizing it and writing the
+// cache file
+bool ImportObjMesh(
+	const char* filename,
+	JobSystem* pJobSystem,
+	OBJ_MESH_LEVELS& levels,
+	OBJ_IMPORT_STATS* pStats = NULL);
+
+// get the name of the cache file of an OBJ file - the same name
+// with the .mesh extension
+std::string GetMeshCacheFilename(const std::string& filename);
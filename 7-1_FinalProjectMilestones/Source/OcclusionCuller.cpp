@@ -0,0 +1,335 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.cpp
+// ============
+// skip drawing objects hidden behind others using GPU occlusion queries
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	const char* g_UseLightingName = "bUseLighting";
+
+	// number of indices in the bounding box mesh
+	const GLsizei g_BoxIndexCount = 36;
+	// the bounding boxes are grown by this fraction, plus a small
+	// constant for flat objects, so that an object never hides
+	// its own bounding box in the depth buffer
+	const float g_BoxInflation = 1.02f;
+	const float g_MinimumBoxSize = 0.01f;
+}
+
+/***********************************************************
+ *  OcclusionCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCuller::OcclusionCuller(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_boxVAO = 0;
+	m_boxVBOs[0] = 0;
+	m_boxVBOs[1] = 0;
+	m_issueSet = 0;
+	m_bEnabled = true;
+	m_bConditionalActive = false;
+	m_viewProjection = glm::mat4(1.0f);
+}
+
+/***********************************************************
+ *  ~OcclusionCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCuller::~OcclusionCuller()
+{
+	DestroyQueries();
+
+	if (m_boxVAO != 0)
+	{
+		glDeleteBuffers(2, m_boxVBOs);
+		glDeleteVertexArrays(1, &m_boxVAO);
+	}
+	m_pShaderManager = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the unit box mesh that
+ *  is drawn for every occlusion query.  Only the position
+ *  attribute is enabled - the normal and texture attributes
+ *  are unused because lighting and texturing are disabled
+ *  while the queries are drawn.
+ ***********************************************************/
+void OcclusionCuller::Initialize()
+{
+	GLfloat verts[] = {
+		-0.5f, -0.5f, -0.5f,	//0
+		0.5f, -0.5f, -0.5f,		//1
+		0.5f, 0.5f, -0.5f,		//2
+		-0.5f, 0.5f, -0.5f,		//3
+		-0.5f, -0.5f, 0.5f,		//4
+		0.5f, -0.5f, 0.5f,		//5
+		0.5f, 0.5f, 0.5f,		//6
+		-0.5f, 0.5f, 0.5f,		//7
+	};
+
+	GLuint indices[] = {
+		0,1,2, 0,2,3,	// back
+		4,6,5, 4,7,6,	// front
+		0,4,5, 0,5,1,	// bottom
+		3,2,6, 3,6,7,	// top
+		0,3,7, 0,7,4,	// left
+		1,5,6, 1,6,2	// right
+	};
+
+	glGenVertexArrays(1, &m_boxVAO);
+	glBindVertexArray(m_boxVAO);
+
+	glGenBuffers(2, m_boxVBOs);
+	glBindBuffer(GL_ARRAY_BUFFER, m_boxVBOs[0]);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_boxVBOs[1]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, 0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used for turning the culling on or off.
+ *  Query results from before the culling was turned off
+ *  are stale, so they are forgotten.
+ ***********************************************************/
+void OcclusionCuller::SetEnabled(bool bEnabled)
+{
+	if (bEnabled == m_bEnabled)
+	{
+		return;
+	}
+
+	m_bEnabled = bEnabled;
+	for (int set = 0; set < 2; set++)
+	{
+		std::fill(m_queryIssued[set].begin(), m_queryIssued[set].end(), false);
+	}
+	m_occludees.clear();
+}
+
+/***********************************************************
+ *  BeginOccludee()
+ *
+ *  This method is used for recording the bounding box of
+ *  the passed in object for this frame's query, and for
+ *  starting the conditional rendering of the object on the
+ *  query that was issued for it in the previous frame.  A
+ *  box that reaches past the near plane, as when the camera
+ *  is inside it, loses its near faces to clipping and its
+ *  far faces are behind the object itself, so the object is
+ *  neither tested nor skipped.
+ ***********************************************************/
+void OcclusionCuller::BeginOccludee(
+	int objectIndex,
+	const glm::mat4& model,
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax)
+{
+	if ((m_bEnabled == false) || (objectIndex < 0))
+	{
+		return;
+	}
+
+	ReserveQueries(objectIndex);
+
+	// record the bounding box for the end of frame query pass
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	glm::vec3 size = (boundsMax - boundsMin) * g_BoxInflation + g_MinimumBoxSize;
+
+	OCCLUDEE occludee;
+	occludee.objectIndex = objectIndex;
+	occludee.boxTransform = glm::scale(glm::translate(model, center), size);
+	if (IsCrossingNearPlane(occludee.boxTransform) == true)
+	{
+		return;
+	}
+	m_occludees.push_back(occludee);
+
+	// if the object was tested in the previous frame, let the
+	// GPU skip its draw commands when the box was not visible
+	int readSet = 1 - m_issueSet;
+	if (m_queryIssued[readSet][objectIndex] == true)
+	{
+		glBeginConditionalRender(m_queries[readSet][objectIndex], GL_QUERY_NO_WAIT);
+		m_bConditionalActive = true;
+	}
+}
+
+/***********************************************************
+ *  IsCrossingNearPlane()
+ *
+ *  This method is used for checking whether any corner of
+ *  the unit box under the passed in transform is in front
+ *  of the near plane, or behind the camera, in the clip
+ *  space of the frame.
+ ***********************************************************/
+bool OcclusionCuller::IsCrossingNearPlane(const glm::mat4& boxTransform) const
+{
+	glm::mat4 boxToClip = m_viewProjection * boxTransform;
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner(
+			((i & 1) != 0) ? 0.5f : -0.5f,
+			((i & 2) != 0) ? 0.5f : -0.5f,
+			((i & 4) != 0) ? 0.5f : -0.5f,
+			1.0f);
+		glm::vec4 clip = boxToClip * corner;
+		if ((clip.w <= 0.0f) || (clip.z < -clip.w))
+		{
+			return(true);
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  EndOccludee()
+ *
+ *  This method is used for ending the conditional rendering
+ *  of the current object.
+ ***********************************************************/
+void OcclusionCuller::EndOccludee()
+{
+	if (m_bConditionalActive == true)
+	{
+		glEndConditionalRender();
+		m_bConditionalActive = false;
+	}
+}
+
+/***********************************************************
+ *  IssueQueries()
+ *
+ *  This method is used for drawing the bounding boxes of the
+ *  objects tested this frame against the finished depth
+ *  buffer.  Each box is drawn inside its own query, without
+ *  writing color or depth, and the query results are used
+ *  for the conditional rendering in the next frame.
+ ***********************************************************/
+void OcclusionCuller::IssueQueries(UniformRingBuffer* pUniformRing)
+{
+	if ((m_bEnabled == false) || (m_boxVAO == 0) || (NULL == m_pShaderManager) || (NULL == pUniformRing))
+	{
+		m_occludees.clear();
+		return;
+	}
+
+	// the conservative query type allows the driver to skip
+	// exact sample counting, but it needs OpenGL 4.3
+	GLenum queryTarget = GL_ANY_SAMPLES_PASSED;
+	if (GLEW_VERSION_4_3)
+	{
+		queryTarget = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+	}
+
+	// objects that are not tested this frame must not be culled
+	// by an old result in the next frame
+	std::fill(m_queryIssued[m_issueSet].begin(), m_queryIssued[m_issueSet].end(), false);
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDepthFunc(GL_LEQUAL);
+
+	m_pShaderManager->setBoolValue(g_UseLightingName, false);
+
+	// only the transform of the per-draw values changes between
+	// the boxes, and nothing is written to the color buffer
+	DRAW_UNIFORMS boxUniforms;
+	boxUniforms.objectColor = glm::vec4(1.0f);
+	boxUniforms.UVscale = glm::vec2(1.0f);
+	boxUniforms.bUseTexture = 0;
+	boxUniforms.materialIndex = 0;
+
+	glBindVertexArray(m_boxVAO);
+	for (size_t i = 0; i < m_occludees.size(); i++)
+	{
+		int objectIndex = m_occludees[i].objectIndex;
+
+		boxUniforms.model = m_occludees[i].boxTransform;
+		GLintptr offset = pUniformRing->Write(&boxUniforms, sizeof(boxUniforms));
+		if (offset < 0)
+		{
+			// an untested object is simply drawn in the next frame
+			continue;
+		}
+		pUniformRing->BindRange(DRAW_DATA_BINDING, offset, sizeof(boxUniforms));
+
+		glBeginQuery(queryTarget, m_queries[m_issueSet][objectIndex]);
+		glDrawElements(GL_TRIANGLES, g_BoxIndexCount, GL_UNSIGNED_INT, (void*)0);
+		glEndQuery(queryTarget);
+
+		m_queryIssued[m_issueSet][objectIndex] = true;
+	}
+	glBindVertexArray(0);
+
+	// restore the state used for drawing the scene
+	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+	// the queries just issued are read in the next frame
+	m_issueSet = 1 - m_issueSet;
+	m_occludees.clear();
+}
+
+/***********************************************************
+ *  ReserveQueries()
+ *
+ *  This method is used for creating query objects in both
+ *  query sets, up to and including the passed in object.
+ ***********************************************************/
+void OcclusionCuller::ReserveQueries(int objectIndex)
+{
+	size_t required = objectIndex + 1;
+	if (m_queries[0].size() >= required)
+	{
+		return;
+	}
+
+	// grow in larger steps to keep the number of GL calls low
+	size_t newSize = std::max(required, m_queries[0].size() * 2);
+	for (int set = 0; set < 2; set++)
+	{
+		size_t oldSize = m_queries[set].size();
+		m_queries[set].resize(newSize);
+		m_queryIssued[set].resize(newSize, false);
+		glGenQueries((GLsizei)(newSize - oldSize), &m_queries[set][oldSize]);
+	}
+}
+
+/***********************************************************
+ *  DestroyQueries()
+ *
+ *  This method is used for deleting all the query objects.
+ ***********************************************************/
+void OcclusionCuller::DestroyQueries()
+{
+	for (int set = 0; set < 2; set++)
+	{
+		if (m_queries[set].size() > 0)
+		{
+			glDeleteQueries((GLsizei)m_queries[set].size(), m_queries[set].data());
+		}
+		m_queries[set].clear();
+		m_queryIssued[set].clear();
+	}
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.h
+// ============
+// skip drawing objects hidden behind others using GPU occlusion queries
+//
+//  At the end of every frame the bounding box of each tested object is
+//  drawn against the finished depth buffer with color and depth writes
+//  disabled, inside a GL_ANY_SAMPLES_PASSED_CONSERVATIVE query.  In the
+//  next frame the object is drawn inside glBeginConditionalRender() on
+//  that query, so the GPU discards the draw when no sample of the box
+//  was visible.  The results are consumed one frame late and with
+//  GL_QUERY_NO_WAIT, so the CPU never stalls waiting on a query.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "UniformRingBuffer.h"
+
+#include <vector>
+
+/***********************************************************
+ *  OcclusionCuller
+ *
+ *  This class contains the code for issuing the per-object
+ *  occlusion queries and wrapping the object draws in
+ *  conditional rendering.
+ ***********************************************************/
+class OcclusionCuller
+{
+public:
+	// constructor
+	OcclusionCuller(ShaderManager* pShaderManager);
+	// destructor
+	~OcclusionCuller();
+
+	// create the bounding box mesh used for the query draws
+	void Initialize();
+
+	// enable or disable the culling - when disabled, all
+	// objects are drawn and no queries are issued
+	void SetEnabled(bool bEnabled);
+	bool IsEnabled() const { return(m_bEnabled); }
+	// set the view and projection of the frame, for finding
+	// the boxes that reach past the near plane
+	void SetViewProjection(const glm::mat4& viewProjection) { m_viewProjection = viewProjection; }
+
+	// start wrapping the draw commands of the passed in object
+	// in conditional rendering on the previous frame's query
+	void BeginOccludee(
+		int objectIndex,
+		const glm::mat4& model,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax);
+	// stop the conditional rendering of the current object
+	void EndOccludee();
+
+	// draw the bounding boxes of all the objects tested this
+	// frame inside occlusion queries for the next frame - the
+	// box transforms are written to the passed in ring buffer
+	void IssueQueries(UniformRingBuffer* pUniformRing);
+
+private:
+	// bounding box of an object tested in the current frame
+	struct OCCLUDEE
+	{
+		int objectIndex;
+		glm::mat4 boxTransform;
+	};
+
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// unit box mesh used for the query draws
+	GLuint m_boxVAO;
+	GLuint m_boxVBOs[2];
+	// two sets of query objects - one set is being read by the
+	// conditional rendering while the other one is issued
+	std::vector<GLuint> m_queries[2];
+	std::vector<bool> m_queryIssued[2];
+	int m_issueSet;
+	// bounding boxes of the objects tested this frame
+	std::vector<OCCLUDEE> m_occludees;
+	bool m_bEnabled;
+	bool m_bConditionalActive;
+	glm::mat4 m_viewProjection;
+
+	// make sure both query sets can hold the passed in object
+	void ReserveQueries(int objectIndex);
+	// check whether any corner of a box is in front of the
+	// near plane, where the faces of the box are clipped
+	bool IsCrossingNearPlane(const glm::mat4& boxTransform) const;
+	// delete all the query objects
+	void DestroyQueries();
+};
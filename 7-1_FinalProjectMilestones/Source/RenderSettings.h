@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendersettings.h
+// ============
+// runtime switches shared between the view, scene and main loop
+//
+//  The settings are filled in from the command line at startup and some
+//  of them can be toggled from the keyboard while the scene is running,
+//  so the cost of each rendering feature can be compared live.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+// ways of skipping the objects hidden behind other objects
+enum OcclusionMode
+{
+	// draw every object
+	OCCLUSION_OFF,
+	// GPU occlusion queries from the previous frame
+	OCCLUSION_GPU_QUERIES,
+	// CPU depth rasterizer with the large objects as occluders
+	OCCLUSION_CPU_RASTER,
+	// a compute shader culling against the frustum and the depth
+	// of the previous frame, writing indirect draw commands
+	OCCLUSION_GPU_DRIVEN,
+	OCCLUSION_MODE_COUNT
+};
+
+// ways of drawing the translucent objects
+enum TransparencyMode
+{
+	// blended over the opaque objects from back to front, after
+	// sorting them by their distance from the camera
+	TRANSPARENCY_SORTED,
+	// weighted blended order independent transparency, which
+	// needs no sorting
+	TRANSPARENCY_WEIGHTED,
+	TRANSPARENCY_MODE_COUNT
+};
+
+/***********************************************************
+ *  GetOcclusionModeName()
+ *
+ *  This function is used for getting the name of the passed
+ *  in occlusion mode, for the console output.
+ ***********************************************************/
+inline const char* GetOcclusionModeName(OcclusionMode mode)
+{
+	switch (mode)
+	{
+	case OCCLUSION_GPU_QUERIES:	return("GPU occlusion queries");
+	case OCCLUSION_CPU_RASTER:	return("CPU occlusion rasterizer");
+	case OCCLUSION_GPU_DRIVEN:	return("GPU driven culling");
+	default:					return("occlusion culling off");
+	}
+}
+
+/***********************************************************
+ *  GetTransparencyModeName()
+ *
+ *  This function is used for getting the name of the passed
+ *  in transparency mode, for the console output.
+ ***********************************************************/
+inline const char* GetTransparencyModeName(TransparencyMode mode)
+{
+	switch (mode)
+	{
+	case TRANSPARENCY_WEIGHTED:	return("weighted blended transparency");
+	default:					return("sorted transparency");
+	}
+}
+
+/***********************************************************
+ *  RENDER_SETTINGS
+ *
+ *  This structure contains the switches that control the
+ *  optional rendering features.
+ ***********************************************************/
+struct RENDER_SETTINGS
+{
+	// scene to draw - a text scene description is cooked into
+	// a .scene file next to it whenever it has changed, and a
+	// .scene file is mapped as it is
+	std::string sceneFile = "../../Utilities/scenes/stilllife.txt";
+	// how objects hidden behind other objects are skipped
+	// (cycle through the modes with the C key)
+	OcclusionMode occlusionMode = OCCLUSION_GPU_QUERIES;
+	// how the translucent objects are blended (toggle with the
+	// T key)
+	TransparencyMode transparencyMode = TRANSPARENCY_SORTED;
+	// draw the curved shapes with fewer vertices when they
+	// cover less of the screen (toggle with the L key)
+	bool bLevelOfDetail = true;
+	// draw only the meshlets of the dense imported meshes that
+	// are inside the frustum and face the camera (toggle with
+	// the K key)
+	bool bMeshletCulling = true;
+	// store the meshes in 16 bytes per vertex instead of 32,
+	// with quantized positions and normals and half float
+	// texture coordinates
+	bool bPackedVertices = false;
+	// threads that run the per-frame CPU work, including the
+	// main thread - 0 uses one per hardware thread
+	int jobThreadCount = 0;
+	// frames the CPU may build before the GPU has finished the
+	// oldest one, from 1 (lowest latency) to 3 (highest
+	// throughput) - cycle with the F key
+	int framesInFlight = 2;
+	// measure the time from reading the input to the GPU
+	// finishing the frame (toggle with the M key)
+	bool bMeasureLatency = false;
+	// print the average CPU and GPU frame times to the console
+	bool bReportFrameTime = true;
+	// seconds between frame time reports
+	float frameReportInterval = 2.0f;
+};
@@ -0,0 +1,626 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebuilder.cpp
+// ============
+// build the arrays of a scene and write them as a cooked scene file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneBuilder.h"
+#include "TransformBatch.h"
+#include "GltfImporter.h"
+
+#include <sys/stat.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  This function is used for rounding a file offset up to
+	 *  the alignment of the arrays.
+	 ***********************************************************/
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return(((offset + SCENE_FILE_ALIGNMENT - 1) / SCENE_FILE_ALIGNMENT) * SCENE_FILE_ALIGNMENT);
+	}
+
+	/***********************************************************
+	 *  ReadVector()
+	 *
+	 *  This function is used for reading the passed in number
+	 *  of floats from a line of the text scene.
+	 ***********************************************************/
+	bool ReadVector(std::istringstream& line, float* pValues, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (!(line >> pValues[i]))
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  IsFileNewer()
+	 *
+	 *  This function is used for checking whether the first
+	 *  file was changed after the second one, or the second
+	 *  one does not exist.
+	 ***********************************************************/
+	bool IsFileNewer(const char* filename, const char* otherFilename)
+	{
+		struct stat fileInfo;
+		struct stat otherFileInfo;
+
+		if (stat(filename, &fileInfo) != 0)
+		{
+			return(false);
+		}
+		if (stat(otherFilename, &otherFileInfo) != 0)
+		{
+			return(true);
+		}
+		return(fileInfo.st_mtime > otherFileInfo.st_mtime);
+	}
+}
+
+/***********************************************************
+ *  SceneBuilder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneBuilder::SceneBuilder()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the entries.  The
+ *  empty string is always the first string of the pool.
+ ***********************************************************/
+void SceneBuilder::Clear()
+{
+	m_nodes.clear();
+	m_transforms.clear();
+	m_nodeTransforms.clear();
+	m_meshes.clear();
+	m_materials.clear();
+	m_textures.clear();
+	m_occluders.clear();
+	m_strings.clear();
+	m_stringOffsets.clear();
+	AddString("");
+}
+
+/***********************************************************
+ *  AddString()
+ *
+ *  This method is used for adding a string to the pool,
+ *  unless the same string is already in it.
+ ***********************************************************/
+uint32_t SceneBuilder::AddString(const std::string& text)
+{
+	std::unordered_map<std::string, uint32_t>::const_iterator found = m_stringOffsets.find(text);
+	if (found != m_stringOffsets.end())
+	{
+		return(found->second);
+	}
+
+	uint32_t offset = (uint32_t)m_strings.size();
+	m_strings.insert(m_strings.end(), text.begin(), text.end());
+	m_strings.push_back('\0');
+	m_stringOffsets[text] = offset;
+	return(offset);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture image file to
+ *  the texture table.
+ ***********************************************************/
+int SceneBuilder::AddTexture(
+	const std::string& tag,
+	const std::string& path)
+{
+	int index = FindTexture(tag);
+	if (index >= 0)
+	{
+		return(index);
+	}
+
+	SCENE_FILE_TEXTURE texture;
+	texture.path = AddString(path);
+	texture.tag = AddString(tag);
+	m_textures.push_back(texture);
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method is used for adding a material to the
+ *  material table.
+ ***********************************************************/
+int SceneBuilder::AddMaterial(
+	const std::string& tag,
+	const glm::vec3& ambientColor,
+	float ambientStrength,
+	const glm::vec3& diffuseColor,
+	const glm::vec3& specularColor,
+	float shininess)
+{
+	int index = FindMaterial(tag);
+	if (index >= 0)
+	{
+		return(index);
+	}
+
+	SCENE_FILE_MATERIAL material;
+	for (int i = 0; i < 3; i++)
+	{
+		material.ambientColor[i] = ambientColor[i];
+		material.diffuseColor[i] = diffuseColor[i];
+		material.specularColor[i] = specularColor[i];
+	}
+	material.ambientStrength = ambientStrength;
+	material.shininess = shininess;
+	material.tag = AddString(tag);
+	m_materials.push_back(material);
+	return((int)m_materials.size() - 1);
+}
+
+/***********************************************************
+ *  FindTexture()
+ *
+ *  This method is used for finding a texture by its tag.
+ ***********************************************************/
+int SceneBuilder::FindTexture(const std::string& tag) const
+{
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		if (tag.compare(&m_strings[m_textures[i].tag]) == 0)
+		{
+			return(i);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for finding a material by its tag.
+ ***********************************************************/
+int SceneBuilder::FindMaterial(const std::string& tag) const
+{
+	for (int i = 0; i < (int)m_materials.size(); i++)
+	{
+		if (tag.compare(&m_strings[m_materials[i].tag]) == 0)
+		{
+			return(i);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for adding a mesh reference by name.
+ ***********************************************************/
+int SceneBuilder::AddMesh(const std::string& name)
+{
+	for (int i = 0; i < (int)m_meshes.size(); i++)
+	{
+		if (name.compare(&m_strings[m_meshes[i].name]) == 0)
+		{
+			return(i);
+		}
+	}
+
+	SCENE_FILE_MESH mesh;
+	mesh.name = AddString(name);
+	m_meshes.push_back(mesh);
+	return((int)m_meshes.size() - 1);
+}
+
+/***********************************************************
+ *  AddNodeRecord()
+ *
+ *  This method is used for adding a node that uses the next
+ *  model matrix.  Occluder nodes are also added to the list
+ *  of occluders, so it never has to be searched for.
+ ***********************************************************/
+int SceneBuilder::AddNodeRecord(
+	int mesh,
+	int texture,
+	int material,
+	const glm::vec4& color,
+	const glm::vec2& uvScale,
+	int flags)
+{
+	SCENE_FILE_NODE node;
+	node.transform = (uint32_t)m_transforms.size();
+	node.mesh = (uint16_t)mesh;
+	node.flags = (uint16_t)flags;
+	node.texture = (int16_t)texture;
+	node.material = (int16_t)material;
+	for (int i = 0; i < 4; i++)
+	{
+		node.color[i] = color[i];
+	}
+	node.uvScale[0] = uvScale.x;
+	node.uvScale[1] = uvScale.y;
+
+	int index = (int)m_nodes.size();
+	m_nodes.push_back(node);
+	if ((flags & SCENE_NODE_OCCLUDER) != 0)
+	{
+		m_occluders.push_back((uint32_t)index);
+	}
+	return(index);
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a node with its own
+ *  transform.  The matrix is composed when the file is
+ *  written.
+ ***********************************************************/
+int SceneBuilder::AddNode(
+	int mesh,
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegreesXYZ,
+	const glm::vec3& positionXYZ,
+	int texture,
+	int material,
+	const glm::vec4& color,
+	const glm::vec2& uvScale,
+	int flags)
+{
+	int index = AddNodeRecord(mesh, texture, material, color, uvScale, flags);
+
+	NODE_TRANSFORM transform;
+	transform.scale = scaleXYZ;
+	transform.rotation = rotationDegreesXYZ;
+	transform.position = positionXYZ;
+	transform.index = (uint32_t)m_transforms.size();
+	m_nodeTransforms.push_back(transform);
+	m_transforms.push_back(SCENE_FILE_TRANSFORM());
+	return(index);
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a node with a model
+ *  matrix that is already composed.
+ ***********************************************************/
+int SceneBuilder::AddNode(
+	int mesh,
+	const glm::mat4& modelMatrix,
+	int texture,
+	int material,
+	const glm::vec4& color,
+	const glm::vec2& uvScale,
+	int flags)
+{
+	int index = AddNodeRecord(mesh, texture, material, color, uvScale, flags);
+
+	SCENE_FILE_TRANSFORM transform;
+	memcpy(transform.matrix, &modelMatrix[0][0], sizeof(transform.matrix));
+	m_transforms.push_back(transform);
+	return(index);
+}
+
+/***********************************************************
+ *  ParseText()
+ *
+ *  This method is used for reading a text scene description
+ *  into the builder.  The first bad line stops the reading
+ *  with an error message that gives its line number.
+ ***********************************************************/
+bool SceneBuilder::ParseText(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cerr << "Could not open scene description: " << filename << std::endl;
+		return(false);
+	}
+
+	std::string text;
+	int lineNumber = 0;
+	while (std::getline(file, text))
+	{
+		lineNumber++;
+		size_t comment = text.find('#');
+		if (comment != std::string::npos)
+		{
+			text.erase(comment);
+		}
+
+		std::istringstream line(text);
+		std::string keyword;
+		if (!(line >> keyword))
+		{
+			continue;
+		}
+
+		std::string error;
+		if (keyword == "texture")
+		{
+			std::string tag;
+			std::string path;
+			if (!(line >> tag >> path))
+			{
+				error = "expected: texture <tag> <path>";
+			}
+			else
+			{
+				AddTexture(tag, path);
+			}
+		}
+		else if (keyword == "material")
+		{
+			std::string tag;
+			float values[11];
+			if (!(line >> tag) || (ReadVector(line, values, 11) == false))
+			{
+				error = "expected: material <tag> <ambient r g b> <strength> <diffuse r g b> <specular r g b> <shininess>";
+			}
+			else
+			{
+				AddMaterial(tag,
+					glm::vec3(values[0], values[1], values[2]), values[3],
+					glm::vec3(values[4], values[5], values[6]),
+					glm::vec3(values[7], values[8], values[9]), values[10]);
+			}
+		}
+		else if (keyword == "node")
+		{
+			std::string meshName;
+			float values[9];
+			if (!(line >> meshName) || (ReadVector(line, values, 9) == false))
+			{
+				error = "expected: node <mesh> <scale x y z> <rotation x y z> <position x y z>";
+			}
+
+			int texture = -1;
+			int material = -1;
+			glm::vec4 color(1.0f);
+			glm::vec2 uvScale(1.0f);
+			int flags = 0;
+			std::string option;
+			while (error.empty() && (line >> option))
+			{
+				std::string tag;
+				if (option == "texture")
+				{
+					if (!(line >> tag) || ((texture = FindTexture(tag)) < 0))
+					{
+						error = "unknown texture: " + tag;
+					}
+				}
+				else if (option == "material")
+				{
+					if (!(line >> tag) || ((material = FindMaterial(tag)) < 0))
+					{
+						error = "unknown material: " + tag;
+					}
+				}
+				else if (option == "color")
+				{
+					if (ReadVector(line, &color[0], 4) == false)
+					{
+						error = "expected: color r g b a";
+					}
+				}
+				else if (option == "uv")
+				{
+					if (ReadVector(line, &uvScale[0], 2) == false)
+					{
+						error = "expected: uv u v";
+					}
+				}
+				else if (option == "occluder")
+				{
+					flags |= SCENE_NODE_OCCLUDER;
+				}
+				else if (option == "nocull")
+				{
+					flags |= SCENE_NODE_NOT_CULLABLE;
+				}
+				else
+				{
+					error = "unknown node option: " + option;
+				}
+			}
+
+			if (error.empty())
+			{
+				AddNode(AddMesh(meshName),
+					glm::vec3(values[0], values[1], values[2]),
+					glm::vec3(values[3], values[4], values[5]),
+					glm::vec3(values[6], values[7], values[8]),
+					texture, material, color, uvScale, flags);
+			}
+		}
+		else
+		{
+			error = "unknown entry: " + keyword;
+		}
+
+		if (error.empty() == false)
+		{
+			std::cerr << filename << "(" << lineNumber << "): " << error << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for composing the model matrices of
+ *  all the nodes and writing the header and arrays of the
+ *  cooked scene file.
+ ***********************************************************/
+bool SceneBuilder::Write(const char* filename)
+{
+	// compose the missing matrices in one batch and put each
+	// one in its place
+	TransformBatch transforms;
+	transforms.Resize((int)m_nodeTransforms.size());
+	for (int i = 0; i < (int)m_nodeTransforms.size(); i++)
+	{
+		transforms.Set(i, m_nodeTransforms[i].scale, m_nodeTransforms[i].rotation, m_nodeTransforms[i].position);
+	}
+	transforms.ComposeAll();
+	for (int i = 0; i < (int)m_nodeTransforms.size(); i++)
+	{
+		memcpy(m_transforms[m_nodeTransforms[i].index].matrix,
+			transforms.GetMatrixData() + i * 16,
+			sizeof(SCENE_FILE_TRANSFORM));
+	}
+
+	// the start and size of every array in the file
+	const void* pSections[SCENE_SECTION_COUNT] =
+	{
+		m_nodes.data(),
+		m_transforms.data(),
+		m_meshes.data(),
+		m_materials.data(),
+		m_textures.data(),
+		m_occluders.data(),
+		m_strings.data()
+	};
+	const size_t sectionSizes[SCENE_SECTION_COUNT] =
+	{
+		sizeof(SCENE_FILE_NODE),
+		sizeof(SCENE_FILE_TRANSFORM),
+		sizeof(SCENE_FILE_MESH),
+		sizeof(SCENE_FILE_MATERIAL),
+		sizeof(SCENE_FILE_TEXTURE),
+		sizeof(uint32_t),
+		sizeof(char)
+	};
+	const size_t sectionCounts[SCENE_SECTION_COUNT] =
+	{
+		m_nodes.size(),
+		m_transforms.size(),
+		m_meshes.size(),
+		m_materials.size(),
+		m_textures.size(),
+		m_occluders.size(),
+		m_strings.size()
+	};
+
+	SCENE_FILE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = SCENE_FILE_MAGIC;
+	header.version = SCENE_FILE_VERSION;
+
+	uint64_t offset = AlignOffset(sizeof(header));
+	for (int i = 0; i < SCENE_SECTION_COUNT; i++)
+	{
+		header.sections[i].offset = offset;
+		header.sections[i].count = sectionCounts[i];
+		offset = AlignOffset(offset + sectionCounts[i] * sectionSizes[i]);
+	}
+	header.fileSize = offset;
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Could not create scene file: " << filename << std::endl;
+		return(false);
+	}
+
+	// the padding in front of each array is written as zeros
+	const char padding[SCENE_FILE_ALIGNMENT] = { 0 };
+	file.write((const char*)&header, sizeof(header));
+	uint64_t position = sizeof(header);
+	for (int i = 0; i < SCENE_SECTION_COUNT; i++)
+	{
+		file.write(padding, (std::streamsize)(header.sections[i].offset - position));
+		file.write((const char*)pSections[i], (std::streamsize)(sectionCounts[i] * sectionSizes[i]));
+		position = header.sections[i].offset + sectionCounts[i] * sectionSizes[i];
+	}
+	file.write(padding, (std::streamsize)(header.fileSize - position));
+
+	if (!file)
+	{
+		std::cerr << "Could not write scene file: " << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CookSceneFile()
+ *
+ *  This function is used for converting a text scene
+ *  description into a cooked scene file.
+ ***********************************************************/
+bool CookSceneFile(const char* textFilename, const char* sceneFilename)
+{
+	SceneBuilder builder;
+
+	if ((builder.ParseText(textFilename) == false) ||
+		(builder.Write(sceneFilename) == false))
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Cooked " << builder.GetNodeCount() << " scene nodes from "
+		<< textFilename << " into " << sceneFilename << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  CookSceneIfChanged()
+ *
+ *  This function is used for getting the name of the cooked
+ *  scene file of a scene.  A text scene description or a
+ *  glTF file is cooked first, when it has changed since it
+ *  was last cooked, into a file with the same name and the
+ *  .scene extension.  Any other file is taken as cooked
+ *  already.
+ ***********************************************************/
+bool CookSceneIfChanged(const std::string& filename, std::string& sceneFilename)
+{
+	sceneFilename = filename;
+	size_t extension = filename.rfind(".txt");
+	if ((extension != std::string::npos) && (extension == filename.size() - 4))
+	{
+		sceneFilename = filename.substr(0, extension) + ".scene";
+		if (IsFileNewer(filename.c_str(), sceneFilename.c_str()) == true)
+		{
+			return(CookSceneFile(filename.c_str(), sceneFilename.c_str()));
+		}
+	}
+	else if (IsGltfFilename(filename) == true)
+	{
+		sceneFilename = filename.substr(0, filename.rfind('.')) + ".scene";
+		if (IsFileNewer(filename.c_str(), sceneFilename.c_str()) == true)
+		{
+			return(CookGltfScene(filename.c_str(), sceneFilename.c_str()));
+		}
+	}
+	return(true);
+}
@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebuilder.h
+// ============
+// build the arrays of a scene and write them as a cooked scene file
+//
+//  The builder collects textures, materials, meshes and nodes, with the
+//  transform of each node given either as scale, rotation and position
+//  or as a finished model matrix.  When the file is written, all the
+//  model matrices that are not finished yet are composed at once in a
+//  TransformBatch, the strings are gathered into one pool without
+//  duplicates, and the arrays are written in the layout described in
+//  SceneFile.h.  CookSceneFile() fills a builder from the text form of a
+//  scene, which is meant to be written and edited by hand:
+//
+//    # comment
+//    texture <tag> <image path>
+//    material <tag> <ambient r g b> <ambient strength> <diffuse r g b>
+//             <specular r g b> <shininess>
+//    node <mesh> <scale x y z> <rotation x y z> <position x y z>
+//         [texture <tag>] [material <tag>] [color r g b a] [uv u v]
+//         [occluder] [nocull]
+//
+//  Everything after a "#" is ignored, and each entry is on one line.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneFile.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  SceneBuilder
+ *
+ *  This class contains the code for collecting the contents
+ *  of a scene and writing the cooked scene file.
+ ***********************************************************/
+class SceneBuilder
+{
+public:
+	// constructor
+	SceneBuilder();
+
+	// remove everything added so far
+	void Clear();
+
+	// add a texture or material - a tag that is already used
+	// returns the index of the existing entry
+	int AddTexture(
+		const std::string& tag,
+		const std::string& path);
+	int AddMaterial(
+		const std::string& tag,
+		const glm::vec3& ambientColor,
+		float ambientStrength,
+		const glm::vec3& diffuseColor,
+		const glm::vec3& specularColor,
+		float shininess);
+	// find a texture or material by tag, or -1
+	int FindTexture(const std::string& tag) const;
+	int FindMaterial(const std::string& tag) const;
+
+	// add a mesh reference by name - a name that is already
+	// used returns the index of the existing reference
+	int AddMesh(const std::string& name);
+
+	// add a node drawing the passed in mesh reference, with its
+	// rotations in degrees and -1 for no texture or material
+	int AddNode(
+		int mesh,
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegreesXYZ,
+		const glm::vec3& positionXYZ,
+		int texture,
+		int material,
+		const glm::vec4& color,
+		const glm::vec2& uvScale,
+		int flags);
+	// add a node with a model matrix that is already composed
+	int AddNode(
+		int mesh,
+		const glm::mat4& modelMatrix,
+		int texture,
+		int material,
+		const glm::vec4& color,
+		const glm::vec2& uvScale,
+		int flags);
+	int GetNodeCount() const { return((int)m_nodes.size()); }
+
+	// read the entries of a text scene description
+	bool ParseText(const char* filename);
+	// compose the matrices and write the cooked scene file
+	bool Write(const char* filename);
+
+private:
+	// the transform of a node before it is composed, and the
+	// index of its matrix
+	struct NODE_TRANSFORM
+	{
+		glm::vec3 scale;
+		glm::vec3 rotation;
+		glm::vec3 position;
+		uint32_t index;
+	};
+
+	std::vector<SCENE_FILE_NODE> m_nodes;
+	// the model matrix of every node, and the transforms of the
+	// nodes whose matrices are composed when writing
+	std::vector<SCENE_FILE_TRANSFORM> m_transforms;
+	std::vector<NODE_TRANSFORM> m_nodeTransforms;
+	std::vector<SCENE_FILE_MESH> m_meshes;
+	std::vector<SCENE_FILE_MATERIAL> m_materials;
+	std::vector<SCENE_FILE_TEXTURE> m_textures;
+	std::vector<uint32_t> m_occluders;
+	// the string pool and the offset of each string in it
+	std::vector<char> m_strings;
+	std::unordered_map<std::string, uint32_t> m_stringOffsets;
+
+	// add a string to the pool once and get its offset
+	uint32_t AddString(const std::string& text);
+	// add a node record for the next model matrix
+	int AddNodeRecord(
+		int mesh,
+		int texture,
+		int material,
+		const glm::vec4& color,
+		const glm::vec2& uvScale,
+		int flags);
+};
+
+// convert a text scene description into a cooked scene file
+bool CookSceneFile(const char* textFilename, const char* sceneFilename);
+// get the cooked scene file for the passed in scene - a text
+// description or a glTF file is cooked into a .scene file next
+// to it when it has changed since it was last cooked
+bool CookSceneIfChanged(const std::string& filename, std::string& sceneFilename);
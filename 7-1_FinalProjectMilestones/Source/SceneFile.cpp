@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// cooked binary scene, memory mapped and used in place
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+// declaration of global variables
+namespace
+{
+	// size of one record of each array, for checking the
+	// array sizes in the header
+	const size_t g_RecordSizes[SCENE_SECTION_COUNT] =
+	{
+		sizeof(SCENE_FILE_NODE),
+		sizeof(SCENE_FILE_TRANSFORM),
+		sizeof(SCENE_FILE_MESH),
+		sizeof(SCENE_FILE_MATERIAL),
+		sizeof(SCENE_FILE_TEXTURE),
+		sizeof(uint32_t),
+		sizeof(char)
+	};
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a scene file read-only
+ *  into memory.  The operating system only reads the pages
+ *  of the file that are actually touched, so opening a file
+ *  takes the same short time whatever its size.
+ ***********************************************************/
+bool SceneFile::Open(const char* filename)
+{
+	Close();
+
+	if ((m_file.Open(filename) == false) || (m_file.GetSize() < sizeof(SCENE_FILE_HEADER)))
+	{
+		Close();
+		return(false);
+	}
+
+	if (ValidateHeader() == false)
+	{
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the current file.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	m_file.Close();
+}
+
+/***********************************************************
+ *  ValidateHeader()
+ *
+ *  This method is used for checking the header of the
+ *  mapped file.  Only the header is read - the records are
+ *  not checked one by one, so the indices they hold are
+ *  checked where they are used.
+ ***********************************************************/
+bool SceneFile::ValidateHeader() const
+{
+	const unsigned char* pData = m_file.GetData();
+	size_t size = m_file.GetSize();
+	const SCENE_FILE_HEADER* pHeader = (const SCENE_FILE_HEADER*)pData;
+
+	if ((pHeader->magic != SCENE_FILE_MAGIC) ||
+		(pHeader->version != SCENE_FILE_VERSION) ||
+		(pHeader->fileSize != size))
+	{
+		return(false);
+	}
+
+	for (int i = 0; i < SCENE_SECTION_COUNT; i++)
+	{
+		const SCENE_FILE_SECTION& section = pHeader->sections[i];
+		if ((section.offset % SCENE_FILE_ALIGNMENT) != 0)
+		{
+			return(false);
+		}
+		if ((section.offset > size) ||
+			(section.count > (size - section.offset) / g_RecordSizes[i]) ||
+			(section.count > 0x7FFFFFFF))
+		{
+			return(false);
+		}
+	}
+
+	// every string must end inside the pool
+	const SCENE_FILE_SECTION& strings = pHeader->sections[SCENE_SECTION_STRINGS];
+	if ((strings.count == 0) || (pData[strings.offset + strings.count - 1] != '\0'))
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetSection()
+ *
+ *  This method is used for getting the start of one of the
+ *  arrays in the mapping.
+ ***********************************************************/
+const void* SceneFile::GetSection(SceneFileSection section) const
+{
+	if (m_file.IsOpen() == false)
+	{
+		return(NULL);
+	}
+
+	const SCENE_FILE_HEADER* pHeader = (const SCENE_FILE_HEADER*)m_file.GetData();
+	return(m_file.GetData() + pHeader->sections[section].offset);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of records in
+ *  one of the arrays.
+ ***********************************************************/
+int SceneFile::GetCount(SceneFileSection section) const
+{
+	if (m_file.IsOpen() == false)
+	{
+		return(0);
+	}
+
+	const SCENE_FILE_HEADER* pHeader = (const SCENE_FILE_HEADER*)m_file.GetData();
+	return((int)pHeader->sections[section].count);
+}
+
+/***********************************************************
+ *  GetNodes()
+ *
+ *  This method is used for getting the array of nodes.
+ ***********************************************************/
+const SCENE_FILE_NODE* SceneFile::GetNodes() const
+{
+	return((const SCENE_FILE_NODE*)GetSection(SCENE_SECTION_NODES));
+}
+
+/***********************************************************
+ *  GetTransforms()
+ *
+ *  This method is used for getting the array of model
+ *  matrices.
+ ***********************************************************/
+const SCENE_FILE_TRANSFORM* SceneFile::GetTransforms() const
+{
+	return((const SCENE_FILE_TRANSFORM*)GetSection(SCENE_SECTION_TRANSFORMS));
+}
+
+/***********************************************************
+ *  GetMeshes()
+ *
+ *  This method is used for getting the array of mesh
+ *  references.
+ ***********************************************************/
+const SCENE_FILE_MESH* SceneFile::GetMeshes() const
+{
+	return((const SCENE_FILE_MESH*)GetSection(SCENE_SECTION_MESHES));
+}
+
+/***********************************************************
+ *  GetMaterials()
+ *
+ *  This method is used for getting the material table.
+ ***********************************************************/
+const SCENE_FILE_MATERIAL* SceneFile::GetMaterials() const
+{
+	return((const SCENE_FILE_MATERIAL*)GetSection(SCENE_SECTION_MATERIALS));
+}
+
+/***********************************************************
+ *  GetTextures()
+ *
+ *  This method is used for getting the texture table.
+ ***********************************************************/
+const SCENE_FILE_TEXTURE* SceneFile::GetTextures() const
+{
+	return((const SCENE_FILE_TEXTURE*)GetSection(SCENE_SECTION_TEXTURES));
+}
+
+/***********************************************************
+ *  GetOccluders()
+ *
+ *  This method is used for getting the node indices of the
+ *  occluders.
+ ***********************************************************/
+const uint32_t* SceneFile::GetOccluders() const
+{
+	return((const uint32_t*)GetSection(SCENE_SECTION_OCCLUDERS));
+}
+
+/***********************************************************
+ *  GetString()
+ *
+ *  This method is used for getting a string of the pool by
+ *  its offset.
+ ***********************************************************/
+const char* SceneFile::GetString(uint32_t offset) const
+{
+	if ((m_file.IsOpen() == false) || ((int64_t)offset >= GetCount(SCENE_SECTION_STRINGS)))
+	{
+		return("");
+	}
+
+	return((const char*)GetSection(SCENE_SECTION_STRINGS) + offset);
+}
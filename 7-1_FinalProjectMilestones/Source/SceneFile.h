@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// cooked binary scene, memory mapped and used in place
+//
+//  A cooked scene file is a fixed header followed by flat arrays: the
+//  nodes, their model matrices, the mesh references, the material and
+//  texture tables, the node indices of the occluders and a pool of null
+//  terminated strings that the other arrays refer to by offset.  The
+//  header records the offset and element count of every array, each
+//  array starts on a 64 byte boundary, and all the records are plain
+//  data with fixed sizes, so once the file is mapped into memory the
+//  arrays are read directly from the mapping without any parsing.  The
+//  matrices are composed when the scene is cooked, not when it is
+//  loaded.  Scene files are written by SceneBuilder and are only read
+//  on the machine that cooked them, so they are in native byte order.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// "SCNE" as the first bytes of a scene file
+const uint32_t SCENE_FILE_MAGIC = 0x454E4353;
+// changed whenever the layout of the records changes
+const uint32_t SCENE_FILE_VERSION = 1;
+// alignment of every array in the file
+const uint32_t SCENE_FILE_ALIGNMENT = 64;
+// textures a scene can draw with - each one is bound to a
+// texture unit of its own when the scene is loaded
+const int SCENE_MAX_TEXTURES = 16;
+
+// arrays stored in a scene file
+enum SceneFileSection
+{
+	// SCENE_FILE_NODE records
+	SCENE_SECTION_NODES,
+	// SCENE_FILE_TRANSFORM records
+	SCENE_SECTION_TRANSFORMS,
+	// SCENE_FILE_MESH records
+	SCENE_SECTION_MESHES,
+	// SCENE_FILE_MATERIAL records
+	SCENE_SECTION_MATERIALS,
+	// SCENE_FILE_TEXTURE records
+	SCENE_SECTION_TEXTURES,
+	// uint32_t node indices of the CPU occluders
+	SCENE_SECTION_OCCLUDERS,
+	// characters of the null terminated strings
+	SCENE_SECTION_STRINGS,
+	SCENE_SECTION_COUNT
+};
+
+// flags of a scene node
+enum SceneNodeFlags
+{
+	// never skipped by the occlusion culling
+	SCENE_NODE_NOT_CULLABLE = 1,
+	// drawn into the depth buffer of the CPU occlusion culling
+	SCENE_NODE_OCCLUDER = 2
+};
+
+// position and size of one array in the file
+struct SCENE_FILE_SECTION
+{
+	uint64_t offset;
+	uint64_t count;
+};
+
+// start of every scene file
+struct SCENE_FILE_HEADER
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t fileSize;
+	SCENE_FILE_SECTION sections[SCENE_SECTION_COUNT];
+};
+
+// one drawn object
+struct SCENE_FILE_NODE
+{
+	// index of the model matrix
+	uint32_t transform;
+	// index of the mesh reference
+	uint16_t mesh;
+	// SceneNodeFlags
+	uint16_t flags;
+	// texture and material table indices, or -1 for none
+	int16_t texture;
+	int16_t material;
+	float color[4];
+	float uvScale[2];
+};
+
+// column-major model matrix of a node
+struct SCENE_FILE_TRANSFORM
+{
+	float matrix[16];
+};
+
+// a mesh drawn by the nodes, by name
+struct SCENE_FILE_MESH
+{
+	uint32_t name;
+};
+
+// lighting values of a material and its tag
+struct SCENE_FILE_MATERIAL
+{
+	float ambientColor[3];
+	float ambientStrength;
+	float diffuseColor[3];
+	float specularColor[3];
+	float shininess;
+	uint32_t tag;
+};
+
+// image file of a texture and its tag
+struct SCENE_FILE_TEXTURE
+{
+	uint32_t path;
+	uint32_t tag;
+};
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class contains the code for mapping a cooked scene
+ *  file into memory and reading its arrays in place.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	// map the passed in file and check its header - false if
+	// it is missing, of another version or damaged
+	bool Open(const char* filename);
+	// unmap the current file
+	void Close();
+	bool IsOpen() const { return(m_file.IsOpen()); }
+
+	// the arrays of the file, read from the mapping
+	const SCENE_FILE_NODE* GetNodes() const;
+	const SCENE_FILE_TRANSFORM* GetTransforms() const;
+	const SCENE_FILE_MESH* GetMeshes() const;
+	const SCENE_FILE_MATERIAL* GetMaterials() const;
+	const SCENE_FILE_TEXTURE* GetTextures() const;
+	const uint32_t* GetOccluders() const;
+	// number of records in one of the arrays
+	int GetCount(SceneFileSection section) const;
+	// a string of the pool by offset - an empty string if the
+	// offset is outside of the pool
+	const char* GetString(uint32_t offset) const;
+
+private:
+	// the mapping of the whole file
+	MappedFile m_file;
+
+	// check that the header describes arrays inside the file
+	bool ValidateHeader() const;
+	// start of one of the arrays
+	const void* GetSection(SceneFileSection section) const;
+};
@@ -8,6 +8,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "ObjImporter.h"
+#include "GltfImporter.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,14 +18,94 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+
 // declaration of global variables
 namespace
 {
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
 	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_PackedVerticesName = "bPackedVertices";
+	const char* g_GpuDrivenName = "bGpuDriven";
+
+	// extension of the mesh names that are imported from files
+	// instead of naming a shape mesh
+	const char* g_ObjExtension = ".obj";
+
+	// name of the uniform block of the per-draw values
+	const char* g_DrawDataBlockName = "DrawData";
+
+	// size of the depth buffer of the CPU occlusion rasterizer,
+	// with the same aspect ratio as the window
+	const int g_OcclusionBufferWidth = 320;
+	const int g_OcclusionBufferHeight = 256;
+
+	// radius of the bounding sphere on the screen, as a fraction
+	// of half the screen height, below which each detail level
+	// switches to the next coarser one
+	const float g_LODThresholds[ShapeMeshes::LOD_COUNT - 1] = { 0.25f, 0.08f, 0.025f };
+	// how far past a threshold the size must move before the
+	// level changes, so objects near a threshold do not pop
+	const float g_LODHysteresis = 0.15f;
+
+	// fewest scene objects processed together by one job
+	const int g_SceneObjectGrainSize = 32;
+
+	// fewest scene nodes recorded together by one job
+	const int g_SceneNodeGrainSize = 64;
+
+	// most index ranges of the visible meshlets of one draw -
+	// past this the last range is stretched over the rest
+	const int g_MaxMeshletRanges = 1024;
+
+	// names of the shape meshes in scene files, in the order
+	// of ShapeMeshes::ShapeType
+	const char* g_ShapeNames[] =
+	{
+		"box",
+		"cone",
+		"cylinder",
+		"plane",
+		"prism",
+		"pyramid3",
+		"pyramid4",
+		"sphere",
+		"tapered_cylinder",
+		"torus"
+	};
+
+	/***********************************************************
+	 *  IsObjMeshName()
+	 *
+	 *  This function is used for checking whether a mesh name
+	 *  of the scene file is the name of an OBJ file.
+	 ***********************************************************/
+	bool IsObjMeshName(const char* meshName)
+	{
+		size_t length = strlen(meshName);
+		size_t extensionLength = strlen(g_ObjExtension);
+		return((length > extensionLength) &&
+			(strcmp(meshName + length - extensionLength, g_ObjExtension) == 0));
+	}
+
+	/***********************************************************
+	 *  IsImportedMeshName()
+	 *
+	 *  This function is used for checking whether a mesh name
+	 *  of the scene file names an OBJ file or a primitive of a
+	 *  glTF file, which LoadSceneMeshes() imports.
+	 ***********************************************************/
+	bool IsImportedMeshName(const char* meshName)
+	{
+		std::string filename;
+		int mesh = 0;
+		int primitive = 0;
+		return((IsObjMeshName(meshName) == true) ||
+			(ParseGltfMeshName(meshName, filename, mesh, primitive) == true));
+	}
 }
 
 /***********************************************************
@@ -31,16 +113,45 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager* pShaderManager)
+SceneManager::SceneManager(ShaderManager* pShaderManager, RENDER_SETTINGS* pRenderSettings)
 {
 	m_pShaderManager = pShaderManager;
+	m_pRenderSettings = pRenderSettings;
 	m_basicMeshes = new ShapeMeshes();
+	m_pJobSystem = new JobSystem((NULL != pRenderSettings) ? pRenderSettings->jobThreadCount : 0);
+	m_pCommandQueue = new CommandQueue(m_pJobSystem);
+	m_pUniformRing = new UniformRingBuffer();
+	m_materialBuffer = 0;
+	m_pOcclusionCuller = new OcclusionCuller(pShaderManager);
+	m_pDepthRasterizer = new DepthRasterizer(
+		g_OcclusionBufferWidth,
+		g_OcclusionBufferHeight,
+		m_pJobSystem);
+	m_occlusionMode = OCCLUSION_GPU_QUERIES;
+	m_pGpuCuller = new GpuCuller(pShaderManager);
+	m_gpuMesh = ShapeMeshes::INVALID_MESH;
+	m_pTransparencyPass = new TransparencyPass(pShaderManager);
+	m_transparencyMode = TRANSPARENCY_SORTED;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewProjection = glm::mat4(1.0f);
+	m_drawnVertexCount = 0;
+	m_drawCallCount = 0;
+	m_vertexArrayBindCount = 0;
+	for (int i = 0; i < PRIMITIVE_QUERY_COUNT; i++)
+	{
+		m_primitiveQueries[i] = 0;
+		m_primitiveQueryPending[i] = false;
+	}
+	m_primitiveQueryIndex = 0;
+	m_primitiveCount = 0;
+	m_bCountPrimitives = false;
 
 	// Initialize texture-related variables
 	m_loadedTextures = 0;
 
 	// Initialize texture array
-	for (int i = 0; i < 16; i++)
+	for (int i = 0; i < SCENE_MAX_TEXTURES; i++)
 	{
 		m_textureIDs[i].tag = "/0";
 		m_textureIDs[i].ID = -1;
@@ -55,6 +166,30 @@ SceneManager::SceneManager(ShaderManager* pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
+	m_pRenderSettings = NULL;
+	delete m_pOcclusionCuller;
+	m_pOcclusionCuller = NULL;
+	delete m_pDepthRasterizer;
+	m_pDepthRasterizer = NULL;
+	delete m_pGpuCuller;
+	m_pGpuCuller = NULL;
+	delete m_pTransparencyPass;
+	m_pTransparencyPass = NULL;
+	delete m_pCommandQueue;
+	m_pCommandQueue = NULL;
+	delete m_pUniformRing;
+	m_pUniformRing = NULL;
+	if (m_materialBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_materialBuffer);
+		m_materialBuffer = 0;
+	}
+	if (m_primitiveQueries[0] != 0)
+	{
+		glDeleteQueries(PRIMITIVE_QUERY_COUNT, m_primitiveQueries);
+	}
+	delete m_pJobSystem;
+	m_pJobSystem = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
 }
@@ -137,7 +272,8 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
  *  BindGLTextures()
  *
  *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  OpenGL texture memory slots.  There are up to
+ *  SCENE_MAX_TEXTURES slots.
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
@@ -251,127 +387,1024 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  RecordDraw()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for recording a draw into the passed
+ *  in command buffer.  With the CPU rasterizer, nothing is
+ *  recorded when the bounding box of the shape is hidden.
+ *  With GPU queries, the replayed draw is skipped by the GPU
+ *  if the bounding box was hidden at the end of the previous
+ *  frame.  The sort key groups the opaque draws by shader
+ *  program, texture, material and mesh, so the replay
+ *  changes as few shader values as possible, and keeps the
+ *  transparent draws last, either from back to front or,
+ *  with the weighted blended transparency, grouped the same
+ *  way as the opaque draws.
  ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
+void SceneManager::RecordDraw(
+	CommandBuffer& buffer,
+	int objectIndex,
+	const DRAW_DATA& drawData,
+	ShapeMeshes::MeshHandle mesh,
+	bool bCullable)
 {
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
+	DRAW_SHAPE_DATA drawShape;
+	drawShape.mesh = mesh;
+	drawShape.lod = 0;
+	drawShape.objectIndex = objectIndex;
+	drawShape.bOcclusionQuery = bCullable;
+	drawShape.bTransparent = (drawData.textureSlot < 0) && (drawData.color.a < 1.0f);
+	m_basicMeshes->GetMeshBounds(mesh, drawShape.boundsMin, drawShape.boundsMax);
+
+	// the objects were already processed at the start of the
+	// frame - only an object that is new or has moved since
+	// the previous frame is processed again here
+	if ((bCullable == true) && (objectIndex >= 0) && (objectIndex < (int)m_sceneObjects.size()))
+	{
+		SCENE_OBJECT& object = m_sceneObjects[objectIndex];
+		if ((object.modelMatrix != drawData.modelMatrix) ||
+			(object.boundsMin != drawShape.boundsMin) ||
+			(object.boundsMax != drawShape.boundsMax))
+		{
+			object.modelMatrix = drawData.modelMatrix;
+			object.boundsMin = drawShape.boundsMin;
+			object.boundsMax = drawShape.boundsMax;
+			ProcessSceneObject(object);
+		}
 
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
+		if (object.bVisible == false)
+		{
+			return;
+		}
+		drawShape.lod = object.lod;
+	}
 
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+	// a dense mesh only draws its meshlets that are inside the
+	// frustum and face the camera - translucent and mirrored
+	// objects keep the meshlets facing away - out of the ones
+	// of the detail level that is drawn
+	MESHLET_RANGE ranges[g_MaxMeshletRanges];
+	int rangeCount = -1;
+	const MESHLETS* pMeshlets = m_basicMeshes->GetMeshlets(mesh, drawShape.lod);
+	if ((NULL != pMeshlets) && (NULL != m_pRenderSettings) && (m_pRenderSettings->bMeshletCulling == true))
+	{
+		glm::mat4 modelViewProjection = m_viewProjection * drawData.modelMatrix;
+		glm::mat4 inverseModelView = glm::inverse(m_viewMatrix * drawData.modelMatrix);
+		glm::vec4 camera = inverseModelView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		if (m_projectionMatrix[2][3] == 0.0f)
+		{
+			camera = inverseModelView * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+		}
+		bool bConeTest = (drawShape.bTransparent == false) &&
+			(glm::determinant(glm::mat3(drawData.modelMatrix)) > 0.0f);
 
-	if (NULL != m_pShaderManager)
+		rangeCount = CullMeshlets(*pMeshlets, &modelViewProjection[0][0],
+			bConeTest ? &camera[0] : NULL, ranges, g_MaxMeshletRanges);
+		if (rangeCount == 0)
+		{
+			return;
+		}
+	}
+
+	unsigned int programID = (NULL != m_pShaderManager) ? m_pShaderManager->m_programID : 0;
+	uint64_t sortKey = GetStateSortKey(programID, drawData.textureSlot,
+		drawData.materialIndex, mesh, drawShape.lod, objectIndex);
+	if (drawShape.bTransparent == true)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		// the translucent draws come after all the opaque ones -
+		// sorted by state like them when the weighted blending
+		// makes their order irrelevant, else from back to front
+		if (m_transparencyMode == TRANSPARENCY_WEIGHTED)
+		{
+			sortKey |= SORT_KEY_TRANSLUCENT;
+		}
+		else
+		{
+			glm::vec3 center = (drawShape.boundsMin + drawShape.boundsMax) * 0.5f;
+			float distance = -(m_viewMatrix * drawData.modelMatrix * glm::vec4(center, 1.0f)).z;
+			sortKey = GetBackToFrontSortKey(distance, objectIndex);
+		}
 	}
+
+	buffer.BeginPacket(sortKey);
+	buffer.Write(COMMAND_BIND_PROGRAM, programID);
+	buffer.Write(COMMAND_SET_DRAW_DATA, drawData);
+	if (rangeCount > 0)
+	{
+		buffer.WriteArray(COMMAND_SET_INDEX_RANGES, ranges, (uint32_t)rangeCount);
+	}
+	buffer.Write(COMMAND_DRAW_SHAPE, drawShape);
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  ReserveSceneObjects()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for adding records for the objects
+ *  that have not been drawn before.  The records are added
+ *  before any thread records the draws of the objects.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+void SceneManager::ReserveSceneObjects(int count)
 {
-	// variables for this method
-	glm::vec4 currentColor;
+	if ((int)m_sceneObjects.size() < count)
+	{
+		SCENE_OBJECT newObject;
+		newObject.modelMatrix = glm::mat4(0.0f);
+		newObject.boundsMin = glm::vec3(0.0f);
+		newObject.boundsMax = glm::vec3(0.0f);
+		newObject.bVisible = true;
+		newObject.lod = 0;
+		m_sceneObjects.resize(count, newObject);
+	}
+}
 
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
+/***********************************************************
+ *  ProcessSceneObjects()
+ *
+ *  This method is used for testing the visibility of every
+ *  object drawn in the previous frame and choosing its
+ *  detail level, split into ranges on the job system.
+ ***********************************************************/
+void SceneManager::ProcessSceneObjects()
+{
+	// with the GPU culling, only the nodes recorded on the CPU
+	// are drawn from their records
+	if (m_pGpuCuller->IsEnabled() == true)
+	{
+		m_pJobSystem->ParallelFor((int)m_cpuNodes.size(), g_SceneObjectGrainSize,
+			[this](int first, int last) {
+				for (int i = first; i < last; i++)
+				{
+					if (m_cpuNodes[i] < (int)m_sceneObjects.size())
+					{
+						ProcessSceneObject(m_sceneObjects[m_cpuNodes[i]]);
+					}
+				}
+			});
+		return;
+	}
 
-	if (NULL != m_pShaderManager)
+	m_pJobSystem->ParallelFor((int)m_sceneObjects.size(), g_SceneObjectGrainSize,
+		[this](int first, int last) {
+			for (int i = first; i < last; i++)
+			{
+				ProcessSceneObject(m_sceneObjects[i]);
+			}
+		});
+}
+
+/***********************************************************
+ *  ProcessSceneObject()
+ *
+ *  This method is used for testing the passed in object
+ *  against the CPU depth buffer and choosing its detail
+ *  level.  It only reads the shared state of the frame, so
+ *  many objects can be processed at the same time.
+ ***********************************************************/
+void SceneManager::ProcessSceneObject(
+	SCENE_OBJECT& object) const
+{
+	object.bVisible = true;
+	if (m_occlusionMode == OCCLUSION_CPU_RASTER)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		object.bVisible = m_pDepthRasterizer->IsVisible(
+			object.modelMatrix, object.boundsMin, object.boundsMax);
+	}
+
+	if (object.bVisible == true)
+	{
+		object.lod = SelectLevelOfDetail(object);
 	}
 }
 
 /***********************************************************
- *  SetShaderTexture()
+ *  SelectLevelOfDetail()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for choosing the detail level of the
+ *  passed in object from the radius of its bounding sphere
+ *  on the screen.  An object only moves to a finer or
+ *  coarser level once its size is clearly past the level
+ *  threshold, so it does not flicker between two levels.
  ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
+int SceneManager::SelectLevelOfDetail(
+	const SCENE_OBJECT& object) const
 {
-	if (NULL != m_pShaderManager)
+	if ((NULL != m_pRenderSettings) && (m_pRenderSettings->bLevelOfDetail == false))
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		return(0);
+	}
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+	// bounding sphere of the bounding box in world space
+	glm::vec3 extents = (object.boundsMax - object.boundsMin) * 0.5f;
+	glm::vec3 worldExtents =
+		glm::abs(glm::vec3(object.modelMatrix[0])) * extents.x +
+		glm::abs(glm::vec3(object.modelMatrix[1])) * extents.y +
+		glm::abs(glm::vec3(object.modelMatrix[2])) * extents.z;
+	float radius = glm::length(worldExtents);
+	glm::vec4 viewCenter = m_viewMatrix * object.modelMatrix *
+		glm::vec4((object.boundsMin + object.boundsMax) * 0.5f, 1.0f);
+
+	// radius on the screen as a fraction of half its height
+	float screenRadius = radius * m_projectionMatrix[1][1];
+	if (m_projectionMatrix[2][3] != 0.0f)
+	{
+		float distance = -viewCenter.z;
+		screenRadius = (distance > radius) ? (screenRadius / distance) : 1.0f;
 	}
+
+	int lod = object.lod;
+	while ((lod > 0) && (screenRadius > g_LODThresholds[lod - 1] * (1.0f + g_LODHysteresis)))
+	{
+		lod--;
+	}
+	while ((lod < ShapeMeshes::LOD_COUNT - 1) && (screenRadius < g_LODThresholds[lod] * (1.0f - g_LODHysteresis)))
+	{
+		lod++;
+	}
+
+	return(lod);
 }
 
 /***********************************************************
- *  SetTextureUVScale()
+ *  AddOccluder()
  *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  This method is used for adding an object to the
+ *  occluders of the CPU rasterizer.  The occluders are drawn
+ *  into its depth buffer at the start of the next frame.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::AddOccluder(
+	ShapeMeshes::MeshHandle mesh,
+	const glm::mat4& modelMatrix)
 {
-	if (NULL != m_pShaderManager)
+	glm::vec3 boxMin;
+	glm::vec3 boxMax;
+
+	if ((m_occlusionMode == OCCLUSION_CPU_RASTER) &&
+		(m_basicMeshes->GetOccluderBounds(mesh, boxMin, boxMax) == true))
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_pDepthRasterizer->AddOccluder(modelMatrix, boxMin, boxMax);
 	}
 }
 
 /***********************************************************
- *  SetShaderMaterial()
+ *  LoadScene()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for mapping the cooked scene file.
+ *  A text scene description is cooked first, when it has
+ *  changed since it was last cooked, into a file with the
+ *  same name and the .scene extension.  The mesh names of
+ *  the file are matched to the shape meshes here, once -
+ *  the names of OBJ files and glTF primitives are imported
+ *  by LoadSceneMeshes().
  ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+bool SceneManager::LoadScene(const std::string& filename)
 {
-	if (m_objectMaterials.size() > 0)
+	std::string sceneFilename;
+	if (CookSceneIfChanged(filename, sceneFilename) == false)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		return(false);
+	}
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	if (m_sceneFile.Open(sceneFilename.c_str()) == false)
+	{
+		std::cerr << "Could not open scene file: " << sceneFilename << std::endl;
+		return(false);
+	}
+	double openTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	int shapeCount = (int)(sizeof(g_ShapeNames) / sizeof(g_ShapeNames[0]));
+	m_meshHandles.assign(m_sceneFile.GetCount(SCENE_SECTION_MESHES), ShapeMeshes::INVALID_MESH);
+	for (int i = 0; i < (int)m_meshHandles.size(); i++)
+	{
+		const char* meshName = m_sceneFile.GetString(m_sceneFile.GetMeshes()[i].name);
+		for (int shape = 0; shape < shapeCount; shape++)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			// the generated shapes have the handles of their types
+			if (strcmp(meshName, g_ShapeNames[shape]) == 0)
+			{
+				m_meshHandles[i] = (ShapeMeshes::MeshHandle)shape;
+			}
+		}
+		if ((m_meshHandles[i] == ShapeMeshes::INVALID_MESH) && (IsImportedMeshName(meshName) == false))
+		{
+			std::cout << "Scene mesh not found, its nodes are not drawn: " << meshName << std::endl;
 		}
 	}
+
+	std::cout << "INFO: Mapped " << m_sceneFile.GetCount(SCENE_SECTION_NODES) << " scene nodes from "
+		<< sceneFilename << " in " << openTime << " ms" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  LoadSceneShapes()
+ *
+ *  This method is used for generating the shape meshes that
+ *  the scene file names, all at once on the job system
+ *  threads, and storing them together with one upload.  The
+ *  shapes the scene does not name are never generated.
+ ***********************************************************/
+void SceneManager::LoadSceneShapes()
+{
+	int shapeCount = (int)(sizeof(g_ShapeNames) / sizeof(g_ShapeNames[0]));
+	std::vector<bool> bUsedShapes(shapeCount, false);
+	for (int i = 0; i < (int)m_meshHandles.size(); i++)
+	{
+		if (m_meshHandles[i] < (ShapeMeshes::MeshHandle)shapeCount)
+		{
+			bUsedShapes[m_meshHandles[i]] = true;
+		}
+	}
+
+	std::vector<ShapeMeshes::SHAPE_DATA> shapes;
+	for (int shape = 0; shape < shapeCount; shape++)
+	{
+		if (bUsedShapes[shape] == true)
+		{
+			shapes.push_back(ShapeMeshes::SHAPE_DATA());
+			shapes.back().shape = (ShapeMeshes::ShapeType)shape;
+		}
+	}
+
+	// every shape is its own job, as each takes well over the
+	// cost of queueing it
+	bool bPackedVertices = m_basicMeshes->IsPackedVertices();
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	m_pJobSystem->ParallelFor((int)shapes.size(), 1, [&shapes, bPackedVertices](int first, int last) {
+		for (int i = first; i < last; i++)
+		{
+			ShapeMeshes::BuildShapeData(shapes[i].shape, bPackedVertices, shapes[i]);
+		}
+	});
+	double buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	startTime = std::chrono::steady_clock::now();
+	m_basicMeshes->StoreShapeData(shapes.data(), (int)shapes.size());
+	double storeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	for (int i = 0; i < (int)shapes.size(); i++)
+	{
+		std::cout << "INFO: Generated the " << g_ShapeNames[shapes[i].shape] << " mesh in "
+			<< shapes[i].buildTime << " ms" << std::endl;
+	}
+	std::cout << "INFO: Generated " << shapes.size() << " of " << shapeCount << " shape meshes in "
+		<< buildTime << " ms on " << m_pJobSystem->GetThreadCount() << " threads, and stored them in "
+		<< storeTime << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  LoadSceneMeshes()
+ *
+ *  This method is used for importing the meshes of the
+ *  scene file that name OBJ files or glTF primitives,
+ *  relative to the working directory like the textures, and
+ *  storing them with the shape meshes.  Each glTF file is
+ *  opened once for all its primitives.  A mesh that can not
+ *  be imported is left out, so its nodes are not drawn.
+ ***********************************************************/
+void SceneManager::LoadSceneMeshes()
+{
+	std::map<std::string, GltfFile*> gltfFiles;
+
+	for (int i = 0; i < (int)m_meshHandles.size(); i++)
+	{
+		const char* meshName = m_sceneFile.GetString(m_sceneFile.GetMeshes()[i].name);
+		std::string gltfFilename;
+		int gltfMesh = 0;
+		int gltfPrimitive = 0;
+		if (m_meshHandles[i] != ShapeMeshes::INVALID_MESH)
+		{
+			continue;
+		}
+
+		if (ParseGltfMeshName(meshName, gltfFilename, gltfMesh, gltfPrimitive) == true)
+		{
+			GltfFile*& pFile = gltfFiles[gltfFilename];
+			if (NULL == pFile)
+			{
+				pFile = new GltfFile();
+				pFile->Open(gltfFilename.c_str());
+			}
+			ShapeMeshes::MeshHandle mesh;
+			if (pFile->LoadPrimitive(gltfMesh, gltfPrimitive, m_basicMeshes, mesh) == false)
+			{
+				std::cout << "Scene mesh not imported, its nodes are not drawn: " << meshName << std::endl;
+				continue;
+			}
+			m_meshHandles[i] = mesh;
+			continue;
+		}
+		if (IsObjMeshName(meshName) == false)
+		{
+			continue;
+		}
+
+		OBJ_MESH_LEVELS levels;
+		OBJ_IMPORT_STATS stats;
+		if (ImportObjMesh(meshName, m_pJobSystem, levels, &stats) == false)
+		{
+			std::cout << "Scene mesh not imported, its nodes are not drawn: " << meshName << std::endl;
+			continue;
+		}
+		m_meshHandles[i] = m_basicMeshes->LoadImportedMesh(levels.levels, levels.levelCount);
+
+		std::cout << "INFO: Imported " << stats.triangleCount << " triangles in " << stats.levelCount
+			<< " detail levels from " << meshName << (stats.bFromCache ? " through its cache" : "") << " in "
+			<< (stats.hashTime + stats.parseTime + stats.weldTime + stats.simplifyTime + stats.optimizeTime + stats.cacheTime)
+			<< " ms" << std::endl;
+	}
+
+	for (std::map<std::string, GltfFile*>::iterator file = gltfFiles.begin(); file != gltfFiles.end(); ++file)
+	{
+		delete file->second;
+	}
+}
+
+/***********************************************************
+ *  GetNodeMesh()
+ *
+ *  This method is used for getting the mesh handle and
+ *  model matrix of a scene node - false if the node refers
+ *  to a missing mesh or transform.
+ ***********************************************************/
+bool SceneManager::GetNodeMesh(
+	const SCENE_FILE_NODE& node,
+	ShapeMeshes::MeshHandle& mesh,
+	glm::mat4& modelMatrix) const
+{
+	if ((node.mesh >= m_meshHandles.size()) || (m_meshHandles[node.mesh] == ShapeMeshes::INVALID_MESH) ||
+		(node.transform >= (uint32_t)m_sceneFile.GetCount(SCENE_SECTION_TRANSFORMS)))
+	{
+		return(false);
+	}
+
+	mesh = m_meshHandles[node.mesh];
+	memcpy(&modelMatrix, m_sceneFile.GetTransforms()[node.transform].matrix, sizeof(modelMatrix));
+	return(true);
+}
+
+/***********************************************************
+ *  GetNodeDrawData()
+ *
+ *  This method is used for getting the mesh handle and the
+ *  shader values of a scene node, with its texture slot and
+ *  material checked - false if the node is not drawn.
+ ***********************************************************/
+bool SceneManager::GetNodeDrawData(
+	const SCENE_FILE_NODE& node,
+	ShapeMeshes::MeshHandle& mesh,
+	DRAW_DATA& drawData) const
+{
+	if (GetNodeMesh(node, mesh, drawData.modelMatrix) == false)
+	{
+		return(false);
+	}
+
+	drawData.color = glm::vec4(node.color[0], node.color[1], node.color[2], node.color[3]);
+	drawData.uvScale = glm::vec2(node.uvScale[0], node.uvScale[1]);
+	drawData.textureSlot = -1;
+	if ((node.texture >= 0) && (node.texture < (int)m_textureSlots.size()))
+	{
+		drawData.textureSlot = m_textureSlots[node.texture];
+	}
+	drawData.materialIndex = -1;
+	if ((node.material >= 0) && (node.material < (int)m_objectMaterials.size()))
+	{
+		drawData.materialIndex = node.material;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  RecordNode()
+ *
+ *  This method is used for recording the draw of a scene
+ *  node, read in place from the mapped scene file - called
+ *  on any of the job system threads.
+ ***********************************************************/
+void SceneManager::RecordNode(
+	CommandBuffer& buffer,
+	int nodeIndex)
+{
+	const SCENE_FILE_NODE& node = m_sceneFile.GetNodes()[nodeIndex];
+	ShapeMeshes::MeshHandle mesh;
+	DRAW_DATA drawData;
+
+	if (GetNodeDrawData(node, mesh, drawData) == false)
+	{
+		return;
+	}
+
+	RecordDraw(buffer, nodeIndex, drawData, mesh, (node.flags & SCENE_NODE_NOT_CULLABLE) == 0);
+}
+
+/***********************************************************
+ *  LoadGpuObjects()
+ *
+ *  This method is used for uploading the scene nodes the
+ *  GPU culling draws, once, grouped into one batch per
+ *  texture slot.  Those are the opaque cullable nodes of the
+ *  generated shapes with indices, which all lie in one
+ *  buffer.  The other nodes - the imported meshes, the
+ *  translucent objects and the shapes drawn as strips - are
+ *  kept in a list, and only they are recorded on the CPU
+ *  while the GPU culls, so the CPU work of a frame does not
+ *  grow with the nodes the GPU draws.  The transforms of
+ *  the scene file never change, so the objects are not
+ *  uploaded again.
+ ***********************************************************/
+void SceneManager::LoadGpuObjects()
+{
+	int nodeCount = m_sceneFile.GetCount(SCENE_SECTION_NODES);
+	m_cpuNodes.clear();
+	m_gpuBatchSlots.clear();
+	m_gpuMesh = ShapeMeshes::INVALID_MESH;
+
+	std::vector<std::pair<int, GPU_OBJECT> > slotObjects;
+	std::vector<GPU_MESH_LEVEL> meshLevels(ShapeMeshes::SHAPE_COUNT * ShapeMeshes::LOD_COUNT);
+	GLuint meshBuffer = 0;
+	for (int i = 0; i < nodeCount; i++)
+	{
+		const SCENE_FILE_NODE& node = m_sceneFile.GetNodes()[i];
+		ShapeMeshes::MeshHandle mesh;
+		DRAW_DATA drawData;
+		ShapeMeshes::INDIRECT_MESH indirectMesh;
+		bool bGpuNode = (m_pGpuCuller->IsSupported() == true) &&
+			((node.flags & SCENE_NODE_NOT_CULLABLE) == 0) &&
+			(GetNodeDrawData(node, mesh, drawData) == true) &&
+			((drawData.textureSlot >= 0) || (drawData.color.a >= 1.0f)) &&
+			(m_basicMeshes->GetIndirectMesh(mesh, indirectMesh) == true) &&
+			((meshBuffer == 0) || (indirectMesh.buffer == meshBuffer));
+		if (bGpuNode == false)
+		{
+			m_cpuNodes.push_back(i);
+			continue;
+		}
+
+		meshBuffer = indirectMesh.buffer;
+		m_gpuMesh = mesh;
+		for (int lod = 0; lod < ShapeMeshes::LOD_COUNT; lod++)
+		{
+			GPU_MESH_LEVEL& level = meshLevels[mesh * ShapeMeshes::LOD_COUNT + lod];
+			level.indexCount = indirectMesh.indexCounts[lod];
+			level.firstIndex = indirectMesh.firstIndices[lod];
+			level.baseVertex = indirectMesh.baseVertices[lod];
+			level.padding = 0;
+		}
+
+		// the bounding box in world space, grown to hold the
+		// rotated box as in SelectLevelOfDetail()
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		m_basicMeshes->GetMeshBounds(mesh, boundsMin, boundsMax);
+		glm::vec3 extents = (boundsMax - boundsMin) * 0.5f;
+		const glm::mat4& model = drawData.modelMatrix;
+
+		GPU_OBJECT object;
+		object.model = model * m_basicMeshes->GetPositionDecode(mesh);
+		object.objectColor = drawData.color;
+		object.boundsCenter = model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f);
+		object.boundsExtents = glm::vec4(
+			glm::abs(glm::vec3(model[0])) * extents.x +
+			glm::abs(glm::vec3(model[1])) * extents.y +
+			glm::abs(glm::vec3(model[2])) * extents.z, 0.0f);
+		object.UVscale = drawData.uvScale;
+		object.bUseTexture = (drawData.textureSlot >= 0) ? 1 : 0;
+		object.materialIndex = std::max(drawData.materialIndex, 0);
+		object.batch = 0;
+		object.mesh = mesh;
+		object.lod = 0;
+		object.padding = 0;
+		slotObjects.push_back(std::make_pair(drawData.textureSlot, object));
+	}
+
+	// the texture is a plain uniform, so every texture slot is
+	// drawn as a batch of its own
+	std::stable_sort(slotObjects.begin(), slotObjects.end(),
+		[](const std::pair<int, GPU_OBJECT>& a, const std::pair<int, GPU_OBJECT>& b) {
+			return(a.first < b.first);
+		});
+	std::vector<GPU_OBJECT> objects(slotObjects.size());
+	std::vector<int> batchCounts;
+	for (size_t i = 0; i < slotObjects.size(); i++)
+	{
+		if ((i == 0) || (slotObjects[i].first != slotObjects[i - 1].first))
+		{
+			m_gpuBatchSlots.push_back(slotObjects[i].first);
+			batchCounts.push_back(0);
+		}
+		objects[i] = slotObjects[i].second;
+		objects[i].batch = (GLuint)(batchCounts.size() - 1);
+		batchCounts.back()++;
+	}
+
+	m_pGpuCuller->SetLevelThresholds(g_LODThresholds, ShapeMeshes::LOD_COUNT, g_LODHysteresis);
+	m_pGpuCuller->SetObjects(objects, meshLevels, batchCounts);
+	if (m_pGpuCuller->IsSupported() == true)
+	{
+		std::cout << "INFO: Loaded " << objects.size() << " of " << nodeCount
+			<< " scene nodes for the GPU driven culling, in " << batchCounts.size() << " batches" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  SetViewProjection()
+ *
+ *  This method is used for setting the view and projection
+ *  of the frame about to be rendered, for the CPU culling.
+ ***********************************************************/
+void SceneManager::SetViewProjection(
+	const glm::mat4& view,
+	const glm::mat4& projection)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewProjection = projection * view;
+	m_pOcclusionCuller->SetViewProjection(m_viewProjection);
+}
+
+/***********************************************************
+ *  SubmitGpuObjects()
+ *
+ *  This method is used for culling the nodes uploaded to the
+ *  GPU and drawing the visible ones, with one indirect
+ *  multi-draw per texture slot.  The vertex shader reads the
+ *  values of every object from the object buffer instead of
+ *  the DrawData block.  Which objects are drawn is never
+ *  known to the CPU, so every multi-draw counts as one draw.
+ ***********************************************************/
+void SceneManager::SubmitGpuObjects()
+{
+	if ((m_pGpuCuller->IsEnabled() == false) || (m_pGpuCuller->GetObjectCount() == 0))
+	{
+		return;
+	}
+
+	bool bLevelOfDetail = (NULL == m_pRenderSettings) || (m_pRenderSettings->bLevelOfDetail == true);
+	m_pGpuCuller->Cull(m_viewMatrix, m_projectionMatrix, bLevelOfDetail);
+
+	m_pShaderManager->setBoolValue(g_GpuDrivenName, true);
+	m_basicMeshes->BindIndirectMeshes(m_gpuMesh, m_pGpuCuller->GetObjectIndexBuffer());
+	m_pGpuCuller->BeginDraws();
+	for (int batch = 0; batch < m_pGpuCuller->GetBatchCount(); batch++)
+	{
+		if (m_gpuBatchSlots[batch] >= 0)
+		{
+			m_pShaderManager->setSampler2DValue(g_TextureValueName, m_gpuBatchSlots[batch]);
+		}
+		m_pGpuCuller->DrawBatch(batch);
+		m_drawCallCount++;
+	}
+	m_pShaderManager->setBoolValue(g_GpuDrivenName, false);
+}
+
+/***********************************************************
+ *  SubmitScene()
+ *
+ *  This method is used for sorting the draws recorded by
+ *  all the threads into one order and replaying them with
+ *  OpenGL.  Only this method and the setup methods call
+ *  OpenGL, so it must run on the thread that owns the
+ *  context.
+ ***********************************************************/
+void SceneManager::SubmitScene()
+{
+	DRAW_DATA previousData;
+	bool bHasPreviousData = false;
+	bool bDrawDataBound = false;
+	// the draw data is bound with the shape that follows it,
+	// whose packed positions may need decoding by the model
+	DRAW_DATA pendingData;
+	bool bPendingData = false;
+	unsigned int currentProgram = 0;
+
+	m_pCommandQueue->Sort();
+	m_basicMeshes->ResetDrawCounts();
+	m_drawCallCount = 0;
+
+	// every packet writes one block of draw data, and with the
+	// occlusion queries every drawn object may write one more
+	// for its box - the ring wraps when a frame needs more than
+	// its largest section
+	size_t drawDataSize = m_pUniformRing->GetAlignedSize(sizeof(DRAW_UNIFORMS));
+	size_t blocksPerPacket = (m_pOcclusionCuller->IsEnabled() == true) ? 2 : 1;
+	m_pUniformRing->BeginFrame(drawDataSize * m_pCommandQueue->GetPacketCount() * blocksPerPacket);
+
+	// count the primitives of the scene draws in a query of
+	// their own, reusing the oldest query once it is read
+	bool bPrimitiveQuery = false;
+	if (m_bCountPrimitives == true)
+	{
+		if (m_primitiveQueryPending[m_primitiveQueryIndex] == true)
+		{
+			GLuint64 primitives = 0;
+			glGetQueryObjectui64v(m_primitiveQueries[m_primitiveQueryIndex], GL_QUERY_RESULT, &primitives);
+			m_primitiveCount += primitives;
+			m_primitiveQueryPending[m_primitiveQueryIndex] = false;
+		}
+		glBeginQuery(GL_PRIMITIVES_GENERATED, m_primitiveQueries[m_primitiveQueryIndex]);
+		bPrimitiveQuery = true;
+	}
+
+	// the nodes culled on the GPU are all opaque, so they are
+	// drawn before the recorded draws, and the depth pyramid of
+	// the next frame is built once the last opaque draw is done
+	SubmitGpuObjects();
+	bool bDepthPyramidPending = m_pGpuCuller->IsEnabled();
+
+	for (int i = 0; i < m_pCommandQueue->GetPacketCount(); i++)
+	{
+		uint32_t size = 0;
+		const unsigned char* pCommands = m_pCommandQueue->GetPacketCommands(i, size);
+		uint32_t position = 0;
+		RenderCommandType type;
+		const unsigned char* pPayload = NULL;
+
+		while (CommandQueue::ReadCommand(pCommands, size, position, type, pPayload) == true)
+		{
+			switch (type)
+			{
+			case COMMAND_BIND_PROGRAM:
+			{
+				unsigned int programID = 0;
+				memcpy(&programID, pPayload, sizeof(programID));
+				if (programID != currentProgram)
+				{
+					glUseProgram(programID);
+					currentProgram = programID;
+					bHasPreviousData = false;
+				}
+				break;
+			}
+			case COMMAND_SET_DRAW_DATA:
+			{
+				memcpy(&pendingData, pPayload, sizeof(pendingData));
+				bPendingData = true;
+				break;
+			}
+			case COMMAND_SET_INDEX_RANGES:
+			{
+				uint32_t rangeCount = 0;
+				memcpy(&rangeCount, pPayload, sizeof(rangeCount));
+				m_drawRanges.resize(rangeCount);
+				memcpy(m_drawRanges.data(), pPayload + sizeof(rangeCount), sizeof(MESHLET_RANGE) * rangeCount);
+				break;
+			}
+			case COMMAND_DRAW_SHAPE:
+			{
+				DRAW_SHAPE_DATA drawShape;
+				memcpy(&drawShape, pPayload, sizeof(drawShape));
+				if (bPendingData == true)
+				{
+					bDrawDataBound = ApplyDrawData(
+						pendingData,
+						bHasPreviousData ? &previousData : NULL,
+						m_basicMeshes->GetPositionDecode(drawShape.mesh));
+					previousData = pendingData;
+					bHasPreviousData = true;
+					bPendingData = false;
+				}
+				if (bDrawDataBound == false)
+				{
+					m_drawRanges.clear();
+					break;
+				}
+				// the translucent draws are sorted last, so the pass
+				// starts at the first of them
+				if ((drawShape.bTransparent == true) && (bDepthPyramidPending == true))
+				{
+					m_pGpuCuller->BuildDepthPyramid();
+					bDepthPyramidPending = false;
+				}
+				if ((drawShape.bTransparent == true) && (m_transparencyMode == TRANSPARENCY_WEIGHTED))
+				{
+					m_pTransparencyPass->Begin();
+				}
+				m_basicMeshes->SetLevelOfDetail(drawShape.lod);
+				if (drawShape.bOcclusionQuery == true)
+				{
+					m_pOcclusionCuller->BeginOccludee(
+						drawShape.objectIndex,
+						previousData.modelMatrix,
+						drawShape.boundsMin,
+						drawShape.boundsMax);
+				}
+				if (m_drawRanges.empty() == false)
+				{
+					m_basicMeshes->DrawRanges(drawShape.mesh,
+						m_drawRanges.data(), (int)m_drawRanges.size());
+				}
+				else
+				{
+					m_basicMeshes->Draw(drawShape.mesh);
+				}
+				m_drawRanges.clear();
+				m_drawCallCount++;
+				if (drawShape.bOcclusionQuery == true)
+				{
+					m_pOcclusionCuller->EndOccludee();
+				}
+				m_basicMeshes->SetLevelOfDetail(0);
+				break;
+			}
+			}
+		}
+	}
+
+	// the passes below draw with vertex arrays of their own
+	m_basicMeshes->UnbindMeshes();
+	if (bPrimitiveQuery == true)
+	{
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		m_primitiveQueryPending[m_primitiveQueryIndex] = true;
+		m_primitiveQueryIndex = (m_primitiveQueryIndex + 1) % PRIMITIVE_QUERY_COUNT;
+		CollectPrimitiveQueries(false);
+	}
+
+	// without translucent draws the depth pyramid is built from
+	// the finished depth buffer
+	if (bDepthPyramidPending == true)
+	{
+		m_pGpuCuller->BuildDepthPyramid();
+	}
+
+	// blend the weighted transparency over the window
+	m_pTransparencyPass->End();
+
+	// test the bounding boxes of the objects against the finished
+	// depth buffer, for skipping the hidden ones in the next frame
+	m_pOcclusionCuller->IssueQueries(m_pUniformRing);
+
+	// protect this frame's section of the ring until the GPU
+	// has finished reading it
+	m_pUniformRing->EndFrame();
+
+	m_drawnVertexCount = m_basicMeshes->GetDrawnVertexCount();
+	m_vertexArrayBindCount = m_basicMeshes->GetVertexArrayBindCount();
+}
+
+/***********************************************************
+ *  StartPrimitiveCount()
+ *
+ *  This method is used for starting a count of the
+ *  primitives of the scene draws, over the frames submitted
+ *  until it is stopped.  The boxes of the occlusion queries
+ *  and the transparency composite are left out, so the
+ *  count is the same in every culling and transparency mode
+ *  that draws the same objects.
+ ***********************************************************/
+void SceneManager::StartPrimitiveCount()
+{
+	if (m_primitiveQueries[0] == 0)
+	{
+		glGenQueries(PRIMITIVE_QUERY_COUNT, m_primitiveQueries);
+	}
+
+	// results of an earlier count are not added to this one
+	CollectPrimitiveQueries(true);
+	m_primitiveCount = 0;
+	m_bCountPrimitives = true;
+}
+
+/***********************************************************
+ *  StopPrimitiveCount()
+ *
+ *  This method is used for stopping the count of the
+ *  primitives, waiting for the queries still in flight, and
+ *  getting the total.
+ ***********************************************************/
+GLuint64 SceneManager::StopPrimitiveCount()
+{
+	CollectPrimitiveQueries(true);
+	m_bCountPrimitives = false;
+	return(m_primitiveCount);
+}
+
+/***********************************************************
+ *  CollectPrimitiveQueries()
+ *
+ *  This method is used for adding the results of the
+ *  primitive queries to the count - only the ones that are
+ *  available, unless asked to wait for all of them.
+ ***********************************************************/
+void SceneManager::CollectPrimitiveQueries(bool bWait)
+{
+	for (int i = 0; i < PRIMITIVE_QUERY_COUNT; i++)
+	{
+		if (m_primitiveQueryPending[i] == false)
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_primitiveQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if ((available != 0) || (bWait == true))
+		{
+			GLuint64 primitives = 0;
+			glGetQueryObjectui64v(m_primitiveQueries[i], GL_QUERY_RESULT, &primitives);
+			m_primitiveCount += primitives;
+			m_primitiveQueryPending[i] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  ApplyDrawData()
+ *
+ *  This method is used for copying the shader values of a
+ *  replayed draw into the current section of the uniform
+ *  ring buffer and binding that slice to the DrawData block.
+ *  The texture sampler is still a plain uniform, so it is
+ *  only set when the texture slot changes.  The passed in
+ *  position decode of the mesh is put in front of the
+ *  model matrix, so the shader needs no extra values to
+ *  unpack the positions.
+ ***********************************************************/
+bool SceneManager::ApplyDrawData(
+	const DRAW_DATA& drawData,
+	const DRAW_DATA* pPreviousData,
+	const glm::mat4& positionDecode)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(false);
+	}
+
+	DRAW_UNIFORMS uniforms;
+	uniforms.model = drawData.modelMatrix * positionDecode;
+	uniforms.objectColor = drawData.color;
+	uniforms.UVscale = drawData.uvScale;
+	uniforms.bUseTexture = (drawData.textureSlot >= 0) ? 1 : 0;
+	uniforms.materialIndex = std::max(drawData.materialIndex, 0);
+
+	GLintptr offset = m_pUniformRing->Write(&uniforms, sizeof(uniforms));
+	if (offset < 0)
+	{
+		return(false);
+	}
+	m_pUniformRing->BindRange(DRAW_DATA_BINDING, offset, sizeof(uniforms));
+
+	if ((drawData.textureSlot >= 0) &&
+		((NULL == pPreviousData) || (pPreviousData->textureSlot != drawData.textureSlot)))
+	{
+		m_pShaderManager->setSampler2DValue(g_TextureValueName, drawData.textureSlot);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetupUniformBuffers()
+ *
+ *  This method is used for uploading the defined object
+ *  materials into a shader storage buffer, once, sized for
+ *  all the materials of the scene, and connecting the
+ *  DrawData block of the shader program to the binding of
+ *  the ring buffer.
+ ***********************************************************/
+void SceneManager::SetupUniformBuffers()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	GLuint programID = m_pShaderManager->m_programID;
+	GLuint drawDataBlock = glGetUniformBlockIndex(programID, g_DrawDataBlockName);
+	if (drawDataBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(programID, drawDataBlock, DRAW_DATA_BINDING);
+	}
+
+	// a node without a material reads the first entry, so a
+	// scene without materials still gets one empty entry
+	std::vector<MATERIAL_UNIFORMS> materials(std::max((int)m_objectMaterials.size(), 1));
+	for (int i = 0; i < (int)materials.size(); i++)
+	{
+		materials[i].ambientColor = glm::vec3(0.0f);
+		materials[i].ambientStrength = 0.0f;
+		materials[i].diffuseColor = glm::vec3(0.0f);
+		materials[i].padding = 0.0f;
+		materials[i].specularColor = glm::vec3(0.0f);
+		materials[i].shininess = 0.0f;
+	}
+	for (int i = 0; i < (int)m_objectMaterials.size(); i++)
+	{
+		materials[i].ambientColor = m_objectMaterials[i].ambientColor;
+		materials[i].ambientStrength = m_objectMaterials[i].ambientStrength;
+		materials[i].diffuseColor = m_objectMaterials[i].diffuseColor;
+		materials[i].specularColor = m_objectMaterials[i].specularColor;
+		materials[i].shininess = m_objectMaterials[i].shininess;
+	}
+
+	if (m_materialBuffer == 0)
+	{
+		glGenBuffers(1, &m_materialBuffer);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_materialBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(MATERIAL_UNIFORMS) * materials.size(), materials.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIALS_BINDING, m_materialBuffer);
 }
 
 /**************************************************************/
@@ -389,71 +1422,35 @@ void SceneManager::SetShaderMaterial(
  ***********************************************************/
 void SceneManager::LoadSceneTextures()
 {
-	bool bReturn = false;
-
-	// Load textures for the table surface
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/rusticwood.jpg",
-		"table_surface");
-
-	// Load textures for the vase (different parts)
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/gold-seamless-texture.jpg",
-		"vase_bottom");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/stainless.jpg",
-		"vase_middle");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/circular-brushed-gold-texture.jpg",
-		"vase_top");
-
-	// Load texture for flower stems
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/rusticwood.jpg",
-		"flower_stem");
-
-	// Load texture for flower buds
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/stainedglass.jpg",
-		"flower_bud");
-
-	// Load texture for pumpkin
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/abstract.jpg",
-		"pumpkin");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/breadcrust.jpg",
-		"pumpkin_stem");
-
-	// Load second table texture for overlapping effect
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/cheddar.jpg",
-		"table_overlay");
-
-	// Load textures for the candles
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/amber_glass.jpg",
-		"candle_holder");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/wax.jpg",
-		"candle_wax");
-
-	// Load texture for the book
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/book_cover.jpg",
-		"book_cover");
-
-	bReturn = CreateGLTexture(
-		"../../Utilities/textures/book_pages.jpg",
-		"book_pages");
+	const SCENE_FILE_TEXTURE* pTextures = m_sceneFile.GetTextures();
+	int textureCount = m_sceneFile.GetCount(SCENE_SECTION_TEXTURES);
+
+	// Load the textures of the scene file, up to the number of
+	// texture slots - the nodes of the textures left out are
+	// drawn with their colors
+	if (textureCount > SCENE_MAX_TEXTURES)
+	{
+		std::cerr << "The scene has " << textureCount << " textures, only the first "
+			<< SCENE_MAX_TEXTURES << " are loaded" << std::endl;
+	}
+	for (int i = 0; (i < textureCount) && (m_loadedTextures < SCENE_MAX_TEXTURES); i++)
+	{
+		CreateGLTexture(
+			m_sceneFile.GetString(pTextures[i].path),
+			m_sceneFile.GetString(pTextures[i].tag));
+	}
+
+	// a texture that could not be loaded is left out of the
+	// slots, so the slot of each texture is found by its tag
+	m_textureSlots.assign(textureCount, -1);
+	for (int i = 0; i < textureCount; i++)
+	{
+		m_textureSlots[i] = FindTextureSlot(m_sceneFile.GetString(pTextures[i].tag));
+	}
 
 	// After the texture image data is loaded into memory, the
 	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
+	// are a total of SCENE_MAX_TEXTURES slots for scene textures
 	BindGLTextures();
 }
 
@@ -465,115 +1462,21 @@ void SceneManager::LoadSceneTextures()
  ***********************************************************/
 void SceneManager::DefineObjectMaterials()
 {
-	// Material for the table surface
-	OBJECT_MATERIAL tableMaterial;
-	tableMaterial.ambientColor = glm::vec3(0.2f, 0.1f, 0.05f);
-	tableMaterial.ambientStrength = 0.2f;
-	tableMaterial.diffuseColor = glm::vec3(0.6f, 0.4f, 0.2f);
-	tableMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
-	tableMaterial.shininess = 32.0f;
-	tableMaterial.tag = "table";
-	m_objectMaterials.push_back(tableMaterial);
-
-	// Material for the vase bottom part
-	OBJECT_MATERIAL vaseBottomMaterial;
-	vaseBottomMaterial.ambientColor = glm::vec3(0.3f, 0.2f, 0.0f);
-	vaseBottomMaterial.ambientStrength = 0.3f;
-	vaseBottomMaterial.diffuseColor = glm::vec3(0.8f, 0.7f, 0.0f);
-	vaseBottomMaterial.specularColor = glm::vec3(1.0f, 0.9f, 0.5f);
-	vaseBottomMaterial.shininess = 64.0f;
-	vaseBottomMaterial.tag = "vase_bottom";
-	m_objectMaterials.push_back(vaseBottomMaterial);
-
-	// Material for the vase middle part
-	OBJECT_MATERIAL vaseMiddleMaterial;
-	vaseMiddleMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	vaseMiddleMaterial.ambientStrength = 0.2f;
-	vaseMiddleMaterial.diffuseColor = glm::vec3(0.6f, 0.6f, 0.6f);
-	vaseMiddleMaterial.specularColor = glm::vec3(0.9f, 0.9f, 0.9f);
-	vaseMiddleMaterial.shininess = 128.0f;
-	vaseMiddleMaterial.tag = "vase_middle";
-	m_objectMaterials.push_back(vaseMiddleMaterial);
-
-	// Material for the vase top part
-	OBJECT_MATERIAL vaseTopMaterial;
-	vaseTopMaterial.ambientColor = glm::vec3(0.3f, 0.2f, 0.0f);
-	vaseTopMaterial.ambientStrength = 0.3f;
-	vaseTopMaterial.diffuseColor = glm::vec3(0.8f, 0.7f, 0.0f);
-	vaseTopMaterial.specularColor = glm::vec3(1.0f, 0.9f, 0.5f);
-	vaseTopMaterial.shininess = 64.0f;
-	vaseTopMaterial.tag = "vase_top";
-	m_objectMaterials.push_back(vaseTopMaterial);
-
-	// Material for the flower stems
-	OBJECT_MATERIAL stemMaterial;
-	stemMaterial.ambientColor = glm::vec3(0.1f, 0.3f, 0.1f);
-	stemMaterial.ambientStrength = 0.2f;
-	stemMaterial.diffuseColor = glm::vec3(0.2f, 0.6f, 0.2f);
-	stemMaterial.specularColor = glm::vec3(0.1f, 0.3f, 0.1f);
-	stemMaterial.shininess = 8.0f;
-	stemMaterial.tag = "stem";
-	m_objectMaterials.push_back(stemMaterial);
-
-	// Material for the flower buds
-	OBJECT_MATERIAL budMaterial;
-	budMaterial.ambientColor = glm::vec3(0.3f, 0.1f, 0.3f);
-	budMaterial.ambientStrength = 0.3f;
-	budMaterial.diffuseColor = glm::vec3(0.7f, 0.2f, 0.7f);
-	budMaterial.specularColor = glm::vec3(0.8f, 0.3f, 0.8f);
-	budMaterial.shininess = 16.0f;
-	budMaterial.tag = "bud";
-	m_objectMaterials.push_back(budMaterial);
-
-	// Material for the pumpkin
-	OBJECT_MATERIAL pumpkinMaterial;
-	pumpkinMaterial.ambientColor = glm::vec3(0.4f, 0.2f, 0.0f);
-	pumpkinMaterial.ambientStrength = 0.3f;
-	pumpkinMaterial.diffuseColor = glm::vec3(0.8f, 0.4f, 0.0f);
-	pumpkinMaterial.specularColor = glm::vec3(0.5f, 0.4f, 0.1f);
-	pumpkinMaterial.shininess = 16.0f;
-	pumpkinMaterial.tag = "pumpkin";
-	m_objectMaterials.push_back(pumpkinMaterial);
-
-	// Material for the pumpkin stem
-	OBJECT_MATERIAL pumpkinStemMaterial;
-	pumpkinStemMaterial.ambientColor = glm::vec3(0.1f, 0.2f, 0.0f);
-	pumpkinStemMaterial.ambientStrength = 0.2f;
-	pumpkinStemMaterial.diffuseColor = glm::vec3(0.3f, 0.4f, 0.1f);
-	pumpkinStemMaterial.specularColor = glm::vec3(0.2f, 0.3f, 0.1f);
-	pumpkinStemMaterial.shininess = 4.0f;
-	pumpkinStemMaterial.tag = "pumpkin_stem";
-	m_objectMaterials.push_back(pumpkinStemMaterial);
-
-	// Material for the candle holder
-	OBJECT_MATERIAL candleHolderMaterial;
-	candleHolderMaterial.ambientColor = glm::vec3(0.3f, 0.2f, 0.0f);
-	candleHolderMaterial.ambientStrength = 0.2f;
-	candleHolderMaterial.diffuseColor = glm::vec3(0.6f, 0.4f, 0.1f);
-	candleHolderMaterial.specularColor = glm::vec3(1.0f, 0.8f, 0.4f);
-	candleHolderMaterial.shininess = 96.0f;
-	candleHolderMaterial.tag = "candle_holder";
-	m_objectMaterials.push_back(candleHolderMaterial);
-
-	// Material for the candle wax
-	OBJECT_MATERIAL candleWaxMaterial;
-	candleWaxMaterial.ambientColor = glm::vec3(0.9f, 0.9f, 0.8f);
-	candleWaxMaterial.ambientStrength = 0.2f;
-	candleWaxMaterial.diffuseColor = glm::vec3(1.0f, 1.0f, 0.9f);
-	candleWaxMaterial.specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
-	candleWaxMaterial.shininess = 4.0f;
-	candleWaxMaterial.tag = "candle_wax";
-	m_objectMaterials.push_back(candleWaxMaterial);
-
-	// Material for the book
-	OBJECT_MATERIAL bookMaterial;
-	bookMaterial.ambientColor = glm::vec3(0.2f, 0.1f, 0.05f);
-	bookMaterial.ambientStrength = 0.1f;
-	bookMaterial.diffuseColor = glm::vec3(0.5f, 0.3f, 0.1f);
-	bookMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	bookMaterial.shininess = 8.0f;
-	bookMaterial.tag = "book";
-	m_objectMaterials.push_back(bookMaterial);
+	const SCENE_FILE_MATERIAL* pMaterials = m_sceneFile.GetMaterials();
+
+	// the nodes refer to the materials by their index in the
+	// scene file, so they are kept in the same order
+	for (int i = 0; i < m_sceneFile.GetCount(SCENE_SECTION_MATERIALS); i++)
+	{
+		OBJECT_MATERIAL material;
+		material.ambientColor = glm::vec3(pMaterials[i].ambientColor[0], pMaterials[i].ambientColor[1], pMaterials[i].ambientColor[2]);
+		material.ambientStrength = pMaterials[i].ambientStrength;
+		material.diffuseColor = glm::vec3(pMaterials[i].diffuseColor[0], pMaterials[i].diffuseColor[1], pMaterials[i].diffuseColor[2]);
+		material.specularColor = glm::vec3(pMaterials[i].specularColor[0], pMaterials[i].specularColor[1], pMaterials[i].specularColor[2]);
+		material.shininess = pMaterials[i].shininess;
+		material.tag = m_sceneFile.GetString(pMaterials[i].tag);
+		m_objectMaterials.push_back(material);
+	}
 }
 
 /***********************************************************
@@ -630,590 +1533,116 @@ void SceneManager::SetupSceneLights()
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
+	// Map the scene file, cooking its text description if needed
+	if (NULL != m_pRenderSettings)
+	{
+		LoadScene(m_pRenderSettings->sceneFile);
+	}
+
 	// Load all textures
 	LoadSceneTextures();
 
 	//Define materials for objects
 	DefineObjectMaterials();
 
+	// upload the materials and bind the uniform blocks
+	SetupUniformBuffers();
+
 	// Setup lighting for the scene
 	SetupSceneLights();
 
-	// Load the mesh shapes
-	m_basicMeshes->LoadPlaneMesh(); // for table surface
-	m_basicMeshes->LoadTaperedCylinderMesh(); // for the vase body
-	m_basicMeshes->LoadCylinderMesh(); // for vase neck and flower stem
-	m_basicMeshes->LoadSphereMesh(); // for flower buds
-	m_basicMeshes->LoadBoxMesh(); // for pumpkin ridges
-	m_basicMeshes->LoadConeMesh(); // for candle flame
-	m_basicMeshes->LoadTorusMesh(); // for candle holder rim
-	m_basicMeshes->LoadPrismMesh(); // for book binding
-	m_basicMeshes->LoadPyramid4Mesh(); // for decorative element
+	// Load the mesh shapes, in the packed vertex layout when
+	// it is enabled
+	bool bPackedVertices = (NULL != m_pRenderSettings) && (m_pRenderSettings->bPackedVertices == true);
+	m_basicMeshes->SetPackedVertices(bPackedVertices);
+	m_pShaderManager->setBoolValue(g_PackedVerticesName, bPackedVertices);
+	LoadSceneShapes();
+	LoadSceneMeshes();
+
+	// create the bounding box mesh for the occlusion queries
+	m_pOcclusionCuller->Initialize();
+
+	// load the shader of the weighted blended transparency
+	m_pTransparencyPass->Initialize();
+
+	// load the compute shaders of the GPU driven culling and
+	// upload the nodes it draws
+	m_pGpuCuller->Initialize();
+	LoadGpuObjects();
+	m_pShaderManager->setBoolValue(g_GpuDrivenName, false);
 }
 
 /***********************************************************
  *  RenderScene()
  *
  *  This method is used for rendering the 3D scene by
- *  transforming and drawing the basic 3D shapes
+ *  recording a draw for every node of the scene file.  The
+ *  draws are only recorded here, split into ranges on the
+ *  job system, and SubmitScene() replays them.  With the
+ *  GPU driven culling only the nodes the GPU does not draw
+ *  are recorded.
  ***********************************************************/
 void SceneManager::RenderScene()
 {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply texture tiling to the table surface (complex texturing technique)
-	SetTextureUVScale(5.0f, 2.5f); // This tiles the texture 5x horizontally and 2.5x vertically
-	SetShaderTexture("table_surface");
-
-	// For the table surface
-	SetShaderMaterial("table");
-
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
-	// Draw a second layer on top of the table with a different texture and transparency
-	// This creates a complex overlapping texture effect
-	scaleXYZ = glm::vec3(20.0f, 1.01f, 10.0f); // Slightly higher than table to avoid z-fighting
-	positionXYZ = glm::vec3(0.0f, 0.01f, 0.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply a different texture with different tiling
-	SetTextureUVScale(10.0f, 5.0f);
-	SetShaderTexture("table_overlay");
-
-	// For the table overlay (keeping transparency)
-	SetShaderMaterial("table");
-
-	// Make overlay partially transparent
-	SetShaderColor(1.0f, 1.0f, 1.0f, 0.3f);
-	m_basicMeshes->DrawPlaneMesh();
-
-	// Reset color and UV scale
-	SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	SetTextureUVScale(1.0f, 1.0f);
-
-	// Draw the vase body (bottom part - widest)
-	scaleXYZ = glm::vec3(2.5f, 1.4f, 2.5f);  // Much wider and taller bottom
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 0.7f, 0.0f);  // Centered in the view
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply texture to vase bottom
-	SetShaderTexture("vase_bottom");
-
-	// For the vase bottom
-	SetShaderMaterial("vase_bottom");
-
-	m_basicMeshes->DrawTaperedCylinderMesh();
-
-	// Draw the vase middle section (narrower)
-	scaleXYZ = glm::vec3(1.2f, 1.0f, 1.2f);  // Narrower but still substantial
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 1.9f, 0.0f);  // Position above bottom part
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply texture to vase middle
-	SetShaderTexture("vase_middle");
-
-	// For the vase middle
-	SetShaderMaterial("vase_middle");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Draw the vase top (wider opening)
-	scaleXYZ = glm::vec3(1.8f, 0.6f, 1.8f);  // Dramatic flared opening
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 2.7f, 0.0f);  // Position above middle
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply texture to vase top
-	SetShaderTexture("vase_top");
-
-	// For the vase top
-	SetShaderMaterial("vase_top");
-
-	m_basicMeshes->DrawTaperedCylinderMesh();
-
-	// Create many flower stems filling the vase in all directions
-	// Generate 32 stems in a circular pattern
-	for (int i = 0; i < 32; i++) {
-		// Calculate varied parameters for natural look
-		float angle = (i * 11.25f);  // Full 360 coverage (32 * 11.25 = 360)
-		float stemLength = 1.0f + (i % 5) * 0.2f;  // Varying lengths
-		float radialPosition = (i % 3) * 0.3f;  // Varied distances from center
-
-		// Calculate stem position with random-like variation
-		float xPos = radialPosition * sin(glm::radians(angle));
-		float zPos = radialPosition * cos(glm::radians(angle));
-
-		// Calculate tilt angle with variation
-		float tiltAngle = 10.0f + (i % 4) * 5.0f;  // Varied tilt
-
-		// Stem properties with variation
-		scaleXYZ = glm::vec3(0.03f, stemLength, 0.03f);
-		XrotationDegrees = tiltAngle;  // Store tilt for later calculations
-		YrotationDegrees = angle;  // Direction matches position angle
-		ZrotationDegrees = 0.0f;
-
-		positionXYZ = glm::vec3(xPos, 3.0f, zPos);  // Start from top of vase
-
-		SetTransformations(
-			scaleXYZ,
-			XrotationDegrees,
-			YrotationDegrees,
-			ZrotationDegrees,
-			positionXYZ);
-
-		// Apply stem texture with UV scaling to make it look natural
-		SetTextureUVScale(1.0f, 3.0f); // Stretch texture vertically along stem
-		SetShaderTexture("flower_stem");
-
-		// For the flower stems
-		SetShaderMaterial("stem");
-
-
-		m_basicMeshes->DrawCylinderMesh();
-
-		// Reset UV scale
-		SetTextureUVScale(1.0f, 1.0f);
-
-		// Precisely calculate the end position of the stem
-		// Convert angles to radians for calculation
-		float tiltRad = glm::radians(tiltAngle);
-		float angleRad = glm::radians(angle);
-
-		// Calculate the vector representing the stem direction
-		// This accounts for both X rotation (tilt) and Y rotation (angle)
-		float dirX = sin(tiltRad) * sin(angleRad);
-		float dirY = cos(tiltRad);
-		float dirZ = sin(tiltRad) * cos(angleRad);
-
-		// Multiply by stem length to get the endpoint offset
-		float endX = stemLength * dirX;
-		float endY = stemLength * dirY;
-		float endZ = stemLength * dirZ;
-
-		// Add to the stem base position to get final bud position
-		float budX = xPos + endX;
-		float budY = 3.3f + endY;
-		float budZ = zPos + endZ;
-
-		// Flower bud
-		float budSize = 0.08f + (i % 4) * 0.03f;  // Slight size variation
-		scaleXYZ = glm::vec3(budSize, budSize, budSize);
-
-		positionXYZ = glm::vec3(budX, budY, budZ);
+	int nodeCount = m_sceneFile.GetCount(SCENE_SECTION_NODES);
 
-		SetTransformations(
-			scaleXYZ,
-			0.0f, 0.0f, 0.0f,
-			positionXYZ);
-
-		// Apply bud texture
-		SetShaderTexture("flower_bud");
-
-		// For the flower buds
-		SetShaderMaterial("bud");
-
-		m_basicMeshes->DrawSphereMesh();
+	if (NULL != m_pRenderSettings)
+	{
+		m_occlusionMode = m_pRenderSettings->occlusionMode;
+		m_transparencyMode = m_pRenderSettings->transparencyMode;
 	}
+	m_pOcclusionCuller->SetEnabled(m_occlusionMode == OCCLUSION_GPU_QUERIES);
+	m_pGpuCuller->SetEnabled((m_occlusionMode == OCCLUSION_GPU_DRIVEN) && (m_pGpuCuller->IsSupported() == true));
 
-	// Draw the pumpkin body (spheroid with distinctive ridges)
-	scaleXYZ = glm::vec3(1.5f, 1.0f, 1.5f);  // Wider than tall for squash shape
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 45.0f;  // Rotate slightly for better view
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(3.0f, 0.5f, 2.0f);  // Position to the right front of vase
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply pumpkin texture
-	SetShaderTexture("pumpkin");
-
-	// For the pumpkin body
-	SetShaderMaterial("pumpkin");
-
-	m_basicMeshes->DrawSphereMesh();  // Base shape is a sphere
-
-	// Create pumpkin ridges using thin, tall boxes arranged in a circle
-	for (int i = 0; i < 8; i++) {
-		float angle = i * 45.0f;  // 8 ridges evenly spaced
-
-		// Calculate ridge position
-		float ridgeX = 3.0f + 0.8f * sin(glm::radians(angle));
-		float ridgeZ = 2.0f + 0.8f * cos(glm::radians(angle));
-
-		// Ridge properties
-		scaleXYZ = glm::vec3(0.1f, 0.9f, 0.1f);  // Thin, tall box
-		XrotationDegrees = 0.0f;
-		YrotationDegrees = angle;  // Orient toward center
-		ZrotationDegrees = 15.0f;  // Tilt outward slightly
-
-		positionXYZ = glm::vec3(ridgeX, 0.5f, ridgeZ);
+	// draw the occluders found in the previous frame with the
+	// current camera, then collect them again while drawing
+	if (m_occlusionMode == OCCLUSION_CPU_RASTER)
+	{
+		m_pDepthRasterizer->Rasterize(m_viewProjection);
+	}
+	m_pDepthRasterizer->ClearOccluders();
 
-		SetTransformations(
-			scaleXYZ,
-			XrotationDegrees,
-			YrotationDegrees,
-			ZrotationDegrees,
-			positionXYZ);
+	// test all the objects of the previous frame against the
+	// new camera before any of them are drawn
+	ProcessSceneObjects();
+	m_pCommandQueue->Reset();
 
-		// Apply the same texture but darker to create subtle ridge effect
-		SetShaderTexture("pumpkin");
+	// every node is one scene object, with the node index as
+	// its object index
+	ReserveSceneObjects(nodeCount);
 
-		// For the pumpkin ridges
-		SetShaderMaterial("pumpkin");
+	// the large objects hide whatever is behind them
+	const uint32_t* pOccluders = m_sceneFile.GetOccluders();
+	int occluderCount = (m_occlusionMode == OCCLUSION_CPU_RASTER) ? m_sceneFile.GetCount(SCENE_SECTION_OCCLUDERS) : 0;
+	for (int i = 0; i < occluderCount; i++)
+	{
+		ShapeMeshes::MeshHandle mesh;
+		glm::mat4 modelMatrix;
+		if ((pOccluders[i] < (uint32_t)nodeCount) &&
+			(GetNodeMesh(m_sceneFile.GetNodes()[pOccluders[i]], mesh, modelMatrix) == true))
+		{
+			AddOccluder(mesh, modelMatrix);
+		}
+	}
 
-		m_basicMeshes->DrawBoxMesh();
+	// record the draws of the nodes on all the threads - the
+	// nodes culled on the GPU are drawn by SubmitScene()
+	if (m_pGpuCuller->IsEnabled() == true)
+	{
+		m_pJobSystem->ParallelFor((int)m_cpuNodes.size(), g_SceneNodeGrainSize, [this](int first, int last) {
+			CommandBuffer& buffer = m_pCommandQueue->GetBuffer();
+			for (int i = first; i < last; i++)
+			{
+				RecordNode(buffer, m_cpuNodes[i]);
+			}
+		});
+		return;
 	}
-
-	// Add pumpkin stem
-	scaleXYZ = glm::vec3(0.2f, 1.1f, 0.2f);
-	XrotationDegrees = -60.0f;  // Stem tilts slightly
-	YrotationDegrees = 30.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(3.0f, 1.1f, 2.0f);  // Position on top of pumpkin
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply stem texture
-	SetShaderTexture("pumpkin_stem");
-
-	// For the pumpkin stem
-	SetShaderMaterial("pumpkin_stem");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Drawing the first amber glass candle holder to the left of the vase
-	// This is the main cylinder of the candle holder
-	scaleXYZ = glm::vec3(0.8f, 0.6f, 0.8f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-3.0f, 0.3f, 3.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply candle holder texture
-	SetShaderTexture("candle_holder");
-
-	// For the candle holder material
-	SetShaderMaterial("candle_holder");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Add a decorative torus rim to the top of the candle holder
-	scaleXYZ = glm::vec3(0.85f, 0.85f, 0.2f);
-	XrotationDegrees = 90.0f; // Orient torus horizontally
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-3.0f, 0.6f, 3.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply same texture as holder
-	SetShaderTexture("candle_holder");
-
-	// For the candle holder rim
-	SetShaderMaterial("candle_holder");
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// Add the candle wax inside the holder
-	scaleXYZ = glm::vec3(0.5f, 0.3f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-3.0f, 0.7f, 3.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply candle wax texture
-	SetShaderTexture("candle_wax");
-
-	// For the candle wax material
-	SetShaderMaterial("candle_wax");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Add a small flame using a cone
-	scaleXYZ = glm::vec3(0.1f, 0.3f, 0.1f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-3.0f, 1.05f, 3.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set flame color (no texture)
-	SetShaderColor(1.0f, 0.6f, 0.0f, 1.0f);
-
-	m_basicMeshes->DrawConeMesh();
-
-	// Draw the second candle holder (similar but slightly different)
-	// This is the main cylinder of the second candle holder
-	scaleXYZ = glm::vec3(0.7f, 0.5f, 0.7f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 15.0f; // Rotate slightly for variation
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-4.0f, 0.25f, 1.5f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply candle holder texture
-	SetShaderTexture("candle_holder");
-
-	// For the candle holder material
-	SetShaderMaterial("candle_holder");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Add a decorative torus rim to the top of the second candle holder
-	scaleXYZ = glm::vec3(0.75f, 0.75f, 0.15f);
-	XrotationDegrees = 90.0f; // Orient torus horizontally
-	YrotationDegrees = 15.0f; // Match rotation with base
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-4.0f, 0.5f, 1.5f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply same texture as holder
-	SetShaderTexture("candle_holder");
-
-	// For the candle holder rim
-	SetShaderMaterial("candle_holder");
-
-	m_basicMeshes->DrawTorusMesh();
-
-	// Add the candle wax inside the second holder
-	scaleXYZ = glm::vec3(0.4f, 0.25f, 0.4f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 15.0f; // Match rotation with base
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-4.0f, 0.6f, 1.5f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply candle wax texture
-	SetShaderTexture("candle_wax");
-
-	// For the candle wax material
-	SetShaderMaterial("candle_wax");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Add a small flame using a cone for the second candle
-	scaleXYZ = glm::vec3(0.08f, 0.25f, 0.08f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 15.0f; // Match rotation with base
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-4.0f, 0.9f, 1.5f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Set flame color (no texture)
-	SetShaderColor(1.0f, 0.6f, 0.0f, 1.0f);
-
-	m_basicMeshes->DrawConeMesh();
-
-	// Reset color after flame
-	SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-
-	// Draw a book on the table near the candles
-	// Main book body
-	scaleXYZ = glm::vec3(1.8f, 0.2f, 1.2f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = -15.0f; // Angle the book slightly
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-2.5f, 0.1f, 0.5f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply book cover texture
-	SetShaderTexture("book_cover");
-
-	// For the book material
-	SetShaderMaterial("book");
-
-	m_basicMeshes->DrawBoxMesh();
-
-	// Book binding (uses prism shape)
-	scaleXYZ = glm::vec3(0.2f, 0.2f, 1.2f);
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = -15.0f; // Match book angle
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-3.3f, 0.2f, 0.4f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply binding texture (same as cover)
-	SetShaderTexture("book_cover");
-
-	// For the book material
-	SetShaderMaterial("book");
-
-	m_basicMeshes->DrawPrismMesh();
-
-	// Book pages (visible on the open side)
-	scaleXYZ = glm::vec3(1.6f, 0.19f, 1.19f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = -15.0f; // Match book angle
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-2.5f, 0.21f, 0.5f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Apply pages texture
-	SetShaderTexture("book_pages");
-
-	// For the book material (same as cover)
-	SetShaderMaterial("book");
-
-	m_basicMeshes->DrawBoxMesh();
-
-	// Add a decorative pyramid element to complete the scene
-	scaleXYZ = glm::vec3(0.4f, 0.7f, 0.4f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(2.5f, 0.35f, -2.0f);
-
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// Use a gold texture for the pyramid
-	SetShaderTexture("vase_bottom");
-
-	// Use gold material
-	SetShaderMaterial("vase_bottom");
-
-	m_basicMeshes->DrawPyramid4Mesh();
-}
\ No newline at end of file
+	m_pJobSystem->ParallelFor(nodeCount, g_SceneNodeGrainSize, [this](int first, int last) {
+		CommandBuffer& buffer = m_pCommandQueue->GetBuffer();
+		for (int i = first; i < last; i++)
+		{
+			RecordNode(buffer, i);
+		}
+	});
+}
@@ -11,6 +11,16 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "OcclusionCuller.h"
+#include "GpuCuller.h"
+#include "JobSystem.h"
+#include "DepthRasterizer.h"
+#include "CommandBuffer.h"
+#include "UniformRingBuffer.h"
+#include "TransparencyPass.h"
+#include "SceneFile.h"
+#include "SceneBuilder.h"
+#include "RenderSettings.h"
 
 #include <string>
 #include <vector>
@@ -25,7 +35,7 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(ShaderManager *pShaderManager, RENDER_SETTINGS* pRenderSettings);
 	// destructor
 	~SceneManager();
 
@@ -45,6 +55,18 @@ public:
 		std::string tag;
 	};
 
+	// an object drawn in the previous frame, which is tested
+	// for visibility and detail level at the start of the next
+	// frame together with all the other objects
+	struct SCENE_OBJECT
+	{
+		glm::mat4 modelMatrix;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		bool bVisible;
+		int lod;
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
@@ -53,9 +75,69 @@ private:
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
+	TEXTURE_INFO m_textureIDs[SCENE_MAX_TEXTURES];
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// pointer to the shared rendering switches
+	RENDER_SETTINGS* m_pRenderSettings;
+	// threads for the per-frame CPU work
+	JobSystem* m_pJobSystem;
+	// draws recorded for the current frame
+	CommandQueue* m_pCommandQueue;
+	// per-draw shader values of the last three frames
+	UniformRingBuffer* m_pUniformRing;
+	// uniform buffer holding all the object materials
+	GLuint m_materialBuffer;
+	// occlusion culling of the scene objects
+	OcclusionCuller* m_pOcclusionCuller;
+	DepthRasterizer* m_pDepthRasterizer;
+	// occlusion culling mode used for the current frame
+	OcclusionMode m_occlusionMode;
+	// culling of the opaque shape nodes on the GPU, the nodes
+	// that are still recorded on the CPU with it, the texture
+	// slot of each of its batches, and a shape of the buffer
+	// its indirect draws read
+	GpuCuller* m_pGpuCuller;
+	std::vector<int> m_cpuNodes;
+	std::vector<int> m_gpuBatchSlots;
+	ShapeMeshes::MeshHandle m_gpuMesh;
+	// weighted blended transparency, and the way translucent
+	// objects are drawn in the current frame
+	TransparencyPass* m_pTransparencyPass;
+	TransparencyMode m_transparencyMode;
+	// view and projection of the current frame
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::mat4 m_viewProjection;
+	// visibility and detail level of each object, by object
+	// index, from the start of the current frame
+	std::vector<SCENE_OBJECT> m_sceneObjects;
+	// vertices and objects drawn in the last frame, and the
+	// vertex arrays bound for them
+	unsigned int m_drawnVertexCount;
+	unsigned int m_drawCallCount;
+	unsigned int m_vertexArrayBindCount;
+	// queries counting the primitives of the scene draws alone,
+	// without the occlusion boxes and the transparency
+	// composite, while a count is running - read a few frames
+	// later so the CPU does not wait for them
+	static const int PRIMITIVE_QUERY_COUNT = 4;
+	GLuint m_primitiveQueries[PRIMITIVE_QUERY_COUNT];
+	bool m_primitiveQueryPending[PRIMITIVE_QUERY_COUNT];
+	int m_primitiveQueryIndex;
+	GLuint64 m_primitiveCount;
+	bool m_bCountPrimitives;
+	// the mapped scene file, read in place every frame
+	SceneFile m_sceneFile;
+	// mesh handle of each mesh reference of the scene file, or
+	// INVALID_MESH when there is no shape mesh with its name
+	// or its file could not be imported
+	std::vector<ShapeMeshes::MeshHandle> m_meshHandles;
+	// texture slot of each texture of the scene file, or -1
+	std::vector<int> m_textureSlots;
+	// index ranges of the visible meshlets of the draw being
+	// replayed, or empty to draw the whole mesh
+	std::vector<MESHLET_RANGE> m_drawRanges;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
@@ -69,35 +151,90 @@ private:
 	// find a defined material by tag
 	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
 
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
+	// map the cooked scene file, cooking it first from a text
+	// scene description that has changed
+	bool LoadScene(const std::string& filename);
+	// generate the shape meshes drawn by the scene file
+	void LoadSceneShapes();
+	// import the OBJ meshes named by the scene file
+	void LoadSceneMeshes();
+	// get the mesh handle and model matrix of a scene node
+	bool GetNodeMesh(
+		const SCENE_FILE_NODE& node,
+		ShapeMeshes::MeshHandle& mesh,
+		glm::mat4& modelMatrix) const;
+	// get the mesh handle and shader values of a scene node
+	bool GetNodeDrawData(
+		const SCENE_FILE_NODE& node,
+		ShapeMeshes::MeshHandle& mesh,
+		DRAW_DATA& drawData) const;
+	// upload the scene nodes that the GPU can cull and draw,
+	// and keep the others for recording on the CPU
+	void LoadGpuObjects();
+	// cull the nodes on the GPU and draw the visible ones
+	void SubmitGpuObjects();
+	// record the draw of a scene node - called on any of the
+	// job system threads
+	void RecordNode(
+		CommandBuffer& buffer,
+		int nodeIndex);
+	// record a draw of the passed in object into a buffer -
+	// called on any of the job system threads
+	void RecordDraw(
+		CommandBuffer& buffer,
+		int objectIndex,
+		const DRAW_DATA& drawData,
+		ShapeMeshes::MeshHandle mesh,
+		bool bCullable);
+	// make sure there is a scene object record for every
+	// object index below the passed in count
+	void ReserveSceneObjects(int count);
+	// add the results of the finished primitive queries to the
+	// count, waiting for all of them when requested
+	void CollectPrimitiveQueries(bool bWait);
+	// copy the shader values of a replayed draw into the ring
+	// buffer and bind them - false without a ring buffer
+	bool ApplyDrawData(
+		const DRAW_DATA& drawData,
+		const DRAW_DATA* pPreviousData,
+		const glm::mat4& positionDecode);
+	// upload the object materials and connect the uniform
+	// blocks of the shader program to their bindings
+	void SetupUniformBuffers();
+	// use an object as an occluder for the CPU culling
+	void AddOccluder(
+		ShapeMeshes::MeshHandle mesh,
+		const glm::mat4& modelMatrix);
+	// test all the objects of the previous frame against the
+	// camera of the current frame, in parallel
+	void ProcessSceneObjects();
+	// test the visibility of an object and choose its detail
+	// level from the size of its bounding sphere on the screen -
+	// called on any of the job system threads
+	void ProcessSceneObject(
+		SCENE_OBJECT& object) const;
+	int SelectLevelOfDetail(
+		const SCENE_OBJECT& object) const;
 
 public:
+	// set the view and projection of the next rendered frame
+	void SetViewProjection(
+		const glm::mat4& view,
+		const glm::mat4& projection);
+	// replay the draws recorded by RenderScene() on the thread
+	// that owns the OpenGL context
+	void SubmitScene();
+	// number of vertices drawn in the last frame
+	unsigned int GetDrawnVertexCount() const { return(m_drawnVertexCount); }
+	// number of objects drawn in the last frame
+	unsigned int GetDrawCallCount() const { return(m_drawCallCount); }
+	// number of vertex arrays bound in the last frame
+	unsigned int GetVertexArrayBindCount() const { return(m_vertexArrayBindCount); }
+	// count the primitives of the scene draws from the next
+	// frame on, and get the total of the frames since then
+	// once the count is stopped
+	void StartPrimitiveCount();
+	GLuint64 StopPrimitiveCount();
 
 	// The following methods are for the students to 
 	// customize for their own 3D scene
@@ -0,0 +1,311 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscene.cpp
+// ============
+// generated scenes of any size and a repeatable camera path through them
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StressScene.h"
+#include "SceneFile.h"
+#include "SceneBuilder.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+// declaration of global variables
+namespace
+{
+	// most objects in a stress scene
+	const int g_MaxStressObjects = 1000000;
+
+	// space left between the copies, as a fraction of the size
+	// of the template
+	const float g_CellGap = 0.1f;
+
+	// lowest and highest height of the camera path above the
+	// tallest object, and how far ahead of the camera the point
+	// it looks at is
+	const float g_CameraHeightMin = 3.0f;
+	const float g_CameraHeightMax = 12.0f;
+	const float g_CameraLookDistance = 20.0f;
+
+	/***********************************************************
+	 *  RandomFloat()
+	 *
+	 *  This function is used for getting a random value from 0
+	 *  up to 1.  The value is made from the bits of the
+	 *  generator directly, since the standard distributions
+	 *  give different values with different libraries.
+	 ***********************************************************/
+	float RandomFloat(std::mt19937& generator)
+	{
+		return((float)(generator() >> 8) / 16777216.0f);
+	}
+
+	/***********************************************************
+	 *  RandomIndex()
+	 *
+	 *  This function is used for getting a random index below
+	 *  the passed in count.
+	 ***********************************************************/
+	int RandomIndex(std::mt19937& generator, int count)
+	{
+		return(std::min((int)(RandomFloat(generator) * count), count - 1));
+	}
+}
+
+/***********************************************************
+ *  GenerateStressScene()
+ *
+ *  This function is used for writing a scene file that
+ *  repeats the nodes of the template scene on a grid until
+ *  it has the passed in number of objects.  The size of the
+ *  cells is taken from the bounds of the template, treating
+ *  every mesh as filling the cube from -1 to 1.
+ ***********************************************************/
+bool GenerateStressScene(
+	const char* templateFilename,
+	int objectCount,
+	const STRESS_SCENE_SETTINGS& settings,
+	const char* sceneFilename,
+	STRESS_SCENE_INFO& info)
+{
+	if ((objectCount < 1) || (objectCount > g_MaxStressObjects))
+	{
+		std::cerr << "Stress scenes have from 1 to " << g_MaxStressObjects << " objects" << std::endl;
+		return(false);
+	}
+
+	SceneFile templateScene;
+	if (templateScene.Open(templateFilename) == false)
+	{
+		std::cerr << "Could not open template scene file: " << templateFilename << std::endl;
+		return(false);
+	}
+	int nodeCount = templateScene.GetCount(SCENE_SECTION_NODES);
+	int transformCount = templateScene.GetCount(SCENE_SECTION_TRANSFORMS);
+	if (nodeCount == 0)
+	{
+		std::cerr << "Template scene has no nodes: " << templateFilename << std::endl;
+		return(false);
+	}
+
+	// the tables of the template are kept as they are
+	SceneBuilder builder;
+	std::vector<int> meshes(templateScene.GetCount(SCENE_SECTION_MESHES));
+	std::vector<int> textures(templateScene.GetCount(SCENE_SECTION_TEXTURES));
+	std::vector<int> materials(templateScene.GetCount(SCENE_SECTION_MATERIALS));
+	for (int i = 0; i < (int)meshes.size(); i++)
+	{
+		meshes[i] = builder.AddMesh(templateScene.GetString(templateScene.GetMeshes()[i].name));
+	}
+	for (int i = 0; i < (int)textures.size(); i++)
+	{
+		const SCENE_FILE_TEXTURE& texture = templateScene.GetTextures()[i];
+		textures[i] = builder.AddTexture(
+			templateScene.GetString(texture.tag),
+			templateScene.GetString(texture.path));
+	}
+	for (int i = 0; i < (int)materials.size(); i++)
+	{
+		const SCENE_FILE_MATERIAL& material = templateScene.GetMaterials()[i];
+		materials[i] = builder.AddMaterial(
+			templateScene.GetString(material.tag),
+			glm::vec3(material.ambientColor[0], material.ambientColor[1], material.ambientColor[2]),
+			material.ambientStrength,
+			glm::vec3(material.diffuseColor[0], material.diffuseColor[1], material.diffuseColor[2]),
+			glm::vec3(material.specularColor[0], material.specularColor[1], material.specularColor[2]),
+			material.shininess);
+	}
+
+	// the bounds of the template decide the size of the cells
+	std::vector<glm::mat4> nodeMatrices(nodeCount, glm::mat4(1.0f));
+	glm::vec3 templateMin(1.0e30f);
+	glm::vec3 templateMax(-1.0e30f);
+	for (int i = 0; i < nodeCount; i++)
+	{
+		uint32_t transform = templateScene.GetNodes()[i].transform;
+		if (transform < (uint32_t)transformCount)
+		{
+			memcpy(&nodeMatrices[i], templateScene.GetTransforms()[transform].matrix, sizeof(glm::mat4));
+		}
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec4 point = nodeMatrices[i] * glm::vec4(
+				(corner & 1) ? 1.0f : -1.0f,
+				(corner & 2) ? 1.0f : -1.0f,
+				(corner & 4) ? 1.0f : -1.0f,
+				1.0f);
+			templateMin = glm::min(templateMin, glm::vec3(point));
+			templateMax = glm::max(templateMax, glm::vec3(point));
+		}
+	}
+	glm::vec3 templateCenter = (templateMin + templateMax) * 0.5f;
+	glm::vec3 cellSize = (templateMax - templateMin) * (1.0f + g_CellGap);
+
+	// a grid covering an area close to square, centered on the
+	// origin
+	info.copyCount = (objectCount + nodeCount - 1) / nodeCount;
+	info.columns = std::max((int)std::ceil(std::sqrt((double)info.copyCount * cellSize.z / cellSize.x)), 1);
+	info.columns = std::min(info.columns, info.copyCount);
+	info.rows = (info.copyCount + info.columns - 1) / info.columns;
+	info.boundsMin = glm::vec3(-0.5f * info.columns * cellSize.x, templateMin.y, -0.5f * info.rows * cellSize.z);
+	info.boundsMax = glm::vec3(0.5f * info.columns * cellSize.x, templateMax.y, 0.5f * info.rows * cellSize.z);
+
+	std::mt19937 generator(settings.seed);
+	int remaining = objectCount;
+	for (int copy = 0; copy < info.copyCount; copy++)
+	{
+		int column = copy % info.columns;
+		int row = copy / info.columns;
+		glm::vec3 offset(
+			info.boundsMin.x + (column + 0.5f) * cellSize.x,
+			0.0f,
+			info.boundsMin.z + (row + 0.5f) * cellSize.z);
+		offset.x += (RandomFloat(generator) * 2.0f - 1.0f) * settings.positionJitter * cellSize.x;
+		offset.z += (RandomFloat(generator) * 2.0f - 1.0f) * settings.positionJitter * cellSize.z;
+		float angle = (RandomFloat(generator) * 2.0f - 1.0f) * settings.rotationJitter;
+
+		glm::mat4 copyMatrix =
+			glm::translate(offset) *
+			glm::rotate(glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::translate(glm::vec3(-templateCenter.x, 0.0f, -templateCenter.z));
+
+		int copyNodes = std::min(remaining, nodeCount);
+		for (int i = 0; i < copyNodes; i++)
+		{
+			const SCENE_FILE_NODE& node = templateScene.GetNodes()[i];
+			int mesh = (node.mesh < meshes.size()) ? meshes[node.mesh] : 0;
+			int texture = ((node.texture >= 0) && (node.texture < (int)textures.size())) ? textures[node.texture] : -1;
+			int material = ((node.material >= 0) && (node.material < (int)materials.size())) ? materials[node.material] : -1;
+
+			if ((settings.meshMix > 0.0f) && ((node.flags & SCENE_NODE_OCCLUDER) == 0) &&
+				(meshes.empty() == false) && (RandomFloat(generator) < settings.meshMix))
+			{
+				mesh = meshes[RandomIndex(generator, (int)meshes.size())];
+			}
+			if ((settings.textureMix > 0.0f) && (texture >= 0) &&
+				(RandomFloat(generator) < settings.textureMix))
+			{
+				texture = textures[RandomIndex(generator, (int)textures.size())];
+			}
+			if ((settings.materialMix > 0.0f) && (material >= 0) &&
+				(RandomFloat(generator) < settings.materialMix))
+			{
+				material = materials[RandomIndex(generator, (int)materials.size())];
+			}
+
+			builder.AddNode(mesh, copyMatrix * nodeMatrices[i], texture, material,
+				glm::vec4(node.color[0], node.color[1], node.color[2], node.color[3]),
+				glm::vec2(node.uvScale[0], node.uvScale[1]),
+				node.flags);
+		}
+		remaining -= copyNodes;
+	}
+
+	if (builder.Write(sceneFilename) == false)
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Generated " << objectCount << " stress scene objects in " << info.copyCount
+		<< " copies (" << info.columns << " x " << info.rows << ") into " << sceneFilename << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  StressCameraPath()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StressCameraPath::StressCameraPath()
+{
+	m_groundHeight = 0.0f;
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used for choosing the points of the loop
+ *  at random heights above the passed in area, keeping
+ *  clear of its edges.
+ ***********************************************************/
+void StressCameraPath::Generate(
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax,
+	unsigned int seed,
+	int pointCount)
+{
+	std::mt19937 generator(seed);
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	glm::vec3 extent = (boundsMax - boundsMin) * 0.4f;
+
+	m_groundHeight = center.y;
+	m_points.resize(std::max(pointCount, 4));
+	for (int i = 0; i < (int)m_points.size(); i++)
+	{
+		m_points[i].x = center.x + (RandomFloat(generator) * 2.0f - 1.0f) * extent.x;
+		m_points[i].z = center.z + (RandomFloat(generator) * 2.0f - 1.0f) * extent.z;
+		m_points[i].y = boundsMax.y + g_CameraHeightMin +
+			RandomFloat(generator) * (g_CameraHeightMax - g_CameraHeightMin);
+	}
+}
+
+/***********************************************************
+ *  GetPose()
+ *
+ *  This method is used for getting the camera position at a
+ *  time along the loop, looking down at the ground a short
+ *  distance ahead in the direction it is moving.
+ ***********************************************************/
+void StressCameraPath::GetPose(
+	float time,
+	glm::vec3& position,
+	glm::vec3& target) const
+{
+	position = GetPoint(time);
+	glm::vec3 direction = GetPoint(time + 0.001f) - position;
+	direction.y = 0.0f;
+	if (glm::length(direction) < 0.0001f)
+	{
+		direction = glm::vec3(0.0f, 0.0f, -1.0f);
+	}
+
+	target = position + glm::normalize(direction) * g_CameraLookDistance;
+	target.y = m_groundHeight;
+}
+
+/***********************************************************
+ *  GetPoint()
+ *
+ *  This method is used for getting a point on the closed
+ *  Catmull-Rom curve through the loop points.
+ ***********************************************************/
+glm::vec3 StressCameraPath::GetPoint(float time) const
+{
+	if (m_points.empty())
+	{
+		return(glm::vec3(0.0f));
+	}
+
+	int count = (int)m_points.size();
+	float segment = (time - std::floor(time)) * count;
+	int index = std::min((int)segment, count - 1);
+	float t = segment - index;
+
+	const glm::vec3& p0 = m_points[(index + count - 1) % count];
+	const glm::vec3& p1 = m_points[index];
+	const glm::vec3& p2 = m_points[(index + 1) % count];
+	const glm::vec3& p3 = m_points[(index + 2) % count];
+
+	float t2 = t * t;
+	float t3 = t2 * t;
+	return(0.5f * ((2.0f * p1) +
+		(p2 - p0) * t +
+		(2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+		(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3));
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscene.h
+// ============
+// generated scenes of any size and a repeatable camera path through them
+//
+//  A stress scene repeats the nodes of a template scene, normally the
+//  still life, on a grid of cells that is close to square, until it has
+//  the requested number of objects - the last copy is cut short when the
+//  count is not a multiple of the template size.  Each copy is moved and
+//  turned a little at random, and a chosen fraction of the objects draw
+//  another mesh, texture or material of the template than their own.
+//  All the random choices come from one seed, so the same settings always
+//  give the same scene and the same camera path, and the frame times of
+//  different runs can be compared.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// how a stress scene is generated
+struct STRESS_SCENE_SETTINGS
+{
+	// seed of all the random choices
+	unsigned int seed = 1;
+	// largest random move of each copy, as a fraction of the
+	// size of its cell
+	float positionJitter = 0.05f;
+	// largest random turn of each copy around the up axis,
+	// in degrees
+	float rotationJitter = 10.0f;
+	// fraction of the objects, from 0 to 1, that draw a random
+	// mesh, texture or material of the template instead of
+	// their own - the large occluder objects keep their meshes
+	float meshMix = 0.0f;
+	float textureMix = 0.0f;
+	float materialMix = 0.0f;
+};
+
+// the area covered by a generated stress scene
+struct STRESS_SCENE_INFO
+{
+	int copyCount;
+	int columns;
+	int rows;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+// write a scene file with the passed in number of objects,
+// repeating the nodes of a cooked template scene file
+bool GenerateStressScene(
+	const char* templateFilename,
+	int objectCount,
+	const STRESS_SCENE_SETTINGS& settings,
+	const char* sceneFilename,
+	STRESS_SCENE_INFO& info);
+
+/***********************************************************
+ *  StressCameraPath
+ *
+ *  This class contains the code for moving the camera along
+ *  a closed loop of random points above a stress scene.
+ ***********************************************************/
+class StressCameraPath
+{
+public:
+	// constructor
+	StressCameraPath();
+
+	// choose the points of the loop above the passed in area
+	void Generate(
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		unsigned int seed,
+		int pointCount);
+
+	// camera position and the point it looks at, for a time
+	// from 0 to 1 along the loop
+	void GetPose(
+		float time,
+		glm::vec3& position,
+		glm::vec3& target) const;
+
+private:
+	std::vector<glm::vec3> m_points;
+	// height the camera looks down to
+	float m_groundHeight;
+
+	// a point on the smooth curve through the loop points
+	glm::vec3 GetPoint(float time) const;
+};
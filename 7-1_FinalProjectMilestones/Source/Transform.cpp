@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// transform.cpp
+// ============
+// model matrix of a scene object built in closed form
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Transform.h"
+
+#include <cmath>
+
+/***********************************************************
+ *  ComposeMatrix()
+ *
+ *  This function is used for building the model matrix
+ *  T * Rx * Ry * Rz * S directly from the sines and cosines
+ *  of the three angles.  The upper 3x3 part is the product
+ *  of the three rotations with each column multiplied by
+ *  its scale, and the last column is the position.
+ ***********************************************************/
+glm::mat4 Transform::ComposeMatrix(
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegreesXYZ,
+	const glm::vec3& positionXYZ)
+{
+	glm::vec3 angles = glm::radians(rotationDegreesXYZ);
+	float sinX = std::sin(angles.x), cosX = std::cos(angles.x);
+	float sinY = std::sin(angles.y), cosY = std::cos(angles.y);
+	float sinZ = std::sin(angles.z), cosZ = std::cos(angles.z);
+	glm::mat4 matrix;
+
+	// glm matrices are indexed by column, then by row
+	matrix[0] = glm::vec4(
+		cosY * cosZ,
+		cosX * sinZ + sinX * sinY * cosZ,
+		sinX * sinZ - cosX * sinY * cosZ,
+		0.0f) * scaleXYZ.x;
+	matrix[1] = glm::vec4(
+		-cosY * sinZ,
+		cosX * cosZ - sinX * sinY * sinZ,
+		sinX * cosZ + cosX * sinY * sinZ,
+		0.0f) * scaleXYZ.y;
+	matrix[2] = glm::vec4(
+		sinY,
+		-sinX * cosY,
+		cosX * cosY,
+		0.0f) * scaleXYZ.z;
+	matrix[3] = glm::vec4(positionXYZ, 1.0f);
+
+	return(matrix);
+}
@@ -0,0 +1,31 @@
+///////////////////////////////////////////////////////////////////////////////
+// transform.h
+// ============
+// model matrix of a scene object built in closed form
+//
+//  The model matrix is built from the sines and cosines of the three
+//  Euler angles rather than by multiplying five separate 4x4 matrices.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  Transform
+ *
+ *  This namespace contains the closed form composition of
+ *  a model matrix from the transformation values of one
+ *  scene object.  The matrices of the scene are composed
+ *  in batches by TransformBatch, which uses this when it is
+ *  not built for AVX2.
+ ***********************************************************/
+namespace Transform
+{
+	// build translation * rotationX * rotationY * rotationZ * scale
+	// in closed form, with the rotations given in degrees
+	glm::mat4 ComposeMatrix(
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegreesXYZ,
+		const glm::vec3& positionXYZ);
+}
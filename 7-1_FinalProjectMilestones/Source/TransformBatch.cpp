@@ -0,0 +1,344 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.cpp
+// ============
+// many object transforms in structure-of-arrays form, composed in bulk
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBatch.h"
+#include "Transform.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_BATCH_AVX2
+#endif
+
+// declaration of global variables
+namespace
+{
+	// number of transforms composed together by the SIMD kernel
+	const int g_GroupSize = 8;
+	// alignment of the arrays in floats (32 bytes)
+	const int g_AlignFloats = 8;
+	// number of component arrays before the matrices
+	const int g_ComponentArrays = 9;
+
+#if defined(TRANSFORM_BATCH_AVX2)
+	/***********************************************************
+	 *  SinCos8()
+	 *
+	 *  This function is used for computing the sine and cosine
+	 *  of 8 angles in radians at once.  The angle is reduced to
+	 *  the range -pi/4 to pi/4 around the nearest multiple of
+	 *  pi/2, and the sine and cosine are then evaluated with
+	 *  the minimax polynomials of the Cephes sinf and cosf.
+	 ***********************************************************/
+	void SinCos8(__m256 x, __m256& sinOut, __m256& cosOut)
+	{
+		const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+		const __m256 fourOverPi = _mm256_set1_ps(1.27323954473516f);
+		const __m256 minusDP1 = _mm256_set1_ps(-0.78515625f);
+		const __m256 minusDP2 = _mm256_set1_ps(-2.4187564849853515625e-4f);
+		const __m256 minusDP3 = _mm256_set1_ps(-3.77489497744594108e-8f);
+
+		// work with the absolute value and restore the sign later
+		__m256 sinSign = _mm256_and_ps(x, signMask);
+		x = _mm256_andnot_ps(signMask, x);
+
+		// octant of the angle, rounded up to an even number
+		__m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, fourOverPi));
+		octant = _mm256_add_epi32(octant, _mm256_set1_epi32(1));
+		octant = _mm256_and_si256(octant, _mm256_set1_epi32(~1));
+		__m256 y = _mm256_cvtepi32_ps(octant);
+
+		__m256 sinSwap = _mm256_castsi256_ps(_mm256_slli_epi32(
+			_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29));
+		__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+			_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+		__m256 polyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+			_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+		sinSign = _mm256_xor_ps(sinSign, sinSwap);
+
+		// subtract the multiple of pi/4 in three parts, for precision
+		x = _mm256_add_ps(x, _mm256_mul_ps(y, minusDP1));
+		x = _mm256_add_ps(x, _mm256_mul_ps(y, minusDP2));
+		x = _mm256_add_ps(x, _mm256_mul_ps(y, minusDP3));
+		__m256 z = _mm256_mul_ps(x, x);
+
+		// cosine polynomial
+		__m256 cosPoly = _mm256_set1_ps(2.443315711809948e-5f);
+		cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(-1.388731625493765e-3f));
+		cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(4.166664568298827e-2f));
+		cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+		cosPoly = _mm256_sub_ps(cosPoly, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+		cosPoly = _mm256_add_ps(cosPoly, _mm256_set1_ps(1.0f));
+
+		// sine polynomial
+		__m256 sinPoly = _mm256_set1_ps(-1.9515295891e-4f);
+		sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(8.3321608736e-3f));
+		sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(-1.6666654611e-1f));
+		sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sinPoly, z), x), x);
+
+		// pick the polynomial for each octant
+		sinOut = _mm256_xor_ps(_mm256_blendv_ps(cosPoly, sinPoly, polyMask), sinSign);
+		cosOut = _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, polyMask), cosSign);
+	}
+
+	/***********************************************************
+	 *  Transpose8x8()
+	 *
+	 *  This function is used for transposing 8 rows of 8
+	 *  floats, so 8 component vectors become 8 runs of values
+	 *  that belong to one transform each.
+	 ***********************************************************/
+	void Transpose8x8(__m256 rows[8])
+	{
+		__m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+		__m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+		__m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+		__m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+		__m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+		__m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+		__m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+		__m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+
+		__m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+		rows[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+		rows[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+		rows[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+		rows[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+		rows[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+		rows[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+		rows[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+		rows[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+	}
+#endif
+}
+
+/***********************************************************
+ *  TransformBatch()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformBatch::TransformBatch()
+{
+	m_count = 0;
+	m_capacity = 0;
+	m_bDirty = false;
+	m_pScaleX = NULL;
+	m_pScaleY = NULL;
+	m_pScaleZ = NULL;
+	m_pRotationX = NULL;
+	m_pRotationY = NULL;
+	m_pRotationZ = NULL;
+	m_pPositionX = NULL;
+	m_pPositionY = NULL;
+	m_pPositionZ = NULL;
+	m_pMatrices = NULL;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for setting the number of transforms
+ *  and laying out the aligned arrays that hold them.
+ ***********************************************************/
+void TransformBatch::Resize(int count)
+{
+	m_count = (count > 0) ? count : 0;
+	m_capacity = ((m_count + g_GroupSize - 1) / g_GroupSize) * g_GroupSize;
+
+	// one block for all the arrays, with room to align its start -
+	// every array length is a multiple of the alignment
+	m_storage.assign((size_t)m_capacity * (g_ComponentArrays + 16) + g_AlignFloats, 0.0f);
+	float* pBase = m_storage.data();
+	while ((reinterpret_cast<uintptr_t>(pBase) % (g_AlignFloats * sizeof(float))) != 0)
+	{
+		pBase++;
+	}
+
+	float** componentArrays[g_ComponentArrays] = {
+		&m_pScaleX, &m_pScaleY, &m_pScaleZ,
+		&m_pRotationX, &m_pRotationY, &m_pRotationZ,
+		&m_pPositionX, &m_pPositionY, &m_pPositionZ };
+	for (int i = 0; i < g_ComponentArrays; i++)
+	{
+		*componentArrays[i] = pBase + (size_t)i * m_capacity;
+	}
+	m_pMatrices = pBase + (size_t)g_ComponentArrays * m_capacity;
+
+	// start every transform, including the padding, as the identity
+	for (int i = 0; i < m_capacity; i++)
+	{
+		m_pScaleX[i] = 1.0f;
+		m_pScaleY[i] = 1.0f;
+		m_pScaleZ[i] = 1.0f;
+	}
+	m_bDirty = true;
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  This method is used for setting the values of one of the
+ *  transforms in the batch.
+ ***********************************************************/
+void TransformBatch::Set(
+	int index,
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegreesXYZ,
+	const glm::vec3& positionXYZ)
+{
+	if ((index < 0) || (index >= m_count))
+	{
+		return;
+	}
+
+	glm::vec3 rotation = glm::radians(rotationDegreesXYZ);
+	if ((m_pScaleX[index] != scaleXYZ.x) || (m_pScaleY[index] != scaleXYZ.y) ||
+		(m_pScaleZ[index] != scaleXYZ.z) || (m_pRotationX[index] != rotation.x) ||
+		(m_pRotationY[index] != rotation.y) || (m_pRotationZ[index] != rotation.z) ||
+		(m_pPositionX[index] != positionXYZ.x) || (m_pPositionY[index] != positionXYZ.y) ||
+		(m_pPositionZ[index] != positionXYZ.z))
+	{
+		m_pScaleX[index] = scaleXYZ.x;
+		m_pScaleY[index] = scaleXYZ.y;
+		m_pScaleZ[index] = scaleXYZ.z;
+		m_pRotationX[index] = rotation.x;
+		m_pRotationY[index] = rotation.y;
+		m_pRotationZ[index] = rotation.z;
+		m_pPositionX[index] = positionXYZ.x;
+		m_pPositionY[index] = positionXYZ.y;
+		m_pPositionZ[index] = positionXYZ.z;
+		m_bDirty = true;
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for composing the matrices when any
+ *  of the transforms changed since the last update.
+ ***********************************************************/
+void TransformBatch::Update()
+{
+	if (m_bDirty == true)
+	{
+		ComposeAll();
+	}
+}
+
+/***********************************************************
+ *  ComposeAll()
+ *
+ *  This method is used for composing the matrices of all
+ *  the transforms in the batch.
+ ***********************************************************/
+void TransformBatch::ComposeAll()
+{
+	ComposeRange(0, m_count);
+	m_bDirty = false;
+}
+
+/***********************************************************
+ *  ComposeRange()
+ *
+ *  This method is used for composing the model matrices
+ *  T * Rx * Ry * Rz * S of a range of the transforms, in
+ *  the same closed form as Transform::ComposeMatrix().
+ ***********************************************************/
+void TransformBatch::ComposeRange(int first, int last)
+{
+	if (last > m_count)
+	{
+		last = m_count;
+	}
+
+#if defined(TRANSFORM_BATCH_AVX2)
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	// whole groups of 8, reaching into the padding at the end
+	for (int i = first; i < last; i += g_GroupSize)
+	{
+		__m256 sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCos8(_mm256_load_ps(m_pRotationX + i), sinX, cosX);
+		SinCos8(_mm256_load_ps(m_pRotationY + i), sinY, cosY);
+		SinCos8(_mm256_load_ps(m_pRotationZ + i), sinZ, cosZ);
+		__m256 scaleX = _mm256_load_ps(m_pScaleX + i);
+		__m256 scaleY = _mm256_load_ps(m_pScaleY + i);
+		__m256 scaleZ = _mm256_load_ps(m_pScaleZ + i);
+		__m256 sinXsinY = _mm256_mul_ps(sinX, sinY);
+		__m256 cosXsinY = _mm256_mul_ps(cosX, sinY);
+
+		// the 16 matrix elements in column-major order, for 8 transforms
+		__m256 columns[16];
+		columns[0] = _mm256_mul_ps(_mm256_mul_ps(cosY, cosZ), scaleX);
+		columns[1] = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(cosX, sinZ), _mm256_mul_ps(sinXsinY, cosZ)), scaleX);
+		columns[2] = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(sinX, sinZ), _mm256_mul_ps(cosXsinY, cosZ)), scaleX);
+		columns[3] = zero;
+		columns[4] = _mm256_mul_ps(_mm256_sub_ps(zero, _mm256_mul_ps(cosY, sinZ)), scaleY);
+		columns[5] = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(cosX, cosZ), _mm256_mul_ps(sinXsinY, sinZ)), scaleY);
+		columns[6] = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(sinX, cosZ), _mm256_mul_ps(cosXsinY, sinZ)), scaleY);
+		columns[7] = zero;
+		columns[8] = _mm256_mul_ps(sinY, scaleZ);
+		columns[9] = _mm256_mul_ps(_mm256_sub_ps(zero, _mm256_mul_ps(sinX, cosY)), scaleZ);
+		columns[10] = _mm256_mul_ps(_mm256_mul_ps(cosX, cosY), scaleZ);
+		columns[11] = zero;
+		columns[12] = _mm256_load_ps(m_pPositionX + i);
+		columns[13] = _mm256_load_ps(m_pPositionY + i);
+		columns[14] = _mm256_load_ps(m_pPositionZ + i);
+		columns[15] = one;
+
+		// turn the 16 element vectors into 8 consecutive matrices -
+		// each matrix is 64 bytes, so both halves stay aligned
+		Transpose8x8(columns);
+		Transpose8x8(columns + 8);
+		float* pOut = m_pMatrices + (size_t)i * 16;
+		for (int j = 0; j < g_GroupSize; j++)
+		{
+			_mm256_store_ps(pOut + j * 16, columns[j]);
+			_mm256_store_ps(pOut + j * 16 + 8, columns[8 + j]);
+		}
+	}
+#else
+	for (int i = first; i < last; i++)
+	{
+		glm::mat4 matrix = Transform::ComposeMatrix(
+			glm::vec3(m_pScaleX[i], m_pScaleY[i], m_pScaleZ[i]),
+			glm::degrees(glm::vec3(m_pRotationX[i], m_pRotationY[i], m_pRotationZ[i])),
+			glm::vec3(m_pPositionX[i], m_pPositionY[i], m_pPositionZ[i]));
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				m_pMatrices[(size_t)i * 16 + column * 4 + row] = matrix[column][row];
+			}
+		}
+	}
+#endif
+}
+
+/***********************************************************
+ *  GetMatrix()
+ *
+ *  This method is used for getting the composed matrix of
+ *  one of the transforms.
+ ***********************************************************/
+glm::mat4 TransformBatch::GetMatrix(int index) const
+{
+	glm::mat4 matrix;
+
+	memcpy(&matrix[0][0], m_pMatrices + (size_t)index * 16, sizeof(float) * 16);
+	return(matrix);
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.h
+// ============
+// many object transforms in structure-of-arrays form, composed in bulk
+//
+//  The scale, rotation and position values are kept in separate aligned
+//  arrays, one per component, and all the model matrices are composed
+//  in one pass into a single contiguous buffer of column-major 4x4
+//  matrices that can be uploaded to the GPU as one block.  When the
+//  compiler targets AVX2 (/arch:AVX2 or -mavx2), eight matrices are
+//  composed at a time with vectorized sine and cosine; otherwise each
+//  matrix is composed with Transform::ComposeMatrix().
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TransformBatch
+ *
+ *  This class contains the transformation values and model
+ *  matrices of a group of objects that are updated together.
+ ***********************************************************/
+class TransformBatch
+{
+public:
+	// constructor
+	TransformBatch();
+
+	// set the number of transforms in the batch - all the
+	// transforms are reset to the identity
+	void Resize(int count);
+	int GetCount() const { return(m_count); }
+
+	// set the values of one transform, with the rotations
+	// in degrees - the batch is only marked for updating
+	// when a value actually changes
+	void Set(
+		int index,
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegreesXYZ,
+		const glm::vec3& positionXYZ);
+
+	// compose the matrices of all the transforms, if any of
+	// them changed since the last update
+	void Update();
+	// compose the matrices of all the transforms
+	void ComposeAll();
+	// compose the matrices of the transforms from first up to
+	// but not including last, so the work can be split into
+	// ranges - first should be a multiple of 8
+	void ComposeRange(int first, int last);
+
+	// the composed matrices, 16 floats per transform
+	const float* GetMatrixData() const { return(m_pMatrices); }
+	glm::mat4 GetMatrix(int index) const;
+
+private:
+	int m_count;
+	// number of transforms the arrays can hold, rounded up
+	// to a whole number of SIMD groups
+	int m_capacity;
+	bool m_bDirty;
+
+	// storage for the component arrays and matrices, with
+	// room to align the start of each array
+	std::vector<float> m_storage;
+	float* m_pScaleX;
+	float* m_pScaleY;
+	float* m_pScaleZ;
+	float* m_pRotationX;
+	float* m_pRotationY;
+	float* m_pRotationZ;
+	float* m_pPositionX;
+	float* m_pPositionY;
+	float* m_pPositionZ;
+	float* m_pMatrices;
+};
@@ -0,0 +1,275 @@
+///////////////////////////////////////////////////////////////////////////////
+// transparencypass.cpp
+// ============
+// weighted blended order independent transparency
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransparencyPass.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_WeightedTransparencyName = "bWeightedTransparency";
+	const char* g_AccumulationTextureName = "accumulationTexture";
+	const char* g_RevealageTextureName = "revealageTexture";
+
+	// texture units of the two targets, above the units of the
+	// scene textures so those never have to be bound again
+	const int g_AccumulationUnit = 16;
+	const int g_RevealageUnit = 17;
+}
+
+/***********************************************************
+ *  TransparencyPass()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransparencyPass::TransparencyPass(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_compositeShader.m_programID = 0;
+	m_emptyVAO = 0;
+	m_framebuffer = 0;
+	m_accumulationTexture = 0;
+	m_revealageTexture = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+	m_bActive = false;
+	m_bFailed = false;
+}
+
+/***********************************************************
+ *  ~TransparencyPass()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransparencyPass::~TransparencyPass()
+{
+	DestroyTargets();
+
+	if (m_emptyVAO != 0)
+	{
+		glDeleteVertexArrays(1, &m_emptyVAO);
+	}
+	if (m_compositeShader.m_programID != 0)
+	{
+		glDeleteProgram(m_compositeShader.m_programID);
+	}
+	m_pShaderManager = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the shader that blends
+ *  the pass over the window.  The targets are created when
+ *  the pass is first used, at the size of the viewport.
+ ***********************************************************/
+void TransparencyPass::Initialize()
+{
+	m_compositeShader.LoadShaders(
+		"../../Utilities/shaders/transparencyVertexShader.glsl",
+		"../../Utilities/shaders/transparencyFragmentShader.glsl");
+	if (m_compositeShader.m_programID != 0)
+	{
+		m_compositeShader.use();
+		m_compositeShader.setSampler2DValue(g_AccumulationTextureName, g_AccumulationUnit);
+		m_compositeShader.setSampler2DValue(g_RevealageTextureName, g_RevealageUnit);
+	}
+
+	glGenVertexArrays(1, &m_emptyVAO);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->use();
+		m_pShaderManager->setBoolValue(g_WeightedTransparencyName, false);
+	}
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used for switching the drawing over to
+ *  the offscreen targets.  The depth of the opaque objects
+ *  is copied from the window and only tested, and the
+ *  blending of each target is set so the order of the draws
+ *  does not matter.  The scene shader program must be in
+ *  use.
+ ***********************************************************/
+bool TransparencyPass::Begin()
+{
+	if ((m_bActive == true) || (m_bFailed == true) || (m_compositeShader.m_programID == 0))
+	{
+		return(m_bActive);
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	bool bNewTargets = (viewport[2] != m_width) || (viewport[3] != m_height);
+	if ((bNewTargets == true) && (CreateTargets(viewport[2], viewport[3]) == false))
+	{
+		std::cerr << "Could not create the weighted transparency targets, the translucent objects are blended directly" << std::endl;
+		m_bFailed = true;
+		return(false);
+	}
+
+	// the depth formats of the window and the pass must match
+	// for the copy, which is checked the first time
+	if (bNewTargets == true)
+	{
+		while (glGetError() != GL_NO_ERROR)
+		{
+		}
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffer);
+	glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	if ((bNewTargets == true) && (glGetError() != GL_NO_ERROR))
+	{
+		std::cerr << "Could not copy the window depth for the weighted transparency, the translucent objects are blended directly" << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		m_bFailed = true;
+		return(false);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+	// nothing added and everything revealed
+	const GLfloat accumulationClear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat revealageClear[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glClearBufferfv(GL_COLOR, 0, accumulationClear);
+	glClearBufferfv(GL_COLOR, 1, revealageClear);
+
+	// the colors are added up and the transparencies multiplied
+	glDepthMask(GL_FALSE);
+	glBlendFunci(0, GL_ONE, GL_ONE);
+	glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue(g_WeightedTransparencyName, true);
+	}
+
+	m_bActive = true;
+	return(true);
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method is used for blending the weighted average
+ *  color of the translucent objects over the window with a
+ *  full screen triangle, and restoring the drawing state of
+ *  the opaque objects with the scene shader program in use.
+ ***********************************************************/
+void TransparencyPass::End()
+{
+	if (m_bActive == false)
+	{
+		return;
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue(g_WeightedTransparencyName, false);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_DEPTH_TEST);
+	glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+	m_compositeShader.use();
+	glBindVertexArray(m_emptyVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+
+	glEnable(GL_DEPTH_TEST);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->use();
+	}
+
+	m_bActive = false;
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for creating the accumulation and
+ *  revealage targets and the depth buffer of the pass.  The
+ *  targets stay bound to their own texture units.
+ ***********************************************************/
+bool TransparencyPass::CreateTargets(int width, int height)
+{
+	DestroyTargets();
+	m_width = width;
+	m_height = height;
+
+	glActiveTexture(GL_TEXTURE0 + g_AccumulationUnit);
+	glGenTextures(1, &m_accumulationTexture);
+	glBindTexture(GL_TEXTURE_2D, m_accumulationTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glActiveTexture(GL_TEXTURE0 + g_RevealageUnit);
+	glGenTextures(1, &m_revealageTexture);
+	glBindTexture(GL_TEXTURE_2D, m_revealageTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, width, height, 0, GL_RED, GL_HALF_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glActiveTexture(GL_TEXTURE0);
+
+	// the same format as the depth buffer of the window
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumulationTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_revealageTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return(bComplete);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method is used for freeing the targets of the pass.
+ ***********************************************************/
+void TransparencyPass::DestroyTargets()
+{
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (m_accumulationTexture != 0)
+	{
+		glDeleteTextures(1, &m_accumulationTexture);
+		m_accumulationTexture = 0;
+	}
+	if (m_revealageTexture != 0)
+	{
+		glDeleteTextures(1, &m_revealageTexture);
+		m_revealageTexture = 0;
+	}
+	if (m_depthBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+	m_width = 0;
+	m_height = 0;
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// transparencypass.h
+// ============
+// weighted blended order independent transparency
+//
+//  The translucent objects are drawn after the opaque ones into two
+//  offscreen targets instead of the window: the sum of their colors,
+//  premultiplied by alpha and scaled by a weight that falls off with
+//  depth, and the product of their transparencies.  Both are built with
+//  blending that does not depend on the order of the draws, so the
+//  translucent objects can be sorted by state and batched like opaque
+//  ones.  The depth buffer of the window is copied into the pass first,
+//  so the opaque objects still hide the translucent ones behind them, and
+//  a full screen triangle then blends the weighted average color over
+//  the window.  The result is an approximation - layers of very
+//  different depths are not ordered exactly - which suits glass, smoke
+//  and overlays.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+/***********************************************************
+ *  TransparencyPass
+ *
+ *  This class contains the code for the offscreen targets
+ *  of the weighted blended transparency and for combining
+ *  them with the window.
+ ***********************************************************/
+class TransparencyPass
+{
+public:
+	// constructor
+	TransparencyPass(ShaderManager* pShaderManager);
+	// destructor
+	~TransparencyPass();
+
+	// load the shader that combines the pass with the window
+	void Initialize();
+
+	// switch the drawing over to the offscreen targets - false
+	// if the pass is not supported, in which case the objects
+	// are drawn into the window as they are
+	bool Begin();
+	// blend the result over the window and switch the drawing
+	// back to it
+	void End();
+	bool IsActive() const { return(m_bActive); }
+
+private:
+	// pointer to the shader manager of the scene shaders
+	ShaderManager* m_pShaderManager;
+	// program that combines the targets with the window
+	ShaderManager m_compositeShader;
+	// empty vertex array for the full screen triangle
+	GLuint m_emptyVAO;
+
+	// offscreen framebuffer, its accumulation and revealage
+	// targets and its depth buffer
+	GLuint m_framebuffer;
+	GLuint m_accumulationTexture;
+	GLuint m_revealageTexture;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+
+	bool m_bActive;
+	// set once the pass failed, so it is not tried again
+	bool m_bFailed;
+
+	// create the targets at the size of the viewport
+	bool CreateTargets(int width, int height);
+	void DestroyTargets();
+};
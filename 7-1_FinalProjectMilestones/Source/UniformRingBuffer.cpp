@@ -0,0 +1,311 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformringbuffer.cpp
+// ============
+// persistently mapped ring of uniform buffer memory for per-draw data
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformRingBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// smallest section, so a simple scene never has to grow it
+	const size_t g_MinimumSectionSize = 64 * 1024;
+	// largest section - a frame with more draw data than this
+	// wraps on to the next section instead
+	const size_t g_MaximumSectionSize = 4 * 1024 * 1024;
+	// nanoseconds to wait for a fence before checking again
+	const GLuint64 g_FenceTimeout = 1000000;
+}
+
+/***********************************************************
+ *  UniformRingBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+UniformRingBuffer::UniformRingBuffer()
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_bPersistent = false;
+	for (int i = 0; i < SECTION_COUNT; i++)
+	{
+		m_fences[i] = 0;
+	}
+	m_section = 0;
+	m_sectionSize = 0;
+	m_offset = 0;
+	m_alignment = 256;
+	m_bFailed = false;
+}
+
+/***********************************************************
+ *  ~UniformRingBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+UniformRingBuffer::~UniformRingBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting the data of a new
+ *  frame in the next section of the ring.  The section was
+ *  normally last used by an earlier frame, so its fence has
+ *  signaled already and there is no wait.
+ ***********************************************************/
+void UniformRingBuffer::BeginFrame(size_t requiredSize)
+{
+	// grow to the next power of two, so a slowly growing scene
+	// does not recreate the buffer every frame, but never past
+	// the largest section
+	size_t sectionSize = g_MinimumSectionSize;
+	while ((sectionSize < requiredSize) && (sectionSize < g_MaximumSectionSize))
+	{
+		sectionSize *= 2;
+	}
+
+	if ((m_bFailed == false) && ((m_buffer == 0) || (sectionSize > m_sectionSize)))
+	{
+		Destroy();
+		if (Create(sectionSize) == false)
+		{
+			std::cerr << "Could not allocate " << sectionSize * SECTION_COUNT
+				<< " bytes for the per-draw uniform buffer, nothing is drawn" << std::endl;
+			m_bFailed = true;
+		}
+	}
+
+	if (m_buffer != 0)
+	{
+		m_section = (m_section + 1) % SECTION_COUNT;
+		WaitForSection(m_section);
+		m_offset = 0;
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing a fence after the draws
+ *  that read the current section.
+ ***********************************************************/
+void UniformRingBuffer::EndFrame()
+{
+	if (m_buffer != 0)
+	{
+		m_fences[m_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+/***********************************************************
+ *  NextSection()
+ *
+ *  This method is used for closing the current section with
+ *  a fence after the draws that read it, and moving on to
+ *  the next section once the GPU has finished reading it.
+ ***********************************************************/
+void UniformRingBuffer::NextSection()
+{
+	m_fences[m_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_section = (m_section + 1) % SECTION_COUNT;
+	WaitForSection(m_section);
+	m_offset = 0;
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for copying a block of data into the
+ *  current section, at the next aligned offset.  A full
+ *  section is closed and the data goes to the start of the
+ *  next one, which may wait for the GPU when a frame fills
+ *  more than all the sections.
+ ***********************************************************/
+GLintptr UniformRingBuffer::Write(const void* pData, size_t size)
+{
+	size_t alignedSize = GetAlignedSize(size);
+	if ((m_buffer == 0) || (alignedSize > m_sectionSize))
+	{
+		return(-1);
+	}
+	if (m_offset + alignedSize > m_sectionSize)
+	{
+		NextSection();
+	}
+
+	size_t offset = m_section * m_sectionSize + m_offset;
+	m_offset += alignedSize;
+
+	if (m_bPersistent == true)
+	{
+		memcpy(m_pMapped + offset, pData, size);
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, pData);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	return((GLintptr)offset);
+}
+
+/***********************************************************
+ *  BindRange()
+ *
+ *  This method is used for binding a slice of the buffer to
+ *  the passed in uniform block binding.
+ ***********************************************************/
+void UniformRingBuffer::BindRange(GLuint bindingIndex, GLintptr offset, size_t size) const
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, bindingIndex, m_buffer, offset, size);
+}
+
+/***********************************************************
+ *  GetAlignedSize()
+ *
+ *  This method is used for rounding a block size up to the
+ *  uniform buffer offset alignment.
+ ***********************************************************/
+size_t UniformRingBuffer::GetAlignedSize(size_t size) const
+{
+	return(((size + m_alignment - 1) / m_alignment) * m_alignment);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the buffer, with
+ *  immutable storage that stays mapped when it is
+ *  available.  Errors already pending are cleared, so an
+ *  allocation that fails is seen and the buffer is left
+ *  out.
+ ***********************************************************/
+bool UniformRingBuffer::Create(size_t sectionSize)
+{
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_alignment);
+	if (m_alignment <= 0)
+	{
+		m_alignment = 256;
+	}
+
+	m_sectionSize = GetAlignedSize(sectionSize);
+	m_bPersistent = (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+	while (glGetError() != GL_NO_ERROR)
+	{
+	}
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	if (m_bPersistent == true)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_UNIFORM_BUFFER, m_sectionSize * SECTION_COUNT, NULL, flags);
+		if (glGetError() == GL_NO_ERROR)
+		{
+			m_pMapped = (unsigned char*)glMapBufferRange(
+				GL_UNIFORM_BUFFER, 0, m_sectionSize * SECTION_COUNT, flags);
+		}
+	}
+	else
+	{
+		glBufferData(GL_UNIFORM_BUFFER, m_sectionSize * SECTION_COUNT, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// fall back to glBufferSubData() if the storage or the
+	// mapping failed
+	if ((m_bPersistent == true) && (NULL == m_pMapped))
+	{
+		while (glGetError() != GL_NO_ERROR)
+		{
+		}
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+		m_bPersistent = false;
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, m_sectionSize * SECTION_COUNT, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	m_section = 0;
+	m_offset = 0;
+
+	// without any storage every write fails, and the draws
+	// that need it are skipped
+	if ((m_bPersistent == false) && (glGetError() != GL_NO_ERROR))
+	{
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+		m_sectionSize = 0;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for deleting the buffer once the GPU
+ *  has finished with all of its sections.
+ ***********************************************************/
+void UniformRingBuffer::Destroy()
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < SECTION_COUNT; i++)
+	{
+		WaitForSection(i);
+	}
+
+	if (NULL != m_pMapped)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		m_pMapped = NULL;
+	}
+	glDeleteBuffers(1, &m_buffer);
+	m_buffer = 0;
+	m_sectionSize = 0;
+}
+
+/***********************************************************
+ *  WaitForSection()
+ *
+ *  This method is used for waiting on the fence of a
+ *  section, flushing the commands before the first wait so
+ *  the fence is sure to be reached.
+ ***********************************************************/
+void UniformRingBuffer::WaitForSection(int section)
+{
+	if (m_fences[section] == 0)
+	{
+		return;
+	}
+
+	GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true)
+	{
+		GLenum result = glClientWaitSync(m_fences[section], waitFlags, g_FenceTimeout);
+		if ((result == GL_ALREADY_SIGNALED) || (result == GL_CONDITION_SATISFIED) || (result == GL_WAIT_FAILED))
+		{
+			break;
+		}
+		waitFlags = 0;
+	}
+
+	glDeleteSync(m_fences[section]);
+	m_fences[section] = 0;
+}
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformringbuffer.h
+// ============
+// persistently mapped ring of uniform buffer memory for per-draw data
+//
+//  One uniform buffer is split into three sections.  The CPU writes the
+//  data of every draw into the current section with a plain copy through
+//  a pointer that stays mapped for the life of the buffer
+//  (GL_MAP_PERSISTENT_BIT and GL_MAP_COHERENT_BIT), and each draw binds
+//  its own slice of the section with glBindBufferRange().  Every frame
+//  starts a new section, and a section that fills up during a frame is
+//  closed and writing wraps on to the next one, so the sections have a
+//  fixed largest size however many draws a frame has.  A fence is placed
+//  after the last draw that read a section, and the section is only
+//  written again once that fence has signaled, so the CPU never
+//  overwrites data the GPU is still reading.  Without OpenGL 4.4 or
+//  ARB_buffer_storage each write becomes a glBufferSubData() call
+//  instead.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// uniform block bindings shared by the shaders and the code
+enum UniformBlockBinding
+{
+	// the DrawData block, bound to a slice of the ring per draw
+	DRAW_DATA_BINDING = 0
+};
+
+/***********************************************************
+ *  DRAW_UNIFORMS
+ *
+ *  This structure matches the std140 layout of the DrawData
+ *  block in the vertex and fragment shaders.
+ ***********************************************************/
+struct DRAW_UNIFORMS
+{
+	glm::mat4 model;
+	glm::vec4 objectColor;
+	glm::vec2 UVscale;
+	int bUseTexture;
+	int materialIndex;
+};
+
+/***********************************************************
+ *  MATERIAL_UNIFORMS
+ *
+ *  This structure matches the std430 layout of one entry
+ *  of the Materials buffer in the fragment shader.
+ ***********************************************************/
+struct MATERIAL_UNIFORMS
+{
+	glm::vec3 ambientColor;
+	float ambientStrength;
+	glm::vec3 diffuseColor;
+	float padding;
+	glm::vec3 specularColor;
+	float shininess;
+};
+
+/***********************************************************
+ *  UniformRingBuffer
+ *
+ *  This class contains the code for allocating per-draw
+ *  uniform data from a triple-buffered ring.
+ ***********************************************************/
+class UniformRingBuffer
+{
+public:
+	// constructor
+	UniformRingBuffer();
+	// destructor
+	~UniformRingBuffer();
+
+	// number of sections whose data can be in use at once
+	static const int SECTION_COUNT = 3;
+
+	// move on to the next section for a new frame, waiting
+	// until the GPU has finished reading it, and grow the
+	// sections towards the passed in number of bytes, up to
+	// their largest size
+	void BeginFrame(size_t requiredSize);
+	// place the fence that protects the current section
+	void EndFrame();
+
+	// copy data into the current section, wrapping on to the
+	// next section when it is full - the offset of the copy in
+	// the buffer is returned, or -1 if there is no buffer
+	GLintptr Write(const void* pData, size_t size);
+	// bind a slice of the buffer to a uniform block binding
+	void BindRange(GLuint bindingIndex, GLintptr offset, size_t size) const;
+
+	// size of the passed in block rounded up to the alignment
+	// of uniform buffer offsets
+	size_t GetAlignedSize(size_t size) const;
+	// true when the buffer is written through a persistent
+	// mapping rather than with glBufferSubData()
+	bool IsPersistent() const { return(m_bPersistent); }
+
+private:
+	GLuint m_buffer;
+	// start of the persistent mapping, or NULL without one
+	unsigned char* m_pMapped;
+	bool m_bPersistent;
+	// fence after the last draw that used each section
+	GLsync m_fences[SECTION_COUNT];
+	int m_section;
+	size_t m_sectionSize;
+	// next free byte of the current section
+	size_t m_offset;
+	GLint m_alignment;
+	// set once the buffer could not be created, so it is not
+	// tried again every frame
+	bool m_bFailed;
+
+	// create the buffer with the passed in section size -
+	// false when the buffer could not be allocated
+	bool Create(size_t sectionSize);
+	// fence the current section and move on to the next one
+	void NextSection();
+	// wait for all the fences and delete the buffer
+	void Destroy();
+	// wait until the GPU is done with a section
+	void WaitForSection(int section);
+};
@@ -14,6 +14,8 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <map>
+
 // declaration of the global variables and defines
 namespace
 {
@@ -36,12 +38,23 @@ namespace
 	float gDeltaTime = 0.0f; 
 	float gLastFrame = 0.0f;
 
+#ifndef __APPLE__
+	// OpenGL versions of the core contexts tried for the
+	// window, newest first, for drivers such as Mesa's
+	// llvmpipe that stop at OpenGL 4.5
+	const int g_ContextVersions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 } };
+	const int g_ContextVersionCount = sizeof(g_ContextVersions) / sizeof(g_ContextVersions[0]);
+#endif
+
 	 //Movement speed that can be adjusted with mouse scroll
 	 float gMovementSpeed = 2.5f;
 
 	// the following variable is false when orthographic projection
 	// is off and true when it is on
 	bool bOrthographicProjection = false;
+
+	// last known state of the keys used as toggle switches
+	std::map<int, bool> gToggleKeyStates;
 }
 
 /***********************************************************
@@ -50,11 +63,15 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderManager *pShaderManager,
+	RENDER_SETTINGS* pRenderSettings)
 {
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
+	m_pRenderSettings = pRenderSettings;
 	m_pWindow = NULL;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
@@ -72,6 +89,7 @@ ViewManager::~ViewManager()
 {
 	// free up allocated memory
 	m_pShaderManager = NULL;
+	m_pRenderSettings = NULL;
 	m_pWindow = NULL;
 	if (NULL != g_pCamera)
 	{
@@ -95,6 +113,23 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 		WINDOW_HEIGHT,
 		windowTitle,
 		NULL, NULL);
+#ifndef __APPLE__
+	// the first version was requested by InitializeGLFW(), so
+	// the older core contexts are tried when it is missing
+	for (int i = 1; (window == NULL) && (i < g_ContextVersionCount); i++)
+	{
+		std::cout << "OpenGL " << g_ContextVersions[i - 1][0] << "." << g_ContextVersions[i - 1][1]
+			<< " is not available, trying OpenGL " << g_ContextVersions[i][0] << "."
+			<< g_ContextVersions[i][1] << std::endl;
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, g_ContextVersions[i][0]);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, g_ContextVersions[i][1]);
+		window = glfwCreateWindow(
+			WINDOW_WIDTH,
+			WINDOW_HEIGHT,
+			windowTitle,
+			NULL, NULL);
+	}
+#endif
 	if (window == NULL)
 	{
 		std::cout << "Failed to create GLFW window" << std::endl;
@@ -250,6 +285,73 @@ void ViewManager::ProcessKeyboardEvents()
 	{
 		bOrthographicProjection = true;
 	}
+
+	// the remaining keys toggle the optional rendering features
+	if (NULL == m_pRenderSettings)
+	{
+		return;
+	}
+
+	// Cycle through the occlusion culling modes with the C key
+	if (WasKeyPressed(GLFW_KEY_C))
+	{
+		m_pRenderSettings->occlusionMode =
+			(OcclusionMode)((m_pRenderSettings->occlusionMode + 1) % OCCLUSION_MODE_COUNT);
+		std::cout << "Occlusion culling: " << GetOcclusionModeName(m_pRenderSettings->occlusionMode) << std::endl;
+	}
+
+	// Toggle between sorted and weighted blended transparency with the T key
+	if (WasKeyPressed(GLFW_KEY_T))
+	{
+		m_pRenderSettings->transparencyMode =
+			(TransparencyMode)((m_pRenderSettings->transparencyMode + 1) % TRANSPARENCY_MODE_COUNT);
+		std::cout << "Transparency: " << GetTransparencyModeName(m_pRenderSettings->transparencyMode) << std::endl;
+	}
+
+	// Toggle the level of detail selection with the L key
+	if (WasKeyPressed(GLFW_KEY_L))
+	{
+		m_pRenderSettings->bLevelOfDetail = !m_pRenderSettings->bLevelOfDetail;
+		std::cout << "Level of detail: " << (m_pRenderSettings->bLevelOfDetail ? "on" : "off") << std::endl;
+	}
+
+	// Toggle the culling of the meshlets of dense meshes with the K key
+	if (WasKeyPressed(GLFW_KEY_K))
+	{
+		m_pRenderSettings->bMeshletCulling = !m_pRenderSettings->bMeshletCulling;
+		std::cout << "Meshlet culling: " << (m_pRenderSettings->bMeshletCulling ? "on" : "off") << std::endl;
+	}
+
+	// Cycle through one, two and three frames in flight with the F key
+	if (WasKeyPressed(GLFW_KEY_F))
+	{
+		m_pRenderSettings->framesInFlight = (m_pRenderSettings->framesInFlight % 3) + 1;
+		std::cout << "Frames in flight: " << m_pRenderSettings->framesInFlight << std::endl;
+	}
+
+	// Toggle the input to photon latency measurement with the M key
+	if (WasKeyPressed(GLFW_KEY_M))
+	{
+		m_pRenderSettings->bMeasureLatency = !m_pRenderSettings->bMeasureLatency;
+		std::cout << "Latency measurement: " << (m_pRenderSettings->bMeasureLatency ? "on" : "off") << std::endl;
+	}
+}
+
+/***********************************************************
+ *  WasKeyPressed()
+ *
+ *  This method is used for detecting a new press of the
+ *  passed in key, so that a switch is toggled only once
+ *  while the key is held down.
+ ***********************************************************/
+bool ViewManager::WasKeyPressed(int key)
+{
+	bool bDown = (glfwGetKey(m_pWindow, key) == GLFW_PRESS);
+	bool bWasDown = gToggleKeyStates[key];
+
+	gToggleKeyStates[key] = bDown;
+
+	return(bDown && !bWasDown);
 }
 
 /***********************************************************
@@ -305,6 +407,10 @@ void ViewManager::PrepareSceneView()
 		 );
 	 }
 
+	// keep the matrices for the CPU side culling of the scene
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
 	{
@@ -315,4 +421,23 @@ void ViewManager::PrepareSceneView()
 		// set the view position of the camera into the shader for proper rendering
 		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
 	}
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera without any
+ *  input, for the camera paths of the stress tests.  The
+ *  next call to PrepareSceneView() uses the new pose.
+ ***********************************************************/
+void ViewManager::SetCameraPose(const glm::vec3& position, const glm::vec3& target)
+{
+	if ((NULL == g_pCamera) || (position == target))
+	{
+		return;
+	}
+
+	g_pCamera->Position = position;
+	g_pCamera->Front = glm::normalize(target - position);
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "RenderSettings.h"
 #include "camera.h"
 
 // GLFW library
@@ -20,7 +21,8 @@ class ViewManager
 public:
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		ShaderManager* pShaderManager,
+		RENDER_SETTINGS* pRenderSettings);
 	// destructor
 	~ViewManager();
 
@@ -35,9 +37,17 @@ private:
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// pointer to the shared rendering switches
+	RENDER_SETTINGS* m_pRenderSettings;
+	// matrices of the current frame
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// check whether the passed in key was pressed since the
+	// last check, so holding a key toggles a switch only once
+	bool WasKeyPressed(int key);
 
 public:
 	// create the initial OpenGL display window
@@ -45,4 +55,11 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// place the camera at a position, looking at a target
+	void SetCameraPose(const glm::vec3& position, const glm::vec3& target);
+
+	// view and projection matrices set by the last call
+	// to PrepareSceneView()
+	const glm::mat4& GetViewMatrix() const { return(m_viewMatrix); }
+	const glm::mat4& GetProjectionMatrix() const { return(m_projectionMatrix); }
 };
\ No newline at end of file
@@ -117,3 +117,83 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 }
 
 
+/***********************************************************
+ *  LoadComputeShader()
+ *
+ *  This method is called to load a compute shader from an
+ *  external GLSL compatible file into a program of its own.
+ *  Unlike the other shaders, a compute shader is optional,
+ *  so 0 is returned when it can not be loaded.
+ ***********************************************************/
+GLuint ShaderManager::LoadComputeShader(const char * compute_file_path){
+
+	m_programID = 0;
+
+	// Read the Compute Shader code from the file
+	std::string ComputeShaderCode;
+	std::ifstream ComputeShaderStream(compute_file_path, std::ios::in);
+	if(ComputeShaderStream.is_open()){
+		std::stringstream sstr;
+		sstr << ComputeShaderStream.rdbuf();
+		ComputeShaderCode = sstr.str();
+		ComputeShaderStream.close();
+	}else{
+		printf("Impossible to open %s. Are you in the right directory ?\n", compute_file_path);
+		return 0;
+	}
+
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	// Compile Compute Shader
+	printf("Compiling shader : %s...", compute_file_path);
+	GLuint ComputeShaderID = glCreateShader(GL_COMPUTE_SHADER);
+	char const * ComputeSourcePointer = ComputeShaderCode.c_str();
+	glShaderSource(ComputeShaderID, 1, &ComputeSourcePointer , NULL);
+	glCompileShader(ComputeShaderID);
+
+	// Check Compute Shader
+	glGetShaderiv(ComputeShaderID, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(ComputeShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 0 ){
+		std::vector<char> ComputeShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(ComputeShaderID, InfoLogLength, NULL, &ComputeShaderErrorMessage[0]);
+		printf("\n%s\n", &ComputeShaderErrorMessage[0]);
+	}
+	if ( Result != GL_TRUE ){
+		printf("failed\n");
+		glDeleteShader(ComputeShaderID);
+		return 0;
+	}
+
+	printf("success\n");
+
+	// Link the program
+	printf("Linking shader program...");
+	GLuint ProgramID = glCreateProgram();
+	glAttachShader(ProgramID, ComputeShaderID);
+	glLinkProgram(ProgramID);
+
+	// Check the program
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
+		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		printf("\n%s\n", &ProgramErrorMessage[0]);
+	}
+
+	glDetachShader(ProgramID, ComputeShaderID);
+	glDeleteShader(ComputeShaderID);
+
+	if ( Result != GL_TRUE ){
+		printf("failed\n");
+		glDeleteProgram(ProgramID);
+		return 0;
+	}
+
+	printf("success\n");
+
+	m_programID = ProgramID;
+	return ProgramID;
+}
@@ -20,6 +20,11 @@ public:
 		const char* vertex_file_path, 
 		const char* fragment_file_path);
 
+	// load a compute shader into a program of its own, or
+	// get 0 when it can not be compiled
+	GLuint LoadComputeShader(
+		const char* compute_file_path);
+
 	// activate the shader
 	// ------------------------------------------------------------------------
 	inline void use()
@@ -0,0 +1,238 @@
+#version 430 core
+layout(local_size_x = 64) in;
+
+#define MAX_LEVELS 8
+
+// the values of every object, laid out like GPU_OBJECT in the code
+// and the ObjectDraw structure of the vertex shader - the detail
+// level is kept here from one frame to the next
+struct ObjectDraw
+{
+   mat4 model;
+   vec4 objectColor;
+   vec4 boundsCenter;
+   vec4 boundsExtents;
+   vec2 UVscale;
+   int bUseTexture;
+   int materialIndex;
+   uint batch;
+   uint mesh;
+   int lod;
+   int padding;
+};
+
+// one detail level of a mesh in the buffer of the shapes
+struct MeshLevel
+{
+   uint indexCount;
+   uint firstIndex;
+   int baseVertex;
+   uint padding;
+};
+
+// the command read by glMultiDrawElementsIndirect()
+struct DrawCommand
+{
+   uint count;
+   uint instanceCount;
+   uint firstIndex;
+   int baseVertex;
+   uint baseInstance;
+};
+
+layout(std430, binding = 0) buffer ObjectDraws
+{
+   ObjectDraw objectDraws[];
+};
+
+layout(std430, binding = 1) readonly buffer MeshLevels
+{
+   MeshLevel meshLevels[];
+};
+
+// first command of every batch, which is also its first object
+layout(std430, binding = 2) readonly buffer BatchStarts
+{
+   uint batchStarts[];
+};
+
+layout(std430, binding = 3) writeonly buffer DrawCommands
+{
+   DrawCommand drawCommands[];
+};
+
+// commands written to every batch, read as the draw count
+layout(std430, binding = 4) buffer DrawCounts
+{
+   uint drawCounts[];
+};
+
+uniform int objectCount;
+
+// camera of the frame being drawn
+uniform mat4 viewProjection;
+uniform mat4 view;
+uniform float projectionScale;
+uniform bool bPerspective;
+
+// depth pyramid of the previous frame, with the camera it was
+// drawn with
+uniform sampler2D depthPyramid;
+uniform bool bDepthPyramid;
+uniform mat4 pyramidViewProjection;
+uniform int pyramidLevels;
+
+// screen sizes of the detail levels, as in SelectLevelOfDetail()
+uniform bool bLevelOfDetail;
+uniform int levelsPerMesh;
+uniform float lodThresholds[MAX_LEVELS - 1];
+uniform float lodHysteresis;
+
+// write the visible commands one after another from the start of
+// their batch, instead of one command per object with the hidden
+// ones left empty
+uniform bool bCompactCommands;
+
+// check whether the box is outside one of the planes of the frustum
+// of the passed in view and projection, from its corners in clip
+// space
+bool IsOutsideFrustum(vec3 center, vec3 extents)
+{
+   vec4 corners[8];
+   for (int i = 0; i < 8; i++)
+   {
+      vec3 corner = center + extents * vec3(((i & 1) != 0) ? 1.0 : -1.0,
+         ((i & 2) != 0) ? 1.0 : -1.0, ((i & 4) != 0) ? 1.0 : -1.0);
+      corners[i] = viewProjection * vec4(corner, 1.0);
+   }
+
+   for (int axis = 0; axis < 3; axis++)
+   {
+      bool bOutsideLow = true;
+      bool bOutsideHigh = true;
+      for (int i = 0; i < 8; i++)
+      {
+         bOutsideLow = bOutsideLow && (corners[i][axis] < -corners[i].w);
+         bOutsideHigh = bOutsideHigh && (corners[i][axis] > corners[i].w);
+      }
+      if (bOutsideLow || bOutsideHigh)
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+// check whether the box was behind the depth of the previous frame -
+// a box that was partly behind its camera or off its screen is not
+// hidden, as the pyramid holds nothing about it
+bool IsOccluded(vec3 center, vec3 extents)
+{
+   vec3 screenMin = vec3(1.0);
+   vec3 screenMax = vec3(0.0);
+   for (int i = 0; i < 8; i++)
+   {
+      vec3 corner = center + extents * vec3(((i & 1) != 0) ? 1.0 : -1.0,
+         ((i & 2) != 0) ? 1.0 : -1.0, ((i & 4) != 0) ? 1.0 : -1.0);
+      vec4 clip = pyramidViewProjection * vec4(corner, 1.0);
+      if (clip.w <= 0.0)
+      {
+         return false;
+      }
+      vec3 screen = (clip.xyz / clip.w) * 0.5 + 0.5;
+      screenMin = min(screenMin, screen);
+      screenMax = max(screenMax, screen);
+   }
+   if ((screenMin.x < 0.0) || (screenMin.y < 0.0) || (screenMax.x > 1.0) || (screenMax.y > 1.0) ||
+      (screenMin.z < 0.0))
+   {
+      return false;
+   }
+
+   // the finest level where the box covers at most two texels
+   // across, whose four texels then cover all of the box
+   ivec2 pyramidSize = textureSize(depthPyramid, 0);
+   ivec2 pixelMin = min(ivec2(screenMin.xy * vec2(pyramidSize)), pyramidSize - 1);
+   ivec2 pixelMax = min(ivec2(screenMax.xy * vec2(pyramidSize)), pyramidSize - 1);
+   int level = 0;
+   while ((level < pyramidLevels - 1) &&
+      (((pixelMax.x >> level) - (pixelMin.x >> level) > 1) || ((pixelMax.y >> level) - (pixelMin.y >> level) > 1)))
+   {
+      level++;
+   }
+
+   ivec2 levelSize = textureSize(depthPyramid, level);
+   ivec2 texelMin = min(pixelMin >> level, levelSize - 1);
+   ivec2 texelMax = min(pixelMax >> level, levelSize - 1);
+   float depth = max(
+      max(texelFetch(depthPyramid, texelMin, level).r, texelFetch(depthPyramid, ivec2(texelMax.x, texelMin.y), level).r),
+      max(texelFetch(depthPyramid, ivec2(texelMin.x, texelMax.y), level).r, texelFetch(depthPyramid, texelMax, level).r));
+   return (screenMin.z > depth);
+}
+
+// choose the detail level from the radius of the bounding sphere on
+// the screen, moving past a threshold only once the size is clearly
+// past it
+int SelectLevelOfDetail(vec3 center, vec3 extents, int lod)
+{
+   if (!bLevelOfDetail)
+   {
+      return 0;
+   }
+
+   float radius = length(extents);
+   float screenRadius = radius * projectionScale;
+   if (bPerspective)
+   {
+      float distance = -(view * vec4(center, 1.0)).z;
+      screenRadius = (distance > radius) ? (screenRadius / distance) : 1.0;
+   }
+
+   while ((lod > 0) && (screenRadius > lodThresholds[lod - 1] * (1.0 + lodHysteresis)))
+   {
+      lod--;
+   }
+   while ((lod < levelsPerMesh - 1) && (screenRadius < lodThresholds[lod] * (1.0 - lodHysteresis)))
+   {
+      lod++;
+   }
+   return lod;
+}
+
+void main()
+{
+   uint objectIndex = gl_GlobalInvocationID.x;
+   if (objectIndex >= uint(objectCount))
+   {
+      return;
+   }
+
+   vec3 center = objectDraws[objectIndex].boundsCenter.xyz;
+   vec3 extents = objectDraws[objectIndex].boundsExtents.xyz;
+   bool bVisible = !IsOutsideFrustum(center, extents);
+   if (bVisible && bDepthPyramid)
+   {
+      bVisible = !IsOccluded(center, extents);
+   }
+
+   if (!bVisible)
+   {
+      if (!bCompactCommands)
+      {
+         drawCommands[objectIndex] = DrawCommand(0u, 0u, 0u, 0, objectIndex);
+      }
+      return;
+   }
+
+   int lod = SelectLevelOfDetail(center, extents, objectDraws[objectIndex].lod);
+   objectDraws[objectIndex].lod = lod;
+
+   MeshLevel level = meshLevels[objectDraws[objectIndex].mesh * uint(levelsPerMesh) + uint(lod)];
+   uint command = objectIndex;
+   if (bCompactCommands)
+   {
+      uint batch = objectDraws[objectIndex].batch;
+      command = batchStarts[batch] + atomicAdd(drawCounts[batch], 1u);
+   }
+   drawCommands[command] = DrawCommand(level.indexCount, 1u, level.firstIndex, level.baseVertex, objectIndex);
+}
@@ -1,4 +1,4 @@
-#version 440 core
+#version 430 core
 
 struct Material 
 {
@@ -24,23 +24,42 @@ struct LightSource
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+// values that change with every draw, passed on by the vertex
+// shader from the DrawData block or from the object of an
+// indirect draw
+flat in vec4 fragmentObjectColor;
+flat in vec2 fragmentUVscale;
+flat in int fragmentUseTexture;
+flat in int fragmentMaterialIndex;
+
+layout(location = 0) out vec4 outFragmentColor;
+// transparency of the fragment, written in the weighted blended
+// transparency pass only
+layout(location = 1) out float outRevealage;
+
+// all the object materials of the scene, uploaded once - the
+// binding matches MATERIALS_BINDING in the code
+layout(std430, binding = 5) readonly buffer Materials
+{
+   Material materials[];
+};
 
-out vec4 outFragmentColor;
-
-uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
+uniform bool bWeightedTransparency=false;
 uniform sampler2D objectTexture;
 uniform vec3 viewPosition;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
 uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
+
+// material of the object being drawn
+Material material;
 
 // function prototypes
 vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
 
 void main()
 {
+   material = materials[fragmentMaterialIndex];
+
    if(bUseLighting == true)
    {
       // properties
@@ -53,27 +72,38 @@ void main()
          phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
       }   
     
-      if(bUseTexture == true)
+      if(fragmentUseTexture != 0)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * fragmentUVscale);
          outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
       }
       else
       {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+         outFragmentColor = vec4(phongResult * fragmentObjectColor.xyz, fragmentObjectColor.w);
       }
    }
    else 
    {
-      if(bUseTexture == true)
+      if(fragmentUseTexture != 0)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * fragmentUVscale);
       }
       else
       {
-         outFragmentColor = objectColor;
+         outFragmentColor = fragmentObjectColor;
       }
    }
+
+   // in the weighted blended transparency pass, the color is
+   // premultiplied and weighted so that nearer and more opaque
+   // fragments count for more, and added to the sums of the pass
+   if(bWeightedTransparency == true)
+   {
+      vec4 color = outFragmentColor;
+      float weight = clamp(pow(min(1.0, color.a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+      outFragmentColor = vec4(color.rgb * color.a, color.a) * weight;
+      outRevealage = color.a;
+   }
 }
 
 // calculates the color when using a directional light.
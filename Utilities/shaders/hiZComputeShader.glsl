@@ -0,0 +1,52 @@
+#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// the depth of the window, copied after the opaque objects were
+// drawn, which is read for the first level of the pyramid
+uniform sampler2D depthTexture;
+uniform bool bCopyDepth;
+
+// the level the pyramid is reduced from, and the level written
+layout(r32f, binding = 0) readonly uniform image2D sourceLevel;
+layout(r32f, binding = 1) writeonly uniform image2D targetLevel;
+
+void main()
+{
+   ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+   ivec2 targetSize = imageSize(targetLevel);
+   if ((texel.x >= targetSize.x) || (texel.y >= targetSize.y))
+   {
+      return;
+   }
+
+   if (bCopyDepth)
+   {
+      imageStore(targetLevel, texel, vec4(texelFetch(depthTexture, texel, 0).r));
+      return;
+   }
+
+   // every texel keeps the farthest depth of the texels it covers -
+   // the last column and row of an odd sized level also take the
+   // texels the halved size leaves over, so no depth is lost
+   ivec2 sourceSize = imageSize(sourceLevel);
+   ivec2 first = texel * 2;
+   ivec2 last = first + 1;
+   if (texel.x == targetSize.x - 1)
+   {
+      last.x = sourceSize.x - 1;
+   }
+   if (texel.y == targetSize.y - 1)
+   {
+      last.y = sourceSize.y - 1;
+   }
+
+   float depth = 0.0;
+   for (int y = first.y; y <= last.y; y++)
+   {
+      for (int x = first.x; x <= last.x; x++)
+      {
+         depth = max(depth, imageLoad(sourceLevel, ivec2(x, y)).r);
+      }
+   }
+   imageStore(targetLevel, texel, vec4(depth));
+}
@@ -0,0 +1,33 @@
+#version 330 core
+
+// sum of the weighted premultiplied colors and the product of the
+// transparencies of the translucent objects
+uniform sampler2D accumulationTexture;
+uniform sampler2D revealageTexture;
+
+out vec4 outFragmentColor;
+
+void main()
+{
+   ivec2 pixel = ivec2(gl_FragCoord.xy);
+   float revealage = texelFetch(revealageTexture, pixel, 0).r;
+
+   // nothing translucent covers this pixel
+   if(revealage >= 1.0)
+   {
+      discard;
+   }
+
+   vec4 accumulation = texelFetch(accumulationTexture, pixel, 0);
+
+   // keep the sums from overflowing to infinity
+   if(isinf(max(max(abs(accumulation.r), abs(accumulation.g)), abs(accumulation.b))))
+   {
+      accumulation.rgb = vec3(accumulation.a);
+   }
+
+   // the weighted average color, blended over the window by the
+   // transparency that is left
+   vec3 averageColor = accumulation.rgb / max(accumulation.a, 0.00001);
+   outFragmentColor = vec4(averageColor, revealage);
+}
@@ -0,0 +1,9 @@
+#version 330 core
+
+// a triangle that covers the whole screen, made from the vertex
+// index alone, so no vertex buffer is needed
+void main()
+{
+   vec2 position = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1)) - 1.0;
+   gl_Position = vec4(position, 0.0, 1.0);
+}
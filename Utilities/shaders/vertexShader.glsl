@@ -1,20 +1,99 @@
-#version 330 core
+#version 430 core
 layout (location = 0) in vec3 inVertexPosition;
-layout (location = 1) in vec3 inVertexNormal;
+layout (location = 1) in vec4 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
+// index of the object of an indirect draw, read once per instance
+// from its base instance
+layout (location = 3) in uint inObjectIndex;
 
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+// the values of the draw that the fragment shader needs
+flat out vec4 fragmentObjectColor;
+flat out vec2 fragmentUVscale;
+flat out int fragmentUseTexture;
+flat out int fragmentMaterialIndex;
+
+// values that change with every draw, read from its own slice
+// of the per-draw uniform ring buffer
+layout(std140) uniform DrawData
+{
+   mat4 model;
+   vec4 objectColor;
+   vec2 UVscale;
+   bool bUseTexture;
+   int materialIndex;
+};
+
+// the values of every object culled on the GPU, laid out like
+// GPU_OBJECT in the code, read instead of the DrawData block by
+// the indirect draws
+struct ObjectDraw
+{
+   mat4 model;
+   vec4 objectColor;
+   vec4 boundsCenter;
+   vec4 boundsExtents;
+   vec2 UVscale;
+   int bUseTexture;
+   int materialIndex;
+   uint batch;
+   uint mesh;
+   int lod;
+   int padding;
+};
+
+layout(std430, binding = 0) readonly buffer ObjectDraws
+{
+   ObjectDraw objectDraws[];
+};
+
+uniform bool bGpuDriven;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// the meshes are stored in the packed vertex layout - the model
+// matrix already turns their positions into object space, and
+// the normal is an octahedral value in plain integers
+uniform bool bPackedVertices;
+const float packedNormalScale = 511.0;
+
+vec3 DecodeOctahedralNormal(vec2 encoded)
+{
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   float fold = max(-normal.z, 0.0);
+   normal.x += (normal.x >= 0.0) ? -fold : fold;
+   normal.y += (normal.y >= 0.0) ? -fold : fold;
+   return normalize(normal);
+}
+
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
+   mat4 drawModel = model;
+   fragmentObjectColor = objectColor;
+   fragmentUVscale = UVscale;
+   fragmentUseTexture = bUseTexture ? 1 : 0;
+   fragmentMaterialIndex = materialIndex;
+   if (bGpuDriven)
+   {
+      drawModel = objectDraws[inObjectIndex].model;
+      fragmentObjectColor = objectDraws[inObjectIndex].objectColor;
+      fragmentUVscale = objectDraws[inObjectIndex].UVscale;
+      fragmentUseTexture = objectDraws[inObjectIndex].bUseTexture;
+      fragmentMaterialIndex = objectDraws[inObjectIndex].materialIndex;
+   }
+
+   fragmentPosition = vec3(drawModel * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * drawModel * vec4(inVertexPosition, 1.0f);
+   if (bPackedVertices)
+   {
+      fragmentVertexNormal = DecodeOctahedralNormal(max(inVertexNormal.xy / packedNormalScale, vec2(-1.0)));
+   }
+   else
+   {
+      fragmentVertexNormal = inVertexNormal.xyz;
+   }
    fragmentTextureCoordinate = inTextureCoordinate;
 }
\ No newline at end of file